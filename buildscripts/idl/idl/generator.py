@@ -896,6 +896,7 @@ class _CppSourceFileWriter(_CppFileWriterBase):
         cpp_type = cpp_type_info.get_type_name()
 
         self._writer.write_line('std::vector<%s> values;' % (cpp_type))
+        self._writer.write_line('values.reserve(sequence.objs.size());')
         self._writer.write_empty_line()
 
         # TODO: add support for sequence length checks, today we allow an empty document sequence
@@ -1398,6 +1399,8 @@ class _CppSourceFileWriter(_CppFileWriterBase):
                 self._writer.write_line('OpMsg::DocumentSequence documentSequence;')
                 self._writer.write_template('documentSequence.name = %s.toString();' %
                                             (_get_field_constant_name(field)))
+                self._writer.write_line('documentSequence.objs.reserve(%s.size());' %
+                                        (_access_member(field)))
 
                 with self._block('for (const auto& item : %s) {' % (_access_member(field)), '}'):
 
@@ -1412,7 +1415,8 @@ class _CppSourceFileWriter(_CppFileWriterBase):
                         self._writer.write_line('item.serialize(&builder);')
                         self._writer.write_line('documentSequence.objs.push_back(builder.obj());')
 
-                self._writer.write_template('request.sequences.emplace_back(documentSequence);')
+                self._writer.write_template(
+                    'request.sequences.emplace_back(std::move(documentSequence));')
 
             # Add a blank line after each block
             self._writer.write_empty_line()
@@ -0,0 +1,103 @@
+//
+// Tests the initial clone of a chunk migration, which the recipient fetches over several concurrent
+// _migrateClone requests:
+//     1. An aborted migration does not wait for the _migrateClone requests in flight.
+//     2. A failed _migrateClone request fails the migration.
+//     3. Every document of the chunk arrives on the recipient exactly once.
+//
+
+load('./jstests/libs/chunk_manipulation_util.js');
+
+(function() {
+    'use strict';
+
+    var staticMongod = MongoRunner.runMongod({});  // For startParallelOps.
+
+    var st = new ShardingTest({shards: 2, other: {enableAutoSplit: false}});
+
+    var mongos = st.s0, admin = mongos.getDB('admin'), dbName = 'testDB', ns = dbName + '.foo',
+        coll = mongos.getCollection(ns), shard0 = st.shard0, shard1 = st.shard1,
+        shard0Coll = shard0.getCollection(ns), shard1Coll = shard1.getCollection(ns);
+
+    assert.commandWorked(admin.runCommand({enableSharding: dbName}));
+    st.ensurePrimaryShard(dbName, st.shard0.shardName);
+    assert.commandWorked(admin.runCommand({shardCollection: ns, key: {_id: 1}}));
+
+    // Enough data for the initial clone to need several _migrateClone batches
+    var numDocs = 4000;
+    var padding = 'x'.repeat(16 * 1024);
+    var bulk = coll.initializeUnorderedBulkOp();
+    for (var i = 0; i < numDocs; i++) {
+        bulk.insert({_id: i, padding: padding});
+    }
+    assert.writeOK(bulk.execute());
+    assert.eq(numDocs, shard0Coll.find().itcount());
+
+    jsTest.log('Aborting a migration while its _migrateClone requests are in flight...');
+
+    assert.commandWorked(shard0.adminCommand(
+        {configureFailPoint: 'hangBeforeMigrateClone', mode: 'alwaysOn'}));
+
+    var joinMoveChunk =
+        moveChunkParallel(staticMongod, st.s0.host, {_id: 0}, null, ns, st.shard1.shardName);
+
+    assert.soon(function() {
+        return shard0.getDB('admin')
+                   .aggregate([
+                       {$currentOp: {allUsers: true}},
+                       {$match: {'command._migrateClone': ns}}
+                   ])
+                   .itcount() > 0;
+    }, 'recipient never issued _migrateClone');
+
+    let inProgressOps = shard0.getDB('admin').aggregate([{$currentOp: {allUsers: true}}]);
+    var abortedMigration = false;
+    let inProgressStr = '';
+    while (inProgressOps.hasNext()) {
+        let op = inProgressOps.next();
+        inProgressStr += tojson(op);
+        if (op.command.moveChunk) {
+            shard0.getDB('admin').killOp(op.opid);
+            abortedMigration = true;
+        }
+    }
+    assert.eq(
+        true, abortedMigration, "Failed to abort migration, current running ops: " + inProgressStr);
+
+    // The donor is still not responding to _migrateClone, but the recipient must not wait for it
+    assert.soon(function() {
+        var res = shard1.adminCommand({'_recvChunkStatus': 1});
+        return (res.active == false);
+    }, "recipient didn't abort the migration while its _migrateClone requests were in flight");
+
+    assert.throws(function() {
+        joinMoveChunk();
+    });
+
+    assert.commandWorked(
+        shard0.adminCommand({configureFailPoint: 'hangBeforeMigrateClone', mode: 'off'}));
+    assert.eq(numDocs, shard0Coll.find().itcount(), "donor lost documents of an aborted migration");
+
+    jsTest.log('Failing a migration with a failed _migrateClone request...');
+
+    assert.commandWorked(
+        shard0.adminCommand({configureFailPoint: 'failMigrateClone', mode: 'alwaysOn'}));
+    assert.commandFailed(admin.runCommand({moveChunk: ns, find: {_id: 0}, to: shard1.shardName}));
+    assert.commandWorked(
+        shard0.adminCommand({configureFailPoint: 'failMigrateClone', mode: 'off'}));
+    assert.eq(numDocs, shard0Coll.find().itcount(), "donor lost documents of a failed migration");
+
+    jsTest.log('Migrating the chunk over several concurrent _migrateClone requests...');
+
+    assert.commandWorked(shard1.adminCommand({setParameter: 1, migrateCloneFetcherThreads: 4}));
+    assert.commandWorked(admin.runCommand(
+        {moveChunk: ns, find: {_id: 0}, to: shard1.shardName, _waitForDelete: true}));
+
+    assert.eq(0, shard0Coll.find().itcount());
+    assert.eq(numDocs, shard1Coll.find({padding: padding}).itcount());
+    assert.eq(numDocs, shard1Coll.aggregate([{$group: {_id: '$_id'}}]).itcount());
+    assert.eq(numDocs, coll.find().itcount());
+
+    st.stop();
+    MongoRunner.stopMongod(staticMongod);
+})();
@@ -28,6 +28,9 @@
 
 #pragma once
 
+#include <boost/optional.hpp>
+#include <set>
+
 #include "mongo/base/disallow_copying.h"
 #include "mongo/util/net/hostandport.h"
 #include "mongo/util/time_support.h"
@@ -106,6 +109,27 @@ public:
      */
     virtual void markHostUnreachable(const HostAndPort& host, const Status& status) = 0;
 
+    /**
+     * Finds a host matching readPref which is not one of 'excludedHosts', using only the
+     * targeter's current view and without blocking. Returns FailedToSatisfyReadPreference if
+     * there is no such host. Used to pick a different member to send a hedged read to.
+     */
+    virtual StatusWith<HostAndPort> findHostExcluding(
+        const ReadPreferenceSetting& readPref, const std::set<HostAndPort>& excludedHosts) = 0;
+
+    /**
+     * Reports to the targeter that a command sent to 'host' received its reply after 'latency',
+     * so that the round trip times observed by callers can inform host selection.
+     */
+    virtual void updateHostCommandLatency(const HostAndPort& host, Microseconds latency) = 0;
+
+    /**
+     * Returns the given percentile (1-100) of the command round trip times reported for 'host'
+     * through updateHostCommandLatency, or boost::none if not enough are known.
+     */
+    virtual boost::optional<Microseconds> getHostCommandLatencyPercentile(const HostAndPort& host,
+                                                                          int percentile) = 0;
+
 protected:
     RemoteCommandTargeter() = default;
 };
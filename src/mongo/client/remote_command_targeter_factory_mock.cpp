@@ -65,6 +65,20 @@ public:
         _mock->markHostUnreachable(host, status);
     }
 
+    StatusWith<HostAndPort> findHostExcluding(const ReadPreferenceSetting& readPref,
+                                              const std::set<HostAndPort>& excludedHosts) override {
+        return _mock->findHostExcluding(readPref, excludedHosts);
+    }
+
+    void updateHostCommandLatency(const HostAndPort& host, Microseconds latency) override {
+        _mock->updateHostCommandLatency(host, latency);
+    }
+
+    boost::optional<Microseconds> getHostCommandLatencyPercentile(const HostAndPort& host,
+                                                                  int percentile) override {
+        return _mock->getHostCommandLatencyPercentile(host, percentile);
+    }
+
 private:
     const std::shared_ptr<RemoteCommandTargeter> _mock;
 };
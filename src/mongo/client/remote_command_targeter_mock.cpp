@@ -68,6 +68,27 @@ void RemoteCommandTargeterMock::markHostNotMaster(const HostAndPort& host, const
 void RemoteCommandTargeterMock::markHostUnreachable(const HostAndPort& host, const Status& status) {
 }
 
+StatusWith<HostAndPort> RemoteCommandTargeterMock::findHostExcluding(
+    const ReadPreferenceSetting& readPref, const std::set<HostAndPort>& excludedHosts) {
+    if (_findHostExcludingReturnValue) {
+        return *_findHostExcludingReturnValue;
+    }
+
+    if (_findHostReturnValue.isOK() && excludedHosts.count(_findHostReturnValue.getValue())) {
+        return {ErrorCodes::FailedToSatisfyReadPreference, "All matching hosts are excluded"};
+    }
+
+    return _findHostReturnValue;
+}
+
+void RemoteCommandTargeterMock::updateHostCommandLatency(const HostAndPort& host,
+                                                         Microseconds latency) {}
+
+boost::optional<Microseconds> RemoteCommandTargeterMock::getHostCommandLatencyPercentile(
+    const HostAndPort& host, int percentile) {
+    return _hostCommandLatencyPercentileReturnValue;
+}
+
 void RemoteCommandTargeterMock::setConnectionStringReturnValue(const ConnectionString returnValue) {
     _connectionStringReturnValue = std::move(returnValue);
 }
@@ -76,4 +97,14 @@ void RemoteCommandTargeterMock::setFindHostReturnValue(StatusWith<HostAndPort> r
     _findHostReturnValue = std::move(returnValue);
 }
 
+void RemoteCommandTargeterMock::setFindHostExcludingReturnValue(
+    StatusWith<HostAndPort> returnValue) {
+    _findHostExcludingReturnValue = std::move(returnValue);
+}
+
+void RemoteCommandTargeterMock::setHostCommandLatencyPercentileReturnValue(
+    boost::optional<Microseconds> returnValue) {
+    _hostCommandLatencyPercentileReturnValue = std::move(returnValue);
+}
+
 }  // namespace mongo
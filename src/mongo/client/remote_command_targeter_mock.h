@@ -70,6 +70,26 @@ public:
      */
     void markHostUnreachable(const HostAndPort& host, const Status& status) override;
 
+    /**
+     * Returns the return value last set by setFindHostExcludingReturnValue if it was called.
+     * Otherwise returns the return value last set by setFindHostReturnValue, unless that host is
+     * excluded.
+     */
+    StatusWith<HostAndPort> findHostExcluding(const ReadPreferenceSetting& readPref,
+                                              const std::set<HostAndPort>& excludedHosts) override;
+
+    /**
+     * No-op for the mock.
+     */
+    void updateHostCommandLatency(const HostAndPort& host, Microseconds latency) override;
+
+    /**
+     * Returns the value last set by setHostCommandLatencyPercentileReturnValue for every host.
+     * Returns boost::none if it was never called.
+     */
+    boost::optional<Microseconds> getHostCommandLatencyPercentile(const HostAndPort& host,
+                                                                  int percentile) override;
+
     /**
      * Sets the return value for the next call to connectionString.
      */
@@ -80,9 +100,21 @@ public:
      */
     void setFindHostReturnValue(StatusWith<HostAndPort> returnValue);
 
+    /**
+     * Sets the return value for the next call to findHostExcluding.
+     */
+    void setFindHostExcludingReturnValue(StatusWith<HostAndPort> returnValue);
+
+    /**
+     * Sets the return value for the next call to getHostCommandLatencyPercentile.
+     */
+    void setHostCommandLatencyPercentileReturnValue(boost::optional<Microseconds> returnValue);
+
 private:
     ConnectionString _connectionStringReturnValue;
     StatusWith<HostAndPort> _findHostReturnValue;
+    boost::optional<StatusWith<HostAndPort>> _findHostExcludingReturnValue;
+    boost::optional<Microseconds> _hostCommandLatencyPercentileReturnValue;
 };
 
 }  // namespace mongo
@@ -100,4 +100,34 @@ void RemoteCommandTargeterRS::markHostUnreachable(const HostAndPort& host, const
     _rsMonitor->failedHost(host, status);
 }
 
+StatusWith<HostAndPort> RemoteCommandTargeterRS::findHostExcluding(
+    const ReadPreferenceSetting& readPref, const std::set<HostAndPort>& excludedHosts) {
+    invariant(_rsMonitor);
+
+    auto host = _rsMonitor->getMatchingHostExcluding(readPref, excludedHosts);
+    if (host.empty()) {
+        return {ErrorCodes::FailedToSatisfyReadPreference,
+                str::stream() << "Could not find another host matching read preference "
+                              << readPref.toString()
+                              << " for set "
+                              << _rsName};
+    }
+
+    return host;
+}
+
+void RemoteCommandTargeterRS::updateHostCommandLatency(const HostAndPort& host,
+                                                       Microseconds latency) {
+    invariant(_rsMonitor);
+
+    _rsMonitor->updateHostCommandLatency(host, latency);
+}
+
+boost::optional<Microseconds> RemoteCommandTargeterRS::getHostCommandLatencyPercentile(
+    const HostAndPort& host, int percentile) {
+    invariant(_rsMonitor);
+
+    return _rsMonitor->getHostCommandLatencyPercentile(host, percentile);
+}
+
 }  // namespace mongo
@@ -62,6 +62,14 @@ public:
 
     void markHostUnreachable(const HostAndPort& host, const Status& status) override;
 
+    StatusWith<HostAndPort> findHostExcluding(const ReadPreferenceSetting& readPref,
+                                              const std::set<HostAndPort>& excludedHosts) override;
+
+    void updateHostCommandLatency(const HostAndPort& host, Microseconds latency) override;
+
+    boost::optional<Microseconds> getHostCommandLatencyPercentile(const HostAndPort& host,
+                                                                  int percentile) override;
+
 private:
     // Name of the replica set which this targeter maintains
     const std::string _rsName;
@@ -62,4 +62,24 @@ void RemoteCommandTargeterStandalone::markHostUnreachable(const HostAndPort& hos
     dassert(host == _hostAndPort);
 }
 
+StatusWith<HostAndPort> RemoteCommandTargeterStandalone::findHostExcluding(
+    const ReadPreferenceSetting& readPref, const std::set<HostAndPort>& excludedHosts) {
+    if (excludedHosts.count(_hostAndPort)) {
+        return {ErrorCodes::FailedToSatisfyReadPreference,
+                "A standalone host has no other members to target"};
+    }
+
+    return _hostAndPort;
+}
+
+void RemoteCommandTargeterStandalone::updateHostCommandLatency(const HostAndPort& host,
+                                                               Microseconds latency) {
+    dassert(host == _hostAndPort);
+}
+
+boost::optional<Microseconds> RemoteCommandTargeterStandalone::getHostCommandLatencyPercentile(
+    const HostAndPort& host, int percentile) {
+    return boost::none;
+}
+
 }  // namespace mongo
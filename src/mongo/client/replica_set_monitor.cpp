@@ -42,6 +42,7 @@
 #include "mongo/db/operation_context.h"
 #include "mongo/db/repl/bson_extract_optime.h"
 #include "mongo/db/server_options.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/s/grid.h"
 #include "mongo/stdx/condition_variable.h"
 #include "mongo/stdx/mutex.h"
@@ -86,6 +87,34 @@ const double socketTimeoutSecs = 5;
 // Intentionally chosen to compare worse than all known latencies.
 const int64_t unknownLatency = numeric_limits<int64_t>::max();
 
+/**
+ * When non-zero, hosts eligible for a read are ranked by this percentile of the command round trip
+ * times reported through ReplicaSetMonitor::updateHostCommandLatency() rather than by the smoothed
+ * isMaster ping time, so that a member which is slow to serve commands (for example because it is
+ * checkpointing) stops being chosen even though it still answers isMaster promptly. The ping times
+ * are still used while any eligible host has too few command round trip times recorded.
+ */
+AtomicInt32 replicaSetMonitorReadLatencyPercentile(0);
+
+class ReplicaSetMonitorReadLatencyPercentile
+    : public ExportedServerParameter<int, ServerParameterType::kStartupAndRuntime> {
+public:
+    ReplicaSetMonitorReadLatencyPercentile()
+        : ExportedServerParameter<int, ServerParameterType::kStartupAndRuntime>(
+              ServerParameterSet::getGlobal(),
+              "replicaSetMonitorReadLatencyPercentile",
+              &replicaSetMonitorReadLatencyPercentile) {}
+
+    Status validate(const int& potentialNewValue) override {
+        if (potentialNewValue < 0 || potentialNewValue > 100) {
+            return Status(ErrorCodes::BadValue,
+                          "replicaSetMonitorReadLatencyPercentile must be between 0 and 100");
+        }
+
+        return Status::OK();
+    }
+} replicaSetMonitorReadLatencyPercentileServerParameter;
+
 const ReadPreferenceSetting kPrimaryOnlyReadPreference(ReadPreference::PrimaryOnly, TagSet());
 const Milliseconds kFindHostMaxBackOffTime(500);
 AtomicBool areRefreshRetriesDisabledForTest{false};  // Only true in tests.
@@ -106,9 +135,10 @@ bool opTimeGreater(const Node* lhs, const Node* rhs) {
     return lhs->opTime > rhs->opTime;
 }
 
-bool compareLatencies(const Node* lhs, const Node* rhs) {
+bool compareLatencies(const std::pair<int64_t, const Node*>& lhs,
+                      const std::pair<int64_t, const Node*>& rhs) {
     // NOTE: this automatically compares Node::unknownLatency worse than all others.
-    return lhs->latencyMicros < rhs->latencyMicros;
+    return lhs.first < rhs.first;
 }
 
 bool hostsEqual(const Node& lhs, const HostAndPort& rhs) {
@@ -329,6 +359,33 @@ void ReplicaSetMonitor::failedHost(const HostAndPort& host, const Status& status
     DEV _state->checkInvariants();
 }
 
+HostAndPort ReplicaSetMonitor::getMatchingHostExcluding(
+    const ReadPreferenceSetting& criteria, const std::set<HostAndPort>& excludedHosts) const {
+    stdx::lock_guard<stdx::mutex> lk(_state->mutex);
+    return _state->getMatchingHost(criteria, excludedHosts);
+}
+
+void ReplicaSetMonitor::updateHostCommandLatency(const HostAndPort& host, Microseconds latency) {
+    stdx::lock_guard<stdx::mutex> lk(_state->mutex);
+    Node* node = _state->findNode(host);
+    if (node)
+        node->recordCommandLatency(durationCount<Microseconds>(latency));
+}
+
+boost::optional<Microseconds> ReplicaSetMonitor::getHostCommandLatencyPercentile(
+    const HostAndPort& host, int percentile) const {
+    stdx::lock_guard<stdx::mutex> lk(_state->mutex);
+    Node* node = _state->findNode(host);
+    if (!node)
+        return boost::none;
+
+    auto latencyMicros = node->getCommandLatencyPercentile(percentile);
+    if (!latencyMicros)
+        return boost::none;
+
+    return Microseconds(*latencyMicros);
+}
+
 bool ReplicaSetMonitor::isPrimary(const HostAndPort& host) const {
     stdx::lock_guard<stdx::mutex> lk(_state->mutex);
     Node* node = _state->findNode(host);
@@ -924,6 +981,9 @@ void IsMasterReply::parse(const BSONObj& obj) {
     }
 }
 
+constexpr size_t Node::kCommandLatencyWindowSize;
+constexpr size_t Node::kMinCommandLatencySamples;
+
 Node::Node(const HostAndPort& host) : host(host), latencyMicros(unknownLatency) {}
 
 void Node::markFailed(const Status& status) {
@@ -998,6 +1058,31 @@ void Node::update(const IsMasterReply& reply) {
     lastWriteDateUpdateTime = Date_t::now();
 }
 
+void Node::recordCommandLatency(int64_t commandLatencyMicros) {
+    if (commandLatencyMicros < 0)
+        return;
+
+    commandLatencySamples[numCommandLatencySamples++ % kCommandLatencyWindowSize] =
+        commandLatencyMicros;
+}
+
+boost::optional<int64_t> Node::getCommandLatencyPercentile(int percentile) const {
+    invariant(percentile > 0 && percentile <= 100);
+
+    const size_t numSamples = std::min(numCommandLatencySamples, kCommandLatencyWindowSize);
+    if (numSamples < kMinCommandLatencySamples)
+        return boost::none;
+
+    // The window is small, so select the percentile from a scratch copy on each call rather than
+    // maintaining an ordered structure on the hot path which records the samples.
+    std::array<int64_t, kCommandLatencyWindowSize> samples;
+    std::copy_n(commandLatencySamples.begin(), numSamples, samples.begin());
+
+    const size_t rank = (numSamples - 1) * percentile / 100;
+    std::nth_element(samples.begin(), samples.begin() + rank, samples.begin() + numSamples);
+    return samples[rank];
+}
+
 SetState::SetState(StringData name, const std::set<HostAndPort>& seedNodes)
     : name(name.toString()),
       consecutiveFailedScans(0),
@@ -1029,33 +1114,38 @@ SetState::SetState(const MongoURI& uri)
     setUri = uri;
 }
 
-HostAndPort SetState::getMatchingHost(const ReadPreferenceSetting& criteria) const {
+HostAndPort SetState::getMatchingHost(const ReadPreferenceSetting& criteria,
+                                      const std::set<HostAndPort>& excludedHosts) const {
     switch (criteria.pref) {
         // "Prefered" read preferences are defined in terms of other preferences
         case ReadPreference::PrimaryPreferred: {
-            HostAndPort out =
-                getMatchingHost(ReadPreferenceSetting(ReadPreference::PrimaryOnly, criteria.tags));
+            HostAndPort out = getMatchingHost(
+                ReadPreferenceSetting(ReadPreference::PrimaryOnly, criteria.tags), excludedHosts);
             // NOTE: the spec says we should use the primary even if tags don't match
             if (!out.empty())
                 return out;
-            return getMatchingHost(ReadPreferenceSetting(
-                ReadPreference::SecondaryOnly, criteria.tags, criteria.maxStalenessSeconds));
+            return getMatchingHost(ReadPreferenceSetting(ReadPreference::SecondaryOnly,
+                                                         criteria.tags,
+                                                         criteria.maxStalenessSeconds),
+                                   excludedHosts);
         }
 
         case ReadPreference::SecondaryPreferred: {
-            HostAndPort out = getMatchingHost(ReadPreferenceSetting(
-                ReadPreference::SecondaryOnly, criteria.tags, criteria.maxStalenessSeconds));
+            HostAndPort out = getMatchingHost(ReadPreferenceSetting(ReadPreference::SecondaryOnly,
+                                                                    criteria.tags,
+                                                                    criteria.maxStalenessSeconds),
+                                              excludedHosts);
             if (!out.empty())
                 return out;
             // NOTE: the spec says we should use the primary even if tags don't match
             return getMatchingHost(
-                ReadPreferenceSetting(ReadPreference::PrimaryOnly, criteria.tags));
+                ReadPreferenceSetting(ReadPreference::PrimaryOnly, criteria.tags), excludedHosts);
         }
 
         case ReadPreference::PrimaryOnly: {
             // NOTE: isMaster implies isUp
             Nodes::const_iterator it = std::find_if(nodes.begin(), nodes.end(), isMaster);
-            if (it == nodes.end())
+            if (it == nodes.end() || excludedHosts.count(it->host))
                 return HostAndPort();
             return it->host;
         }
@@ -1111,7 +1201,7 @@ HostAndPort SetState::getMatchingHost(const ReadPreferenceSetting& criteria) con
                 std::vector<const Node*> matchingNodes;
                 for (size_t i = 0; i < nodes.size(); i++) {
                     if (nodes[i].matches(criteria.pref) && nodes[i].matches(tag) &&
-                        matchNode(nodes[i])) {
+                        matchNode(nodes[i]) && !excludedHosts.count(nodes[i].host)) {
                         matchingNodes.push_back(&nodes[i]);
                     }
                 }
@@ -1146,13 +1236,34 @@ HostAndPort SetState::getMatchingHost(const ReadPreferenceSetting& criteria) con
 
                 // If there are multiple nodes satisfying the minOpTime, next order by latency
                 // and don't consider hosts further than a threshold from the closest.
-                std::sort(matchingNodes.begin(), matchingNodes.end(), compareLatencies);
-                for (size_t i = 1; i < matchingNodes.size(); i++) {
-                    int64_t distance =
-                        matchingNodes[i]->latencyMicros - matchingNodes[0]->latencyMicros;
+                // The command round trip times are only used if every candidate has enough of
+                // them, since they are not comparable with the isMaster ping times.
+                const int latencyPercentile = replicaSetMonitorReadLatencyPercentile.load();
+                std::vector<std::pair<int64_t, const Node*>> nodesByLatency;
+                nodesByLatency.reserve(matchingNodes.size());
+                if (latencyPercentile > 0) {
+                    for (const Node* node : matchingNodes) {
+                        auto commandLatencyMicros =
+                            node->getCommandLatencyPercentile(latencyPercentile);
+                        if (!commandLatencyMicros) {
+                            nodesByLatency.clear();
+                            break;
+                        }
+                        nodesByLatency.emplace_back(*commandLatencyMicros, node);
+                    }
+                }
+                if (nodesByLatency.empty()) {
+                    for (const Node* node : matchingNodes) {
+                        nodesByLatency.emplace_back(node->latencyMicros, node);
+                    }
+                }
+
+                std::sort(nodesByLatency.begin(), nodesByLatency.end(), compareLatencies);
+                for (size_t i = 1; i < nodesByLatency.size(); i++) {
+                    int64_t distance = nodesByLatency[i].first - nodesByLatency[0].first;
                     if (distance >= latencyThresholdMicros) {
                         // this node and all remaining ones are too far away
-                        matchingNodes.erase(matchingNodes.begin() + i, matchingNodes.end());
+                        nodesByLatency.erase(nodesByLatency.begin() + i, nodesByLatency.end());
                         break;
                     }
                 }
@@ -1160,10 +1271,10 @@ HostAndPort SetState::getMatchingHost(const ReadPreferenceSetting& criteria) con
                 // of the remaining nodes, pick one at random (or use round-robin)
                 if (ReplicaSetMonitor::useDeterministicHostSelection) {
                     // only in tests
-                    return matchingNodes[roundRobin++ % matchingNodes.size()]->host;
+                    return nodesByLatency[roundRobin++ % nodesByLatency.size()].second->host;
                 } else {
                     // normal case
-                    return matchingNodes[rand.nextInt32(matchingNodes.size())]->host;
+                    return nodesByLatency[rand.nextInt32(nodesByLatency.size())].second->host;
                 };
             }
 
@@ -28,6 +28,7 @@
 #pragma once
 
 #include <atomic>
+#include <boost/optional.hpp>
 #include <memory>
 #include <memory>
 #include <set>
@@ -119,6 +120,28 @@ public:
      */
     void failedHost(const HostAndPort& host, const Status& status);
 
+    /**
+     * Returns a host matching the given read preference which is not one of 'excludedHosts', or
+     * an empty HostAndPort if there is none. Uses only the current view of the set and never
+     * refreshes it.
+     */
+    HostAndPort getMatchingHostExcluding(const ReadPreferenceSetting& readPref,
+                                         const std::set<HostAndPort>& excludedHosts) const;
+
+    /**
+     * Notifies this Monitor that a command sent to 'host' got its reply after 'latency'. These
+     * round trip times are used by host selection when replicaSetMonitorReadLatencyPercentile is
+     * set and can be queried through getHostCommandLatencyPercentile.
+     */
+    void updateHostCommandLatency(const HostAndPort& host, Microseconds latency);
+
+    /**
+     * Returns the given percentile (1-100) of the command round trip times recently reported for
+     * 'host', or boost::none if the host is not part of the set or too few have been reported.
+     */
+    boost::optional<Microseconds> getHostCommandLatencyPercentile(const HostAndPort& host,
+                                                                  int percentile) const;
+
     /**
      * Returns true if this node is the master based ONLY on local data. Be careful, return may
      * be stale.
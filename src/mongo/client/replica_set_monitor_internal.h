@@ -33,6 +33,8 @@
 
 #pragma once
 
+#include <array>
+#include <boost/optional.hpp>
 #include <cstdint>
 #include <deque>
 #include <set>
@@ -122,6 +124,21 @@ public:
          */
         void update(const IsMasterReply& reply);
 
+        /**
+         * Records the round trip time of a command which was run against this node by a user of
+         * the monitor. Only the most recent kCommandLatencyWindowSize samples are retained.
+         */
+        void recordCommandLatency(int64_t commandLatencyMicros);
+
+        /**
+         * Returns the given percentile (1-100) of the recorded command round trip times, or
+         * boost::none if fewer than kMinCommandLatencySamples have been recorded.
+         */
+        boost::optional<int64_t> getCommandLatencyPercentile(int percentile) const;
+
+        static constexpr size_t kCommandLatencyWindowSize = 64;
+        static constexpr size_t kMinCommandLatencySamples = 8;
+
         HostAndPort host;
         bool isUp{false};
         bool isMaster{false};
@@ -133,6 +150,11 @@ public:
         Date_t lastWriteDateUpdateTime{};  // set to the local system's time at the time of updating
                                            // lastWriteDate
         repl::OpTime opTime{};             // from isMasterReply
+
+        // Ring buffer of the most recent command round trip times, in microseconds. The total
+        // number of samples ever recorded is kept so that the next slot can be located.
+        std::array<int64_t, kCommandLatencyWindowSize> commandLatencySamples{};
+        size_t numCommandLatencySamples{0};
     };
 
     typedef std::vector<Node> Nodes;
@@ -147,11 +169,13 @@ public:
     bool isUsable() const;
 
     /**
-     * Returns a host matching criteria or an empty host if no known host matches.
+     * Returns a host matching criteria or an empty host if no known host matches. Hosts in
+     * 'excludedHosts' are never returned.
      *
      * Note: Uses only local data and does not go over the network.
      */
-    HostAndPort getMatchingHost(const ReadPreferenceSetting& criteria) const;
+    HostAndPort getMatchingHost(const ReadPreferenceSetting& criteria,
+                                const std::set<HostAndPort>& excludedHosts = {}) const;
 
     /**
      * Returns the Node with the given host, or NULL if no Node has that host.
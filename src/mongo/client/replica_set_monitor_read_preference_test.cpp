@@ -33,8 +33,10 @@
 
 #include "mongo/client/replica_set_monitor.h"
 #include "mongo/client/replica_set_monitor_internal.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/unittest/unittest.h"
+#include "mongo/util/scopeguard.h"
 
 namespace mongo {
 namespace {
@@ -298,6 +300,121 @@ TEST(ReplSetMonitorReadPref, NearestOneLocal) {
     ASSERT(!isPrimarySelected);
 }
 
+void setReadLatencyPercentile(StringData value) {
+    auto param = ServerParameterSet::getGlobal()->getMap().find(
+        "replicaSetMonitorReadLatencyPercentile");
+    invariant(param != ServerParameterSet::getGlobal()->getMap().end());
+    ASSERT_OK(param->second->setFromString(value.toString()));
+}
+
+TEST(ReplSetMonitorReadPref, CommandLatencyPercentileNeedsEnoughSamples) {
+    Node node(HostAndPort("a"));
+    for (size_t i = 1; i < Node::kMinCommandLatencySamples; i++) {
+        node.recordCommandLatency(i * 1000);
+    }
+    ASSERT_FALSE(node.getCommandLatencyPercentile(50));
+
+    node.recordCommandLatency(Node::kMinCommandLatencySamples * 1000);
+    ASSERT_TRUE(node.getCommandLatencyPercentile(50));
+    ASSERT_EQUALS(int64_t(Node::kMinCommandLatencySamples * 1000),
+                  *node.getCommandLatencyPercentile(100));
+}
+
+TEST(ReplSetMonitorReadPref, CommandLatencyPercentileOnlyUsesRecentSamples) {
+    Node node(HostAndPort("a"));
+    for (size_t i = 0; i < Node::kCommandLatencyWindowSize; i++) {
+        node.recordCommandLatency(100 * 1000);
+    }
+    for (size_t i = 0; i < Node::kCommandLatencyWindowSize; i++) {
+        node.recordCommandLatency(i);
+    }
+
+    ASSERT_EQUALS(int64_t(Node::kCommandLatencyWindowSize - 1),
+                  *node.getCommandLatencyPercentile(100));
+    ASSERT_EQUALS(0, *node.getCommandLatencyPercentile(1));
+}
+
+TEST(ReplSetMonitorReadPref, NearestRanksByCommandLatencyPercentile) {
+    setReadLatencyPercentile("95");
+    ON_BLOCK_EXIT([] { setReadLatencyPercentile("0"); });
+
+    vector<Node> nodes = getThreeMemberWithTags();
+    TagSet tags(getDefaultTagSet());
+
+    // Node "a" answers isMaster quickly but is slow to serve commands.
+    nodes[0].latencyMicros = 1 * 1000;
+    nodes[1].latencyMicros = 20 * 1000;
+    nodes[2].latencyMicros = 30 * 1000;
+    for (size_t i = 0; i < Node::kMinCommandLatencySamples; i++) {
+        nodes[0].recordCommandLatency(500 * 1000);
+        nodes[1].recordCommandLatency(100 * 1000);
+        nodes[2].recordCommandLatency(2 * 1000);
+    }
+
+    bool isPrimarySelected = false;
+    HostAndPort host =
+        selectNode(nodes, mongo::ReadPreference::Nearest, tags, 3, &isPrimarySelected);
+
+    ASSERT_EQUALS("c", host.host());
+    ASSERT(!isPrimarySelected);
+}
+
+TEST(ReplSetMonitorReadPref, NearestRanksByPingTimeUnlessAllHostsHaveCommandLatencies) {
+    setReadLatencyPercentile("95");
+    ON_BLOCK_EXIT([] { setReadLatencyPercentile("0"); });
+
+    vector<Node> nodes = getThreeMemberWithTags();
+    TagSet tags(getDefaultTagSet());
+
+    // Node "b" has no command round trip times, so none of them are compared against its ping.
+    nodes[0].latencyMicros = 1 * 1000;
+    nodes[1].latencyMicros = 20 * 1000;
+    nodes[2].latencyMicros = 30 * 1000;
+    for (size_t i = 0; i < Node::kMinCommandLatencySamples; i++) {
+        nodes[0].recordCommandLatency(500 * 1000);
+        nodes[2].recordCommandLatency(2 * 1000);
+    }
+
+    bool isPrimarySelected = false;
+    HostAndPort host =
+        selectNode(nodes, mongo::ReadPreference::Nearest, tags, 3, &isPrimarySelected);
+
+    ASSERT_EQUALS("a", host.host());
+}
+
+TEST(ReplSetMonitorReadPref, NearestIgnoresCommandLatencyByDefault) {
+    vector<Node> nodes = getThreeMemberWithTags();
+    TagSet tags(getDefaultTagSet());
+
+    nodes[0].latencyMicros = 1 * 1000;
+    nodes[1].latencyMicros = 20 * 1000;
+    nodes[2].latencyMicros = 30 * 1000;
+    for (size_t i = 0; i < Node::kMinCommandLatencySamples; i++) {
+        nodes[0].recordCommandLatency(500 * 1000);
+        nodes[2].recordCommandLatency(2 * 1000);
+    }
+
+    bool isPrimarySelected = false;
+    HostAndPort host =
+        selectNode(nodes, mongo::ReadPreference::Nearest, tags, 3, &isPrimarySelected);
+
+    ASSERT_EQUALS("a", host.host());
+}
+
+TEST(ReplSetMonitorReadPref, SecOnlySkipsExcludedHosts) {
+    vector<Node> nodes = getThreeMemberWithTags();
+
+    set<HostAndPort> seeds;
+    seeds.insert(nodes.front().host);
+    SetState state("name", seeds);
+    state.nodes = nodes;
+
+    ReadPreferenceSetting criteria(ReadPreference::SecondaryOnly, TagSet(getDefaultTagSet()));
+    ASSERT_EQUALS("c", state.getMatchingHost(criteria, {HostAndPort("a")}).host());
+    ASSERT_EQUALS("a", state.getMatchingHost(criteria, {HostAndPort("c")}).host());
+    ASSERT(state.getMatchingHost(criteria, {HostAndPort("a"), HostAndPort("c")}).empty());
+}
+
 TEST(ReplSetMonitorReadPref, PriOnlyWithTagsNoMatch) {
     vector<Node> nodes = getThreeMemberWithTags();
     TagSet tags(getP2TagSet());
@@ -180,6 +180,23 @@ public:
         _sections[section->getSectionName()] = section;
     }
 
+    void appendSections(OperationContext* opCtx, const BSONObj& spec, BSONObjBuilder* result) {
+        for (const auto& specElem : spec) {
+            if (!specElem.trueValue()) {
+                continue;
+            }
+
+            auto it = _sections.find(specElem.fieldName());
+            if (it != _sections.end()) {
+                it->second->appendSection(opCtx, specElem, result);
+            }
+        }
+
+        if (spec["metrics"].trueValue() && MetricTree::theMetricTree) {
+            MetricTree::theMetricTree->appendTo(*result);
+        }
+    }
+
 private:
     const Date_t _started;
     bool _runCalled;
@@ -210,6 +227,12 @@ ServerStatusSection::ServerStatusSection(const string& sectionName) : _sectionNa
     CmdServerStatusInstantiator::getInstance().addSection(this);
 }
 
+void appendServerStatusSections(OperationContext* opCtx,
+                                const BSONObj& spec,
+                                BSONObjBuilder* result) {
+    CmdServerStatusInstantiator::getInstance().appendSections(opCtx, spec, result);
+}
+
 OpCounterServerStatusSection::OpCounterServerStatusSection(const string& sectionName,
                                                            OpCounters* counters)
     : ServerStatusSection(sectionName), _counters(counters) {}
@@ -121,4 +121,15 @@ public:
 private:
     const OpCounters* _counters;
 };
+
+/**
+ * Appends to 'result' only the server status sections which are set to a true value in 'spec',
+ * passing each section its element of 'spec' as the configuration element. The metrics tree is
+ * appended if 'spec' has a true "metrics" field. Unlike the serverStatus command, this does no
+ * authorization checks and never includes sections by default, so it is cheap enough to be used
+ * by periodic in-process collectors.
+ */
+void appendServerStatusSections(OperationContext* opCtx,
+                                const BSONObj& spec,
+                                BSONObjBuilder* result);
 }
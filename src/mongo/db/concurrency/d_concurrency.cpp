@@ -39,6 +39,7 @@
 #include "mongo/db/namespace_string.h"
 #include "mongo/db/server_parameters.h"
 #include "mongo/db/service_context.h"
+#include "mongo/db/stats/operation_phase_trace.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/stdx/mutex.h"
 #include "mongo/util/assert_util.h"
@@ -166,11 +167,15 @@ void Lock::GlobalLock::_enqueue(LockMode lockMode, unsigned timeoutMs) {
         _pbwm.lock(MODE_IS);
     }
 
+    OperationPhaseTrace::ScopedPhase ticketPhase(_opCtx,
+                                                 OperationPhaseTrace::Phase::kTicketAcquisition);
     _result = _opCtx->lockState()->lockGlobalBegin(lockMode, Milliseconds(timeoutMs));
 }
 
 void Lock::GlobalLock::waitForLock(unsigned timeoutMs) {
     if (_result == LOCK_WAITING) {
+        OperationPhaseTrace::ScopedPhase lockWaitPhase(_opCtx,
+                                                       OperationPhaseTrace::Phase::kLockWait);
         _result = _opCtx->lockState()->lockGlobalComplete(Milliseconds(timeoutMs));
     }
 
@@ -206,7 +211,13 @@ Lock::DBLock::DBLock(OperationContext* opCtx, StringData db, LockMode mode)
         _mode = MODE_X;
     }
 
-    invariant(LOCK_OK == _opCtx->lockState()->lock(_id, _mode));
+    LockResult result = _opCtx->lockState()->lockBegin(_id, _mode);
+    if (result == LOCK_WAITING) {
+        OperationPhaseTrace::ScopedPhase lockWaitPhase(_opCtx,
+                                                       OperationPhaseTrace::Phase::kLockWait);
+        result = _opCtx->lockState()->lockComplete(_id, _mode, Milliseconds::max(), false);
+    }
+    invariant(LOCK_OK == result);
 }
 
 Lock::DBLock::DBLock(DBLock&& otherLock)
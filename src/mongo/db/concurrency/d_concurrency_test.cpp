@@ -37,6 +37,7 @@
 #include "mongo/db/concurrency/global_lock_acquisition_tracker.h"
 #include "mongo/db/concurrency/lock_manager_test_help.h"
 #include "mongo/db/concurrency/write_conflict_exception.h"
+#include "mongo/db/stats/operation_phase_trace.h"
 #include "mongo/db/storage/recovery_unit_noop.h"
 #include "mongo/stdx/functional.h"
 #include "mongo/stdx/memory.h"
@@ -46,6 +47,7 @@
 #include "mongo/util/debug_util.h"
 #include "mongo/util/log.h"
 #include "mongo/util/progress_meter.h"
+#include "mongo/util/tick_source_mock.h"
 #include "mongo/util/time_support.h"
 
 namespace mongo {
@@ -699,6 +701,56 @@ TEST_F(DConcurrencyTestFixture, MultipleConflictingDBLocksOnSameThread) {
     ASSERT(lockState->isDbLockedForMode("db1", MODE_S));
 }
 
+/**
+ * Returns how many times an operation has entered the lock wait phase.
+ */
+int countLockWaits(OperationContext* opCtx) {
+    BSONArrayBuilder builder;
+    OperationPhaseTrace::get(opCtx).appendTransitions(&builder);
+
+    int lockWaits = 0;
+    for (auto&& transition : builder.arr()) {
+        if (transition.Obj()["phase"].str() == "lockWait") {
+            ++lockWaits;
+        }
+    }
+    return lockWaits;
+}
+
+TEST_F(DConcurrencyTestFixture, UncontendedDBLockDoesNotRecordLockWait) {
+    TickSourceMock tickSource;
+    auto opCtx = makeOpCtx();
+    opCtx->setLockState(stdx::make_unique<DefaultLockerImpl>());
+    OperationPhaseTrace::get(opCtx.get()).start(&tickSource, 0);
+
+    Lock::DBLock dbWrite(opCtx.get(), "db", MODE_X);
+
+    ASSERT(opCtx->lockState()->isDbLockedForMode("db", MODE_X));
+    ASSERT_EQUALS(0, countLockWaits(opCtx.get()));
+}
+
+TEST_F(DConcurrencyTestFixture, ContendedDBLockRecordsLockWait) {
+    TickSourceMock tickSource;
+    auto clients = makeKClientsWithLockers<DefaultLockerImpl>(2);
+    auto holderOpCtx = clients[0].second.get();
+    auto waiterOpCtx = clients[1].second.get();
+    OperationPhaseTrace::get(waiterOpCtx).start(&tickSource, 0);
+
+    boost::optional<Lock::DBLock> holder;
+    holder.emplace(holderOpCtx, "db", MODE_X);
+
+    stdx::thread waiter([&] { Lock::DBLock dbWrite(waiterOpCtx, "db", MODE_X); });
+
+    const ResourceId resIdDb(RESOURCE_DATABASE, std::string("db"));
+    while (waiterOpCtx->lockState()->getWaitingResource() != resIdDb) {
+        sleepmillis(1);
+    }
+    holder.reset();
+    waiter.join();
+
+    ASSERT_EQUALS(1, countLockWaits(waiterOpCtx));
+}
+
 TEST_F(DConcurrencyTestFixture, IsDbLockedForSMode) {
     const std::string dbName("db");
 
@@ -158,10 +158,10 @@ public:
      * In other words for each call to lockBegin, which does not return LOCK_OK, there needs to
      * be a corresponding call to either lockComplete or unlock.
      *
-     * NOTE: These methods are not public and should only be used inside the class
-     * implementation and for unit-tests and not called directly.
+     * Outside of this class, prefer lock() unless the caller needs to distinguish a contended
+     * acquisition from an uncontended one.
      */
-    LockResult lockBegin(ResourceId resId, LockMode mode);
+    virtual LockResult lockBegin(ResourceId resId, LockMode mode);
 
     /**
      * Waits for the completion of a lock, previously requested through lockBegin or
@@ -172,10 +172,10 @@ public:
      * @param timeout How long to wait for the lock acquisition to complete.
      * @param checkDeadlock whether to perform deadlock detection while waiting.
      */
-    LockResult lockComplete(ResourceId resId,
-                            LockMode mode,
-                            Milliseconds timeout,
-                            bool checkDeadlock);
+    virtual LockResult lockComplete(ResourceId resId,
+                                    LockMode mode,
+                                    Milliseconds timeout,
+                                    bool checkDeadlock);
 
 private:
     friend class AutoYieldFlushLockForMMAPV1Commit;
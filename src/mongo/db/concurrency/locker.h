@@ -186,6 +186,18 @@ public:
                             Milliseconds timeout = Milliseconds::max(),
                             bool checkDeadlock = false) = 0;
 
+    /**
+     * Non-blocking variant of lock(), for callers which need to know whether the acquisition
+     * had to wait. lockBegin either grants the lock and returns LOCK_OK, or queues the request
+     * and returns LOCK_WAITING, in which case lockComplete (or unlock) must be called next with
+     * the same resource and mode.
+     */
+    virtual LockResult lockBegin(ResourceId resId, LockMode mode) = 0;
+    virtual LockResult lockComplete(ResourceId resId,
+                                    LockMode mode,
+                                    Milliseconds timeout,
+                                    bool checkDeadlock) = 0;
+
     /**
      * Downgrades the specified resource's lock mode without changing the reference count.
      */
@@ -96,6 +96,17 @@ public:
         return LockResult::LOCK_OK;
     }
 
+    virtual LockResult lockBegin(ResourceId resId, LockMode mode) {
+        return LockResult::LOCK_OK;
+    }
+
+    virtual LockResult lockComplete(ResourceId resId,
+                                    LockMode mode,
+                                    Milliseconds timeout,
+                                    bool checkDeadlock) {
+        invariant(false);
+    }
+
     virtual void downgrade(ResourceId resId, LockMode newMode) {
         invariant(false);
     }
@@ -42,6 +42,7 @@
 #include "mongo/db/json.h"
 #include "mongo/db/query/getmore_request.h"
 #include "mongo/db/query/plan_summary_stats.h"
+#include "mongo/db/stats/operation_phase_trace.h"
 #include "mongo/rpc/metadata/client_metadata.h"
 #include "mongo/rpc/metadata/client_metadata_ismaster.h"
 #include "mongo/util/log.h"
@@ -525,6 +526,13 @@ string OpDebug::report(Client* client,
         s << " locks:" << locks.obj().toString();
     }
 
+    if (auto opCtx = client ? client->getOperationContext() : nullptr) {
+        const auto& phaseTrace = OperationPhaseTrace::get(opCtx);
+        if (phaseTrace.isActive()) {
+            s << " phaseMicros:" << phaseTrace.toString();
+        }
+    }
+
     if (iscommand) {
         s << " protocol:" << getProtoString(networkOp);
     }
@@ -119,6 +119,7 @@
 #include "mongo/db/session_killer.h"
 #include "mongo/db/startup_warnings_mongod.h"
 #include "mongo/db/stats/counters.h"
+#include "mongo/db/stats/metrics_exporter.h"
 #include "mongo/db/storage/encryption_hooks.h"
 #include "mongo/db/storage/mmap_v1/mmap_v1_options.h"
 #include "mongo/db/storage/storage_engine.h"
@@ -1000,6 +1001,8 @@ ExitCode _initAndListen(int listenPort) {
 
     startClientCursorMonitor();
 
+    uassertStatusOK(startMetricsExporter(serviceContext));
+
     PeriodicTask::startRunningPeriodicTasks();
 
     // Set up the periodic runner for background job execution
@@ -1342,6 +1345,8 @@ void shutdownTask() {
     // Shutdown Full-Time Data Capture
     stopMongoDFTDC();
 
+    shutdownMetricsExporter();
+
     HealthLog::get(serviceContext).shutdown();
 
     // We should always be able to acquire the global lock at shutdown.
@@ -41,6 +41,7 @@
 #include "mongo/db/curop.h"
 #include "mongo/db/db_raii.h"
 #include "mongo/db/jsobj.h"
+#include "mongo/db/stats/operation_phase_trace.h"
 #include "mongo/rpc/metadata/client_metadata.h"
 #include "mongo/rpc/metadata/client_metadata_ismaster.h"
 #include "mongo/util/log.h"
@@ -94,6 +95,13 @@ void profile(OperationContext* opCtx, NetworkOp op) {
         CurOp::get(opCtx)->debug().append(*CurOp::get(opCtx), lockerInfo.stats, b);
     }
 
+    const auto& phaseTrace = OperationPhaseTrace::get(opCtx);
+    if (phaseTrace.isActive()) {
+        phaseTrace.append(&b);
+        BSONArrayBuilder transitions(b.subarrayStart("phaseTransitions"));
+        phaseTrace.appendTransitions(&transitions);
+    }
+
     b.appendDate("ts", jsTime());
     b.append("client", opCtx->getClient()->clientAddress());
 
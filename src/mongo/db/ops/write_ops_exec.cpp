@@ -61,6 +61,7 @@
 #include "mongo/db/repl/repl_client_info.h"
 #include "mongo/db/repl/replication_coordinator.h"
 #include "mongo/db/retryable_writes_stats.h"
+#include "mongo/db/s/chunk_field_summary_publisher.h"
 #include "mongo/db/s/collection_sharding_state.h"
 #include "mongo/db/s/sharding_state.h"
 #include "mongo/db/session_catalog.h"
@@ -321,6 +322,20 @@ void insertDocuments(OperationContext* opCtx,
     wuow.commit();
 }
 
+/**
+ * Lets the field summaries of the chunks of 'nss' be widened for 'documents', which cannot happen
+ * once the write holds its locks.
+ */
+void prepareChunkFieldSummaries(OperationContext* opCtx,
+                                const NamespaceString& nss,
+                                const std::vector<BSONObj>& documents) {
+    auto const chunkFieldSummaryPublisher =
+        ShardingState::get(opCtx)->getChunkFieldSummaryPublisher();
+    if (chunkFieldSummaryPublisher->isActive()) {
+        chunkFieldSummaryPublisher->prepareWrites(opCtx, nss, documents);
+    }
+}
+
 /**
  * Returns true if caller should try to insert more documents. Does nothing else if batch is empty.
  */
@@ -334,6 +349,26 @@ bool insertBatchAndHandleErrors(OperationContext* opCtx,
 
     auto& curOp = *CurOp::get(opCtx);
 
+    try {
+        std::vector<BSONObj> documents;
+        documents.reserve(batch.size());
+        for (const auto& insertStatement : batch) {
+            documents.push_back(insertStatement.doc);
+        }
+
+        prepareChunkFieldSummaries(opCtx, wholeOp.getNamespace(), documents);
+    } catch (const DBException& ex) {
+        // None of the documents can be inserted, since they may not be covered by the summaries
+        for (size_t i = 0; i < batch.size(); ++i) {
+            globalOpCounters.gotInsert();
+            if (!handleError(
+                    opCtx, ex, wholeOp.getNamespace(), wholeOp.getWriteCommandBase(), out)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
     boost::optional<AutoGetCollection> collection;
     auto acquireCollection = [&] {
         while (true) {
@@ -495,8 +530,9 @@ WriteResult performInserts(OperationContext* opCtx, const write_ops::Insert& who
                 }
             }
 
+            // An unmodified document stays a view into the request's message buffer.
             BSONObj toInsert = fixedDoc.getValue().isEmpty() ? doc : std::move(fixedDoc.getValue());
-            batch.emplace_back(stmtId, toInsert);
+            batch.emplace_back(stmtId, std::move(toInsert));
             bytesInBatch += batch.back().doc.objsize();
             if (!isLastDoc && batch.size() < maxBatchSize && bytesInBatch < insertVectorMaxBytes)
                 continue;  // Add more to batch before inserting.
@@ -660,6 +696,7 @@ WriteResult performUpdates(OperationContext* opCtx, const write_ops::Update& who
         }
         ON_BLOCK_EXIT([&] { finishCurOp(opCtx, &curOp); });
         try {
+            prepareChunkFieldSummaries(opCtx, wholeOp.getNamespace(), {});
             lastOpFixer.startingOp();
             out.results.emplace_back(
                 performSingleUpdateOp(opCtx, wholeOp.getNamespace(), stmtId, singleOp));
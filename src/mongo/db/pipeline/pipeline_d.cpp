@@ -72,6 +72,7 @@
 #include "mongo/db/s/sharding_state.h"
 #include "mongo/db/service_context.h"
 #include "mongo/db/stats/fill_locker_info.h"
+#include "mongo/db/stats/operation_phase_trace.h"
 #include "mongo/db/stats/storage_stats.h"
 #include "mongo/db/stats/top.h"
 #include "mongo/db/storage/record_store.h"
@@ -797,6 +798,7 @@ std::vector<BSONObj> PipelineD::MongoDInterface::getCurrentOps(
 
             CurOp::get(clientOpCtx)
                 ->reportState(&infoBuilder, (truncateMode == CurrentOpTruncateMode::kTruncateOps));
+            OperationPhaseTrace::get(clientOpCtx).append(&infoBuilder);
 
             Locker::LockerInfo lockerInfo;
             clientOpCtx->lockState()->getLockerInfo(&lockerInfo);
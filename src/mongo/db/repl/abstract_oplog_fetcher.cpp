@@ -32,6 +32,8 @@
 
 #include "mongo/db/repl/abstract_oplog_fetcher.h"
 
+#include <array>
+
 #include "mongo/base/counter.h"
 #include "mongo/bson/util/bson_extract.h"
 #include "mongo/db/commands/server_status_metric.h"
@@ -65,6 +67,24 @@ const Milliseconds kDefaultOplogGetMoreMaxMS{5000};
 }  // namespace
 
 StatusWith<OpTimeWithHash> AbstractOplogFetcher::parseOpTimeWithHash(const BSONObj& oplogEntryObj) {
+    // This runs for every fetched document, so read all three fields in one pass over the entry
+    // when they are well formed. Anything unusual goes through the field extractors below, which
+    // produce the appropriate error.
+    static const std::array<StringData, 3> kOpTimeWithHashFields{
+        {OpTime::kTimestampFieldName, OpTime::kTermFieldName, "h"_sd}};
+    std::array<BSONElement, 3> fields;
+    oplogEntryObj.getFields(kOpTimeWithHashFields, &fields);
+
+    const auto isIntegral = [](const BSONElement& elem) {
+        return elem.isNumber() && elem.safeNumberLong() == elem.numberDouble();
+    };
+    if (fields[0].type() == bsonTimestamp && (fields[1].eoo() || isIntegral(fields[1])) &&
+        isIntegral(fields[2])) {
+        const long long term =
+            fields[1].eoo() ? OpTime::kUninitializedTerm : fields[1].safeNumberLong();
+        return OpTimeWithHash{fields[2].safeNumberLong(), OpTime(fields[0].timestamp(), term)};
+    }
+
     const auto opTime = OpTime::parseFromOplogEntry(oplogEntryObj);
     if (!opTime.isOK()) {
         return opTime.getStatus();
@@ -301,9 +321,14 @@ void AbstractOplogFetcher::_callback(const Fetcher::QueryResponseStatus& result,
     getMoreBob->appendElements(batchResult.getValue());
 }
 
+Status AbstractOplogFetcher::_onFinish(Status status) {
+    return status;
+}
+
 void AbstractOplogFetcher::_finishCallback(Status status) {
     invariant(isActive());
 
+    status = _onFinish(status);
     _onShutdownCallbackFn(status);
 
     decltype(_onShutdownCallbackFn) onShutdownCallbackFn;
@@ -173,6 +173,14 @@ private:
      */
     virtual StatusWith<BSONObj> _onSuccessfulBatch(const Fetcher::QueryResponse& queryResponse) = 0;
 
+    /**
+     * Function called by the abstract oplog fetcher with the status it is about to finish with,
+     * before that status is passed to the "_onShutdownCallbackFn". Subclasses that process batches
+     * outside of _onSuccessfulBatch must wait here for that processing to complete, and may
+     * return an error from it in place of 'status'.
+     */
+    virtual Status _onFinish(Status status);
+
     /**
      * This function creates a Fetcher with the given `find` command and metadata.
      */
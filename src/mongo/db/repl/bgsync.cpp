@@ -79,6 +79,11 @@ const auto defaultBatchSize = (16 * 1024 * 1024) / 12 * 10;
 // The batchSize to use for the find/getMore queries called by the OplogFetcher
 MONGO_EXPORT_STARTUP_SERVER_PARAMETER(bgSyncOplogFetcherBatchSize, int, defaultBatchSize);
 
+// When enabled, the OplogFetcher sends the getMore for the next batch before pushing the current
+// batch onto the oplog buffer, so that the round trip to the sync source overlaps with waiting for
+// buffer space.
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(bgSyncPipelinedOplogFetcher, bool, true);
+
 /**
  * Extends DataReplicatorExternalStateImpl to be member state aware.
  */
@@ -449,7 +454,9 @@ void BackgroundSync::_produce() {
                 return this->_enqueueDocuments(a1, a2, a3);
             },
             onOplogFetcherShutdownCallbackFn,
-            bgSyncOplogFetcherBatchSize);
+            bgSyncOplogFetcherBatchSize,
+            bgSyncPipelinedOplogFetcher ? OplogFetcher::EnqueueMode::kPipelined
+                                        : OplogFetcher::EnqueueMode::kSynchronous);
         stdx::lock_guard<stdx::mutex> lock(_mutex);
         if (_state != ProducerState::Running) {
             return;
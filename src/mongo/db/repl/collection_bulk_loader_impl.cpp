@@ -254,8 +254,28 @@ Status CollectionBulkLoaderImpl::commit() {
     });
 }
 
+Status CollectionBulkLoaderImpl::_lockCollection() {
+    if (!_autoColl) {
+        _autoColl = stdx::make_unique<AutoGetCollection>(_opCtx.get(), _nss, MODE_IX);
+    }
+
+    // Collections with unfinished indexes can not be dropped, but capped collections are loaded
+    // without index builders.
+    if (!_autoColl->getCollection()) {
+        return {ErrorCodes::NamespaceNotFound,
+                str::stream() << "Collection " << _nss.ns() << " was dropped while loading it"};
+    }
+    return Status::OK();
+}
+
 void CollectionBulkLoaderImpl::_releaseResources() {
     invariant(&cc() == _opCtx->getClient());
+
+    // Dropping unfinished indexes modifies the catalog, which requires the collection lock.
+    if ((_secondaryIndexesBlock || _idIndexBlock) && !_autoColl) {
+        _autoColl = stdx::make_unique<AutoGetCollection>(_opCtx.get(), _nss, MODE_IX);
+    }
+
     if (_secondaryIndexesBlock) {
         // A valid Client is required to drop unfinished indexes.
         Client::initThreadIfNotAlready();
@@ -278,12 +298,20 @@ Status CollectionBulkLoaderImpl::_runTaskReleaseResourcesOnFailure(F task) noexc
     AlternativeClientRegion acr(_client);
     ScopeGuard guard = MakeGuard(&CollectionBulkLoaderImpl::_releaseResources, this);
     try {
-        const auto status = [&task]() noexcept {
+        const auto status = [&task, this ]() noexcept {
+            auto lockStatus = _lockCollection();
+            if (!lockStatus.isOK()) {
+                return lockStatus;
+            }
             return task();
         }
         ();
         if (status.isOK()) {
             guard.Dismiss();
+
+            // Loaders for other collections of the database need to lock it exclusively to create
+            // their collections, so the locks are only held while the loader is in use.
+            _autoColl.reset();
         }
         return status;
     } catch (...) {
@@ -45,6 +45,9 @@ namespace repl {
 /**
  * Class in charge of building a collection during data loading (like initial sync).
  *
+ * The collection is only locked while one of the methods below runs, so that collections of the
+ * same database can be loaded concurrently.
+ *
  * Note: Call commit when done inserting documents.
  */
 class CollectionBulkLoaderImpl : public CollectionBulkLoader {
@@ -77,6 +80,12 @@ public:
     virtual BSONObj toBSON() const override;
 
 private:
+    /**
+     * Locks the collection in MODE_IX unless it is already locked. Returns NamespaceNotFound if the
+     * collection no longer exists.
+     */
+    Status _lockCollection();
+
     void _releaseResources();
 
     template <typename F>
@@ -75,6 +75,11 @@ MONGO_EXPORT_SERVER_PARAMETER(numInitialSyncListCollectionsAttempts, int, 3);
 // The number of cursors to use in the collection cloning process.
 MONGO_EXPORT_SERVER_PARAMETER(maxNumInitialSyncCollectionClonerCursors, int, 1);
 
+// The number of collections in a database that are cloned at the same time. Each collection
+// cloner feeds its own bulk loader, so secondary index keys for all of them are generated while
+// their documents are still being copied.
+MONGO_EXPORT_SERVER_PARAMETER(maxNumInitialSyncCollectionClonersPerDatabase, int, 4);
+
 // Failpoint which causes initial sync to hang right after listCollections, but before cloning
 // any colelctions in the 'database' database.
 MONGO_FP_DECLARE(initialSyncHangAfterListCollections);
@@ -137,7 +142,9 @@ DatabaseCloner::DatabaseCloner(executor::TaskExecutor* executor,
                                   numInitialSyncListCollectionsAttempts.load(),
                                   executor::RemoteCommandRequest::kNoTimeout,
                                   RemoteCommandRetryScheduler::kAllRetriableErrors)),
-      _startCollectionCloner([](CollectionCloner& cloner) { return cloner.startup(); }) {
+      _startCollectionCloner([](CollectionCloner& cloner) { return cloner.startup(); }),
+      _maxActiveCollectionCloners(
+          std::max(1, maxNumInitialSyncCollectionClonersPerDatabase.load())) {
     // Fetcher throws an exception on null executor.
     invariant(executor);
     uassert(ErrorCodes::BadValue, "db worker thread pool cannot be null", dbWorkThreadPool);
@@ -262,6 +269,11 @@ void DatabaseCloner::setStartCollectionClonerFn(
     _startCollectionCloner = startCollectionCloner;
 }
 
+void DatabaseCloner::setMaxActiveCollectionCloners_forTest(std::size_t maxActiveCollectionCloners) {
+    invariant(maxActiveCollectionCloners > 0);
+    _maxActiveCollectionCloners = maxActiveCollectionCloners;
+}
+
 DatabaseCloner::State DatabaseCloner::getState_forTest() const {
     stdx::lock_guard<stdx::mutex> lk(_mutex);
     return _state;
@@ -416,16 +428,13 @@ void DatabaseCloner::_listCollectionsCallback(const StatusWith<Fetcher::QueryRes
         }
     }
 
-    // Start first collection cloner.
-    _currentCollectionClonerIter = _collectionCloners.begin();
+    // Start as many collection cloners as we are allowed to run at once. Each completed cloner
+    // starts the next one.
+    _nextCollectionClonerIter = _collectionCloners.begin();
+    _startCollectionCloners_inlock();
 
-    LOG(1) << "    cloning collection " << _currentCollectionClonerIter->getSourceNamespace();
-
-    Status startStatus = _startCollectionCloner(*_currentCollectionClonerIter);
-    if (!startStatus.isOK()) {
-        LOG(1) << "    failed to start collection cloning on "
-               << _currentCollectionClonerIter->getSourceNamespace() << ": " << redact(startStatus);
-        _finishCallback_inlock(lk, startStatus);
+    if (_activeCollectionCloners == 0) {
+        _finishCallback_inlock(lk, _startCollectionClonerStatus);
         return;
     }
 }
@@ -447,17 +456,19 @@ void DatabaseCloner::_collectionClonerCallback(const Status& status, const Names
     lk.unlock();
     _collectionWork(newStatus, nss);
     lk.lock();
-    _currentCollectionClonerIter++;
+    invariant(_activeCollectionCloners > 0);
+    --_activeCollectionCloners;
 
-    if (_currentCollectionClonerIter != _collectionCloners.end()) {
-        Status startStatus = _startCollectionCloner(*_currentCollectionClonerIter);
-        if (!startStatus.isOK()) {
-            LOG(1) << "    failed to start collection cloning on "
-                   << _currentCollectionClonerIter->getSourceNamespace() << ": "
-                   << redact(startStatus);
-            _finishCallback_inlock(lk, startStatus);
-            return;
-        }
+    _startCollectionCloners_inlock();
+
+    // Wait for the remaining cloners before reporting completion so that no collection cloner
+    // outlives the database cloner.
+    if (_activeCollectionCloners > 0) {
+        return;
+    }
+
+    if (!_startCollectionClonerStatus.isOK()) {
+        _finishCallback_inlock(lk, _startCollectionClonerStatus);
         return;
     }
 
@@ -473,6 +484,25 @@ void DatabaseCloner::_collectionClonerCallback(const Status& status, const Names
     _finishCallback_inlock(lk, finalStatus);
 }
 
+void DatabaseCloner::_startCollectionCloners_inlock() {
+    while (_startCollectionClonerStatus.isOK() &&
+           _activeCollectionCloners < _maxActiveCollectionCloners &&
+           _nextCollectionClonerIter != _collectionCloners.end()) {
+        auto&& collectionCloner = *_nextCollectionClonerIter++;
+
+        LOG(1) << "    cloning collection " << collectionCloner.getSourceNamespace();
+
+        Status startStatus = _startCollectionCloner(collectionCloner);
+        if (!startStatus.isOK()) {
+            LOG(1) << "    failed to start collection cloning on "
+                   << collectionCloner.getSourceNamespace() << ": " << redact(startStatus);
+            _startCollectionClonerStatus = startStatus;
+            return;
+        }
+        ++_activeCollectionCloners;
+    }
+}
+
 void DatabaseCloner::_finishCallback(const Status& status) {
     _onCompletion(status);
     LockGuard lk(_mutex);
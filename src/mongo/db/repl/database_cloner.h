@@ -155,6 +155,14 @@ public:
      */
     void setStartCollectionClonerFn(const StartCollectionClonerFn& startCollectionCloner);
 
+    /**
+     * Overrides the number of collection cloners allowed to run at the same time. Must be called
+     * before the listCollections response is processed.
+     *
+     * For testing only.
+     */
+    void setMaxActiveCollectionCloners_forTest(std::size_t maxActiveCollectionCloners);
+
     // State transitions:
     // PreStart --> Running --> ShuttingDown --> Complete
     // It is possible to skip intermediate states. For example,
@@ -190,6 +198,14 @@ private:
      */
     void _collectionClonerCallback(const Status& status, const NamespaceString& nss);
 
+    /**
+     * Starts collection cloners in listCollections order until the number of active cloners
+     * reaches the limit or there are none left to start.
+     * The first failure to start a cloner is recorded in '_startCollectionClonerStatus' and stops
+     * any further cloners from being started.
+     */
+    void _startCollectionCloners_inlock();
+
     /**
      * Reports completion status.
      * Sets cloner to inactive.
@@ -233,7 +249,10 @@ private:
     std::vector<BSONObj> _collectionInfos;                               // (M)
     std::vector<NamespaceString> _collectionNamespaces;                  // (M)
     std::list<CollectionCloner> _collectionCloners;                      // (M)
-    std::list<CollectionCloner>::iterator _currentCollectionClonerIter;  // (M)
+    std::list<CollectionCloner>::iterator _nextCollectionClonerIter;     // (M)
+    std::size_t _activeCollectionCloners = 0;                            // (M)
+    std::size_t _maxActiveCollectionCloners;                             // (RT)
+    Status _startCollectionClonerStatus = Status::OK();                  // (M)
     std::vector<std::pair<Status, NamespaceString>> _failedNamespaces;   // (M)
     CollectionCloner::ScheduleDbWorkFn
         _scheduleDbWorkFn;  // (RT) Function for scheduling database work using the executor.
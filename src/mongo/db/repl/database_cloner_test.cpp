@@ -30,7 +30,9 @@
 
 #include <list>
 #include <memory>
+#include <string>
 #include <utility>
+#include <vector>
 
 #include "mongo/db/catalog/collection_options.h"
 #include "mongo/db/commands/list_collections_filter.h"
@@ -95,6 +97,8 @@ void DatabaseClonerTest::setUp() {
         [this](const executor::TaskExecutor::CallbackFn& work) {
             return getExecutor().scheduleWork(work);
         });
+    // Most tests below depend on the order of the collection cloner network requests.
+    _databaseCloner->setMaxActiveCollectionCloners_forTest(1U);
 
     storageInterface->createCollectionForBulkFn =
         [this](const NamespaceString& nss,
@@ -897,4 +901,63 @@ TEST_F(DatabaseClonerTest, CreateCollections) {
     stats.commitCalled = true;
 }
 
+TEST_F(DatabaseClonerTest, CollectionClonersRunConcurrentlyUpToLimit) {
+    _databaseCloner->setMaxActiveCollectionCloners_forTest(2U);
+
+    std::vector<std::string> startedCollections;
+    _databaseCloner->setStartCollectionClonerFn(
+        [&startedCollections](CollectionCloner& cloner) {
+            startedCollections.push_back(cloner.getSourceNamespace().coll().toString());
+            return cloner.startup();
+        });
+
+    ASSERT_OK(_databaseCloner->startup());
+
+    auto net = getNet();
+    {
+        executor::NetworkInterfaceMock::InNetworkGuard guard(net);
+        processNetworkResponse(createListCollectionsResponse(0,
+                                                             BSON_ARRAY(BSON("name"
+                                                                             << "a"
+                                                                             << "options"
+                                                                             << BSONObj())
+                                                                        << BSON("name"
+                                                                                << "b"
+                                                                                << "options"
+                                                                                << BSONObj())
+                                                                        << BSON("name"
+                                                                                << "c"
+                                                                                << "options"
+                                                                                << BSONObj()))));
+    }
+    ASSERT_EQUALS(getDetectableErrorStatus(), getStatus());
+
+    // 'c' is not started until one of the first two collection cloners completes.
+    ASSERT_TRUE((std::vector<std::string>{"a", "b"}) == startedCollections);
+
+    {
+        executor::NetworkInterfaceMock::InNetworkGuard guard(net);
+        while (net->hasReadyRequests()) {
+            auto noi = net->getNextReadyRequest();
+            const std::string cmdName = noi->getRequest().cmdObj.firstElementFieldName();
+            if (cmdName == "count") {
+                scheduleNetworkResponse(noi, createCountResponse(0));
+            } else if (cmdName == "listIndexes") {
+                scheduleNetworkResponse(noi, createListIndexesResponse(0, BSON_ARRAY(idIndexSpec)));
+            } else {
+                assertRemoteCommandNameEquals("find", noi->getRequest());
+                scheduleNetworkResponse(noi, createCursorResponse(0, BSONArray()));
+            }
+            net->runReadyNetworkOperations();
+        }
+    }
+
+    _databaseCloner->join();
+    ASSERT_OK(getStatus());
+    ASSERT_FALSE(_databaseCloner->isActive());
+    ASSERT_TRUE((std::vector<std::string>{"a", "b", "c"}) == startedCollections);
+    ASSERT_EQUALS(3U, _collections.size());
+    ASSERT_EQUALS(3U, _databaseCloner->getStats().clonedCollections);
+}
+
 }  // namespace
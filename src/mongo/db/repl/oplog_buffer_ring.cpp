@@ -0,0 +1,210 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/repl/oplog_buffer_ring.h"
+
+#include <algorithm>
+
+#include "mongo/util/assert_util.h"
+
+namespace mongo {
+namespace repl {
+
+namespace {
+
+// Number of slots allocated by the first push.
+const std::size_t kInitialCapacity = 1024;
+
+std::size_t getDocumentSize(const BSONObj& o) {
+    // SERVER-9808 Avoid Fortify complaint about implicit signed->unsigned conversion
+    return static_cast<std::size_t>(o.objsize());
+}
+
+}  // namespace
+
+const std::size_t OplogBufferRing::kDefaultMaxSize;
+
+OplogBufferRing::OplogBufferRing(std::size_t maxSize) : _maxSize(maxSize) {}
+
+void OplogBufferRing::startup(OperationContext*) {}
+
+void OplogBufferRing::shutdown(OperationContext* opCtx) {
+    clear(opCtx);
+}
+
+void OplogBufferRing::pushEvenIfFull(OperationContext*, const Value& value) {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    _push_inlock(value);
+}
+
+void OplogBufferRing::push(OperationContext*, const Value& value) {
+    stdx::unique_lock<stdx::mutex> lk(_mutex);
+    _waitForSpace_inlock(getDocumentSize(value), lk);
+    _push_inlock(value);
+}
+
+void OplogBufferRing::pushAllNonBlocking(OperationContext*,
+                                         Batch::const_iterator begin,
+                                         Batch::const_iterator end) {
+    if (begin == end) {
+        return;
+    }
+
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    _reserve_inlock(std::distance(begin, end));
+    std::for_each(begin, end, [this](const Value& value) { _push_inlock(value); });
+}
+
+void OplogBufferRing::waitForSpace(OperationContext*, std::size_t size) {
+    stdx::unique_lock<stdx::mutex> lk(_mutex);
+    _waitForSpace_inlock(size, lk);
+}
+
+bool OplogBufferRing::isEmpty() const {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    return _count == 0;
+}
+
+std::size_t OplogBufferRing::getMaxSize() const {
+    return _maxSize;
+}
+
+std::size_t OplogBufferRing::getSize() const {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    return _size;
+}
+
+std::size_t OplogBufferRing::getCount() const {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    return _count;
+}
+
+void OplogBufferRing::clear(OperationContext*) {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    // Release the slots too, since a buffer that filled up during catch-up may be much larger
+    // than what steady state replication needs.
+    std::vector<Value>().swap(_slots);
+    _head = 0;
+    _count = 0;
+    _size = 0;
+    _clearing = true;
+    _notFullCondition.notify_one();
+    _notEmptyCondition.notify_one();
+}
+
+bool OplogBufferRing::tryPop(OperationContext*, Value* value) {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    if (_count == 0) {
+        return false;
+    }
+
+    // Moving out of the slot drops its reference to the reply buffer.
+    *value = std::move(_slots[_head]);
+    _slots[_head] = Value();
+    _head = (_head + 1) % _slots.size();
+    --_count;
+    _size -= getDocumentSize(*value);
+    _notFullCondition.notify_one();
+    return true;
+}
+
+bool OplogBufferRing::waitForData(Seconds waitDuration) {
+    const auto deadline = stdx::chrono::system_clock::now() + waitDuration.toSystemDuration();
+    stdx::unique_lock<stdx::mutex> lk(_mutex);
+    _clearing = false;
+    while (_count == 0 && !_clearing) {
+        if (stdx::cv_status::timeout == _notEmptyCondition.wait_until(lk, deadline)) {
+            return false;
+        }
+    }
+    return _count != 0;
+}
+
+bool OplogBufferRing::peek(OperationContext*, Value* value) {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    if (_count == 0) {
+        return false;
+    }
+    *value = _slots[_head];
+    return true;
+}
+
+boost::optional<OplogBuffer::Value> OplogBufferRing::lastObjectPushed(OperationContext*) const {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    if (_count == 0) {
+        return boost::none;
+    }
+    return _slots[(_head + _count - 1) % _slots.size()];
+}
+
+std::size_t OplogBufferRing::getCapacity_forTest() const {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    return _slots.size();
+}
+
+void OplogBufferRing::_reserve_inlock(std::size_t count) {
+    if (_count + count <= _slots.size()) {
+        return;
+    }
+
+    auto newCapacity = std::max(_slots.size(), kInitialCapacity);
+    while (newCapacity < _count + count) {
+        newCapacity *= 2;
+    }
+
+    // Unwrap the entries to the front of the new ring.
+    std::vector<Value> newSlots(newCapacity);
+    for (std::size_t i = 0; i < _count; ++i) {
+        newSlots[i] = std::move(_slots[(_head + i) % _slots.size()]);
+    }
+    _slots.swap(newSlots);
+    _head = 0;
+}
+
+void OplogBufferRing::_push_inlock(const Value& value) {
+    _reserve_inlock(1);
+    _slots[(_head + _count) % _slots.size()] = value;
+    ++_count;
+    _size += getDocumentSize(value);
+    _clearing = false;
+    if (_count == 1) {
+        // We were empty.
+        _notEmptyCondition.notify_one();
+    }
+}
+
+void OplogBufferRing::_waitForSpace_inlock(std::size_t size, stdx::unique_lock<stdx::mutex>& lk) {
+    while (_size + size > _maxSize) {
+        _notFullCondition.wait(lk);
+    }
+}
+
+}  // namespace repl
+}  // namespace mongo
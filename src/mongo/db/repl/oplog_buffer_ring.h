@@ -0,0 +1,108 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "mongo/db/repl/oplog_buffer.h"
+#include "mongo/stdx/condition_variable.h"
+#include "mongo/stdx/mutex.h"
+
+namespace mongo {
+namespace repl {
+
+/**
+ * In memory oplog buffer that keeps its entries in a ring of BSONObj slots.
+ *
+ * Entries pushed by the OplogFetcher share ownership of the reply they arrived in, so the ring only
+ * holds references into the original reply buffers; a reply is released once its last entry is
+ * popped. The ring grows by doubling when it runs out of slots and reuses them afterwards, so
+ * steady state pushes and pops do not allocate. Its size is bounded by the total objsize() of the
+ * buffered entries.
+ */
+class OplogBufferRing final : public OplogBuffer {
+public:
+    // Limit buffer to 256MB.
+    static const std::size_t kDefaultMaxSize = 256 * 1024 * 1024;
+
+    explicit OplogBufferRing(std::size_t maxSize = kDefaultMaxSize);
+
+    void startup(OperationContext* opCtx) override;
+    void shutdown(OperationContext* opCtx) override;
+    void pushEvenIfFull(OperationContext* opCtx, const Value& value) override;
+    void push(OperationContext* opCtx, const Value& value) override;
+    void pushAllNonBlocking(OperationContext* opCtx,
+                            Batch::const_iterator begin,
+                            Batch::const_iterator end) override;
+    void waitForSpace(OperationContext* opCtx, std::size_t size) override;
+    bool isEmpty() const override;
+    std::size_t getMaxSize() const override;
+    std::size_t getSize() const override;
+    std::size_t getCount() const override;
+    void clear(OperationContext* opCtx) override;
+    bool tryPop(OperationContext* opCtx, Value* value) override;
+    bool waitForData(Seconds waitDuration) override;
+    bool peek(OperationContext* opCtx, Value* value) override;
+    boost::optional<Value> lastObjectPushed(OperationContext* opCtx) const override;
+
+    /**
+     * Returns the number of slots in the ring, for testing.
+     */
+    std::size_t getCapacity_forTest() const;
+
+private:
+    /**
+     * Makes room for at least 'count' more entries, doubling the number of slots as needed.
+     */
+    void _reserve_inlock(std::size_t count);
+
+    void _push_inlock(const Value& value);
+
+    void _waitForSpace_inlock(std::size_t size, stdx::unique_lock<stdx::mutex>& lk);
+
+    const std::size_t _maxSize;
+
+    mutable stdx::mutex _mutex;
+    stdx::condition_variable _notEmptyCondition;
+    stdx::condition_variable _notFullCondition;
+
+    // Entries live in [_head, _head + _count), modulo the number of slots.
+    std::vector<Value> _slots;
+    std::size_t _head = 0;
+    std::size_t _count = 0;
+
+    // Sum of objsize() over the buffered entries.
+    std::size_t _size = 0;
+
+    // Set by clear() to wake up waitForData(), and reset by the next push.
+    bool _clearing = false;
+};
+
+}  // namespace repl
+}  // namespace mongo
@@ -0,0 +1,180 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/jsobj.h"
+#include "mongo/db/repl/oplog_buffer_ring.h"
+#include "mongo/stdx/thread.h"
+#include "mongo/unittest/barrier.h"
+#include "mongo/unittest/unittest.h"
+
+namespace {
+
+using namespace mongo;
+using namespace mongo::repl;
+
+BSONObj makeOplogEntry(int t) {
+    return BSON("ts" << Timestamp(t, t) << "h" << t << "ns"
+                     << "a.a"
+                     << "v"
+                     << 2
+                     << "op"
+                     << "i"
+                     << "o"
+                     << BSON("_id" << t << "a" << t));
+}
+
+TEST(OplogBufferRingTest, PopsEntriesInPushOrderWhileGrowingAndWrappingAround) {
+    OplogBufferRing oplogBuffer;
+    oplogBuffer.startup(nullptr);
+
+    int nextToPush = 0;
+    int nextToPop = 0;
+    auto pushN = [&](int n) {
+        OplogBuffer::Batch batch;
+        for (int i = 0; i < n; ++i) {
+            batch.push_back(makeOplogEntry(nextToPush++));
+        }
+        oplogBuffer.pushAllNonBlocking(nullptr, batch.cbegin(), batch.cend());
+    };
+    auto popN = [&](int n) {
+        for (int i = 0; i < n; ++i) {
+            BSONObj doc;
+            ASSERT_TRUE(oplogBuffer.tryPop(nullptr, &doc));
+            ASSERT_BSONOBJ_EQ(makeOplogEntry(nextToPop++), doc);
+        }
+    };
+
+    pushN(1000);
+    const auto capacity = oplogBuffer.getCapacity_forTest();
+    popN(600);
+
+    // The next pushes wrap around the end of the ring without growing it.
+    pushN(500);
+    ASSERT_EQUALS(capacity, oplogBuffer.getCapacity_forTest());
+    ASSERT_EQUALS(900U, oplogBuffer.getCount());
+
+    // Growing the ring keeps the wrapped entries in order.
+    pushN(2000);
+    ASSERT_GREATER_THAN(oplogBuffer.getCapacity_forTest(), capacity);
+    popN(2900);
+
+    BSONObj doc;
+    ASSERT_FALSE(oplogBuffer.tryPop(nullptr, &doc));
+    ASSERT_TRUE(oplogBuffer.isEmpty());
+    ASSERT_EQUALS(0U, oplogBuffer.getSize());
+}
+
+TEST(OplogBufferRingTest, TracksSizeAndCountAndIsEmptiedByClear) {
+    OplogBufferRing oplogBuffer;
+    oplogBuffer.startup(nullptr);
+
+    auto entry1 = makeOplogEntry(1);
+    auto entry2 = makeOplogEntry(2);
+    oplogBuffer.push(nullptr, entry1);
+    oplogBuffer.pushEvenIfFull(nullptr, entry2);
+    ASSERT_EQUALS(2U, oplogBuffer.getCount());
+    ASSERT_EQUALS(std::size_t(entry1.objsize() + entry2.objsize()), oplogBuffer.getSize());
+
+    BSONObj doc;
+    ASSERT_TRUE(oplogBuffer.peek(nullptr, &doc));
+    ASSERT_BSONOBJ_EQ(entry1, doc);
+    ASSERT_BSONOBJ_EQ(entry2, *oplogBuffer.lastObjectPushed(nullptr));
+
+    oplogBuffer.clear(nullptr);
+    ASSERT_TRUE(oplogBuffer.isEmpty());
+    ASSERT_EQUALS(0U, oplogBuffer.getCount());
+    ASSERT_EQUALS(0U, oplogBuffer.getSize());
+    ASSERT_FALSE(oplogBuffer.peek(nullptr, &doc));
+    ASSERT_FALSE(oplogBuffer.lastObjectPushed(nullptr));
+}
+
+TEST(OplogBufferRingTest, PoppingTheLastEntryOfAReplyReleasesTheReply) {
+    OplogBufferRing oplogBuffer;
+    oplogBuffer.startup(nullptr);
+
+    auto reply = BSON("batch" << BSON_ARRAY(makeOplogEntry(1) << makeOplogEntry(2)));
+    OplogBuffer::Batch batch;
+    for (auto&& elem : reply["batch"].Obj()) {
+        batch.push_back(elem.Obj().shareOwnershipWith(reply));
+    }
+    oplogBuffer.pushAllNonBlocking(nullptr, batch.cbegin(), batch.cend());
+    batch.clear();
+    ASSERT_TRUE(reply.sharedBuffer().isShared());
+
+    BSONObj doc;
+    ASSERT_TRUE(oplogBuffer.tryPop(nullptr, &doc));
+    ASSERT_TRUE(oplogBuffer.tryPop(nullptr, &doc));
+    ASSERT_BSONOBJ_EQ(makeOplogEntry(2), doc);
+    doc = BSONObj();
+    ASSERT_FALSE(reply.sharedBuffer().isShared());
+}
+
+TEST(OplogBufferRingTest, WaitForSpaceBlocksUntilEnoughEntriesArePopped) {
+    auto entry = makeOplogEntry(1);
+    OplogBufferRing oplogBuffer(2 * entry.objsize());
+    oplogBuffer.startup(nullptr);
+    oplogBuffer.push(nullptr, entry);
+    oplogBuffer.push(nullptr, entry);
+
+    unittest::Barrier barrier(2U);
+    bool pushed = false;
+    stdx::thread pushingThread([&] {
+        barrier.countDownAndWait();
+        oplogBuffer.waitForSpace(nullptr, entry.objsize());
+        pushed = true;
+    });
+
+    barrier.countDownAndWait();
+    BSONObj doc;
+    ASSERT_TRUE(oplogBuffer.tryPop(nullptr, &doc));
+    pushingThread.join();
+    ASSERT_TRUE(pushed);
+}
+
+TEST(OplogBufferRingTest, WaitForDataBlocksAndFindsEntry) {
+    OplogBufferRing oplogBuffer;
+    oplogBuffer.startup(nullptr);
+    ASSERT_FALSE(oplogBuffer.waitForData(Seconds(0)));
+
+    unittest::Barrier barrier(2U);
+    bool success = false;
+    stdx::thread peekingThread([&] {
+        barrier.countDownAndWait();
+        success = oplogBuffer.waitForData(Seconds(30));
+    });
+
+    barrier.countDownAndWait();
+    oplogBuffer.push(nullptr, makeOplogEntry(1));
+    peekingThread.join();
+    ASSERT_TRUE(success);
+    ASSERT_EQUALS(1U, oplogBuffer.getCount());
+}
+
+}  // namespace
@@ -34,10 +34,12 @@
 
 #include "mongo/base/counter.h"
 #include "mongo/db/commands/server_status_metric.h"
+#include "mongo/db/client.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/repl/replication_coordinator.h"
 #include "mongo/db/stats/timer_stats.h"
 #include "mongo/rpc/metadata/oplog_query_metadata.h"
+#include "mongo/stdx/memory.h"
 #include "mongo/util/assert_util.h"
 #include "mongo/util/fail_point_service.h"
 #include "mongo/util/log.h"
@@ -324,7 +326,8 @@ OplogFetcher::OplogFetcher(executor::TaskExecutor* executor,
                            DataReplicatorExternalState* dataReplicatorExternalState,
                            EnqueueDocumentsFn enqueueDocumentsFn,
                            OnShutdownCallbackFn onShutdownCallbackFn,
-                           const int batchSize)
+                           const int batchSize,
+                           EnqueueMode enqueueMode)
     : AbstractOplogFetcher(executor,
                            lastFetched,
                            source,
@@ -338,15 +341,33 @@ OplogFetcher::OplogFetcher(executor::TaskExecutor* executor,
       _dataReplicatorExternalState(dataReplicatorExternalState),
       _enqueueDocumentsFn(enqueueDocumentsFn),
       _awaitDataTimeout(calculateAwaitDataTimeout(config)),
-      _batchSize(batchSize) {
+      _batchSize(batchSize),
+      _enqueueMode(enqueueMode) {
 
     invariant(config.isInitialized());
     invariant(enqueueDocumentsFn);
+
+    if (_enqueueMode == EnqueueMode::kPipelined) {
+        ThreadPool::Options options;
+        options.poolName = "OplogFetcherEnqueue";
+        options.minThreads = 0;
+        options.maxThreads = 1;
+        options.onCreateThread = [](const std::string& threadName) {
+            Client::initThread(threadName.c_str());
+        };
+        _enqueuePool = stdx::make_unique<ThreadPool>(options);
+        _enqueuePool->startup();
+    }
 }
 
 OplogFetcher::~OplogFetcher() {
     shutdown();
     join();
+
+    if (_enqueuePool) {
+        _enqueuePool->shutdown();
+        _enqueuePool->join();
+    }
 }
 
 BSONObj OplogFetcher::_makeFindCommandObject(const NamespaceString& nss,
@@ -484,7 +505,7 @@ StatusWith<BSONObj> OplogFetcher::_onSuccessfulBatch(const Fetcher::QueryRespons
     getmoreReplStats.recordMillis(durationCount<Milliseconds>(queryResponse.elapsedMillis));
 
     // TODO: back pressure handling will be added in SERVER-23499.
-    auto status = _enqueueDocumentsFn(firstDocToApply, documents.cend(), info);
+    auto status = _enqueueBatch(documents, firstDocToApply - documents.cbegin(), info);
     if (!status.isOK()) {
         return status;
     }
@@ -517,5 +538,61 @@ StatusWith<BSONObj> OplogFetcher::_onSuccessfulBatch(const Fetcher::QueryRespons
                                     _getGetMoreMaxTime(),
                                     _batchSize);
 }
+
+Status OplogFetcher::_enqueueBatch(const Fetcher::Documents& documents,
+                                   std::size_t numToSkip,
+                                   const DocumentsInfo& info) {
+    if (_enqueueMode == EnqueueMode::kSynchronous) {
+        return _enqueueDocumentsFn(documents.cbegin() + numToSkip, documents.cend(), info);
+    }
+
+    // Wait for the previous batch to be enqueued before handing over this one.
+    {
+        stdx::unique_lock<stdx::mutex> lock(_enqueueMutex);
+        _enqueueCondition.wait(lock, [this] { return !_enqueueInProgress; });
+        if (!_enqueueStatus.isOK()) {
+            return _enqueueStatus;
+        }
+        _enqueueInProgress = true;
+    }
+
+    // The documents share ownership of the reply buffer, so this only copies references to it.
+    auto ownedDocuments =
+        std::make_shared<Fetcher::Documents>(documents.cbegin() + numToSkip, documents.cend());
+
+    auto scheduleStatus = _enqueuePool->schedule([this, ownedDocuments, info] {
+        auto status = _enqueueDocumentsFn(ownedDocuments->cbegin(), ownedDocuments->cend(), info);
+        {
+            stdx::lock_guard<stdx::mutex> lock(_enqueueMutex);
+            _enqueueInProgress = false;
+            _enqueueStatus = status;
+            _enqueueCondition.notify_all();
+        }
+        if (!status.isOK()) {
+            // The getMore for the next batch is already in flight. Cancel it so the failure is
+            // reported from _onFinish().
+            shutdown();
+        }
+    });
+    if (!scheduleStatus.isOK()) {
+        stdx::lock_guard<stdx::mutex> lock(_enqueueMutex);
+        _enqueueInProgress = false;
+        return scheduleStatus;
+    }
+    return Status::OK();
+}
+
+Status OplogFetcher::_onFinish(Status status) {
+    if (_enqueueMode == EnqueueMode::kSynchronous) {
+        return status;
+    }
+
+    stdx::unique_lock<stdx::mutex> lock(_enqueueMutex);
+    _enqueueCondition.wait(lock, [this] { return !_enqueueInProgress; });
+    if (!_enqueueStatus.isOK()) {
+        return _enqueueStatus;
+    }
+    return status;
+}
 }  // namespace repl
 }  // namespace mongo
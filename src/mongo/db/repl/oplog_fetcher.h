@@ -38,7 +38,10 @@
 #include "mongo/db/repl/abstract_oplog_fetcher.h"
 #include "mongo/db/repl/data_replicator_external_state.h"
 #include "mongo/db/repl/repl_set_config.h"
+#include "mongo/stdx/condition_variable.h"
 #include "mongo/stdx/functional.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/util/concurrency/thread_pool.h"
 #include "mongo/util/fail_point_service.h"
 
 namespace mongo {
@@ -99,6 +102,18 @@ public:
                                                      Fetcher::Documents::const_iterator end,
                                                      const DocumentsInfo& info)>;
 
+    /**
+     * Controls when "enqueueDocumentsFn" runs relative to the getMore for the next batch.
+     *
+     * kSynchronous: each batch is enqueued before the next getMore is sent.
+     *
+     * kPipelined: each batch is validated before the next getMore is sent, but enqueued on a
+     * separate thread while that getMore is in flight. At most one batch is waiting to be enqueued
+     * at a time, so a full buffer still stops the fetcher from requesting more. This keeps the
+     * network round trip off the critical path when the sync source is far away.
+     */
+    enum class EnqueueMode { kSynchronous, kPipelined };
+
     /**
      * Validates documents in current batch of results returned from tailing the remote oplog.
      * 'first' should be set to true if this set of documents is the first batch returned from the
@@ -123,7 +138,8 @@ public:
                  DataReplicatorExternalState* dataReplicatorExternalState,
                  EnqueueDocumentsFn enqueueDocumentsFn,
                  OnShutdownCallbackFn onShutdownCallbackFn,
-                 const int batchSize);
+                 const int batchSize,
+                 EnqueueMode enqueueMode = EnqueueMode::kSynchronous);
 
     virtual ~OplogFetcher();
 
@@ -157,6 +173,20 @@ private:
      */
     StatusWith<BSONObj> _onSuccessfulBatch(const Fetcher::QueryResponse& queryResponse) override;
 
+    /**
+     * Waits for the batch handed to '_enqueuePool', if any, to be enqueued and returns its error
+     * in place of 'status' if it failed.
+     */
+    Status _onFinish(Status status) override;
+
+    /**
+     * Passes the documents of 'documents' after the first 'numToSkip' to '_enqueueDocumentsFn',
+     * either directly or through '_enqueuePool' depending on '_enqueueMode'.
+     */
+    Status _enqueueBatch(const Fetcher::Documents& documents,
+                         std::size_t numToSkip,
+                         const DocumentsInfo& info);
+
     // The metadata object sent with the Fetcher queries.
     const BSONObj _metadataObject;
 
@@ -173,6 +203,16 @@ private:
     const EnqueueDocumentsFn _enqueueDocumentsFn;
     const Milliseconds _awaitDataTimeout;
     const int _batchSize;
+    const EnqueueMode _enqueueMode;
+
+    // Single thread running '_enqueueDocumentsFn' in kPipelined mode. Null in kSynchronous mode.
+    std::unique_ptr<ThreadPool> _enqueuePool;
+
+    // Protects the members below, which track the batch handed to '_enqueuePool'.
+    stdx::mutex _enqueueMutex;
+    stdx::condition_variable _enqueueCondition;
+    bool _enqueueInProgress = false;
+    Status _enqueueStatus = Status::OK();
 };
 
 }  // namespace repl
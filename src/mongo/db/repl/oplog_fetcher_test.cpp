@@ -29,6 +29,7 @@
 #include "mongo/platform/basic.h"
 
 #include <memory>
+#include <vector>
 
 #include "mongo/db/repl/abstract_oplog_fetcher_test_fixture.h"
 #include "mongo/db/repl/data_replicator_external_state_mock.h"
@@ -36,7 +37,9 @@
 #include "mongo/rpc/metadata.h"
 #include "mongo/rpc/metadata/oplog_query_metadata.h"
 #include "mongo/rpc/metadata/repl_set_metadata.h"
+#include "mongo/stdx/condition_variable.h"
 #include "mongo/stdx/memory.h"
+#include "mongo/stdx/mutex.h"
 #include "mongo/unittest/ensure_fcv.h"
 #include "mongo/unittest/task_executor_proxy.h"
 #include "mongo/unittest/unittest.h"
@@ -798,6 +801,117 @@ TEST_F(OplogFetcherTest,
     ASSERT_FALSE(request.cmdObj.hasField("lastKnownCommittedOpTime"));
 }
 
+TEST_F(OplogFetcherTest, PipelinedOplogFetcherSendsNextGetMoreBeforeEnqueueingBatch) {
+    ShutdownState shutdownState;
+
+    stdx::mutex mutex;
+    stdx::condition_variable condition;
+    bool enqueueAllowed = false;
+    std::vector<Fetcher::Documents> enqueuedBatches;
+    auto blockingEnqueueDocumentsFn = [&](Fetcher::Documents::const_iterator begin,
+                                          Fetcher::Documents::const_iterator end,
+                                          const OplogFetcher::DocumentsInfo&) -> Status {
+        stdx::unique_lock<stdx::mutex> lock(mutex);
+        condition.wait(lock, [&] { return enqueueAllowed; });
+        enqueuedBatches.emplace_back(begin, end);
+        return Status::OK();
+    };
+
+    OplogFetcher oplogFetcher(&getExecutor(),
+                              lastFetched,
+                              source,
+                              nss,
+                              _createConfig(true),
+                              0,
+                              rbid,
+                              true,
+                              dataReplicatorExternalState.get(),
+                              blockingEnqueueDocumentsFn,
+                              stdx::ref(shutdownState),
+                              defaultBatchSize,
+                              OplogFetcher::EnqueueMode::kPipelined);
+    ASSERT_OK(oplogFetcher.startup());
+
+    CursorId cursorId = 22LL;
+    auto firstEntry = makeNoopOplogEntry(lastFetched);
+    auto secondEntry = makeNoopOplogEntry({{Seconds(456), 0}, lastFetched.opTime.getTerm()}, 200);
+    auto metadataObj = makeOplogQueryMetadataObject(remoteNewerOpTime, rbid, 2, 2);
+
+    // The getMore is ready to be sent while the first batch is still waiting to be enqueued.
+    processNetworkResponse(
+        {makeCursorResponse(cursorId, {firstEntry, secondEntry}), metadataObj, Milliseconds(0)},
+        true);
+    {
+        stdx::lock_guard<stdx::mutex> lock(mutex);
+        ASSERT_TRUE(enqueuedBatches.empty());
+        enqueueAllowed = true;
+        condition.notify_all();
+    }
+
+    auto thirdEntry = makeNoopOplogEntry({{Seconds(789), 0}, lastFetched.opTime.getTerm()}, 300);
+    auto request = processNetworkResponse(makeCursorResponse(0, {thirdEntry}, false));
+    ASSERT_EQUALS(std::string("getMore"), request.cmdObj.firstElementFieldName());
+
+    // Both batches are enqueued, in order, before the fetcher reports that it has finished.
+    oplogFetcher.join();
+    ASSERT_OK(shutdownState.getStatus());
+    stdx::lock_guard<stdx::mutex> lock(mutex);
+    ASSERT_EQUALS(2U, enqueuedBatches.size());
+    ASSERT_EQUALS(1U, enqueuedBatches[0].size());
+    ASSERT_BSONOBJ_EQ(secondEntry, enqueuedBatches[0][0]);
+    ASSERT_EQUALS(1U, enqueuedBatches[1].size());
+    ASSERT_BSONOBJ_EQ(thirdEntry, enqueuedBatches[1][0]);
+}
+
+TEST_F(OplogFetcherTest, PipelinedOplogFetcherStopsWithErrorReturnedByEnqueueDocumentsFn) {
+    ShutdownState shutdownState;
+
+    stdx::mutex mutex;
+    stdx::condition_variable condition;
+    bool enqueueAllowed = false;
+    auto failingEnqueueDocumentsFn = [&](Fetcher::Documents::const_iterator,
+                                         Fetcher::Documents::const_iterator,
+                                         const OplogFetcher::DocumentsInfo&) -> Status {
+        stdx::unique_lock<stdx::mutex> lock(mutex);
+        condition.wait(lock, [&] { return enqueueAllowed; });
+        return Status(ErrorCodes::OperationFailed, "failed to enqueue");
+    };
+
+    OplogFetcher oplogFetcher(&getExecutor(),
+                              lastFetched,
+                              source,
+                              nss,
+                              _createConfig(true),
+                              0,
+                              rbid,
+                              true,
+                              dataReplicatorExternalState.get(),
+                              failingEnqueueDocumentsFn,
+                              stdx::ref(shutdownState),
+                              defaultBatchSize,
+                              OplogFetcher::EnqueueMode::kPipelined);
+    ASSERT_OK(oplogFetcher.startup());
+
+    auto firstEntry = makeNoopOplogEntry(lastFetched);
+    auto secondEntry = makeNoopOplogEntry({{Seconds(456), 0}, lastFetched.opTime.getTerm()}, 200);
+    auto metadataObj = makeOplogQueryMetadataObject(remoteNewerOpTime, rbid, 2, 2);
+    processNetworkResponse(
+        {makeCursorResponse(22LL, {firstEntry, secondEntry}), metadataObj, Milliseconds(0)}, true);
+    {
+        stdx::lock_guard<stdx::mutex> lock(mutex);
+        enqueueAllowed = true;
+        condition.notify_all();
+    }
+
+    // The failed enqueue cancels the outstanding getMore.
+    while (oplogFetcher.isActive()) {
+        executor::NetworkInterfaceMock::InNetworkGuard guard(getNet());
+        getNet()->runReadyNetworkOperations();
+    }
+    oplogFetcher.join();
+    ASSERT_EQUALS(ErrorCodes::OperationFailed, shutdownState.getStatus());
+}
+
 TEST_F(OplogFetcherTest, ValidateDocumentsReturnsNoSuchKeyIfTimestampIsNotFoundInAnyDocument) {
     auto firstEntry = makeNoopOplogEntry(Seconds(123), 100);
     auto secondEntry = BSON("o" << BSON("msg"
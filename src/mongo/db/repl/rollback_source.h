@@ -28,15 +28,19 @@
 
 #pragma once
 
+#include <tuple>
+#include <utility>
+#include <vector>
+
 #include "mongo/base/disallow_copying.h"
 #include "mongo/base/status_with.h"
 #include "mongo/db/jsobj.h"
+#include "mongo/db/namespace_string.h"
 #include "mongo/util/net/hostandport.h"
 #include "mongo/util/uuid.h"
 
 namespace mongo {
 
-class NamespaceString;
 class OperationContext;
 
 namespace repl {
@@ -88,6 +92,27 @@ public:
                                                               UUID uuid,
                                                               const BSONObj& filter) const = 0;
 
+    /**
+     * Fetch the documents with the given _id values from the sync source using the UUID. Documents
+     * that no longer exist on the sync source are left out of the result. Returns the namespace
+     * matching the UUID on the sync source as well.
+     *
+     * The default implementation fetches one document at a time with findOneByUUID().
+     */
+    virtual std::pair<std::vector<BSONObj>, NamespaceString> findManyByUUID(
+        const std::string& db, UUID uuid, const std::vector<BSONElement>& ids) const {
+        std::vector<BSONObj> docs;
+        NamespaceString nss;
+        for (const auto& id : ids) {
+            BSONObj doc;
+            std::tie(doc, nss) = findOneByUUID(db, uuid, id.wrap());
+            if (!doc.isEmpty()) {
+                docs.push_back(doc);
+            }
+        }
+        return {docs, nss};
+    }
+
     /**
      * Clones a single collection from the sync source.
      */
@@ -79,6 +79,61 @@ std::pair<BSONObj, NamespaceString> RollbackSourceImpl::findOneByUUID(const std:
     return _getConnection()->findOneByUUID(db, uuid, filter);
 }
 
+std::pair<std::vector<BSONObj>, NamespaceString> RollbackSourceImpl::findManyByUUID(
+    const std::string& db, UUID uuid, const std::vector<BSONElement>& ids) const {
+    BSONObjBuilder cmdBuilder;
+    uuid.appendToBuilder(&cmdBuilder, "find");
+    {
+        BSONObjBuilder filterBuilder(cmdBuilder.subobjStart("filter"));
+        BSONObjBuilder idBuilder(filterBuilder.subobjStart("_id"));
+        BSONArrayBuilder inBuilder(idBuilder.subarrayStart("$in"));
+        for (const auto& id : ids) {
+            inBuilder.append(id);
+        }
+    }
+    // The _id values must match exactly, whatever the default collation of the collection is.
+    cmdBuilder.append("collation",
+                      BSON("locale"
+                           << "simple"));
+    cmdBuilder.append("batchSize", static_cast<long long>(ids.size()));
+    const BSONObj cmd = cmdBuilder.obj();
+
+    auto conn = _getConnection();
+    BSONObj res;
+    uassert(50663,
+            str::stream() << "find command using UUID failed. Command: " << cmd << " Result: "
+                          << res,
+            conn->runCommand(db, cmd, res, QueryOption_SlaveOk));
+
+    std::vector<BSONObj> docs;
+    docs.reserve(ids.size());
+    auto appendBatch = [&docs](const BSONObj& batch) {
+        for (auto&& elem : batch) {
+            docs.push_back(elem.Obj().getOwned());
+        }
+    };
+
+    BSONObj cursorObj = res.getObjectField("cursor");
+    const NamespaceString nss(cursorObj["ns"].valueStringData());
+    appendBatch(cursorObj.getObjectField("firstBatch"));
+
+    // The documents only fill more than one batch if they add up to more than the maximum reply
+    // size.
+    auto cursorId = cursorObj["id"].numberLong();
+    while (cursorId != 0) {
+        const BSONObj getMoreCmd = BSON("getMore" << cursorId << "collection" << nss.coll());
+        uassert(50664,
+                str::stream() << "getMore command failed. Command: " << getMoreCmd << " Result: "
+                              << res,
+                conn->runCommand(db, getMoreCmd, res, QueryOption_SlaveOk));
+        cursorObj = res.getObjectField("cursor");
+        appendBatch(cursorObj.getObjectField("nextBatch"));
+        cursorId = cursorObj["id"].numberLong();
+    }
+
+    return {docs, nss};
+}
+
 void RollbackSourceImpl::copyCollectionFromRemote(OperationContext* opCtx,
                                                   const NamespaceString& nss) const {
     std::string errmsg;
@@ -981,22 +981,38 @@ void rollback_internal::syncFixUp(OperationContext* opCtx,
 
     log() << "Starting refetching documents";
 
-    for (auto&& doc : fixUpInfo.docsToRefetch) {
-        invariant(!doc._id.eoo());  // This is checked when we insert to the set.
-
-        UUID uuid = doc.uuid;
-        NamespaceString nss = catalog.lookupNSSByUUID(uuid);
+    // Documents are refetched in batches of documents from the same collection, so that rolling
+    // back many writes does not take a round trip to the sync source per document. The size of
+    // the _id values in a batch is bounded so that the find command stays well below the maximum
+    // BSON size.
+    const size_t kMaxRefetchBatchDocs = 1000;
+    const int kMaxRefetchBatchIdBytes = 4 * 1024 * 1024;
+
+    auto batchBegin = fixUpInfo.docsToRefetch.begin();
+    while (batchBegin != fixUpInfo.docsToRefetch.end()) {
+        const UUID uuid = batchBegin->uuid;
+        const NamespaceString nss = catalog.lookupNSSByUUID(uuid);
+
+        std::vector<BSONElement> ids;
+        int idBytes = 0;
+        auto batchEnd = batchBegin;
+        while (batchEnd != fixUpInfo.docsToRefetch.end() && batchEnd->uuid == uuid &&
+               ids.size() < kMaxRefetchBatchDocs && idBytes < kMaxRefetchBatchIdBytes) {
+            invariant(!batchEnd->_id.eoo());  // This is checked when we insert to the set.
+            ids.push_back(batchEnd->_id);
+            idBytes += batchEnd->_id.size();
+            ++batchEnd;
+        }
 
         try {
-            LOG(2) << "Refetching document, collection: " << nss << ", UUID: " << uuid << ", "
-                   << redact(doc._id);
-            // TODO : Slow. Lots of round trips.
-            numFetched++;
+            LOG(2) << "Refetching " << ids.size() << " documents, collection: " << nss
+                   << ", UUID: " << uuid;
+            numFetched += ids.size();
 
-            BSONObj good;
+            std::vector<BSONObj> goodDocs;
             NamespaceString resNss;
-            std::tie(good, resNss) =
-                rollbackSource.findOneByUUID(nss.db().toString(), uuid, doc._id.wrap());
+            std::tie(goodDocs, resNss) =
+                rollbackSource.findManyByUUID(nss.db().toString(), uuid, ids);
 
             // To prevent inconsistencies in the transactions collection, rollback fails if the UUID
             // of the collection is different on the sync source than on the node rolling back,
@@ -1013,7 +1029,11 @@ void rollback_internal::syncFixUp(OperationContext* opCtx,
                        "resync is required.");
             }
 
-            totalSize += good.objsize();
+            std::set<DocID> fetched;
+            for (const auto& good : goodDocs) {
+                fetched.emplace(good, good["_id"], uuid);
+                totalSize += good.objsize();
+            }
 
             // Checks that the total amount of data that needs to be refetched is at most
             // 300 MB. We do not roll back more than 300 MB of documents in order to
@@ -1022,21 +1042,28 @@ void rollback_internal::syncFixUp(OperationContext* opCtx,
                 throw RSFatalException("replSet too much data to roll back.");
             }
 
-            // Note good might be empty, indicating we should delete it.
-            goodVersions[uuid].insert(std::pair<DocID, BSONObj>(doc, good));
+            // Documents missing from the result no longer exist on the sync source. Their good
+            // version is empty, indicating we should delete them.
+            auto& goodVersionsByDocID = goodVersions[uuid];
+            for (auto it = batchBegin; it != batchEnd; ++it) {
+                auto fetchedIt = fetched.find(*it);
+                goodVersionsByDocID.insert(std::pair<DocID, BSONObj>(
+                    *it, fetchedIt == fetched.end() ? BSONObj() : fetchedIt->ownedObj));
+            }
 
         } catch (const DBException& ex) {
             // If the collection turned into a view, we might get an error trying to
             // refetch documents, but these errors should be ignored, as we'll be creating
             // the view during oplog replay.
-            if (ex.code() == ErrorCodes::CommandNotSupportedOnView)
-                continue;
-
-            log() << "Rollback couldn't re-fetch from uuid: " << uuid << " _id: " << redact(doc._id)
-                  << ' ' << numFetched << '/' << fixUpInfo.docsToRefetch.size() << ": "
-                  << redact(ex);
-            throw;
+            if (ex.code() != ErrorCodes::CommandNotSupportedOnView) {
+                log() << "Rollback couldn't re-fetch " << ids.size()
+                      << " documents from uuid: " << uuid << ' ' << numFetched << '/'
+                      << fixUpInfo.docsToRefetch.size() << ": " << redact(ex);
+                throw;
+            }
         }
+
+        batchBegin = batchEnd;
     }
 
     log() << "Finished refetching documents. Total size of documents refetched: "
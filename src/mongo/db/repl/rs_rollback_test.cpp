@@ -31,7 +31,9 @@
 #include "mongo/platform/basic.h"
 
 #include <initializer_list>
+#include <set>
 #include <utility>
+#include <vector>
 
 #include "mongo/db/catalog/collection.h"
 #include "mongo/db/catalog/collection_catalog_entry.h"
@@ -1758,6 +1760,76 @@ TEST_F(RSRollbackTest, RollbackApplyOpsCommand) {
         << result;
 }
 
+TEST_F(RSRollbackTest, RollbackRefetchesDocumentsOfACollectionInOneBatch) {
+    createOplog(_opCtx.get());
+    CollectionOptions options;
+    options.uuid = UUID::gen();
+    _createCollection(_opCtx.get(), "test.t", options);
+    const UUID uuid = *options.uuid;
+
+    const auto commonOperation =
+        std::make_pair(BSON("ts" << Timestamp(Seconds(1), 0) << "h" << 1LL), RecordId(1));
+    auto makeInsertOperation = [&uuid](int id) {
+        return std::make_pair(BSON("ts" << Timestamp(Seconds(1 + id), 0) << "h" << 1LL << "op"
+                                        << "i"
+                                        << "ui"
+                                        << uuid
+                                        << "ns"
+                                        << "test.t"
+                                        << "o"
+                                        << BSON("_id" << id)),
+                              RecordId(1 + id));
+    };
+
+    class RollbackSourceLocal : public RollbackSourceMock {
+    public:
+        RollbackSourceLocal(std::unique_ptr<OplogInterface> oplog)
+            : RollbackSourceMock(std::move(oplog)) {}
+
+        std::pair<BSONObj, NamespaceString> findOneByUUID(const std::string& db,
+                                                          UUID uuid,
+                                                          const BSONObj& filter) const override {
+            FAIL("Unexpected findOneByUUID request") << filter;
+            return {};
+        }
+
+        std::pair<std::vector<BSONObj>, NamespaceString> findManyByUUID(
+            const std::string& db, UUID uuid, const std::vector<BSONElement>& ids) const override {
+            ++numRequests;
+            for (const auto& id : ids) {
+                searchedIds.insert(id.numberInt());
+            }
+            // Document 3 no longer exists on the sync source.
+            return {{BSON("_id" << 1 << "v" << 1), BSON("_id" << 2 << "v" << 2)},
+                    NamespaceString("test.t")};
+        }
+
+        mutable int numRequests = 0;
+        mutable std::set<int> searchedIds;
+    } rollbackSource(std::unique_ptr<OplogInterface>(new OplogInterfaceMock({commonOperation})));
+
+    ASSERT_OK(syncRollback(_opCtx.get(),
+                           OplogInterfaceMock({makeInsertOperation(3),
+                                               makeInsertOperation(2),
+                                               makeInsertOperation(1),
+                                               commonOperation}),
+                           rollbackSource,
+                           {},
+                           _coordinator,
+                           _replicationProcess.get()));
+    ASSERT_EQUALS(1, rollbackSource.numRequests);
+    ASSERT_TRUE((std::set<int>{1, 2, 3}) == rollbackSource.searchedIds);
+
+    AutoGetCollectionForReadCommand acr(_opCtx.get(), NamespaceString("test.t"));
+    BSONObj result;
+    ASSERT(Helpers::findOne(_opCtx.get(), acr.getCollection(), BSON("_id" << 1), result));
+    ASSERT_EQUALS(1, result["v"].numberInt()) << result;
+    ASSERT(Helpers::findOne(_opCtx.get(), acr.getCollection(), BSON("_id" << 2), result));
+    ASSERT_EQUALS(2, result["v"].numberInt()) << result;
+    ASSERT_FALSE(Helpers::findOne(_opCtx.get(), acr.getCollection(), BSON("_id" << 3), result))
+        << result;
+}
+
 TEST_F(RSRollbackTest, RollbackCreateCollectionCommand) {
     createOplog(_opCtx.get());
     CollectionOptions options;
@@ -263,7 +263,7 @@ StorageInterfaceImpl::createCollectionForBulkLoading(
         return status;
     }
 
-    // Move locks into loader, so it now controls their lifetime.
+    // Move locks into loader, which holds them until it has been initialized.
     auto loader =
         stdx::make_unique<CollectionBulkLoaderImpl>(Client::releaseCurrent(),
                                                     std::move(opCtx),
@@ -513,6 +513,40 @@ TEST_F(StorageInterfaceImplTest, CreateCollectionWithIDIndexCommits) {
     ASSERT_EQ(count, 2LL);
 }
 
+TEST_F(StorageInterfaceImplTest, CollectionsOfTheSameDatabaseCanBeBulkLoadedConcurrently) {
+    auto opCtx = getOperationContext();
+    StorageInterfaceImpl storage;
+    auto nss1 = makeNamespace(_agent, "1");
+    auto nss2 = makeNamespace(_agent, "2");
+    ASSERT_EQ(nss1.db(), nss2.db());
+
+    // Creating the second collection locks the database exclusively, which must not wait for the
+    // loader of the first one.
+    std::vector<BSONObj> indexes;
+    auto loader1 = unittest::assertGet(storage.createCollectionForBulkLoading(
+        nss1, CollectionOptions(), makeIdIndexSpec(nss1), indexes));
+    auto loader2 = unittest::assertGet(storage.createCollectionForBulkLoading(
+        nss2, CollectionOptions(), makeIdIndexSpec(nss2), indexes));
+
+    std::vector<BSONObj> docs1 = {BSON("_id" << 1), BSON("_id" << 2)};
+    std::vector<BSONObj> docs2 = {BSON("_id" << 3)};
+    ASSERT_OK(loader1->insertDocuments(docs1.begin(), docs1.begin() + 1));
+    ASSERT_OK(loader2->insertDocuments(docs2.begin(), docs2.end()));
+    ASSERT_OK(loader1->insertDocuments(docs1.begin() + 1, docs1.end()));
+    ASSERT_OK(loader2->commit());
+    ASSERT_OK(loader1->commit());
+
+    for (const auto& expected : {std::make_pair(nss1, 2LL), std::make_pair(nss2, 1LL)}) {
+        AutoGetCollectionForReadCommand autoColl(opCtx, expected.first);
+        auto coll = autoColl.getCollection();
+        ASSERT(coll);
+        ASSERT_EQ(expected.second, coll->getRecordStore()->numRecords(opCtx));
+        auto collIdxCat = coll->getIndexCatalog();
+        ASSERT_EQ(expected.second,
+                  getIndexKeyCount(opCtx, collIdxCat, collIdxCat->findIdIndex(opCtx)));
+    }
+}
+
 void _testDestroyUncommitedCollectionBulkLoader(
     OperationContext* opCtx,
     const NamespaceString& nss,
@@ -34,6 +34,7 @@
 #include "mongo/db/repl/sync_tail.h"
 
 #include "third_party/murmurhash3/MurmurHash3.h"
+#include <array>
 #include <boost/functional/hash.hpp>
 #include <memory>
 
@@ -79,6 +80,7 @@
 #include "mongo/util/mongoutils/str.h"
 #include "mongo/util/net/socket_exception.h"
 #include "mongo/util/scopeguard.h"
+#include "mongo/util/timer.h"
 
 namespace mongo {
 
@@ -90,6 +92,16 @@ AtomicInt32 SyncTail::replBatchLimitOperations{50 * 1000};
 
 namespace {
 
+using SessionRecordMap = SyncTail::SessionRecordMap;
+
+}  // namespace
+
+namespace {
+
+// When enabled, and the storage engine supports document-level locking, the next batch is written
+// to the oplog and partitioned among the writer threads while the current one is being applied.
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(replPipelinedBatchApplication, bool, false);
+
 /**
  * This variable determines the number of writer threads SyncTail will have. It has a default value,
  * which varies based on architecture and can be overridden using the "replWriterThreadCount" server
@@ -120,6 +132,33 @@ public:
 
 } exportedWriterThreadCountParam;
 
+/**
+ * The number of writer vectors a batch is partitioned into for each writer thread. Writer threads
+ * take the vectors largest first as they become free, so a finer partition lets the other threads
+ * absorb the rest of a batch when one vector is much longer than the others.
+ */
+int replWriterVectorsPerThread = 4;
+
+class ExportedWriterVectorsPerThreadParameter
+    : public ExportedServerParameter<int, ServerParameterType::kStartupOnly> {
+public:
+    ExportedWriterVectorsPerThreadParameter()
+        : ExportedServerParameter<int, ServerParameterType::kStartupOnly>(
+              ServerParameterSet::getGlobal(),
+              "replWriterVectorsPerThread",
+              &replWriterVectorsPerThread) {}
+
+    virtual Status validate(const int& potentialNewValue) {
+        if (potentialNewValue < 1 || potentialNewValue > 64) {
+            return Status(ErrorCodes::BadValue,
+                          "replWriterVectorsPerThread must be between 1 and 64");
+        }
+
+        return Status::OK();
+    }
+
+} exportedWriterVectorsPerThreadParam;
+
 class ExportedBatchLimitOperationsParameter
     : public ExportedServerParameter<int, ServerParameterType::kStartupAndRuntime> {
 public:
@@ -152,6 +191,44 @@ ServerStatusMetricField<Counter64> displayAttemptsToBecomeSecondary(
 TimerStats applyBatchStats;
 ServerStatusMetricField<TimerStats> displayOpBatchesApplied("repl.apply.batches", &applyBatchStats);
 
+/**
+ * Reports, for each writer thread slot, how many operations and writer vectors it has applied and
+ * how long it spent applying them, as "repl.apply.writers". Comparing the slots shows how evenly
+ * batches are spread over the writer threads.
+ */
+class WriterUtilizationMetric : public ServerStatusMetric {
+public:
+    WriterUtilizationMetric() : ServerStatusMetric("repl.apply.writers") {}
+
+    void record(size_t slot, long long ops, long long vectors, long long busyMicros) {
+        invariant(slot < _slots.size());
+        _slots[slot].ops.fetchAndAdd(ops);
+        _slots[slot].vectors.fetchAndAdd(vectors);
+        _slots[slot].busyMicros.fetchAndAdd(busyMicros);
+    }
+
+    void appendAtLeaf(BSONObjBuilder& b) const override {
+        BSONArrayBuilder arr(b.subarrayStart(_leafName));
+        const auto numSlots = std::min(_slots.size(), static_cast<size_t>(replWriterThreadCount));
+        for (size_t i = 0; i < numSlots; ++i) {
+            BSONObjBuilder slotBuilder(arr.subobjStart());
+            slotBuilder.append("ops", _slots[i].ops.load());
+            slotBuilder.append("writerVectors", _slots[i].vectors.load());
+            slotBuilder.append("busyMicros", _slots[i].busyMicros.load());
+        }
+    }
+
+private:
+    struct Slot {
+        AtomicInt64 ops;
+        AtomicInt64 vectors;
+        AtomicInt64 busyMicros;
+    };
+
+    // Sized to the maximum value of "replWriterThreadCount".
+    std::array<Slot, 256> _slots;
+} writerUtilization;
+
 void initializePrefetchThread() {
     if (!Client::getCurrent()) {
         Client::initThreadIfNotAlready();
@@ -307,20 +384,25 @@ bool SyncTail::peek(OperationContext* opCtx, BSONObj* op) {
     return _networkQueue->peek(opCtx, op);
 }
 
-// static
-Status SyncTail::syncApply(OperationContext* opCtx,
-                           const BSONObj& op,
-                           OplogApplication::Mode oplogApplicationMode,
-                           ApplyOperationInLockFn applyOperationInLock,
-                           ApplyCommandInLockFn applyCommandInLock,
-                           IncrementOpsAppliedStatsFn incrementOpsAppliedStats) {
+namespace {
+
+/**
+ * Applies 'op' given the fields that syncApply needs to choose the locks to take, so that callers
+ * which already hold a parsed OplogEntry do not have to extract them from the raw BSON again.
+ * 'uuid' is only consulted for CRUD operations.
+ */
+Status syncApplyDecoded(OperationContext* opCtx,
+                        const BSONObj& op,
+                        const NamespaceString& nss,
+                        const char* opType,
+                        const boost::optional<UUID>& uuid,
+                        OplogApplication::Mode oplogApplicationMode,
+                        SyncTail::ApplyOperationInLockFn applyOperationInLock,
+                        SyncTail::ApplyCommandInLockFn applyCommandInLock,
+                        SyncTail::IncrementOpsAppliedStatsFn incrementOpsAppliedStats) {
     // Count each log op application as a separate operation, for reporting purposes
     CurOp individualOp(opCtx);
 
-    const NamespaceString nss(op.getStringField("ns"));
-
-    const char* opType = op["op"].valuestrsafe();
-
     auto applyOp = [&](Database* db) {
         // For non-initial-sync, we convert updates to upserts
         // to suppress errors when replaying oplog entries.
@@ -357,19 +439,15 @@ Status SyncTail::syncApply(OperationContext* opCtx,
         return writeConflictRetry(opCtx, "syncApply_CRUD", nss.ns(), [&] {
             // DB lock always acquires the global lock
             Lock::DBLock dbLock(opCtx, nss.db(), MODE_IX);
-            auto ui = op["ui"];
             NamespaceString actualNss = nss;
-            if (ui) {
-                auto statusWithUUID = UUID::parse(ui);
-                if (!statusWithUUID.isOK())
-                    return statusWithUUID.getStatus();
+            if (uuid) {
                 // We may be replaying operations on a collection that was renamed since. If so,
                 // it must have been in the same database or it would have gotten a new UUID.
                 // Need to throw instead of returning a status for it to be properly ignored.
-                actualNss = UUIDCatalog::get(opCtx).lookupNSSByUUID(statusWithUUID.getValue());
+                actualNss = UUIDCatalog::get(opCtx).lookupNSSByUUID(*uuid);
                 uassert(ErrorCodes::NamespaceNotFound,
                         str::stream() << "Failed to apply operation due to missing collection ("
-                                      << statusWithUUID.getValue()
+                                      << *uuid
                                       << "): "
                                       << redact(op.toString()),
                         !actualNss.isEmpty());
@@ -411,6 +489,42 @@ Status SyncTail::syncApply(OperationContext* opCtx,
     return Status(ErrorCodes::BadValue, ss);
 }
 
+}  // namespace
+
+// static
+Status SyncTail::syncApply(OperationContext* opCtx,
+                           const BSONObj& op,
+                           OplogApplication::Mode oplogApplicationMode,
+                           ApplyOperationInLockFn applyOperationInLock,
+                           ApplyCommandInLockFn applyCommandInLock,
+                           IncrementOpsAppliedStatsFn incrementOpsAppliedStats) {
+    // Pull out everything needed to dispatch the operation in a single pass over its fields.
+    static const std::array<StringData, 3> kDispatchFields{{"ns"_sd, "op"_sd, "ui"_sd}};
+    std::array<BSONElement, 3> fields;
+    op.getFields(kDispatchFields, &fields);
+
+    const NamespaceString nss(fields[0].type() == String ? fields[0].valuestr() : "");
+    const char* opType = fields[1].valuestrsafe();
+
+    boost::optional<UUID> uuid;
+    if (fields[2] && isCrudOpType(opType)) {
+        auto statusWithUUID = UUID::parse(fields[2]);
+        if (!statusWithUUID.isOK())
+            return statusWithUUID.getStatus();
+        uuid = statusWithUUID.getValue();
+    }
+
+    return syncApplyDecoded(opCtx,
+                            op,
+                            nss,
+                            opType,
+                            uuid,
+                            oplogApplicationMode,
+                            applyOperationInLock,
+                            applyCommandInLock,
+                            incrementOpsAppliedStats);
+}
+
 Status SyncTail::syncApply(OperationContext* opCtx,
                            const BSONObj& op,
                            OplogApplication::Mode oplogApplicationMode) {
@@ -420,6 +534,20 @@ Status SyncTail::syncApply(OperationContext* opCtx,
         });
 }
 
+Status SyncTail::syncApply(OperationContext* opCtx,
+                           const OplogEntry& entry,
+                           OplogApplication::Mode oplogApplicationMode) {
+    return syncApplyDecoded(opCtx,
+                            entry.raw,
+                            entry.getNamespace(),
+                            OpType_serializer(entry.getOpType()).rawData(),
+                            entry.getUuid(),
+                            oplogApplicationMode,
+                            applyOperation_inlock,
+                            applyCommand_inlock,
+                            [] { opsAppliedStats.increment(1); });
+}
+
 
 namespace {
 
@@ -457,21 +585,62 @@ void prefetchOps(const MultiApplier::Operations& ops, OldThreadPool* prefetcherP
     prefetcherPool->join();
 }
 
-// Doles out all the work to the writer pool threads.
+// Returns the number of writer vectors a batch applied by 'writerPool' is partitioned into.
+size_t getNumWriterVectors(OldThreadPool* writerPool) {
+    return writerPool->getNumThreads() * replWriterVectorsPerThread;
+}
+
+// Doles out all the work to the writer pool threads. Each thread repeatedly takes the longest
+// writer vector nobody has taken yet, so a thread that is given a long vector doesn't also have
+// its share of the short ones queued up behind it.
 // Does not modify writerVectors, but passes non-const pointers to inner vectors into func.
+// 'statusVector' holds one entry per writer thread.
 void applyOps(std::vector<MultiApplier::OperationPtrs>& writerVectors,
               OldThreadPool* writerPool,
               const MultiApplier::ApplyOperationFn& func,
               std::vector<Status>* statusVector) {
-    invariant(writerVectors.size() == statusVector->size());
+    struct SharedState {
+        std::vector<size_t> order;
+        AtomicUInt64 next;
+    };
+
     TimerHolder timer(&applyBatchStats);
+
+    // The scheduled tasks outlive this function, so the state they share is reference counted.
+    auto state = std::make_shared<SharedState>();
     for (size_t i = 0; i < writerVectors.size(); i++) {
         if (!writerVectors[i].empty()) {
-            writerPool->schedule([&func, &writerVectors, statusVector, i] {
-                (*statusVector)[i] = func(&writerVectors[i]);
-            });
+            state->order.push_back(i);
         }
     }
+    std::stable_sort(state->order.begin(), state->order.end(), [&](size_t l, size_t r) {
+        return writerVectors[l].size() > writerVectors[r].size();
+    });
+
+    const size_t numTasks = std::min(statusVector->size(), state->order.size());
+    for (size_t slot = 0; slot < numTasks; slot++) {
+        writerPool->schedule([&func, &writerVectors, statusVector, state, slot] {
+            Timer busyTimer;
+            long long ops = 0;
+            long long vectors = 0;
+            while (true) {
+                const auto next = state->next.fetchAndAdd(1);
+                if (next >= state->order.size()) {
+                    break;
+                }
+
+                auto& writerVector = writerVectors[state->order[next]];
+                ops += writerVector.size();
+                ++vectors;
+                auto status = func(&writerVector);
+                if (!status.isOK()) {
+                    (*statusVector)[slot] = status;
+                    break;
+                }
+            }
+            writerUtilization.record(slot, ops, vectors, busyTimer.micros());
+        });
+    }
 }
 
 void initializeWriterThread() {
@@ -542,9 +711,6 @@ void scheduleWritesToOplog(OperationContext* opCtx,
     }
 }
 
-using SessionRecordMap =
-    stdx::unordered_map<LogicalSessionId, SessionTxnRecord, LogicalSessionIdHash>;
-
 void scheduleTxnTableUpdates(OperationContext* opCtx,
                              OldThreadPool* threadPool,
                              const SessionRecordMap& latestRecords) {
@@ -624,7 +790,9 @@ private:
 /**
  * ops - This only modifies the isForCappedCollection field on each op. It does not alter the ops
  *      vector in any other way.
- * writerVectors - Set of operations for each worker thread to apply.
+ * writerVectors - Sets of operations that may be applied concurrently with each other. Operations
+ *      on the same document, or on the same collection when it is capped or the storage engine
+ *      lacks document-level locking, always share a set and keep their oplog order within it.
  * latestSessionRecords - Populated map of the "latest" transaction table records for each logical
  *      session id present in the given operations. Each record represents the final state of the
  *      transaction table entry for that session id after the operations are applied.
@@ -696,6 +864,76 @@ void fillWriterVectorsAndLatestSessionRecords(
     }
 }
 
+/**
+ * Writes 'ops' to the oplog using the threads of 'oplogWriterPool' while partitioning them into
+ * 'prepared', whose writer vectors must already be sized to the number of applier threads.
+ *
+ * The caller must move 'minValid' forward to the end of the batch before it starts applying it.
+ */
+void writeBatchToOplogAndPartition(OperationContext* opCtx,
+                                   OldThreadPool* oplogWriterPool,
+                                   MultiApplier::Operations* ops,
+                                   SyncTail::PreparedBatch* prepared) {
+    auto consistencyMarkers = ReplicationProcess::get(opCtx)->getConsistencyMarkers();
+
+    // We must wait for the all work we've dispatched to complete before leaving this function
+    // because the spawned threads refer to 'ops'.
+    ON_BLOCK_EXIT([&] { oplogWriterPool->join(); });
+
+    // Write batch of ops into oplog.
+    consistencyMarkers->setOplogTruncateAfterPoint(opCtx, ops->front().getTimestamp());
+    scheduleWritesToOplog(opCtx, oplogWriterPool, *ops);
+
+    fillWriterVectorsAndLatestSessionRecords(
+        opCtx, ops, &prepared->writerVectors, &prepared->latestSessionRecords);
+
+    // Wait for writes to finish before applying ops.
+    oplogWriterPool->join();
+
+    // The whole batch is in the oplog, so it no longer needs to be truncated after a crash.
+    consistencyMarkers->setOplogTruncateAfterPoint(opCtx, Timestamp());
+}
+
+/**
+ * Applies a batch prepared by writeBatchToOplogAndPartition() using the threads of 'workerPool'
+ * and updates the transaction table to match. Returns the first error reported by an applier
+ * thread, if any.
+ */
+Status applyPreparedBatch(OperationContext* opCtx,
+                          OldThreadPool* workerPool,
+                          SyncTail::PreparedBatch* prepared,
+                          const MultiApplier::ApplyOperationFn& applyOperation) {
+    std::vector<Status> statusVector(workerPool->getNumThreads(), Status::OK());
+    {
+        // We must wait for the all work we've dispatched to complete before leaving this block
+        // because the spawned threads refer to objects on the stack
+        ON_BLOCK_EXIT([&] { workerPool->join(); });
+
+        applyOps(prepared->writerVectors, workerPool, applyOperation, &statusVector);
+        workerPool->join();
+
+        // Update the transaction table to point to the latest oplog entries for each session id.
+        scheduleTxnTableUpdates(opCtx, workerPool, prepared->latestSessionRecords);
+        workerPool->join();
+
+        // Notify the storage engine that a replication batch has completed.
+        // This means that all the writes associated with the oplog entries in the batch are
+        // finished and no new writes with timestamps associated with those oplog entries will show
+        // up in the future.
+        const auto storageEngine = opCtx->getServiceContext()->getGlobalStorageEngine();
+        storageEngine->replicationBatchIsComplete();
+    }
+
+    // If any of the statuses is not ok, return error.
+    for (auto& status : statusVector) {
+        if (!status.isOK()) {
+            return status;
+        }
+    }
+
+    return Status::OK();
+}
+
 }  // namespace
 
 /**
@@ -717,6 +955,17 @@ OpTime SyncTail::multiApply(OperationContext* opCtx, MultiApplier::Operations op
         34437, repl::multiApply(opCtx, _writerPool.get(), std::move(ops), applyOperation));
 }
 
+OpTime SyncTail::_multiApplyPrepared(OperationContext* opCtx,
+                                     MultiApplier::Operations ops,
+                                     PreparedBatch* prepared) {
+    auto applyOperation = [this](MultiApplier::OperationPtrs* ops) -> Status {
+        _applyFunc(ops, this);
+        return Status::OK();
+    };
+    return fassertStatusOK(
+        50665, multiApplyPrepared(opCtx, _writerPool.get(), ops, prepared, applyOperation));
+}
+
 namespace {
 void tryToGoLiveAsASecondary(OperationContext* opCtx,
                              ReplicationCoordinator* replCoord,
@@ -770,13 +1019,22 @@ class SyncTail::OpQueueBatcher {
     MONGO_DISALLOW_COPYING(OpQueueBatcher);
 
 public:
-    OpQueueBatcher(SyncTail* syncTail) : _syncTail(syncTail), _thread([this] { run(); }) {}
+    OpQueueBatcher(SyncTail* syncTail)
+        : _syncTail(syncTail),
+          _oplogWriterPool(_makeOplogWriterPool()),
+          _thread([this] { run(); }) {}
     ~OpQueueBatcher() {
         invariant(_isDead);
         _thread.join();
     }
 
-    OpQueue getNextBatch(Seconds maxWaitTime) {
+    /**
+     * Returns the next batch. If the batcher has already written it to the oplog, 'prepared' is
+     * set to the result of doing so and the batch must be applied with _multiApplyPrepared().
+     * Every non-empty batch returned must be followed by a call to batchApplied() once it has been
+     * applied.
+     */
+    OpQueue getNextBatch(Seconds maxWaitTime, std::unique_ptr<PreparedBatch>* prepared) {
         stdx::unique_lock<stdx::mutex> lk(_mutex);
         if (_ops.empty() && !_ops.mustShutdown()) {
             // We intentionally don't care about whether this returns due to signaling or timeout
@@ -784,14 +1042,74 @@ public:
             (void)_cv.wait_for(lk, maxWaitTime.toSystemDuration());
         }
 
+        // A batch which is being written to the oplog has already been consumed from the buffer,
+        // so wait for it instead of reporting that there is nothing left to apply.
+        _cv.wait(lk, [&] { return !_ops.empty() || !_preparing; });
+
         OpQueue ops = std::move(_ops);
         _ops = {};
+        *prepared = std::move(_prepared);
         _cv.notify_all();
 
         return ops;
     }
 
+    /**
+     * Signals that the last batch returned by getNextBatch() has been fully applied.
+     */
+    void batchApplied() {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        _commandBatchInProgress = false;
+        _cv.notify_all();
+    }
+
 private:
+    /**
+     * Returns the pool used to write batches to the oplog ahead of their application, or nullptr
+     * if batches should be written to the oplog by multiApply() instead.
+     */
+    static std::unique_ptr<OldThreadPool> _makeOplogWriterPool() {
+        if (!replPipelinedBatchApplication ||
+            !getGlobalServiceContext()->getGlobalStorageEngine()->supportsDocLocking()) {
+            return nullptr;
+        }
+
+        // The oplog writes for a batch overlap with the application of the previous one, so they
+        // are off the critical path and need fewer threads than the appliers.
+        return stdx::make_unique<OldThreadPool>(std::max(1, replWriterThreadCount / 2),
+                                                "repl oplog writer worker ");
+    }
+
+    /**
+     * Commands, and index builds which are replicated as inserts, are always applied in batches
+     * of their own.
+     */
+    static bool _isCommandBatch(const OpQueue& ops) {
+        if (ops.getCount() != 1) {
+            return false;
+        }
+
+        const auto& entry = ops.front();
+        return entry.isCommand() ||
+            (!entry.getNamespace().isEmpty() && entry.getNamespace().coll() == "system.indexes");
+    }
+
+    /**
+     * Writes 'ops' to the oplog and partitions it among the writer threads.
+     */
+    std::unique_ptr<PreparedBatch> _prepare(OpQueue* ops) {
+        const auto opCtx = cc().makeOperationContext();
+        // The previous batch is applied while holding the PBWM lock in exclusive mode.
+        opCtx->lockState()->setShouldConflictWithSecondaryBatchApplication(false);
+
+        // The writer vectors point into the batch owned by 'ops', whose elements stay in place when
+        // the batch is later moved to the applier.
+        return prepareBatchForApplication(opCtx.get(),
+                                          _oplogWriterPool.get(),
+                                          _syncTail->getWriterPool(),
+                                          ops->getMutableBatch());
+    }
+
     /**
      * Calculates batch limit size (in bytes) using the maximum capped collection size of the oplog
      * size.
@@ -845,10 +1163,25 @@ private:
                 continue;  // Don't emit empty batches.
             }
 
+            std::unique_ptr<PreparedBatch> prepared;
+            if (_oplogWriterPool && !ops.empty()) {
+                {
+                    stdx::unique_lock<stdx::mutex> lk(_mutex);
+                    // Writer vectors depend on collection properties such as cappedness, which a
+                    // command may change, so a command batch must be fully applied first.
+                    _cv.wait(lk, [&] { return !_commandBatchInProgress; });
+                    _preparing = true;
+                }
+                prepared = _prepare(&ops);
+            }
+
             stdx::unique_lock<stdx::mutex> lk(_mutex);
             // Block until the previous batch has been taken.
             _cv.wait(lk, [&] { return _ops.empty(); });
+            _commandBatchInProgress = _isCommandBatch(ops);
             _ops = std::move(ops);
+            _prepared = std::move(prepared);
+            _preparing = false;
             _cv.notify_all();
             if (_ops.mustShutdown()) {
                 _isDead = true;
@@ -859,9 +1192,19 @@ private:
 
     SyncTail* const _syncTail;
 
-    stdx::mutex _mutex;  // Guards _ops.
+    // Only set if batches are written to the oplog by this batcher ahead of their application.
+    const std::unique_ptr<OldThreadPool> _oplogWriterPool;
+
+    stdx::mutex _mutex;  // Guards _ops, _prepared, _preparing and _commandBatchInProgress.
     stdx::condition_variable _cv;
     OpQueue _ops;
+    std::unique_ptr<PreparedBatch> _prepared;
+
+    // True while a batch which has been consumed from the buffer is being written to the oplog.
+    bool _preparing = false;
+
+    // True from when a command batch is handed to the applier until it has been applied.
+    bool _commandBatchInProgress = false;
 
     // This only exists so the destructor invariants rather than deadlocking.
     // TODO remove once we trust noexcept enough to mark oplogApplication() as noexcept.
@@ -913,7 +1256,8 @@ void SyncTail::oplogApplication(ReplicationCoordinator* replCoord) {
         long long termWhenBufferIsEmpty = replCoord->getTerm();
         // Blocks up to a second waiting for a batch to be ready to apply. If one doesn't become
         // ready in time, we'll loop again so we can do the above checks periodically.
-        OpQueue ops = batcher.getNextBatch(Seconds(1));
+        std::unique_ptr<PreparedBatch> prepared;
+        OpQueue ops = batcher.getNextBatch(Seconds(1), &prepared);
         if (ops.empty()) {
             if (ops.mustShutdown()) {
                 // Shut down and exit oplog application loop.
@@ -946,9 +1290,13 @@ void SyncTail::oplogApplication(ReplicationCoordinator* replCoord) {
         stdx::lock_guard<SimpleMutex> fsynclk(filesLockedFsync);
 
         // Apply the operations in this batch. 'multiApply' returns the optime of the last op that
-        // was applied, which should be the last optime in the batch.
-        auto lastOpTimeAppliedInBatch = multiApply(&opCtx, ops.releaseBatch());
+        // was applied, which should be the last optime in the batch. If the batcher has already
+        // written the batch to the oplog, only its application remains.
+        auto lastOpTimeAppliedInBatch = prepared
+            ? _multiApplyPrepared(&opCtx, ops.releaseBatch(), prepared.get())
+            : multiApply(&opCtx, ops.releaseBatch());
         invariant(lastOpTimeAppliedInBatch == lastOpTimeInBatch);
+        batcher.batchApplied();
 
         // In order to provide resilience in the event of a crash in the middle of batch
         // application, 'multiApply' will update 'minValid' so that it is at least as great as the
@@ -1217,6 +1565,53 @@ bool SyncTail::fetchAndInsertMissingDocument(OperationContext* opCtx,
     });
 }
 
+namespace {
+
+// When enabled, runs of consecutive updates and deletes on one collection within a writer vector
+// are applied in a single storage transaction rather than one transaction per op.
+MONGO_EXPORT_SERVER_PARAMETER(replGroupUpdatesAndDeletes, bool, true);
+
+// The most ops, and bytes of ops, applied in one storage transaction by applyGroupInOneUnitOfWork.
+const int kMaxGroupedWritesCount = 64;
+const int kMaxGroupedWritesBytes = insertVectorMaxBytes;
+
+bool isGroupableWrite(const OplogEntry* entry) {
+    return entry->getOpType() == OpTypeEnum::kUpdate || entry->getOpType() == OpTypeEnum::kDelete;
+}
+
+/**
+ * Applies the updates and deletes in [begin, end), which all share a namespace and collection
+ * UUID, using 'syncApply' under a single WriteUnitOfWork. Each op's writes are still timestamped
+ * with that op's optime. Nothing is applied if any of the ops fails.
+ */
+Status applyGroupInOneUnitOfWork(OperationContext* opCtx,
+                                 MultiApplier::OperationPtrs::const_iterator begin,
+                                 MultiApplier::OperationPtrs::const_iterator end,
+                                 const SyncApplyFn& syncApply,
+                                 OplogApplication::Mode oplogApplicationMode) {
+    const auto& nss = (*begin)->getNamespace();
+    return writeConflictRetry(opCtx, "applyGroupInOneUnitOfWork", nss.ns(), [&] {
+        // Take the locks syncApply would take up front, so that they are held for the whole unit
+        // of work and the storage transaction is only opened once they are.
+        Lock::DBLock dbLock(opCtx, nss.db(), MODE_IX);
+        Lock::CollectionLock collLock(opCtx->lockState(), nss.ns(), MODE_IX);
+
+        WriteUnitOfWork wuow(opCtx);
+        for (auto it = begin; it != end; ++it) {
+            // Ops applied under a wrapping unit of work don't set their own timestamp.
+            uassertStatusOK(opCtx->recoveryUnit()->setTimestamp((*it)->getTimestamp()));
+            auto status = syncApply(opCtx, (*it)->raw, oplogApplicationMode);
+            if (!status.isOK()) {
+                return status;
+            }
+        }
+        wuow.commit();
+        return Status::OK();
+    });
+}
+
+}  // namespace
+
 // This free function is used by the writer threads to apply each op
 void multiSyncApply(MultiApplier::OperationPtrs* ops, SyncTail*) {
     initializeWriterThread();
@@ -1257,6 +1652,9 @@ Status multiSyncApply_noAbort(OperationContext* opCtx,
     // of a failed group and not allowing further group inserts until that op has been processed.
     auto doNotGroupBeforePoint = oplogEntryPointers->begin();
 
+    // Whether consecutive updates and deletes may be grouped, checked once per writer vector.
+    const bool groupUpdatesAndDeletes = replGroupUpdatesAndDeletes.load();
+
     for (auto oplogEntriesIterator = oplogEntryPointers->begin();
          oplogEntriesIterator != oplogEntryPointers->end();
          ++oplogEntriesIterator) {
@@ -1387,6 +1785,41 @@ Status multiSyncApply_noAbort(OperationContext* opCtx,
             }
         }
 
+        // Attempt to group consecutive updates and deletes on the same collection.
+        if (groupUpdatesAndDeletes && isGroupableWrite(entry) &&
+            oplogEntriesIterator > doNotGroupBeforePoint) {
+            int groupSize = entry->raw.objsize();
+            int groupCount = 1;
+            auto endOfGroupableOpsIterator = std::find_if(
+                oplogEntriesIterator + 1,
+                oplogEntryPointers->end(),
+                [&](const OplogEntry* nextEntry) -> bool {
+                    groupSize += nextEntry->raw.objsize();
+                    groupCount += 1;
+                    return !isGroupableWrite(nextEntry) ||
+                        nextEntry->getNamespace() != entry->getNamespace() ||
+                        nextEntry->getUuid() != entry->getUuid() ||
+                        groupSize > kMaxGroupedWritesBytes || groupCount > kMaxGroupedWritesCount;
+                });
+
+            if (endOfGroupableOpsIterator > oplogEntriesIterator + 1) {
+                try {
+                    uassertStatusOK(applyGroupInOneUnitOfWork(opCtx,
+                                                              oplogEntriesIterator,
+                                                              endOfGroupableOpsIterator,
+                                                              syncApply,
+                                                              oplogApplicationMode));
+                    oplogEntriesIterator = endOfGroupableOpsIterator - 1;
+                    continue;
+                } catch (const DBException& e) {
+                    // Nothing in the group was applied, so apply its ops one at a time.
+                    error() << "Error applying grouped updates and deletes " << causedBy(redact(e))
+                            << " trying first op individually";
+                    doNotGroupBeforePoint = endOfGroupableOpsIterator - 1;
+                }
+            }
+        }
+
         // If we didn't create a group, try to apply the op individually.
         try {
             const Status status = syncApply(opCtx, entry->raw, oplogApplicationMode);
@@ -1436,7 +1869,7 @@ Status multiInitialSyncApply_noAbort(OperationContext* opCtx,
         auto& entry = **it;
         try {
             const Status s =
-                SyncTail::syncApply(opCtx, entry.raw, OplogApplication::Mode::kInitialSync);
+                SyncTail::syncApply(opCtx, entry, OplogApplication::Mode::kInitialSync);
             if (!s.isOK()) {
                 // In initial sync, update operations can cause documents to be missed during
                 // collection cloning. As a result, it is possible that a document that we need to
@@ -1494,8 +1927,6 @@ StatusWith<OpTime> multiApply(OperationContext* opCtx,
         prefetchOps(ops, workerPool);
     }
 
-    auto consistencyMarkers = ReplicationProcess::get(opCtx)->getConsistencyMarkers();
-
     LOG(2) << "replication batch size is " << ops.size();
     // Stop all readers until we're done. This also prevents doc-locking engines from deleting old
     // entries from the oplog until we finish writing.
@@ -1508,51 +1939,66 @@ StatusWith<OpTime> multiApply(OperationContext* opCtx,
                 "attempting to replicate ops while primary"};
     }
 
-    std::vector<Status> statusVector(workerPool->getNumThreads(), Status::OK());
-    {
-        // We must wait for the all work we've dispatched to complete before leaving this block
-        // because the spawned threads refer to objects on the stack
-        ON_BLOCK_EXIT([&] { workerPool->join(); });
+    SyncTail::PreparedBatch prepared;
+    prepared.writerVectors.resize(getNumWriterVectors(workerPool));
+    writeBatchToOplogAndPartition(opCtx, workerPool, &ops, &prepared);
 
-        // Write batch of ops into oplog.
-        consistencyMarkers->setOplogTruncateAfterPoint(opCtx, ops.front().getTimestamp());
-        scheduleWritesToOplog(opCtx, workerPool, ops);
+    // Reset consistency markers in case the node fails while applying ops.
+    ReplicationProcess::get(opCtx)->getConsistencyMarkers()->setMinValidToAtLeast(
+        opCtx, ops.back().getOpTime());
 
-        std::vector<MultiApplier::OperationPtrs> writerVectors(workerPool->getNumThreads());
-        SessionRecordMap latestSessionRecords;
-        fillWriterVectorsAndLatestSessionRecords(
-            opCtx, &ops, &writerVectors, &latestSessionRecords);
+    auto status = applyPreparedBatch(opCtx, workerPool, &prepared, applyOperation);
+    if (!status.isOK()) {
+        return status;
+    }
 
-        // Wait for writes to finish before applying ops.
-        workerPool->join();
+    // We have now written all database writes and updated the oplog to match.
+    return ops.back().getOpTime();
+}
 
-        // Reset consistency markers in case the node fails while applying ops.
-        consistencyMarkers->setOplogTruncateAfterPoint(opCtx, Timestamp());
-        consistencyMarkers->setMinValidToAtLeast(opCtx, ops.back().getOpTime());
+std::unique_ptr<SyncTail::PreparedBatch> prepareBatchForApplication(
+    OperationContext* opCtx,
+    OldThreadPool* oplogWriterPool,
+    OldThreadPool* workerPool,
+    MultiApplier::Operations* ops) {
+    invariant(!ops->empty());
+
+    auto prepared = stdx::make_unique<SyncTail::PreparedBatch>();
+    prepared->writerVectors.resize(getNumWriterVectors(workerPool));
+    writeBatchToOplogAndPartition(opCtx, oplogWriterPool, ops, prepared.get());
+    return prepared;
+}
 
-        applyOps(writerVectors, workerPool, applyOperation, &statusVector);
-        workerPool->join();
+StatusWith<OpTime> multiApplyPrepared(OperationContext* opCtx,
+                                      OldThreadPool* workerPool,
+                                      const MultiApplier::Operations& ops,
+                                      SyncTail::PreparedBatch* prepared,
+                                      MultiApplier::ApplyOperationFn applyOperation) {
+    invariant(!ops.empty());
 
-        // Update the transaction table to point to the latest oplog entries for each session id.
-        scheduleTxnTableUpdates(opCtx, workerPool, latestSessionRecords);
-        workerPool->join();
+    LOG(2) << "replication batch size is " << ops.size();
+    // Stop all readers until we're done. The batch is already in the oplog, but readers must not
+    // observe the collections while it is only partially applied.
+    Lock::ParallelBatchWriterMode pbwm(opCtx->lockState());
 
-        // Notify the storage engine that a replication batch has completed.
-        // This means that all the writes associated with the oplog entries in the batch are
-        // finished and no new writes with timestamps associated with those oplog entries will show
-        // up in the future.
-        const auto storageEngine = opCtx->getServiceContext()->getGlobalStorageEngine();
-        storageEngine->replicationBatchIsComplete();
+    auto replCoord = ReplicationCoordinator::get(opCtx);
+    if (replCoord->getApplierState() == ReplicationCoordinator::ApplierState::Stopped) {
+        severe() << "attempting to replicate ops while primary";
+        return {ErrorCodes::CannotApplyOplogWhilePrimary,
+                "attempting to replicate ops while primary"};
     }
 
-    // If any of the statuses is not ok, return error.
-    for (auto& status : statusVector) {
-        if (!status.isOK()) {
-            return status;
-        }
+    // The batch was written to the oplog without moving 'minValid', since the previous batch was
+    // still being applied and the node must only consider itself consistent after applying that
+    // one. Do it now in case the node fails while applying this batch.
+    ReplicationProcess::get(opCtx)->getConsistencyMarkers()->setMinValidToAtLeast(
+        opCtx, ops.back().getOpTime());
+
+    auto status = applyPreparedBatch(opCtx, workerPool, prepared, applyOperation);
+    if (!status.isOK()) {
+        return status;
     }
 
-    // We have now written all database writes and updated the oplog to match.
     return ops.back().getOpTime();
 }
 
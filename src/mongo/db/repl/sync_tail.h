@@ -33,10 +33,13 @@
 
 #include "mongo/base/status.h"
 #include "mongo/bson/bsonobj.h"
+#include "mongo/db/logical_session_id.h"
 #include "mongo/db/repl/multiapplier.h"
 #include "mongo/db/repl/oplog.h"
 #include "mongo/db/repl/oplog_entry.h"
+#include "mongo/db/session_txn_record_gen.h"
 #include "mongo/stdx/functional.h"
+#include "mongo/stdx/unordered_map.h"
 #include "mongo/util/concurrency/old_thread_pool.h"
 
 namespace mongo {
@@ -113,6 +116,14 @@ public:
                             const BSONObj& o,
                             OplogApplication::Mode oplogApplicationMode);
 
+    /**
+     * Applies an already parsed oplog entry, reusing its decoded namespace, op type and UUID
+     * instead of extracting them from the raw document again.
+     */
+    static Status syncApply(OperationContext* opCtx,
+                            const OplogEntry& entry,
+                            OplogApplication::Mode oplogApplicationMode);
+
     void oplogApplication(ReplicationCoordinator* replCoord);
     bool peek(OperationContext* opCtx, BSONObj* obj);
 
@@ -143,6 +154,14 @@ public:
             return _batch;
         }
 
+        /**
+         * Allows the entries to be modified in place while the batch is prepared for application.
+         * Entries must not be added or removed through the returned pointer.
+         */
+        std::vector<OplogEntry>* getMutableBatch() {
+            return &_batch;
+        }
+
         void emplace_back(BSONObj obj) {
             invariant(!_mustShutdown);
             _bytes += obj.objsize();
@@ -224,6 +243,16 @@ public:
 
     static AtomicInt32 replBatchLimitOperations;
 
+    using SessionRecordMap =
+        stdx::unordered_map<LogicalSessionId, SessionTxnRecord, LogicalSessionIdHash>;
+
+    // A batch which has already been written to the oplog and partitioned among the writer
+    // threads, so that only its application remains.
+    struct PreparedBatch {
+        std::vector<MultiApplier::OperationPtrs> writerVectors;
+        SessionRecordMap latestSessionRecords;
+    };
+
 protected:
     static const unsigned int replBatchLimitBytes = 100 * 1024 * 1024;
     static const int replBatchLimitSeconds = 1;
@@ -235,6 +264,14 @@ protected:
 private:
     class OpQueueBatcher;
 
+    /**
+     * Same as multiApply(), but for a batch which the OpQueueBatcher has already written to the
+     * oplog and partitioned while the previous batch was being applied.
+     */
+    OpTime _multiApplyPrepared(OperationContext* opCtx,
+                               MultiApplier::Operations ops,
+                               PreparedBatch* prepared);
+
     std::string _hostname;
 
     BackgroundSync* _networkQueue;
@@ -260,6 +297,30 @@ StatusWith<OpTime> multiApply(OperationContext* opCtx,
                               MultiApplier::Operations ops,
                               MultiApplier::ApplyOperationFn applyOperation);
 
+/**
+ * The two halves of multiApply(), which run on different threads when batch application is
+ * pipelined so that the oplog writes for a batch overlap with the application of the previous one.
+ *
+ * prepareBatchForApplication() writes 'ops' to the oplog using the threads of 'oplogWriterPool' and
+ * partitions them among the threads of 'workerPool'. It neither takes the PBWM lock nor moves
+ * 'minValid', so 'opCtx' must be set not to conflict with secondary batch application. The
+ * returned batch points into 'ops', whose elements must stay in place until it is applied.
+ *
+ * multiApplyPrepared() takes the PBWM lock, moves 'minValid' to the end of 'ops' and only then
+ * applies 'prepared', which must have been returned by prepareBatchForApplication() for 'ops'. It
+ * returns the same results as multiApply().
+ */
+std::unique_ptr<SyncTail::PreparedBatch> prepareBatchForApplication(
+    OperationContext* opCtx,
+    OldThreadPool* oplogWriterPool,
+    OldThreadPool* workerPool,
+    MultiApplier::Operations* ops);
+StatusWith<OpTime> multiApplyPrepared(OperationContext* opCtx,
+                                      OldThreadPool* workerPool,
+                                      const MultiApplier::Operations& ops,
+                                      SyncTail::PreparedBatch* prepared,
+                                      MultiApplier::ApplyOperationFn applyOperation);
+
 // These free functions are used by the thread pool workers to write ops to the db.
 // They consume the passed in OperationPtrs and callers should not make any assumptions about the
 // state of the container after calling. However, these functions cannot modify the pointed-to
@@ -29,6 +29,7 @@
 #include "mongo/platform/basic.h"
 
 #include <algorithm>
+#include <map>
 #include <memory>
 #include <utility>
 #include <vector>
@@ -65,9 +66,11 @@
 #include "mongo/db/service_context_d_test_fixture.h"
 #include "mongo/db/session_catalog.h"
 #include "mongo/stdx/mutex.h"
+#include "mongo/stdx/thread.h"
 #include "mongo/unittest/death_test.h"
 #include "mongo/unittest/unittest.h"
 #include "mongo/util/concurrency/old_thread_pool.h"
+#include "mongo/util/mongoutils/str.h"
 #include "mongo/util/md5.hpp"
 #include "mongo/util/scopeguard.h"
 #include "mongo/util/string_map.h"
@@ -575,6 +578,66 @@ TEST_F(SyncTailTest, MultiApplyAssignsOperationsToWriterThreadsBasedOnNamespaceH
     ASSERT_EQUALS(op2, unittest::assertGet(OplogEntry::parse(operationsWrittenToOplog[1].doc)));
 }
 
+TEST_F(SyncTailTest, MultiApplyKeepsOperationsOnTheSameNamespaceInOrderInOneWriterVector) {
+    OldThreadPool writerPool(2);
+
+    stdx::mutex mutex;
+    std::vector<MultiApplier::Operations> operationsApplied;
+    auto applyOperationFn = [&mutex, &operationsApplied](
+        MultiApplier::OperationPtrs* operationsForWriterThreadToApply) -> Status {
+        stdx::lock_guard<stdx::mutex> lock(mutex);
+        operationsApplied.emplace_back();
+        for (auto&& opPtr : *operationsForWriterThreadToApply) {
+            operationsApplied.back().push_back(*opPtr);
+        }
+        return Status::OK();
+    };
+
+    // Most of the batch goes to a single collection.
+    MultiApplier::Operations ops;
+    for (int i = 0; i < 50; i++) {
+        NamespaceString nss(str::stream() << "test.t" << (i % 5 == 0 ? i : 0));
+        ops.push_back(makeInsertDocumentOplogEntry(
+            {Timestamp(Seconds(i + 1), 0), 1LL}, nss, BSON("_id" << i)));
+    }
+    const auto lastOp = ops.back();
+
+    _storageInterface->insertDocumentsFn =
+        [](OperationContext*, const NamespaceString&, const std::vector<InsertStatement>&) {
+            return Status::OK();
+        };
+
+    auto lastOpTime =
+        unittest::assertGet(multiApply(_opCtx.get(), &writerPool, std::move(ops), applyOperationFn));
+    ASSERT_EQUALS(lastOp.getOpTime(), lastOpTime);
+
+    // Every operation is applied exactly once, and all operations on a namespace are applied by
+    // the same call in oplog order.
+    stdx::lock_guard<stdx::mutex> lock(mutex);
+    std::map<std::string, size_t> callForNamespace;
+    size_t numApplied = 0;
+    for (size_t call = 0; call < operationsApplied.size(); call++) {
+        OpTime lastOpTimeForNamespace;
+        std::string lastNamespace;
+        for (auto&& oplogEntry : operationsApplied[call]) {
+            const auto ns = oplogEntry.getNamespace().ns();
+            auto it = callForNamespace.find(ns);
+            if (it == callForNamespace.end()) {
+                callForNamespace.emplace(ns, call);
+            } else {
+                ASSERT_EQUALS(call, it->second);
+            }
+            if (ns == lastNamespace) {
+                ASSERT_LESS_THAN(lastOpTimeForNamespace, oplogEntry.getOpTime());
+            }
+            lastNamespace = ns;
+            lastOpTimeForNamespace = oplogEntry.getOpTime();
+            numApplied++;
+        }
+    }
+    ASSERT_EQUALS(50U, numApplied);
+}
+
 TEST_F(SyncTailTest, MultiApplyUpdatesTheTransactionTable) {
     // Set up the transactions collection, which can only be done by the primary.
     ASSERT_OK(ReplicationCoordinator::get(_opCtx.get())->setFollowerMode(MemberState::RS_PRIMARY));
@@ -688,6 +751,152 @@ TEST_F(SyncTailTest, MultiApplyUpdatesTheTransactionTable) {
     ASSERT_TRUE(resultNoTxn.isEmpty());
 }
 
+TEST_F(SyncTailTest, MultiApplyPreparedAppliesBatchOnlyAfterItIsInTheOplogAndMinValidCoversIt) {
+    NamespaceString nss("test.t");
+    auto consistencyMarkers = _replicationProcess->getConsistencyMarkers();
+    auto writerPool = SyncTail::makeWriterPool();
+    OldThreadPool oplogWriterPool(1);
+
+    stdx::mutex mutex;
+    std::vector<OpTime> opTimesWrittenToOplog;
+    _storageInterface->insertDocumentsFn = [&](OperationContext* opCtx,
+                                               const NamespaceString& nss,
+                                               const std::vector<InsertStatement>& docs) {
+        stdx::lock_guard<stdx::mutex> lock(mutex);
+        ASSERT_EQUALS(NamespaceString::kRsOplogNamespace, nss);
+        for (auto&& doc : docs) {
+            opTimesWrittenToOplog.push_back(
+                unittest::assertGet(OplogEntry::parse(doc.doc)).getOpTime());
+        }
+        return Status::OK();
+    };
+
+    // Every operation must already be in the oplog and covered by 'minValid' before it is
+    // applied, so that a failure while applying it can be recovered from.
+    size_t numOpsApplied = 0;
+    size_t numOpsAppliedOutOfOrder = 0;
+    auto applyOperationFn = [&](MultiApplier::OperationPtrs* opsToApply) -> Status {
+        stdx::lock_guard<stdx::mutex> lock(mutex);
+        for (auto&& op : *opsToApply) {
+            const bool inOplog = std::find(opTimesWrittenToOplog.begin(),
+                                           opTimesWrittenToOplog.end(),
+                                           op->getOpTime()) != opTimesWrittenToOplog.end();
+            if (!inOplog || consistencyMarkers->getMinValid(_opCtx.get()) < op->getOpTime()) {
+                ++numOpsAppliedOutOfOrder;
+            }
+            ++numOpsApplied;
+        }
+        return Status::OK();
+    };
+
+    MultiApplier::Operations ops = {
+        makeInsertDocumentOplogEntry(nextOpTime(), nss, BSON("_id" << 1)),
+        makeInsertDocumentOplogEntry(nextOpTime(), nss, BSON("_id" << 2))};
+
+    _opCtx->lockState()->setShouldConflictWithSecondaryBatchApplication(false);
+    auto prepared =
+        prepareBatchForApplication(_opCtx.get(), &oplogWriterPool, writerPool.get(), &ops);
+    _opCtx->lockState()->setShouldConflictWithSecondaryBatchApplication(true);
+
+    // Preparing the batch writes it to the oplog but must not move 'minValid', since the previous
+    // batch may still be being applied.
+    ASSERT_EQUALS(2U, opTimesWrittenToOplog.size());
+    ASSERT_EQUALS(OpTime(), consistencyMarkers->getMinValid(_opCtx.get()));
+    ASSERT_EQUALS(Timestamp(), consistencyMarkers->getOplogTruncateAfterPoint(_opCtx.get()));
+    ASSERT_EQUALS(0U, numOpsApplied);
+
+    ASSERT_EQUALS(ops.back().getOpTime(),
+                  unittest::assertGet(multiApplyPrepared(
+                      _opCtx.get(), writerPool.get(), ops, prepared.get(), applyOperationFn)));
+    ASSERT_EQUALS(2U, numOpsApplied);
+    ASSERT_EQUALS(0U, numOpsAppliedOutOfOrder);
+    ASSERT_EQUALS(ops.back().getOpTime(), consistencyMarkers->getMinValid(_opCtx.get()));
+}
+
+TEST_F(SyncTailTest, PipelinedBatchIsRecoverableIfNodeFailsWhilePreviousBatchIsBeingApplied) {
+    NamespaceString nss("test.t");
+    auto consistencyMarkers = _replicationProcess->getConsistencyMarkers();
+    auto writerPool = SyncTail::makeWriterPool();
+    OldThreadPool oplogWriterPool(1);
+
+    MultiApplier::Operations firstBatch = {
+        makeInsertDocumentOplogEntry(nextOpTime(), nss, BSON("_id" << 1))};
+    MultiApplier::Operations secondBatch = {
+        makeInsertDocumentOplogEntry(nextOpTime(), nss, BSON("_id" << 2)),
+        makeInsertDocumentOplogEntry(nextOpTime(), nss, BSON("_id" << 3))};
+
+    // Records the consistency markers as they would be found on restart if the node failed while
+    // the second batch was only partially written to the oplog.
+    stdx::mutex mutex;
+    boost::optional<Timestamp> truncateAfterPointDuringSecondBatchWrite;
+    boost::optional<OpTime> minValidDuringSecondBatchWrite;
+    _storageInterface->insertDocumentsFn = [&](OperationContext* opCtx,
+                                               const NamespaceString& nss,
+                                               const std::vector<InsertStatement>& docs) {
+        stdx::lock_guard<stdx::mutex> lock(mutex);
+        if (docs.front().oplogSlot.opTime.getTimestamp() >=
+            secondBatch.front().getOpTime().getTimestamp()) {
+            truncateAfterPointDuringSecondBatchWrite =
+                consistencyMarkers->getOplogTruncateAfterPoint(opCtx);
+            minValidDuringSecondBatchWrite = consistencyMarkers->getMinValid(opCtx);
+        }
+        return Status::OK();
+    };
+
+    _opCtx->lockState()->setShouldConflictWithSecondaryBatchApplication(false);
+    auto firstPrepared =
+        prepareBatchForApplication(_opCtx.get(), &oplogWriterPool, writerPool.get(), &firstBatch);
+    _opCtx->lockState()->setShouldConflictWithSecondaryBatchApplication(true);
+
+    // Prepare the second batch while the first one is being applied, as the batcher does, and
+    // record the consistency markers as they would be found on restart if the node failed then.
+    std::unique_ptr<SyncTail::PreparedBatch> secondPrepared;
+    boost::optional<Timestamp> truncateAfterPointAfterSecondBatchWrite;
+    boost::optional<OpTime> minValidAfterSecondBatchWrite;
+    auto applyFirstBatchFn = [&](MultiApplier::OperationPtrs*) -> Status {
+        stdx::thread oplogWriter([&] {
+            Client::initThread("PipelinedOplogWriter");
+            auto opCtx = cc().makeOperationContext();
+            opCtx->lockState()->setShouldConflictWithSecondaryBatchApplication(false);
+            secondPrepared = prepareBatchForApplication(
+                opCtx.get(), &oplogWriterPool, writerPool.get(), &secondBatch);
+        });
+        oplogWriter.join();
+
+        truncateAfterPointAfterSecondBatchWrite =
+            consistencyMarkers->getOplogTruncateAfterPoint(_opCtx.get());
+        minValidAfterSecondBatchWrite = consistencyMarkers->getMinValid(_opCtx.get());
+        return Status::OK();
+    };
+    ASSERT_EQUALS(firstBatch.back().getOpTime(),
+                  unittest::assertGet(multiApplyPrepared(_opCtx.get(),
+                                                         writerPool.get(),
+                                                         firstBatch,
+                                                         firstPrepared.get(),
+                                                         applyFirstBatchFn)));
+
+    // Failing while the second batch was being written must truncate the partially written batch on
+    // recovery and must not consider the node consistent before the end of the first batch.
+    ASSERT(secondPrepared);
+    ASSERT(truncateAfterPointDuringSecondBatchWrite);
+    ASSERT_EQUALS(secondBatch.front().getOpTime().getTimestamp(),
+                  *truncateAfterPointDuringSecondBatchWrite);
+    ASSERT_EQUALS(firstBatch.back().getOpTime(), *minValidDuringSecondBatchWrite);
+
+    // Failing once the second batch is written must leave all of it in the oplog for recovery to
+    // apply, while the node only needs to reach the end of the first batch to be consistent.
+    ASSERT_EQUALS(Timestamp(), *truncateAfterPointAfterSecondBatchWrite);
+    ASSERT_EQUALS(firstBatch.back().getOpTime(), *minValidAfterSecondBatchWrite);
+
+    ASSERT_EQUALS(secondBatch.back().getOpTime(),
+                  unittest::assertGet(multiApplyPrepared(_opCtx.get(),
+                                                         writerPool.get(),
+                                                         secondBatch,
+                                                         secondPrepared.get(),
+                                                         noopApplyOperationFn)));
+    ASSERT_EQUALS(secondBatch.back().getOpTime(), consistencyMarkers->getMinValid(_opCtx.get()));
+}
+
 TEST_F(SyncTailTest, MultiSyncApplyUsesSyncApplyToApplyOperation) {
     NamespaceString nss("local." + _agent.getSuiteName() + "_" + _agent.getTestName());
     auto op = makeCreateCollectionOplogEntry({Timestamp(Seconds(1), 0), 1LL}, nss);
@@ -700,6 +909,14 @@ TEST_F(SyncTailTest, MultiSyncApplyUsesSyncApplyToApplyOperation) {
     ASSERT_TRUE(AutoGetCollectionForReadCommand(_opCtx.get(), nss).getCollection());
 }
 
+TEST_F(SyncTailTest, SyncApplyAppliesParsedOplogEntry) {
+    NamespaceString nss("local." + _agent.getSuiteName() + "_" + _agent.getTestName());
+    auto op = makeCreateCollectionOplogEntry({Timestamp(Seconds(1), 0), 1LL}, nss);
+
+    ASSERT_OK(SyncTail::syncApply(_opCtx.get(), op, OplogApplication::Mode::kSecondary));
+    ASSERT_TRUE(AutoGetCollectionForReadCommand(_opCtx.get(), nss).getCollection());
+}
+
 DEATH_TEST_F(SyncTailTest,
              MultiSyncApplyFailsWhenCollectionCreationTriesToMakeUUID,
              "Attempted to create a new collection") {
@@ -1074,6 +1291,67 @@ TEST_F(SyncTailTest, MultiSyncApplyFallsBackOnApplyingInsertsIndividuallyWhenGro
     ASSERT_EQUALS(1U, numFailedGroupedInserts);
 }
 
+TEST_F(SyncTailTest, MultiSyncApplyAppliesUpdatesAndDeletesOnOneCollectionInOneUnitOfWork) {
+    NamespaceString nss1("test." + _agent.getSuiteName() + "_" + _agent.getTestName() + "_1");
+    NamespaceString nss2("test." + _agent.getSuiteName() + "_" + _agent.getTestName() + "_2");
+    auto update1 = makeUpdateDocumentOplogEntry(
+        {Timestamp(Seconds(1), 0), 1LL}, nss1, BSON("_id" << 1), BSON("$set" << BSON("x" << 1)));
+    auto delete1 =
+        makeDeleteDocumentOplogEntry({Timestamp(Seconds(2), 0), 1LL}, nss1, BSON("_id" << 2));
+    auto update2 = makeUpdateDocumentOplogEntry(
+        {Timestamp(Seconds(3), 0), 1LL}, nss2, BSON("_id" << 1), BSON("$set" << BSON("x" << 1)));
+
+    MultiApplier::Operations operationsApplied;
+    std::vector<bool> appliedInUnitOfWork;
+    auto syncApply = [&](OperationContext* opCtx, const BSONObj& op, OplogApplication::Mode) {
+        operationsApplied.push_back(OplogEntry(op));
+        appliedInUnitOfWork.push_back(opCtx->lockState()->inAWriteUnitOfWork());
+        return Status::OK();
+    };
+
+    MultiApplier::OperationPtrs ops = {&update1, &delete1, &update2};
+    ASSERT_OK(multiSyncApply_noAbort(_opCtx.get(), &ops, syncApply));
+
+    // The two ops on 'nss1' are grouped, while the lone op on 'nss2' is applied by itself.
+    ASSERT_EQUALS(3U, operationsApplied.size());
+    ASSERT_EQUALS(update1, operationsApplied[0]);
+    ASSERT_EQUALS(delete1, operationsApplied[1]);
+    ASSERT_EQUALS(update2, operationsApplied[2]);
+    ASSERT_TRUE(appliedInUnitOfWork[0]);
+    ASSERT_TRUE(appliedInUnitOfWork[1]);
+    ASSERT_FALSE(appliedInUnitOfWork[2]);
+}
+
+TEST_F(SyncTailTest, MultiSyncApplyFallsBackOnApplyingUpdatesIndividuallyWhenGroupFails) {
+    NamespaceString nss("test." + _agent.getSuiteName() + "_" + _agent.getTestName());
+    auto update1 = makeUpdateDocumentOplogEntry(
+        {Timestamp(Seconds(1), 0), 1LL}, nss, BSON("_id" << 1), BSON("$set" << BSON("x" << 1)));
+    auto update2 = makeUpdateDocumentOplogEntry(
+        {Timestamp(Seconds(2), 0), 1LL}, nss, BSON("_id" << 2), BSON("$set" << BSON("x" << 1)));
+
+    std::size_t numFailedGroups = 0;
+    MultiApplier::Operations operationsApplied;
+    auto syncApply = [&](OperationContext* opCtx, const BSONObj& op, OplogApplication::Mode) {
+        // Reject the second op when it is part of a group.
+        if (opCtx->lockState()->inAWriteUnitOfWork() && OplogEntry(op) == update2) {
+            numFailedGroups++;
+            return Status(ErrorCodes::OperationFailed, "grouped updates not supported");
+        }
+        operationsApplied.push_back(OplogEntry(op));
+        return Status::OK();
+    };
+
+    MultiApplier::OperationPtrs ops = {&update1, &update2};
+    ASSERT_OK(multiSyncApply_noAbort(_opCtx.get(), &ops, syncApply));
+
+    // The first op was applied once inside the failed group, which was rolled back, and once more
+    // individually.
+    ASSERT_EQUALS(1U, numFailedGroups);
+    ASSERT_EQUALS(3U, operationsApplied.size());
+    ASSERT_EQUALS(update1, operationsApplied[1]);
+    ASSERT_EQUALS(update2, operationsApplied[2]);
+}
+
 TEST_F(SyncTailTest, MultiInitialSyncApplyDisablesDocumentValidationWhileApplyingOperations) {
     SyncTailWithOperationContextChecker syncTail;
     NamespaceString nss("test.t");
@@ -203,7 +203,7 @@ public:
 private:
     /**
      * Return the shard with the specified tag, which has the least number of chunks. If the tag is
-     * empty, considers all shards.
+     * empty, considers all shards. Ties are broken in favour of the shard with the least data.
      */
     static ShardId _getLeastLoadedReceiverShard(const ShardStatisticsVector& shardStats,
                                                 const DistributionStatus& distribution,
@@ -211,8 +211,8 @@ private:
                                                 const std::set<ShardId>& excludedShards);
 
     /**
-     * Return the shard which has the least number of chunks with the specified tag. If the tag is
-     * empty, considers all chunks.
+     * Return the shard which has the most number of chunks with the specified tag. If the tag is
+     * empty, considers all chunks. Ties are broken in favour of the shard with the most data.
      */
     static ShardId _getMostOverloadedShard(const ShardStatisticsVector& shardStats,
                                            const DistributionStatus& distribution,
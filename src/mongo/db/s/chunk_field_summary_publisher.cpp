@@ -0,0 +1,1034 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kSharding
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/s/chunk_field_summary_publisher.h"
+
+#include <cmath>
+#include <limits>
+#include <map>
+#include <set>
+#include <vector>
+
+#include "mongo/bson/simple_bsonobj_comparator.h"
+#include "mongo/db/catalog/catalog_raii.h"
+#include "mongo/db/catalog/index_catalog.h"
+#include "mongo/db/client.h"
+#include "mongo/db/dbhelpers.h"
+#include "mongo/db/exec/working_set_common.h"
+#include "mongo/db/index/index_descriptor.h"
+#include "mongo/db/keypattern.h"
+#include "mongo/db/operation_context.h"
+#include "mongo/db/query/internal_plans.h"
+#include "mongo/db/query/plan_executor.h"
+#include "mongo/db/s/collection_sharding_state.h"
+#include "mongo/db/s/operation_sharding_state.h"
+#include "mongo/db/s/sharding_state.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/executor/task_executor_pool.h"
+#include "mongo/s/catalog/sharding_catalog_client.h"
+#include "mongo/s/catalog/type_chunk.h"
+#include "mongo/s/chunk_manager.h"
+#include "mongo/s/client/shard_registry.h"
+#include "mongo/s/grid.h"
+#include "mongo/s/request_types/commit_chunk_field_summaries_gen.h"
+#include "mongo/s/stale_exception.h"
+#include "mongo/util/assert_util.h"
+#include "mongo/util/log.h"
+#include "mongo/util/scopeguard.h"
+#include "mongo/util/stringutils.h"
+
+namespace mongo {
+namespace {
+
+// Comma-separated list of the top-level, non-shard-key fields for which this shard publishes
+// per-chunk min/max summaries. Routers only use them for targeting if the
+// 'useChunkFieldSummariesForTargeting' parameter is enabled on them.
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(chunkFieldSummaryFields, std::string, "");
+
+const ReadPreferenceSetting kPrimaryOnlyReadPreference{ReadPreference::PrimaryOnly};
+
+// Upper bound on how long a write waits for the config server to widen its chunk's summaries
+const Seconds kPublishTimeout(15);
+
+// Dates widened with slack stay well within the range of Date_t
+const double kMaxDateMillisWithSlack =
+    static_cast<double>(std::numeric_limits<long long>::max() / 2);
+
+// How long to wait before retrying a failed rebuild, doubled on each consecutive failure
+const Milliseconds kInitialRebuildRetryInterval(1000);
+const Milliseconds kMaxRebuildRetryInterval(60 * 1000);
+
+/**
+ * Constructs the default options for the thread pool used to publish summaries.
+ */
+ThreadPool::Options makeDefaultThreadPoolOptions() {
+    ThreadPool::Options options;
+    options.poolName = "ChunkFieldSummaryPublisher";
+    options.minThreads = 0;
+    options.maxThreads = 4;
+
+    // Ensure all threads have a client
+    options.onCreateThread = [](const std::string& threadName) {
+        Client::initThread(threadName.c_str());
+    };
+    return options;
+}
+
+/**
+ * Returns the fields listed in the 'chunkFieldSummaryFields' server parameter. Dotted field names
+ * are not supported and are skipped.
+ */
+const std::vector<std::string>& getSummarizedFields() {
+    static const std::vector<std::string> summarizedFields = [] {
+        std::vector<std::string> fieldNames;
+        splitStringDelim(chunkFieldSummaryFields, &fieldNames, ',');
+
+        std::vector<std::string> result;
+        for (const auto& fieldName : fieldNames) {
+            if (fieldName.empty() || fieldName.find('.') != std::string::npos) {
+                warning() << "Ignoring unsupported field '" << fieldName
+                          << "' in chunkFieldSummaryFields";
+                continue;
+            }
+            result.push_back(fieldName);
+        }
+        return result;
+    }();
+
+    return summarizedFields;
+}
+
+/**
+ * Returns the summary of a single document's value for a field. Missing values are summarized as
+ * null and arrays as spanning all values, because queries may match any of their elements.
+ */
+BSONObj summarizeValue(const BSONElement& value) {
+    BSONObjBuilder builder;
+    if (value.eoo()) {
+        builder.appendNull(ChunkType::kFieldSummaryMin);
+        builder.appendNull(ChunkType::kFieldSummaryMax);
+    } else if (value.type() == Array) {
+        builder.appendMinKey(ChunkType::kFieldSummaryMin);
+        builder.appendMaxKey(ChunkType::kFieldSummaryMax);
+    } else {
+        builder.appendAs(value, ChunkType::kFieldSummaryMin);
+        builder.appendAs(value, ChunkType::kFieldSummaryMax);
+    }
+    return builder.obj();
+}
+
+/**
+ * Returns the summary spanning both 'summary' and 'other'. An empty 'summary' is treated as
+ * spanning nothing.
+ */
+BSONObj unionSummaries(const BSONObj& summary, const BSONObj& other) {
+    if (summary.isEmpty()) {
+        return other.getOwned();
+    }
+
+    const auto summaryMin = summary[ChunkType::kFieldSummaryMin];
+    const auto summaryMax = summary[ChunkType::kFieldSummaryMax];
+    const auto otherMin = other[ChunkType::kFieldSummaryMin];
+    const auto otherMax = other[ChunkType::kFieldSummaryMax];
+
+    BSONObjBuilder builder;
+    builder.appendAs(otherMin.woCompare(summaryMin, false) < 0 ? otherMin : summaryMin,
+                     ChunkType::kFieldSummaryMin);
+    builder.appendAs(otherMax.woCompare(summaryMax, false) > 0 ? otherMax : summaryMax,
+                     ChunkType::kFieldSummaryMax);
+    return builder.obj();
+}
+
+/**
+ * Returns the field summaries spanning both 'fieldSummaries' and 'other', which are in the format
+ * of ChunkType::fieldSummaries.
+ */
+BSONObj unionFieldSummaries(const BSONObj& fieldSummaries, const BSONObj& other) {
+    BSONObjBuilder builder;
+    for (const auto& elem : fieldSummaries) {
+        const auto otherElem = other[elem.fieldNameStringData()];
+        builder.append(elem.fieldNameStringData(),
+                       otherElem.eoo() ? elem.Obj() : unionSummaries(elem.Obj(), otherElem.Obj()));
+    }
+    for (const auto& otherElem : other) {
+        if (!fieldSummaries.hasField(otherElem.fieldNameStringData())) {
+            builder.append(otherElem);
+        }
+    }
+    return builder.obj();
+}
+
+/**
+ * Returns the summaries of 'document' for the summarized fields, which are not part of the shard
+ * key 'keyPattern', in the format of ChunkType::fieldSummaries.
+ */
+BSONObj summarizeDocument(const BSONObj& keyPattern, const BSONObj& document) {
+    BSONObjBuilder builder;
+    for (const auto& fieldName : getSummarizedFields()) {
+        // Routers already target on the shard key fields through the chunk ranges
+        if (keyPattern.hasField(fieldName)) {
+            continue;
+        }
+
+        builder.append(fieldName, summarizeValue(document[fieldName]));
+    }
+    return builder.obj();
+}
+
+/**
+ * Returns whether the field summary 'summary' spans the field summary 'other'.
+ */
+bool summaryCovers(const BSONObj& summary, const BSONObj& other) {
+    return summary[ChunkType::kFieldSummaryMin].woCompare(other[ChunkType::kFieldSummaryMin],
+                                                          false) <= 0 &&
+        other[ChunkType::kFieldSummaryMax].woCompare(summary[ChunkType::kFieldSummaryMax],
+                                                     false) <= 0;
+}
+
+/**
+ * Appends the number or date 'value' moved by 'slack' as 'fieldName'. Dates which would leave the
+ * representable range are appended unchanged.
+ */
+void appendWithSlack(BSONObjBuilder* builder,
+                     StringData fieldName,
+                     const BSONElement& value,
+                     double slack) {
+    if (value.isNumber()) {
+        builder->append(fieldName, value.numberDouble() + slack);
+        return;
+    }
+
+    const double millis = static_cast<double>(value.date().toMillisSinceEpoch()) + slack;
+    if (!std::isfinite(millis) || std::abs(millis) > kMaxDateMillisWithSlack) {
+        builder->appendAs(value, fieldName);
+        return;
+    }
+
+    builder->appendDate(fieldName, Date_t::fromMillisSinceEpoch(static_cast<long long>(millis)));
+}
+
+/**
+ * Returns the field summary spanning both 'summary' and 'other'. If both are numeric or both are
+ * dates, the bounds which 'other' extends are moved further out by the width of 'summary'. This
+ * makes the width at least double with each widening, so a field which grows steadily only needs
+ * a number of widenings logarithmic in its range.
+ */
+BSONObj widenSummaryWithSlack(const BSONObj& summary, const BSONObj& other) {
+    const auto widened = unionSummaries(summary, other);
+
+    const auto summaryMin = summary[ChunkType::kFieldSummaryMin];
+    const auto summaryMax = summary[ChunkType::kFieldSummaryMax];
+    const auto otherMin = other[ChunkType::kFieldSummaryMin];
+    const auto otherMax = other[ChunkType::kFieldSummaryMax];
+
+    const bool isNumeric = summaryMin.isNumber() && summaryMax.isNumber() && otherMin.isNumber() &&
+        otherMax.isNumber();
+    const bool isDate = summaryMin.type() == Date && summaryMax.type() == Date &&
+        otherMin.type() == Date && otherMax.type() == Date;
+    if (!isNumeric && !isDate) {
+        return widened;
+    }
+
+    const double width = isNumeric
+        ? summaryMax.numberDouble() - summaryMin.numberDouble()
+        : static_cast<double>(summaryMax.date().toMillisSinceEpoch()) -
+            static_cast<double>(summaryMin.date().toMillisSinceEpoch());
+
+    BSONObjBuilder builder;
+    if (otherMin.woCompare(summaryMin, false) < 0) {
+        appendWithSlack(&builder, ChunkType::kFieldSummaryMin, otherMin, -width);
+    } else {
+        builder.appendAs(summaryMin, ChunkType::kFieldSummaryMin);
+    }
+    if (otherMax.woCompare(summaryMax, false) > 0) {
+        appendWithSlack(&builder, ChunkType::kFieldSummaryMax, otherMax, width);
+    } else {
+        builder.appendAs(summaryMax, ChunkType::kFieldSummaryMax);
+    }
+
+    // Converting large integers to doubles may round them towards the summary, so the exact union
+    // must still be included
+    return unionSummaries(builder.obj(), widened);
+}
+
+/**
+ * Returns the fields of the field summaries 'fieldSummaries' which are also in 'fieldNames'.
+ */
+BSONObj filterFieldSummaries(const BSONObj& fieldSummaries, const BSONObj& fieldNames) {
+    BSONObjBuilder builder;
+    for (const auto& elem : fieldSummaries) {
+        if (fieldNames.hasField(elem.fieldNameStringData())) {
+            builder.append(elem);
+        }
+    }
+    return builder.obj();
+}
+
+/**
+ * Installs 'fieldSummaries' and applies 'fieldSummaryWidenings' to the config.chunks entry of the
+ * chunk [min, max) owned by this shard. Returns IncompatibleShardingMetadata or StaleEpoch if the
+ * chunk was split, merged, moved or its collection dropped in the meantime and throws on any other
+ * error.
+ */
+Status commitChunkFieldSummaries(OperationContext* opCtx,
+                                 const NamespaceString& nss,
+                                 const OID& epoch,
+                                 const BSONObj& min,
+                                 const BSONObj& max,
+                                 const BSONObj& fieldSummaries,
+                                 const BSONObj& fieldSummaryWidenings) {
+    ConfigsvrCommitChunkFieldSummaries request;
+    request.set_configsvrCommitChunkFieldSummaries(nss);
+    request.setCollEpoch(epoch);
+    request.setShard(ShardingState::get(opCtx)->getShardName());
+    request.setMin(min);
+    request.setMax(max);
+    if (!fieldSummaries.isEmpty()) {
+        request.setFieldSummaries(fieldSummaries);
+    }
+    if (!fieldSummaryWidenings.isEmpty()) {
+        request.setFieldSummaryWidenings(fieldSummaryWidenings);
+    }
+
+    BSONObjBuilder cmdBuilder;
+    request.serialize(&cmdBuilder);
+    cmdBuilder.append(WriteConcernOptions::kWriteConcernField,
+                      ShardingCatalogClient::kMajorityWriteConcern.toBSON());
+
+    auto cmdResponse = uassertStatusOK(
+        Grid::get(opCtx)->shardRegistry()->getConfigShard()->runCommandWithFixedRetryAttempts(
+            opCtx,
+            kPrimaryOnlyReadPreference,
+            "admin",
+            cmdBuilder.obj(),
+            kPublishTimeout,
+            Shard::RetryPolicy::kIdempotent));
+
+    if (cmdResponse.commandStatus == ErrorCodes::IncompatibleShardingMetadata ||
+        cmdResponse.commandStatus == ErrorCodes::StaleEpoch) {
+        return cmdResponse.commandStatus;
+    }
+
+    uassertStatusOK(cmdResponse.commandStatus);
+    uassertStatusOK(cmdResponse.writeConcernStatus);
+    return Status::OK();
+}
+
+/**
+ * Scans all documents of the chunk [min, max) over the shard key index and returns the summaries
+ * of 'fieldNames' across them. Fields are omitted from the result if the chunk is empty.
+ */
+BSONObj scanChunkFieldSummaries(OperationContext* opCtx,
+                                const NamespaceString& nss,
+                                const BSONObj& keyPattern,
+                                const BSONObj& min,
+                                const BSONObj& max,
+                                const std::set<std::string>& fieldNames) {
+    std::map<std::string, BSONObj> summaries;
+
+    {
+        AutoGetCollection autoColl(opCtx, nss, MODE_IS);
+
+        Collection* const collection = autoColl.getCollection();
+        uassert(ErrorCodes::NamespaceNotFound,
+                str::stream() << "ns " << nss.ns() << " does not exist",
+                collection);
+
+        // Allow multiKey based on the invariant that shard keys must be single-valued. Therefore,
+        // any multi-key index prefixed by shard key cannot be multikey over the shard key fields.
+        IndexDescriptor* idx =
+            collection->getIndexCatalog()->findShardKeyPrefixedIndex(opCtx, keyPattern, false);
+        uassert(ErrorCodes::IndexNotFound,
+                str::stream() << "couldn't find index over shard key " << keyPattern
+                              << " for collection "
+                              << nss.ns(),
+                idx);
+
+        KeyPattern kp(idx->keyPattern());
+        BSONObj minKey = Helpers::toKeyFormat(kp.extendRangeBound(min, false));
+        BSONObj maxKey = Helpers::toKeyFormat(kp.extendRangeBound(max, false));
+
+        auto exec = InternalPlanner::indexScan(opCtx,
+                                               collection,
+                                               idx,
+                                               minKey,
+                                               maxKey,
+                                               BoundInclusion::kIncludeStartKeyOnly,
+                                               PlanExecutor::YIELD_AUTO,
+                                               InternalPlanner::FORWARD,
+                                               InternalPlanner::IXSCAN_FETCH);
+
+        BSONObj obj;
+        PlanExecutor::ExecState state;
+        while (PlanExecutor::ADVANCED == (state = exec->getNext(&obj, NULL))) {
+            for (const auto& fieldName : fieldNames) {
+                summaries[fieldName] =
+                    unionSummaries(summaries[fieldName], summarizeValue(obj[fieldName]));
+            }
+        }
+
+        uassert(ErrorCodes::OperationFailed,
+                str::stream() << "Executor error while scanning chunk " << redact(min) << " -->> "
+                              << redact(max)
+                              << " of "
+                              << nss.ns()
+                              << " for field summaries: "
+                              << WorkingSetCommon::toStatusString(obj),
+                PlanExecutor::DEAD != state && PlanExecutor::FAILURE != state);
+    }
+
+    BSONObjBuilder builder;
+    for (const auto& summary : summaries) {
+        builder.append(summary.first, summary.second);
+    }
+    return builder.obj();
+}
+
+}  // namespace
+
+ChunkFieldSummaryPublisher::ChunkFieldSummaryPublisher()
+    : _threadPool(makeDefaultThreadPoolOptions()) {
+    _threadPool.startup();
+}
+
+ChunkFieldSummaryPublisher::~ChunkFieldSummaryPublisher() {
+    _threadPool.shutdown();
+    _threadPool.join();
+}
+
+void ChunkFieldSummaryPublisher::initiate() {
+    stdx::lock_guard<stdx::mutex> scopedLock(_mutex);
+    _isPrimary = true;
+    _isActive.store(!getSummarizedFields().empty());
+}
+
+void ChunkFieldSummaryPublisher::interrupt() {
+    stdx::lock_guard<stdx::mutex> scopedLock(_mutex);
+    _isPrimary = false;
+    _isActive.store(false);
+    _chunks.clear();
+    _refreshedShardVersions.clear();
+    _condVar.notify_all();
+}
+
+void ChunkFieldSummaryPublisher::prepareWrites(OperationContext* opCtx,
+                                               const NamespaceString& nss,
+                                               const std::vector<BSONObj>& documents) {
+    // Writes made while holding locks, such as the ones of internal operations, rely on onWrite
+    if (opCtx->lockState()->isLocked()) {
+        return;
+    }
+
+    {
+        stdx::unique_lock<stdx::mutex> lk(_mutex);
+        opCtx->waitForConditionOrInterrupt(_condVar, lk, [&] {
+            return !_isPrimary || !_numPublicationsInProgress.count(nss.ns());
+        });
+
+        if (!_isPrimary || (documents.empty() && _refreshedShardVersions.count(nss.ns()))) {
+            return;
+        }
+    }
+
+    // The chunk written by some of 'documents', as found in this shard's metadata
+    struct ChunkWrites {
+        OID epoch;
+        uint32_t majorVersion;
+        BSONObj min;
+        BSONObj max;
+        BSONObj summaries;
+        BSONObj documentSummaries;
+        BSONObj widenings;
+    };
+
+    const ShardId shardId(ShardingState::get(opCtx)->getShardName());
+
+    auto readChunkWrites = [&](ChunkVersion* shardVersion) {
+        std::map<std::string, ChunkWrites> chunkWrites;
+
+        AutoGetCollection autoColl(opCtx, nss, MODE_IS);
+        auto metadata = CollectionShardingState::get(opCtx, nss)->getMetadata();
+        if (!metadata) {
+            *shardVersion = ChunkVersion::UNSHARDED();
+            return chunkWrites;
+        }
+
+        *shardVersion = metadata->getShardVersion();
+
+        const auto cm = metadata->getChunkManager();
+        const auto keyPattern = cm->getShardKeyPattern().toBSON();
+
+        std::vector<BSONObj> shardKeys;
+        shardKeys.reserve(documents.size());
+        for (const auto& document : documents) {
+            shardKeys.push_back(cm->getShardKeyPattern().extractShardKeyFromDoc(document));
+        }
+
+        const auto chunks = cm->findIntersectingChunksWithSimpleCollation(shardKeys);
+        for (size_t i = 0; i < documents.size(); ++i) {
+            const auto& chunk = chunks[i];
+            if (!chunk || chunk->getShardId() != shardId) {
+                continue;
+            }
+
+            const auto documentSummaries = summarizeDocument(keyPattern, documents[i]);
+            if (documentSummaries.isEmpty()) {
+                continue;
+            }
+
+            auto& writes = chunkWrites[ChunkType::genID(nss.ns(), chunk->getMin())];
+            if (writes.documentSummaries.isEmpty()) {
+                writes.epoch = cm->getVersion().epoch();
+                writes.majorVersion = chunk->getLastmod().majorVersion();
+                writes.min = chunk->getMin();
+                writes.max = chunk->getMax();
+                writes.summaries = chunk->getFieldSummaries();
+            }
+            writes.documentSummaries =
+                unionFieldSummaries(writes.documentSummaries, documentSummaries);
+        }
+
+        return chunkWrites;
+    };
+
+    ChunkVersion shardVersion;
+    auto chunkWrites = readChunkWrites(&shardVersion);
+    if (!shardVersion.isSet()) {
+        return;
+    }
+
+    bool isMetadataRefreshed;
+    {
+        stdx::lock_guard<stdx::mutex> scopedLock(_mutex);
+        isMetadataRefreshed = _isMetadataRefreshed(scopedLock, nss, shardVersion);
+    }
+
+    if (!isMetadataRefreshed) {
+        // A previous primary may have published summaries which are missing from the metadata
+        uassertStatusOK(_refreshMetadata(opCtx, nss));
+        chunkWrites = readChunkWrites(&shardVersion);
+    }
+
+    {
+        stdx::lock_guard<stdx::mutex> scopedLock(_mutex);
+        for (auto& entry : chunkWrites) {
+            auto& writes = entry.second;
+
+            auto it = _chunks.find(entry.first);
+            if (it != _chunks.end() && it->second.epoch == writes.epoch &&
+                it->second.majorVersion == writes.majorVersion &&
+                it->second.max.woCompare(writes.max) == 0) {
+                writes.summaries = unionFieldSummaries(writes.summaries, it->second.summaries);
+            }
+
+            // Fields without summaries are left to onWrite, which starts rebuilding them
+            BSONObjBuilder wideningsBuilder;
+            for (const auto& elem : writes.documentSummaries) {
+                const auto summaryElem = writes.summaries[elem.fieldNameStringData()];
+                if (summaryElem.type() == Object && !summaryCovers(summaryElem.Obj(), elem.Obj())) {
+                    wideningsBuilder.append(elem.fieldNameStringData(),
+                                            widenSummaryWithSlack(summaryElem.Obj(), elem.Obj()));
+                }
+            }
+            writes.widenings = wideningsBuilder.obj();
+        }
+    }
+
+    bool hasCommitted = false;
+    for (auto& entry : chunkWrites) {
+        auto& writes = entry.second;
+        if (writes.widenings.isEmpty()) {
+            continue;
+        }
+
+        Status commitStatus = commitChunkFieldSummaries(
+            opCtx, nss, writes.epoch, writes.min, writes.max, BSONObj(), writes.widenings);
+        if (!commitStatus.isOK()) {
+            // The chunk was split, merged or moved. The refresh below makes the write find out.
+            writes.widenings = BSONObj();
+        }
+
+        hasCommitted = true;
+    }
+
+    if (!hasCommitted) {
+        return;
+    }
+
+    // Routers, which contact this shard with the previous version, must find out about the
+    // widenings before the write becomes visible
+    uassertStatusOK(_refreshMetadata(opCtx, nss));
+
+    stdx::lock_guard<stdx::mutex> scopedLock(_mutex);
+    for (const auto& entry : chunkWrites) {
+        const auto& writes = entry.second;
+
+        auto it = _chunks.find(entry.first);
+        if (it != _chunks.end() && it->second.epoch == writes.epoch &&
+            it->second.majorVersion == writes.majorVersion &&
+            it->second.max.woCompare(writes.max) == 0) {
+            it->second.summaries = unionFieldSummaries(it->second.summaries, writes.widenings);
+        }
+    }
+}
+
+void ChunkFieldSummaryPublisher::onWrite(OperationContext* opCtx,
+                                         const NamespaceString& nss,
+                                         const ChunkManager& cm,
+                                         const Chunk& chunk,
+                                         const BSONObj& document) {
+    // Documents written to chunks of other shards, such as the ones cloned by an incoming
+    // migration, are summarized once the chunk belongs to this shard
+    if (chunk.getShardId() != ShardId(ShardingState::get(opCtx)->getShardName())) {
+        return;
+    }
+
+    const auto documentSummaries = summarizeDocument(cm.getShardKeyPattern().toBSON(), document);
+    if (documentSummaries.isEmpty()) {
+        return;
+    }
+
+    const auto chunkId = ChunkType::genID(nss.ns(), chunk.getMin());
+    const auto shardVersion = cm.getVersion(chunk.getShardId());
+
+    stdx::lock_guard<stdx::mutex> scopedLock(_mutex);
+    if (!_isPrimary) {
+        return;
+    }
+
+    ChunkState* const state = _getChunkState(scopedLock, nss, cm, chunk);
+
+    if (state->rebuildState == RebuildState::kScanning) {
+        state->writtenDuringRebuild =
+            unionFieldSummaries(state->writtenDuringRebuild, documentSummaries);
+    }
+
+    const bool isMetadataRefreshed = _isMetadataRefreshed(scopedLock, nss, shardVersion);
+
+    bool hasUnsummarizedFields = false;
+    bool mayBeUncovered = false;
+    BSONObjBuilder wideningsBuilder;
+
+    for (const auto& elem : documentSummaries) {
+        const auto fieldName = elem.fieldNameStringData();
+
+        const auto summaryElem = state->summaries[fieldName];
+        if (summaryElem.type() == Object) {
+            if (!summaryCovers(summaryElem.Obj(), elem.Obj())) {
+                wideningsBuilder.append(fieldName,
+                                        widenSummaryWithSlack(summaryElem.Obj(), elem.Obj()));
+                mayBeUncovered = true;
+            }
+            continue;
+        }
+
+        // The summary being installed by a rebuild may be published at any moment, so it must
+        // cover the document as well. Once installed, it is widened like any other summary.
+        const auto installingElem = state->installing[fieldName];
+        if (installingElem.type() == Object) {
+            if (!summaryCovers(installingElem.Obj(), elem.Obj())) {
+                mayBeUncovered = true;
+            }
+            continue;
+        }
+
+        if (!isMetadataRefreshed) {
+            // A previous primary may have published a summary, which is missing from the metadata
+            mayBeUncovered = true;
+            continue;
+        }
+
+        hasUnsummarizedFields = true;
+    }
+
+    if (!mayBeUncovered) {
+        // Routers do not skip chunks for the fields they do not have summaries for, so these can be
+        // built in the background
+        if (hasUnsummarizedFields && state->rebuildState == RebuildState::kNone) {
+            state->rebuildState = RebuildState::kScanning;
+            state->writtenDuringRebuild = documentSummaries;
+            _scheduleRebuild(scopedLock, opCtx, chunkId, state->generation, Milliseconds(0));
+        }
+        return;
+    }
+
+    // The write cannot wait for the config server while holding its locks, so fail it with a stale
+    // version instead. Routers retry it, at which point prepareWrites waits for the widening.
+    state->pendingWidenings = unionFieldSummaries(state->pendingWidenings, wideningsBuilder.obj());
+    _schedulePublishWidenings(scopedLock, chunkId, state);
+
+    uasserted(StaleConfigInfo(
+                  nss.ns(), OperationShardingState::get(opCtx).getShardVersion(nss), shardVersion),
+              str::stream() << "Field summaries of chunk " << redact(chunk.getMin()) << " -->> "
+                            << redact(chunk.getMax())
+                            << " of "
+                            << nss.ns()
+                            << " must be published before the write");
+}
+
+ChunkFieldSummaryPublisher::ChunkState* ChunkFieldSummaryPublisher::_getChunkState(
+    WithLock, const NamespaceString& nss, const ChunkManager& cm, const Chunk& chunk) {
+    const auto chunkId = ChunkType::genID(nss.ns(), chunk.getMin());
+    const auto epoch = cm.getVersion().epoch();
+    const auto majorVersion = chunk.getLastmod().majorVersion();
+
+    auto it = _chunks.find(chunkId);
+    if (it == _chunks.end() || it->second.epoch != epoch ||
+        it->second.majorVersion != majorVersion ||
+        it->second.max.woCompare(chunk.getMax()) != 0) {
+        // First write to the chunk since this node became primary or since the chunk changed
+        ChunkState newState;
+        newState.generation = _nextGeneration++;
+        newState.nss = nss;
+        newState.epoch = epoch;
+        newState.majorVersion = majorVersion;
+        newState.keyPattern = cm.getShardKeyPattern().toBSON();
+        newState.min = chunk.getMin();
+        newState.max = chunk.getMax();
+        newState.lastmod = chunk.getLastmod();
+        newState.summaries = chunk.getFieldSummaries();
+
+        auto& state = _chunks[chunkId];
+        state = std::move(newState);
+        return &state;
+    }
+
+    auto& state = it->second;
+    if (!state.lastmod.equals(chunk.getLastmod())) {
+        // The metadata was refreshed and may include summaries published by a previous primary
+        state.summaries = unionFieldSummaries(state.summaries, chunk.getFieldSummaries());
+        state.lastmod = chunk.getLastmod();
+    }
+
+    return &state;
+}
+
+bool ChunkFieldSummaryPublisher::_isMetadataRefreshed(WithLock,
+                                                      const NamespaceString& nss,
+                                                      const ChunkVersion& shardVersion) const {
+    auto it = _refreshedShardVersions.find(nss.ns());
+    return it != _refreshedShardVersions.end() && it->second.hasEqualEpoch(shardVersion) &&
+        !shardVersion.isOlderThan(it->second);
+}
+
+Status ChunkFieldSummaryPublisher::_refreshMetadata(OperationContext* opCtx,
+                                                    const NamespaceString& nss) {
+    ChunkVersion shardVersion;
+    Status refreshStatus = ShardingState::get(opCtx)->refreshMetadataNow(opCtx, nss, &shardVersion);
+    if (!refreshStatus.isOK()) {
+        return refreshStatus;
+    }
+
+    stdx::lock_guard<stdx::mutex> scopedLock(_mutex);
+    if (_isPrimary) {
+        _refreshedShardVersions[nss.ns()] = shardVersion;
+    }
+    return Status::OK();
+}
+
+void ChunkFieldSummaryPublisher::_publishWidenings(const NamespaceString& nss,
+                                                   const std::string& chunkId,
+                                                   uint64_t generation) {
+    ON_BLOCK_EXIT([&] {
+        stdx::lock_guard<stdx::mutex> scopedLock(_mutex);
+        if (--_numPublicationsInProgress[nss.ns()] == 0) {
+            _numPublicationsInProgress.erase(nss.ns());
+        }
+        _condVar.notify_all();
+    });
+
+    const auto opCtx = cc().makeOperationContext();
+
+    while (true) {
+        ChunkState target;
+        {
+            stdx::lock_guard<stdx::mutex> scopedLock(_mutex);
+            auto it = _chunks.find(chunkId);
+            if (it == _chunks.end() || it->second.generation != generation) {
+                return;
+            }
+
+            target = it->second;
+        }
+
+        Status commitStatus = Status::OK();
+        try {
+            if (!target.pendingWidenings.isEmpty()) {
+                commitStatus = commitChunkFieldSummaries(opCtx.get(),
+                                                         target.nss,
+                                                         target.epoch,
+                                                         target.min,
+                                                         target.max,
+                                                         BSONObj(),
+                                                         target.pendingWidenings);
+            }
+        } catch (const DBException& ex) {
+            commitStatus = ex.toStatus();
+        }
+
+        // Also refresh if the request failed, because it may have been applied nonetheless
+        Status refreshStatus = _refreshMetadata(opCtx.get(), target.nss);
+
+        stdx::lock_guard<stdx::mutex> scopedLock(_mutex);
+        auto it = _chunks.find(chunkId);
+        if (it == _chunks.end() || it->second.generation != generation) {
+            return;
+        }
+
+        auto& state = it->second;
+
+        if (commitStatus == ErrorCodes::IncompatibleShardingMetadata ||
+            commitStatus == ErrorCodes::StaleEpoch) {
+            // The retried writes target the chunks which replaced this one
+            _chunks.erase(it);
+            return;
+        }
+
+        if (!commitStatus.isOK() || !refreshStatus.isOK()) {
+            // The writes which depend on the widenings failed, their retries request them again
+            warning() << "Failed to publish field summary widenings for chunk " << chunkId
+                      << causedBy(redact(commitStatus.isOK() ? refreshStatus : commitStatus));
+            state.pendingWidenings = BSONObj();
+            state.isPublishingWidenings = false;
+            return;
+        }
+
+        // The config server ignores widenings of fields without summaries, such as the ones being
+        // installed by a rebuild
+        state.summaries = unionFieldSummaries(
+            state.summaries, filterFieldSummaries(target.pendingWidenings, target.summaries));
+
+        if (SimpleBSONObjComparator::kInstance.evaluate(state.pendingWidenings ==
+                                                         target.pendingWidenings)) {
+            state.pendingWidenings = BSONObj();
+            state.isPublishingWidenings = false;
+            return;
+        }
+    }
+}
+
+void ChunkFieldSummaryPublisher::_schedulePublishWidenings(WithLock,
+                                                           const std::string& chunkId,
+                                                           ChunkState* state) {
+    if (state->isPublishingWidenings) {
+        return;
+    }
+
+    const auto nss = state->nss;
+    const auto generation = state->generation;
+
+    Status scheduleStatus = _threadPool.schedule([this, nss, chunkId, generation]() noexcept {
+        _publishWidenings(nss, chunkId, generation);
+    });
+    if (!scheduleStatus.isOK()) {
+        warning() << "Failed to schedule publishing field summary widenings for chunk " << chunkId
+                  << causedBy(redact(scheduleStatus));
+        _chunks.erase(chunkId);
+        return;
+    }
+
+    state->isPublishingWidenings = true;
+    ++_numPublicationsInProgress[nss.ns()];
+}
+
+void ChunkFieldSummaryPublisher::_rebuild(const std::string& chunkId, uint64_t generation) {
+    ChunkState target;
+
+    {
+        stdx::lock_guard<stdx::mutex> scopedLock(_mutex);
+        auto it = _chunks.find(chunkId);
+        if (it == _chunks.end() || it->second.generation != generation) {
+            return;
+        }
+
+        invariant(it->second.rebuildState == RebuildState::kScanning);
+        target = it->second;
+    }
+
+    const auto opCtx = cc().makeOperationContext();
+
+    bool isInstalling = false;
+    const auto installDone = MakeGuard([&] {
+        if (!isInstalling) {
+            return;
+        }
+
+        stdx::lock_guard<stdx::mutex> scopedLock(_mutex);
+        if (--_numPublicationsInProgress[target.nss.ns()] == 0) {
+            _numPublicationsInProgress.erase(target.nss.ns());
+        }
+        _condVar.notify_all();
+    });
+
+    BSONObj installed;
+
+    try {
+        std::set<std::string> fieldNames;
+        for (const auto& fieldName : getSummarizedFields()) {
+            if (!target.keyPattern.hasField(fieldName)) {
+                fieldNames.insert(fieldName);
+            }
+        }
+
+        const auto scanned = scanChunkFieldSummaries(
+            opCtx.get(), target.nss, target.keyPattern, target.min, target.max, fieldNames);
+
+        {
+            stdx::lock_guard<stdx::mutex> scopedLock(_mutex);
+            auto it = _chunks.find(chunkId);
+            if (it == _chunks.end() || it->second.generation != generation) {
+                return;
+            }
+
+            // From here on writes must be covered by the installed summaries, because they may be
+            // published at any moment. These include the summaries of a previous attempt, which may
+            // have been published even though it failed.
+            auto& state = it->second;
+            state.rebuildState = RebuildState::kInstalling;
+            state.installing = unionFieldSummaries(
+                state.installing, unionFieldSummaries(scanned, state.writtenDuringRebuild));
+            installed = state.installing;
+
+            isInstalling = true;
+            ++_numPublicationsInProgress[target.nss.ns()];
+        }
+
+        Status commitStatus = installed.isEmpty()
+            ? Status::OK()
+            : commitChunkFieldSummaries(opCtx.get(),
+                                        target.nss,
+                                        target.epoch,
+                                        target.min,
+                                        target.max,
+                                        installed,
+                                        BSONObj());
+
+        if (!installed.isEmpty()) {
+            uassertStatusOK(_refreshMetadata(opCtx.get(), target.nss));
+        }
+
+        stdx::lock_guard<stdx::mutex> scopedLock(_mutex);
+        auto it = _chunks.find(chunkId);
+        if (it == _chunks.end() || it->second.generation != generation) {
+            return;
+        }
+
+        if (!commitStatus.isOK()) {
+            // The chunks which replaced this one do not have summaries yet. The next write to
+            // them starts their rebuild.
+            LOG(1) << "Abandoning rebuild of field summaries for chunk " << chunkId
+                   << causedBy(redact(commitStatus));
+            _chunks.erase(it);
+            return;
+        }
+
+        auto& state = it->second;
+        state.summaries = unionFieldSummaries(state.summaries, installed);
+        state.rebuildState = RebuildState::kNone;
+        state.writtenDuringRebuild = BSONObj();
+        state.installing = BSONObj();
+        state.numFailedRebuilds = 0;
+    } catch (const DBException& ex) {
+        stdx::lock_guard<stdx::mutex> scopedLock(_mutex);
+        auto it = _chunks.find(chunkId);
+        if (it == _chunks.end() || it->second.generation != generation) {
+            return;
+        }
+
+        // The summaries being installed are kept as a bound for the writes until a later attempt
+        // publishes them, because this one may have succeeded
+        auto& state = it->second;
+        state.rebuildState = RebuildState::kScanning;
+
+        const auto retryInterval = std::min(
+            kMaxRebuildRetryInterval,
+            kInitialRebuildRetryInterval * (1LL << std::min(state.numFailedRebuilds, 6)));
+        ++state.numFailedRebuilds;
+
+        warning() << "Failed to rebuild field summaries for chunk " << chunkId << ", retrying in "
+                  << retryInterval << causedBy(redact(ex.toStatus()));
+
+        _scheduleRebuild(scopedLock, opCtx.get(), chunkId, generation, retryInterval);
+    }
+}
+
+void ChunkFieldSummaryPublisher::_scheduleRebuild(WithLock,
+                                                  OperationContext* opCtx,
+                                                  const std::string& chunkId,
+                                                  uint64_t generation,
+                                                  Milliseconds delay) {
+    Status scheduleStatus = Status::OK();
+
+    if (delay <= Milliseconds(0)) {
+        scheduleStatus = _threadPool.schedule(
+            [this, chunkId, generation]() noexcept { _rebuild(chunkId, generation); });
+    } else {
+        // Wait on the executor rather than on a thread of the pool, which would otherwise be held
+        // for the whole duration of the back off
+        auto const executor = Grid::get(opCtx)->getExecutorPool()->getFixedExecutor();
+        scheduleStatus =
+            executor
+                ->scheduleWorkAt(
+                    executor->now() + delay,
+                    [this, chunkId, generation](const executor::TaskExecutor::CallbackArgs& args) {
+                        if (!args.status.isOK()) {
+                            return;
+                        }
+
+                        stdx::lock_guard<stdx::mutex> scopedLock(_mutex);
+                        auto it = _chunks.find(chunkId);
+                        if (it == _chunks.end() || it->second.generation != generation) {
+                            return;
+                        }
+
+                        auto status = _threadPool.schedule([this, chunkId, generation]() noexcept {
+                            _rebuild(chunkId, generation);
+                        });
+                        if (!status.isOK()) {
+                            warning() << "Failed to schedule rebuild of field summaries for chunk "
+                                      << chunkId << causedBy(redact(status));
+                            _chunks.erase(it);
+                            _condVar.notify_all();
+                        }
+                    })
+                .getStatus();
+    }
+
+    if (!scheduleStatus.isOK()) {
+        warning() << "Failed to schedule rebuild of field summaries for chunk " << chunkId
+                  << causedBy(redact(scheduleStatus));
+        _chunks.erase(chunkId);
+        _condVar.notify_all();
+    }
+}
+
+}  // namespace mongo
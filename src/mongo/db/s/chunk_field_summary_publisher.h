@@ -0,0 +1,247 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "mongo/bson/bsonobj.h"
+#include "mongo/bson/oid.h"
+#include "mongo/db/namespace_string.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/s/chunk_version.h"
+#include "mongo/stdx/condition_variable.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/stdx/unordered_map.h"
+#include "mongo/util/concurrency/thread_pool.h"
+#include "mongo/util/concurrency/with_lock.h"
+#include "mongo/util/time_support.h"
+
+namespace mongo {
+
+class Chunk;
+class ChunkManager;
+class OperationContext;
+
+/**
+ * Keeps the min/max summaries of the non-shard-key fields listed in the 'chunkFieldSummaryFields'
+ * server parameter in the config.chunks entries of the chunks owned by this shard, so that routers
+ * can use them to skip chunks while targeting queries.
+ *
+ * The published summaries always cover the documents of the chunk. Before a write, which would
+ * take a document outside of its chunk's summaries, commits, they are widened on the config server,
+ * which bumps the chunk's version, and this shard's metadata is refreshed. Widening never happens
+ * while the write holds locks. Numeric and date summaries are widened past the written value, so
+ * that steadily growing fields, such as timestamps, only need to be widened every so often. Chunks
+ * without summaries are never skipped by routers, so their summaries are built asynchronously from
+ * the data.
+ */
+class ChunkFieldSummaryPublisher {
+    MONGO_DISALLOW_COPYING(ChunkFieldSummaryPublisher);
+
+public:
+    ChunkFieldSummaryPublisher();
+    ~ChunkFieldSummaryPublisher();
+
+    /**
+     * Invoked when the shard server primary enters the 'PRIMARY' state to begin publishing.
+     */
+    void initiate();
+
+    /**
+     * Invoked when this node which is currently serving as a 'PRIMARY' steps down. Rebuilds and
+     * widenings in progress are abandoned.
+     */
+    void interrupt();
+
+    /**
+     * Returns whether writes must be reported through onWrite, which is the case on a primary with
+     * summarized fields configured. Cheap enough to be checked on every write.
+     */
+    bool isActive() const {
+        return _isActive.load();
+    }
+
+    /**
+     * Invoked before writing to the sharded collection 'nss', without any locks held, with the
+     * documents to insert, if any. Waits for the widenings which failed writes to the collection
+     * depend on and widens the summaries of the chunks the documents fall into, so that onWrite
+     * finds them covered. Throws if the summaries could not be widened or the metadata could not be
+     * refreshed afterwards, in which case the write must fail. Does nothing if locks are held.
+     */
+    void prepareWrites(OperationContext* opCtx,
+                       const NamespaceString& nss,
+                       const std::vector<BSONObj>& documents);
+
+    /**
+     * Invoked for each document inserted or updated in 'chunk' of the sharded collection 'nss',
+     * from within the write's unit of work. Never blocks and does no network I/O. If the chunk's
+     * published summaries may not cover the document, schedules their widening and throws
+     * StaleConfig, so that the write is retried once the widening has been published.
+     */
+    void onWrite(OperationContext* opCtx,
+                 const NamespaceString& nss,
+                 const ChunkManager& cm,
+                 const Chunk& chunk,
+                 const BSONObj& document);
+
+private:
+    enum class RebuildState {
+        // The chunk's summaries are only widened by the writes
+        kNone,
+
+        // The chunk is being scanned, writes are recorded in 'writtenDuringRebuild'
+        kScanning,
+
+        // The rebuilt summaries are being published, writes must be covered by 'installing'
+        kInstalling,
+    };
+
+    /**
+     * The publishing state of a single chunk since this node became primary.
+     */
+    struct ChunkState {
+        // Distinguishes this state from the one of a previous incarnation of the same chunk
+        uint64_t generation;
+
+        NamespaceString nss;
+        OID epoch;
+        uint32_t majorVersion;
+        BSONObj keyPattern;
+        BSONObj min;
+        BSONObj max;
+
+        // Version of the chunk in the metadata which 'summaries' were last merged from
+        ChunkVersion lastmod;
+
+        // Summaries which are known to be published, in the format of ChunkType::fieldSummaries
+        BSONObj summaries;
+
+        RebuildState rebuildState{RebuildState::kNone};
+
+        // Summaries of the documents written since the current rebuild started
+        BSONObj writtenDuringRebuild;
+
+        // Summaries being installed by the current rebuild
+        BSONObj installing;
+
+        // Number of consecutive failed rebuilds, which determines when the next one is attempted
+        int numFailedRebuilds{0};
+
+        // Widenings which failed writes are waiting for, published by _publishWidenings
+        BSONObj pendingWidenings;
+        bool isPublishingWidenings{false};
+    };
+
+    /**
+     * Returns the state of 'chunk' of the collection 'nss', creating it if this is the first write
+     * to the chunk since this node became primary or since the chunk changed. Merges the summaries
+     * from this shard's metadata into it.
+     */
+    ChunkState* _getChunkState(WithLock,
+                               const NamespaceString& nss,
+                               const ChunkManager& cm,
+                               const Chunk& chunk);
+
+    /**
+     * Returns whether this shard's metadata for 'nss' at 'shardVersion' includes all summaries
+     * which may have been published before this node became primary.
+     */
+    bool _isMetadataRefreshed(WithLock,
+                              const NamespaceString& nss,
+                              const ChunkVersion& shardVersion) const;
+
+    /**
+     * Refreshes this shard's metadata for 'nss' after its chunks changed on the config server, so
+     * that the shard version reflects the change.
+     */
+    Status _refreshMetadata(OperationContext* opCtx, const NamespaceString& nss);
+
+    /**
+     * Publishes the pending widenings of the chunk with the specified id of the collection 'nss'
+     * and refreshes this shard's metadata. Goes on while more widenings become pending meanwhile.
+     */
+    void _publishWidenings(const NamespaceString& nss,
+                           const std::string& chunkId,
+                           uint64_t generation);
+
+    /**
+     * Schedules publishing the pending widenings of the chunk with the specified id, unless this is
+     * already scheduled. Forgets the chunk if this cannot be scheduled.
+     */
+    void _schedulePublishWidenings(WithLock, const std::string& chunkId, ChunkState* state);
+
+    /**
+     * Scans the chunk with the specified id and publishes summaries spanning both its documents and
+     * the ones written while scanning. Schedules another attempt on failure.
+     */
+    void _rebuild(const std::string& chunkId, uint64_t generation);
+
+    /**
+     * Schedules a rebuild of the chunk with the specified id after 'delay'. Forgets the chunk if
+     * the rebuild cannot be scheduled, so that the next write starts over.
+     */
+    void _scheduleRebuild(WithLock,
+                          OperationContext* opCtx,
+                          const std::string& chunkId,
+                          uint64_t generation,
+                          Milliseconds delay);
+
+    // Whether writes must be reported, mirrors '_isPrimary' and the summarized fields
+    AtomicWord<bool> _isActive{false};
+
+    // Protects the state below.
+    stdx::mutex _mutex;
+
+    // Signalled whenever a publication counted in '_numPublicationsInProgress' finishes and when
+    // the node steps down
+    stdx::condition_variable _condVar;
+
+    // The publisher is only active on a primary node.
+    bool _isPrimary{false};
+
+    // Source of ChunkState::generation
+    uint64_t _nextGeneration{0};
+
+    // Chunks written since this node became primary, keyed by the chunk's config.chunks _id
+    stdx::unordered_map<std::string, ChunkState> _chunks;
+
+    // Number of widening publications and rebuild installations in progress for each collection,
+    // which prepareWrites waits for, keyed by namespace
+    stdx::unordered_map<std::string, int> _numPublicationsInProgress;
+
+    // Shard version of each collection after the latest refresh of its metadata since this node
+    // became primary, keyed by namespace
+    stdx::unordered_map<std::string, ChunkVersion> _refreshedShardVersions;
+
+    // Thread pool for publishing the summaries of different chunks in parallel.
+    ThreadPool _threadPool;
+};
+
+}  // namespace mongo
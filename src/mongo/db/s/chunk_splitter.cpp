@@ -309,16 +309,28 @@ void ChunkSplitter::_runAutosplit(const NamespaceString& nss,
                << " dataWritten since last check: " << dataWritten
                << " maxChunkSizeBytes: " << maxChunkSizeBytes;
 
-        auto splitPoints = uassertStatusOK(splitVector(opCtx.get(),
-                                                       nss,
-                                                       cm->getShardKeyPattern().toBSON(),
-                                                       chunk->getMin(),
-                                                       chunk->getMax(),
-                                                       false,
-                                                       boost::none,
-                                                       boost::none,
-                                                       boost::none,
-                                                       maxChunkSizeBytes));
+        // Try to pick the split points from a sample of the collection first, since scanning the
+        // shard key index over a large chunk can take a long time
+        auto sampledSplitPoints =
+            uassertStatusOK(sampleSplitPoints(opCtx.get(),
+                                              nss,
+                                              cm->getShardKeyPattern().toBSON(),
+                                              chunk->getMin(),
+                                              chunk->getMax(),
+                                              maxChunkSizeBytes));
+
+        auto splitPoints = sampledSplitPoints
+            ? std::move(*sampledSplitPoints)
+            : uassertStatusOK(splitVector(opCtx.get(),
+                                          nss,
+                                          cm->getShardKeyPattern().toBSON(),
+                                          chunk->getMin(),
+                                          chunk->getMax(),
+                                          false,
+                                          boost::none,
+                                          boost::none,
+                                          boost::none,
+                                          maxChunkSizeBytes));
 
         if (splitPoints.size() <= 1) {
             // No split points means there isn't enough data to split on; 1 split point means we
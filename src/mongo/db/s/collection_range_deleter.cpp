@@ -50,6 +50,7 @@
 #include "mongo/db/repl/repl_client_info.h"
 #include "mongo/db/s/collection_sharding_state.h"
 #include "mongo/db/s/sharding_state.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/service_context.h"
 #include "mongo/db/write_concern.h"
 #include "mongo/executor/task_executor.h"
@@ -67,6 +68,17 @@ const WriteConcernOptions kMajorityWriteConcern(WriteConcernOptions::kMajority,
                                                 WriteConcernOptions::SyncMode::UNSET,
                                                 Seconds(60));
 
+// Upper bound on the total size of the documents removed by a single range deletion batch, in
+// addition to the number of documents per batch
+MONGO_EXPORT_SERVER_PARAMETER(rangeDeleterBatchMaxBytes, int, 4 * 1024 * 1024);
+
+// Fixed pause between consecutive range deletion batches
+MONGO_EXPORT_SERVER_PARAMETER(rangeDeleterBatchDelayMS, int, 0);
+
+// Waiting at least this long for a deletion batch to replicate means the secondaries are lagging
+// and the next batch gets delayed by the same amount of time
+const Milliseconds kReplicationLagBackoffThreshold(100);
+
 boost::optional<DeleteNotification> checkOverlap(std::list<Deletion> const& deletions,
                                                  ChunkRange const& range) {
     // Start search with newest entries by using reverse iterators
@@ -227,6 +239,7 @@ boost::optional<Date_t> CollectionRangeDeleter::cleanUpNextRange(
     const auto clientOpTime = repl::ReplClientInfo::forClient(opCtx->getClient()).getLastOp();
 
     // Wait for replication outside the lock
+    const auto waitStart = Date_t::now();
     const auto status = [&] {
         try {
             WriteConcernResult unusedWCResult;
@@ -236,6 +249,8 @@ boost::optional<Date_t> CollectionRangeDeleter::cleanUpNextRange(
         }
     }();
 
+    const auto replicationWait = Date_t::now() - waitStart;
+
     if (!status.isOK()) {
         LOG(0) << "Error when waiting for write concern after removing " << nss << " range "
                << redact(range->toString()) << " : " << redact(status.reason());
@@ -261,7 +276,20 @@ boost::optional<Date_t> CollectionRangeDeleter::cleanUpNextRange(
     }
 
     notification.abandon();
-    return Date_t{};
+
+    // Pause before the next batch if so configured or if the secondaries are lagging behind, in
+    // which case back off for as long as it took them to catch up with this batch
+    Milliseconds delay(rangeDeleterBatchDelayMS.load());
+    if (replicationWait >= kReplicationLagBackoffThreshold) {
+        delay += duration_cast<Milliseconds>(replicationWait);
+    }
+
+    if (delay <= Milliseconds(0)) {
+        return Date_t{};
+    }
+
+    LOG(1) << "Pausing for " << delay << " before the next deletion batch in " << nss.ns();
+    return Date_t::now() + delay;
 }
 
 StatusWith<int> CollectionRangeDeleter::_doDeletion(OperationContext* opCtx,
@@ -310,16 +338,23 @@ StatusWith<int> CollectionRangeDeleter::_doDeletion(OperationContext* opCtx,
         saver.emplace("moveChunk", nss.ns(), "cleaning");
     }
 
-    int numDeleted = 0;
-    do {
-        auto halfOpen = BoundInclusion::kIncludeStartKeyOnly;
-        auto manual = PlanExecutor::YIELD_MANUAL;
-        auto forward = InternalPlanner::FORWARD;
-        auto fetch = InternalPlanner::IXSCAN_FETCH;
+    // Use a single index scan for the whole batch, detaching it from the document it is positioned
+    // on while that document is deleted, instead of seeking from the start of the range every time
+    auto exec = InternalPlanner::indexScan(opCtx,
+                                           collection,
+                                           descriptor,
+                                           min,
+                                           max,
+                                           BoundInclusion::kIncludeStartKeyOnly,
+                                           PlanExecutor::YIELD_MANUAL,
+                                           InternalPlanner::FORWARD,
+                                           InternalPlanner::IXSCAN_FETCH);
 
-        auto exec = InternalPlanner::indexScan(
-            opCtx, collection, descriptor, min, max, halfOpen, manual, forward, fetch);
+    const long long maxBytesToDelete = std::max(rangeDeleterBatchMaxBytes.load(), 1);
 
+    int numDeleted = 0;
+    long long numBytesDeleted = 0;
+    while (numDeleted < maxToDelete && numBytesDeleted < maxBytesToDelete) {
         RecordId rloc;
         BSONObj obj;
         PlanExecutor::ExecState state = exec->getNext(&obj, &rloc);
@@ -335,6 +370,14 @@ StatusWith<int> CollectionRangeDeleter::_doDeletion(OperationContext* opCtx,
         }
         invariant(PlanExecutor::ADVANCED == state);
 
+        const int objSize = obj.objsize();
+        if (saver) {
+            // Saving the executor's state may free the memory backing the document
+            obj = obj.getOwned();
+        }
+
+        exec->saveState();
+
         writeConflictRetry(opCtx, "delete range", nss.ns(), [&] {
             WriteUnitOfWork wuow(opCtx);
             if (saver) {
@@ -343,7 +386,17 @@ StatusWith<int> CollectionRangeDeleter::_doDeletion(OperationContext* opCtx,
             collection->deleteDocument(opCtx, kUninitializedStmtId, rloc, nullptr, true);
             wuow.commit();
         });
-    } while (++numDeleted < maxToDelete);
+
+        ++numDeleted;
+        numBytesDeleted += objSize;
+
+        auto restoreStatus = exec->restoreState();
+        if (!restoreStatus.isOK()) {
+            warning() << "cursor error while trying to delete " << redact(min) << " to "
+                      << redact(max) << " in " << nss << ": " << redact(restoreStatus);
+            break;
+        }
+    }
 
     return numDeleted;
 }
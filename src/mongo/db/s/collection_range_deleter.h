@@ -153,12 +153,13 @@ public:
     void append(BSONObjBuilder* builder) const;
 
     /**
-     * If any range deletions are scheduled, deletes up to maxToDelete documents, notifying
-     * watchers of ranges as they are done being deleted. It performs its own collection locking, so
-     * it must be called without locks.
+     * If any range deletions are scheduled, deletes up to maxToDelete documents, but no more than
+     * rangeDeleterBatchMaxBytes worth of them, notifying watchers of ranges as they are done being
+     * deleted. It performs its own collection locking, so it must be called without locks.
      *
      * If it should be scheduled to run again because there might be more documents to delete,
-     * returns the time to begin, or boost::none otherwise.
+     * returns the time to begin, or boost::none otherwise. The time is pushed out when a delay
+     * between batches is configured or when replicating the batch was slow.
      *
      * Argument 'forTestOnly' is used in unit tests that exercise the CollectionRangeDeleter class,
      * so that they do not need to set up CollectionShardingState and MetadataManager objects.
@@ -171,8 +172,9 @@ public:
 
 private:
     /**
-     * Performs the deletion of up to maxToDelete entries within the range in progress. Must be
-     * called under the collection lock.
+     * Performs the deletion of up to maxToDelete entries, totalling at most
+     * rangeDeleterBatchMaxBytes, within the range in progress. Must be called under the collection
+     * lock.
      *
      * Returns the number of documents deleted, 0 if done with the range, or bad status if deleting
      * the range failed.
@@ -40,11 +40,13 @@
 #include "mongo/db/repl/replication_coordinator_mock.h"
 #include "mongo/db/s/collection_sharding_state.h"
 #include "mongo/db/s/sharding_state.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/s/balancer_configuration.h"
 #include "mongo/s/chunk_version.h"
 #include "mongo/s/client/shard_registry.h"
 #include "mongo/s/sharding_mongod_test_fixture.h"
 #include "mongo/unittest/unittest.h"
+#include "mongo/util/scopeguard.h"
 
 namespace mongo {
 namespace {
@@ -238,6 +240,43 @@ TEST_F(CollectionRangeDeleterTest, MultipleCleanupNextRangeCalls) {
     ASSERT_EQUALS(0ULL, dbclient.count(kAdminSysVer.ns(), BSON(kPattern << "startRangeDeletion")));
 }
 
+void setRangeDeleterBatchMaxBytes(int value) {
+    auto param = ServerParameterSet::getGlobal()->getMap().find("rangeDeleterBatchMaxBytes");
+    invariant(param != ServerParameterSet::getGlobal()->getMap().end());
+    ASSERT_OK(param->second->setFromString(std::to_string(value)));
+}
+
+// Tests that a batch stops once it has deleted rangeDeleterBatchMaxBytes worth of documents, even
+// if fewer than maxToDelete documents were deleted.
+TEST_F(CollectionRangeDeleterTest, BatchSizeIsLimitedByBytes) {
+    CollectionRangeDeleter rangeDeleter;
+    DBDirectClient dbclient(operationContext());
+    const std::string filler(1024, 'x');
+    for (int i = 1; i <= 4; i++) {
+        dbclient.insert(kNss.toString(), BSON(kPattern << i << "filler" << filler));
+    }
+    ASSERT_EQUALS(4ULL, dbclient.count(kNss.toString(), BSON(kPattern << LT << 5)));
+
+    std::list<Deletion> ranges;
+    auto deletion = Deletion{ChunkRange(BSON(kPattern << 0), BSON(kPattern << 10)), Date_t{}};
+    ranges.emplace_back(std::move(deletion));
+    auto when = rangeDeleter.add(std::move(ranges));
+    ASSERT(when && *when == Date_t{});
+
+    // Two documents fill a batch
+    setRangeDeleterBatchMaxBytes(2 * 1024);
+    ON_BLOCK_EXIT([] { setRangeDeleterBatchMaxBytes(4 * 1024 * 1024); });
+
+    ASSERT_TRUE(next(rangeDeleter, 100));
+    ASSERT_EQUALS(2ULL, dbclient.count(kNss.toString(), BSON(kPattern << LT << 5)));
+
+    ASSERT_TRUE(next(rangeDeleter, 100));
+    ASSERT_EQUALS(0ULL, dbclient.count(kNss.toString(), BSON(kPattern << LT << 5)));
+
+    ASSERT_TRUE(next(rangeDeleter, 100));
+    ASSERT_FALSE(next(rangeDeleter, 100));
+}
+
 // Tests the case that there are two ranges to clean, each containing multiple documents.
 TEST_F(CollectionRangeDeleterTest, MultipleDocumentsInMultipleRangesToClean) {
     CollectionRangeDeleter rangeDeleter;
@@ -603,6 +603,12 @@ uint64_t CollectionShardingState::_incrementChunkOnInsertOrUpdate(OperationConte
     auto chunk = cm->findIntersectingChunkWithSimpleCollation(shardKey);
     chunk->addBytesWritten(dataWritten);
 
+    auto const chunkFieldSummaryPublisher =
+        ShardingState::get(opCtx)->getChunkFieldSummaryPublisher();
+    if (chunkFieldSummaryPublisher->isActive()) {
+        chunkFieldSummaryPublisher->onWrite(opCtx, _nss, *cm, *chunk, document);
+    }
+
     // If the chunk becomes too large, then we call the ChunkSplitter to schedule a split. Then, we
     // reset the tracking for that chunk to 0.
     if (_shouldSplitChunk(opCtx, shardKeyPattern, *chunk)) {
@@ -0,0 +1,127 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kSharding
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/auth/action_type.h"
+#include "mongo/db/auth/authorization_session.h"
+#include "mongo/db/auth/privilege.h"
+#include "mongo/db/commands.h"
+#include "mongo/db/namespace_string.h"
+#include "mongo/db/operation_context.h"
+#include "mongo/s/catalog/sharding_catalog_manager.h"
+#include "mongo/s/catalog/type_chunk.h"
+#include "mongo/s/request_types/commit_chunk_field_summaries_gen.h"
+
+namespace mongo {
+namespace {
+
+/**
+ * Internal sharding command run on config servers to publish the summaries of non-shard-key fields
+ * for a chunk.
+ *
+ * Format:
+ * {
+ *   _configsvrCommitChunkFieldSummaries: <string namespace>,
+ *   collEpoch: <OID epoch>,
+ *   shard: <string shard>,
+ *   min: <BSONObj min>,
+ *   max: <BSONObj max>,
+ *   fieldSummaries: { <field>: { min: <value>, max: <value> }, ... },
+ *   fieldSummaryWidenings: { <field>: { min: <value>, max: <value> }, ... },
+ *   writeConcern: <BSONObj>
+ * }
+ */
+class ConfigSvrCommitChunkFieldSummariesCommand : public BasicCommand {
+public:
+    ConfigSvrCommitChunkFieldSummariesCommand()
+        : BasicCommand("_configsvrCommitChunkFieldSummaries") {}
+
+    void help(std::stringstream& help) const override {
+        help << "Internal command, which is sent by a shard to the sharding config server. Do "
+                "not call directly. Updates the field summaries of a chunk.";
+    }
+
+    bool slaveOk() const override {
+        return false;
+    }
+
+    bool adminOnly() const override {
+        return true;
+    }
+
+    bool supportsWriteConcern(const BSONObj& cmd) const override {
+        return true;
+    }
+
+    Status checkAuthForCommand(Client* client,
+                               const std::string& dbname,
+                               const BSONObj& cmdObj) override {
+        if (!AuthorizationSession::get(client)->isAuthorizedForActionsOnResource(
+                ResourcePattern::forClusterResource(), ActionType::internal)) {
+            return Status(ErrorCodes::Unauthorized, "Unauthorized");
+        }
+        return Status::OK();
+    }
+
+    std::string parseNs(const std::string& dbname, const BSONObj& cmdObj) const override {
+        return CommandHelpers::parseNsFullyQualified(dbname, cmdObj);
+    }
+
+    bool run(OperationContext* opCtx,
+             const std::string& dbName,
+             const BSONObj& cmdObj,
+             BSONObjBuilder& result) override {
+        if (serverGlobalParams.clusterRole != ClusterRole::ConfigServer) {
+            uasserted(ErrorCodes::IllegalOperation,
+                      "_configsvrCommitChunkFieldSummaries can only be run on config servers");
+        }
+
+        const auto request = ConfigsvrCommitChunkFieldSummaries::parse(
+            IDLParserErrorContext("ConfigsvrCommitChunkFieldSummaries"), cmdObj);
+
+        const auto range = uassertStatusOK(ChunkRange::fromBSON(
+            BSON(ChunkType::min(request.getMin()) << ChunkType::max(request.getMax()))));
+
+        uassertStatusOK(ShardingCatalogManager::get(opCtx)->commitChunkFieldSummaries(
+            opCtx,
+            request.get_configsvrCommitChunkFieldSummaries(),
+            request.getCollEpoch(),
+            range,
+            request.getShard().toString(),
+            request.getFieldSummaries().get_value_or(BSONObj()),
+            request.getFieldSummaryWidenings().get_value_or(BSONObj())));
+
+        return true;
+    }
+} configsvrCommitChunkFieldSummariesCmd;
+
+}  // namespace
+}  // namespace mongo
@@ -32,6 +32,8 @@
 
 #include "mongo/db/s/migration_chunk_cloner_source_legacy.h"
 
+#include <vector>
+
 #include "mongo/base/status.h"
 #include "mongo/client/read_preference.h"
 #include "mongo/db/catalog/catalog_raii.h"
@@ -274,7 +276,7 @@ Status MigrationChunkClonerSourceLegacy::awaitUntilCriticalSectionIsAppropriate(
 
         stdx::lock_guard<stdx::mutex> sl(_mutex);
 
-        const std::size_t cloneLocsRemaining = _cloneLocs.size();
+        const std::size_t cloneLocsRemaining = _cloneLocs.size() + _numCloneLocsInFlight;
 
         log() << "moveChunk data transfer progress: " << redact(res) << " mem used: " << _memoryUsed
               << " documents remaining to clone: " << cloneLocsRemaining;
@@ -460,39 +462,71 @@ Status MigrationChunkClonerSourceLegacy::nextCloneBatch(OperationContext* opCtx,
                                                         BSONArrayBuilder* arrBuilder) {
     dassert(opCtx->lockState()->isCollectionLockedForMode(_args.getNss().ns(), MODE_IS));
 
+    const int yieldIterations = internalQueryExecYieldIterations.load();
     ElapsedTracker tracker(opCtx->getServiceContext()->getFastClockSource(),
-                           internalQueryExecYieldIterations.load(),
+                           yieldIterations,
                            Milliseconds(internalQueryExecYieldPeriodMS.load()));
 
-    stdx::lock_guard<stdx::mutex> sl(_mutex);
+    // Take the record ids which this call can read off the front of the clone set and read them
+    // without holding the mutex, so that concurrent _migrateClone requests do not serialize on each
+    // other. The tracker ends the batch after 'yieldIterations' documents at the latest, and so
+    // does a full batch of average sized documents. The ids which do not make it into the batch,
+    // e.g. because the tracker's time ran out, are handed back.
+    std::vector<RecordId> cloneLocs;
+    {
+        stdx::lock_guard<stdx::mutex> sl(_mutex);
 
-    std::set<RecordId>::iterator it;
+        const uint64_t maxLocs = std::max<uint64_t>(
+            1,
+            std::min<uint64_t>(
+                std::max(yieldIterations, 1),
+                BSONObjMaxUserSize / std::max<uint64_t>(1, _averageObjectSizeForCloneLocs)));
 
-    for (it = _cloneLocs.begin(); it != _cloneLocs.end(); ++it) {
-        // We must always make progress in this method by at least one document because empty return
-        // indicates there is no more initial clone data.
-        if (arrBuilder->arrSize() && tracker.intervalHasElapsed()) {
-            break;
+        auto end = _cloneLocs.begin();
+        while (end != _cloneLocs.end() && cloneLocs.size() < maxLocs) {
+            cloneLocs.push_back(*end);
+            ++end;
         }
 
-        Snapshotted<BSONObj> doc;
-        if (collection->findDoc(opCtx, *it, &doc)) {
-            // Use the builder size instead of accumulating the document sizes directly so that we
-            // take into consideration the overhead of BSONArray indices.
-            if (arrBuilder->arrSize() &&
-                (arrBuilder->len() + doc.value().objsize() + 1024) > BSONObjMaxUserSize) {
+        _cloneLocs.erase(_cloneLocs.begin(), end);
+        _numCloneLocsInFlight += cloneLocs.size();
+    }
+
+    {
+        auto it = cloneLocs.cbegin();
+
+        const auto handBackUnreadLocs = MakeGuard([&] {
+            stdx::lock_guard<stdx::mutex> sl(_mutex);
+            _cloneLocs.insert(it, cloneLocs.cend());
+            _numCloneLocsInFlight -= cloneLocs.size();
+        });
+
+        for (; it != cloneLocs.cend(); ++it) {
+            // We must always make progress in this method by at least one document because empty
+            // return indicates there is no more initial clone data.
+            if (arrBuilder->arrSize() && tracker.intervalHasElapsed()) {
                 break;
             }
 
-            arrBuilder->append(doc.value());
+            Snapshotted<BSONObj> doc;
+            if (collection->findDoc(opCtx, *it, &doc)) {
+                // Use the builder size instead of accumulating the document sizes directly so that
+                // we take into consideration the overhead of BSONArray indices.
+                if (arrBuilder->arrSize() &&
+                    (arrBuilder->len() + doc.value().objsize() + 1024) > BSONObjMaxUserSize) {
+                    break;
+                }
+
+                arrBuilder->append(doc.value());
+            }
         }
     }
 
-    _cloneLocs.erase(_cloneLocs.begin(), it);
+    stdx::lock_guard<stdx::mutex> sl(_mutex);
 
     // If we have drained all the cloned data, there is no need to keep the delete notify executor
     // around
-    if (_cloneLocs.empty() && _deleteNotifyExec) {
+    if (_cloneLocs.empty() && !_numCloneLocsInFlight && _deleteNotifyExec) {
         // We have a different OperationContext than when we created the PlanExecutor, so need to
         // manually destroy it ourselves.
         _deleteNotifyExec->dispose(opCtx, collection->getCursorManager());
@@ -511,6 +545,7 @@ Status MigrationChunkClonerSourceLegacy::nextModsBatch(OperationContext* opCtx,
 
     // All clone data must have been drained before starting to fetch the incremental changes
     invariant(_cloneLocs.empty());
+    invariant(!_numCloneLocsInFlight);
 
     long long docSizeAccumulator = 0;
 
@@ -212,6 +212,10 @@ private:
     // List of record ids that needs to be transferred (initial clone)
     std::set<RecordId> _cloneLocs;
 
+    // Number of record ids taken off _cloneLocs by _migrateClone requests, which are still reading
+    // their documents (initial clone)
+    std::size_t _numCloneLocsInFlight{0};
+
     // The estimated average object size during the clone phase. Used for buffer size
     // pre-allocation (initial clone).
     uint64_t _averageObjectSizeForCloneLocs{0};
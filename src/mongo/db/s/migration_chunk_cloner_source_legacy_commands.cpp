@@ -43,6 +43,7 @@
 #include "mongo/db/s/migration_source_manager.h"
 #include "mongo/db/s/sharding_state.h"
 #include "mongo/db/write_concern.h"
+#include "mongo/util/fail_point_service.h"
 
 /**
  * This file contains commands, which are specific to the legacy chunk cloner source.
@@ -50,6 +51,9 @@
 namespace mongo {
 namespace {
 
+MONGO_FP_DECLARE(failMigrateClone);
+MONGO_FP_DECLARE(hangBeforeMigrateClone);
+
 /**
  * Shortcut class to perform the appropriate checks and acquire the cloner associated with the
  * currently active migration. Uses the currently registered migration for this shard and ensures
@@ -148,6 +152,12 @@ public:
         const MigrationSessionId migrationSessionId(
             uassertStatusOK(MigrationSessionId::extractFromBSON(cmdObj)));
 
+        MONGO_FAIL_POINT_PAUSE_WHILE_SET(hangBeforeMigrateClone);
+
+        uassert(ErrorCodes::InternalError,
+                "Failing _migrateClone due to failpoint.",
+                !MONGO_FAIL_POINT(failMigrateClone));
+
         boost::optional<BSONArrayBuilder> arrBuilder;
 
         // Try to maximize on the size of the buffer, which we are returning in order to have less
@@ -131,7 +131,8 @@ protected:
      * Shortcut to create BSON represenation of a moveChunk request for the specified range with
      * fixed kDonorConnStr and kRecipientConnStr, respectively.
      */
-    static MoveChunkRequest createMoveChunkRequest(const ChunkRange& chunkRange) {
+    static MoveChunkRequest createMoveChunkRequest(const ChunkRange& chunkRange,
+                                                   int64_t maxChunkSizeBytes = 1024 * 1024) {
         BSONObjBuilder cmdBuilder;
         MoveChunkRequest::appendAsCommand(
             &cmdBuilder,
@@ -141,7 +142,7 @@ protected:
             kDonorConnStr.getSetName(),
             kRecipientConnStr.getSetName(),
             chunkRange,
-            1024 * 1024,
+            maxChunkSizeBytes,
             MigrationSecondaryThrottleOptions::create(MigrationSecondaryThrottleOptions::kDefault),
             false);
 
@@ -293,6 +294,66 @@ TEST_F(MigrationChunkClonerSourceLegacyTest, CorrectDocumentsFetched) {
     futureCommit.timed_get(kFutureTimeout);
 }
 
+TEST_F(MigrationChunkClonerSourceLegacyTest, DocumentsWhichDoNotFitInABatchAreReturnedLater) {
+    // Going by the average document size, the first batch takes three documents, but only the
+    // first two of them fit in a single _migrateClone response
+    const std::string payload(7 * 1024 * 1024, 'x');
+    std::vector<BSONObj> contents;
+    for (int i = 0; i < 3; i++) {
+        contents.push_back(BSON("_id" << 100 + i << "X" << 100 + i << "payload" << payload));
+    }
+    contents.push_back(BSON("_id" << 103 << "X" << 103));
+
+    createShardedCollection(contents);
+
+    MigrationChunkClonerSourceLegacy cloner(
+        createMoveChunkRequest(ChunkRange(BSON("X" << 100), BSON("X" << 200)), 64 * 1024 * 1024),
+        kShardKeyPattern,
+        kDonorConnStr,
+        kRecipientConnStr.getServers()[0]);
+
+    {
+        auto futureStartClone = launchAsync([&]() {
+            onCommand([&](const RemoteCommandRequest& request) { return BSON("ok" << true); });
+        });
+
+        ASSERT_OK(cloner.startClone(operationContext()));
+        futureStartClone.timed_get(kFutureTimeout);
+    }
+
+    {
+        AutoGetCollection autoColl(operationContext(), kNss, MODE_IS);
+
+        for (int batch = 0; batch < 2; batch++) {
+            BSONArrayBuilder arrBuilder;
+            ASSERT_OK(
+                cloner.nextCloneBatch(operationContext(), autoColl.getCollection(), &arrBuilder));
+            ASSERT_EQ(2, arrBuilder.arrSize());
+
+            const auto arr = arrBuilder.arr();
+            ASSERT_BSONOBJ_EQ(contents[2 * batch], arr[0].Obj());
+            ASSERT_BSONOBJ_EQ(contents[2 * batch + 1], arr[1].Obj());
+        }
+
+        {
+            BSONArrayBuilder arrBuilder;
+            ASSERT_OK(
+                cloner.nextCloneBatch(operationContext(), autoColl.getCollection(), &arrBuilder));
+            ASSERT_EQ(0, arrBuilder.arrSize());
+        }
+
+        BSONObjBuilder modsBuilder;
+        ASSERT_OK(cloner.nextModsBatch(operationContext(), autoColl.getDb(), &modsBuilder));
+    }
+
+    auto futureCommit = launchAsync([&]() {
+        onCommand([&](const RemoteCommandRequest& request) { return BSON("ok" << true); });
+    });
+
+    ASSERT_OK(cloner.commitClone(operationContext()));
+    futureCommit.timed_get(kFutureTimeout);
+}
+
 TEST_F(MigrationChunkClonerSourceLegacyTest, CollectionNotFound) {
     MigrationChunkClonerSourceLegacy cloner(
         createMoveChunkRequest(ChunkRange(BSON("X" << 100), BSON("X" << 200))),
@@ -0,0 +1,211 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kSharding
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/s/migration_clone_batch_fetcher.h"
+
+#include <algorithm>
+
+#include "mongo/db/client.h"
+#include "mongo/db/operation_context.h"
+#include "mongo/db/service_context.h"
+#include "mongo/util/scopeguard.h"
+
+namespace mongo {
+
+MigrationCloneBatchFetcher::MigrationCloneBatchFetcher(ServiceContext* serviceContext,
+                                                       FetchBatchFn fetchBatch,
+                                                       int numThreads,
+                                                       long long maxBytesPerSec)
+    : _serviceContext(serviceContext),
+      _fetchBatch(std::move(fetchBatch)),
+      _maxBytesPerSec(maxBytesPerSec),
+      _maxBufferedBatches(std::max(2, numThreads)) {
+    invariant(numThreads > 0);
+
+    _numRunning = numThreads;
+    for (int i = 0; i < numThreads; i++) {
+        _threads.emplace_back([this] { _fetchBatches(); });
+    }
+}
+
+MigrationCloneBatchFetcher::~MigrationCloneBatchFetcher() {
+    shutdown();
+}
+
+boost::optional<StatusWith<BSONObj>> MigrationCloneBatchFetcher::next(OperationContext* opCtx,
+                                                                      Milliseconds timeout) {
+    stdx::unique_lock<stdx::mutex> lk(_mutex);
+    if (!opCtx->waitForConditionOrInterruptFor(_condVar, lk, timeout, [&] {
+            return !_batches.empty() || !_status.isOK() || _numRunning == 0;
+        })) {
+        return boost::none;
+    }
+
+    if (!_status.isOK()) {
+        return StatusWith<BSONObj>(_status);
+    }
+
+    if (_batches.empty()) {
+        return StatusWith<BSONObj>(BSONObj());
+    }
+
+    BSONObj batch = std::move(_batches.front());
+    _batches.pop_front();
+    _condVar.notify_all();
+
+    return StatusWith<BSONObj>(std::move(batch));
+}
+
+void MigrationCloneBatchFetcher::shutdown() {
+    {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        _shutdown = true;
+
+        for (auto opCtx : _opCtxs) {
+            stdx::lock_guard<Client> clientLock(*opCtx->getClient());
+            _serviceContext->killOperation(opCtx, ErrorCodes::Interrupted);
+        }
+    }
+    _condVar.notify_all();
+
+    for (auto& thread : _threads) {
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+}
+
+void MigrationCloneBatchFetcher::_fetchBatches() {
+    Client::initThread("migrateCloneFetcher", _serviceContext, nullptr);
+    auto opCtx = cc().makeOperationContext();
+
+    {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        _opCtxs.push_back(opCtx.get());
+    }
+
+    try {
+        while (true) {
+            uint64_t numBatchesFetchedBeforeRequest;
+            {
+                stdx::unique_lock<stdx::mutex> lk(_mutex);
+                _condVar.wait(lk, [&] {
+                    return _shutdown || !_status.isOK() || _batches.size() < _maxBufferedBatches;
+                });
+
+                _throttle(lk);
+
+                if (_shutdown || !_status.isOK()) {
+                    break;
+                }
+
+                numBatchesFetchedBeforeRequest = _numBatchesFetched;
+                ++_numFetchesInFlight;
+            }
+
+            auto swRes = [&] {
+                const auto requestDone = MakeGuard([&] {
+                    {
+                        stdx::lock_guard<stdx::mutex> lk(_mutex);
+                        --_numFetchesInFlight;
+                    }
+                    _condVar.notify_all();
+                });
+                return _fetchBatch(opCtx.get());
+            }();
+            if (!swRes.isOK()) {
+                _setStatus(swRes.getStatus());
+                break;
+            }
+
+            const BSONObj& res = swRes.getValue();
+
+            // An empty batch only means that the donor has handed out all of its documents if no
+            // other request could have been holding some of them. Those are either returned by
+            // that request or handed back to the donor once it completes with a non-empty batch.
+            if (res["objects"].Obj().isEmpty()) {
+                stdx::unique_lock<stdx::mutex> lk(_mutex);
+                _condVar.wait(lk, [&] {
+                    return _shutdown || !_status.isOK() ||
+                        _numBatchesFetched != numBatchesFetchedBeforeRequest ||
+                        _numFetchesInFlight == 0;
+                });
+
+                if (_numBatchesFetched == numBatchesFetchedBeforeRequest) {
+                    break;
+                }
+                continue;
+            }
+
+            {
+                stdx::lock_guard<stdx::mutex> lk(_mutex);
+                _bytesFetched += res.objsize();
+                _batches.push_back(res.getOwned());
+                ++_numBatchesFetched;
+            }
+            _condVar.notify_all();
+        }
+    } catch (const DBException& ex) {
+        _setStatus(ex.toStatus());
+    }
+
+    {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        _opCtxs.erase(std::find(_opCtxs.begin(), _opCtxs.end(), opCtx.get()));
+        --_numRunning;
+    }
+    _condVar.notify_all();
+}
+
+void MigrationCloneBatchFetcher::_throttle(stdx::unique_lock<stdx::mutex>& lk) {
+    if (_maxBytesPerSec <= 0) {
+        return;
+    }
+
+    const long long waitMicros = (_bytesFetched * 1000 * 1000) / _maxBytesPerSec - _timer.micros();
+    if (waitMicros > 0) {
+        _condVar.wait_for(
+            lk, Microseconds(waitMicros).toSystemDuration(), [&] { return _shutdown; });
+    }
+}
+
+void MigrationCloneBatchFetcher::_setStatus(Status status) {
+    {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        if (_status.isOK()) {
+            _status = std::move(status);
+        }
+    }
+    _condVar.notify_all();
+}
+
+}  // namespace mongo
@@ -0,0 +1,139 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <boost/optional.hpp>
+#include <deque>
+#include <vector>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/base/status_with.h"
+#include "mongo/bson/bsonobj.h"
+#include "mongo/stdx/condition_variable.h"
+#include "mongo/stdx/functional.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/stdx/thread.h"
+#include "mongo/util/time_support.h"
+#include "mongo/util/timer.h"
+
+namespace mongo {
+
+class OperationContext;
+class ServiceContext;
+
+/**
+ * Fetches the initial clone documents of a migration from the donor shard with several concurrent
+ * _migrateClone requests and buffers the returned batches until the migrate thread consumes them.
+ * The donor hands out each document to exactly one request, so the batches may be applied in any
+ * order.
+ *
+ * Each fetcher thread runs under its own client and operation context, which shutdown() kills in
+ * order to interrupt the requests in flight.
+ */
+class MigrationCloneBatchFetcher {
+    MONGO_DISALLOW_COPYING(MigrationCloneBatchFetcher);
+
+public:
+    /**
+     * Issues a single _migrateClone request against the donor and returns its response. Must
+     * return or throw promptly once 'opCtx' is killed.
+     */
+    using FetchBatchFn = stdx::function<StatusWith<BSONObj>(OperationContext* opCtx)>;
+
+    /**
+     * Starts 'numThreads' threads, which keep calling 'fetchBatch' until the donor returns an
+     * empty batch while no other request is in flight. The optional 'maxBytesPerSec' caps the
+     * combined rate of all the threads.
+     */
+    MigrationCloneBatchFetcher(ServiceContext* serviceContext,
+                               FetchBatchFn fetchBatch,
+                               int numThreads,
+                               long long maxBytesPerSec);
+    ~MigrationCloneBatchFetcher();
+
+    /**
+     * Waits for the next batch of documents. Returns the full _migrateClone response, whose
+     * "objects" array holds the documents, or an empty object once the donor has run out of
+     * documents. Returns the error of the first failed fetch, if any.
+     *
+     * Returns boost::none if no batch arrived within 'timeout', so that the caller can check
+     * whether the migration was aborted.
+     */
+    boost::optional<StatusWith<BSONObj>> next(OperationContext* opCtx, Milliseconds timeout);
+
+    /**
+     * Interrupts the requests in flight and waits for the fetcher threads to exit. Safe to call
+     * more than once. Called by the destructor.
+     */
+    void shutdown();
+
+private:
+    void _fetchBatches();
+
+    /**
+     * Waits until the bytes fetched so far by all the threads fit within '_maxBytesPerSec' or the
+     * fetcher is shut down.
+     */
+    void _throttle(stdx::unique_lock<stdx::mutex>& lk);
+
+    void _setStatus(Status status);
+
+    ServiceContext* const _serviceContext;
+    const FetchBatchFn _fetchBatch;
+    const long long _maxBytesPerSec;
+    const size_t _maxBufferedBatches;
+
+    // Protects the state below. The fetcher threads never wait on it through their operation
+    // contexts, because killing them is done while it is held.
+    stdx::mutex _mutex;
+
+    // Signalled whenever a batch is produced or consumed, a fetcher thread exits or the fetcher is
+    // shut down
+    stdx::condition_variable _condVar;
+
+    std::deque<BSONObj> _batches;
+    Status _status{Status::OK()};
+    int _numRunning{0};
+    bool _shutdown{false};
+
+    // Number of requests sent to the donor which have not completed yet, and of non-empty batches
+    // received so far
+    int _numFetchesInFlight{0};
+    uint64_t _numBatchesFetched{0};
+
+    // Operation contexts of the fetcher threads, which are still running
+    std::vector<OperationContext*> _opCtxs;
+
+    Timer _timer;
+    long long _bytesFetched{0};
+
+    std::vector<stdx::thread> _threads;
+};
+
+}  // namespace mongo
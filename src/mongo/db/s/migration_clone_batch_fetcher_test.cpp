@@ -0,0 +1,285 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <set>
+
+#include "mongo/db/client.h"
+#include "mongo/db/operation_context.h"
+#include "mongo/db/s/migration_clone_batch_fetcher.h"
+#include "mongo/db/service_context_noop.h"
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/scopeguard.h"
+
+namespace mongo {
+namespace {
+
+BSONObj makeBatch(int id) {
+    return BSON("objects" << BSON_ARRAY(BSON("_id" << id)) << "ok" << 1);
+}
+
+const BSONObj kEmptyBatch = BSON("objects" << BSONArray() << "ok" << 1);
+
+class MigrationCloneBatchFetcherTest : public unittest::Test {
+protected:
+    void setUp() override {
+        _client = _serviceCtx.makeClient("Test");
+        _opCtx = _client->makeOperationContext();
+    }
+
+    ServiceContext* serviceContext() {
+        return &_serviceCtx;
+    }
+
+    OperationContext* operationContext() const {
+        return _opCtx.get();
+    }
+
+    /**
+     * Returns the next response of the fetcher, waiting for as long as it takes.
+     */
+    StatusWith<BSONObj> nextResponse(MigrationCloneBatchFetcher* fetcher) {
+        while (true) {
+            auto swRes = fetcher->next(operationContext(), Milliseconds(100));
+            if (swRes) {
+                return *swRes;
+            }
+        }
+    }
+
+private:
+    ServiceContextNoop _serviceCtx;
+    ServiceContext::UniqueClient _client;
+    ServiceContext::UniqueOperationContext _opCtx;
+};
+
+TEST_F(MigrationCloneBatchFetcherTest, SingleThreadReturnsBatchesInOrderUntilDonorRunsOut) {
+    const int kNumBatches = 10;
+
+    stdx::mutex mutex;
+    int nextId = 0;
+
+    MigrationCloneBatchFetcher fetcher(serviceContext(),
+                                       [&](OperationContext* opCtx) -> StatusWith<BSONObj> {
+                                           stdx::lock_guard<stdx::mutex> lk(mutex);
+                                           if (nextId == kNumBatches) {
+                                               return kEmptyBatch;
+                                           }
+                                           return makeBatch(nextId++);
+                                       },
+                                       1,
+                                       0);
+
+    for (int i = 0; i < kNumBatches; i++) {
+        auto swRes = nextResponse(&fetcher);
+        ASSERT_OK(swRes.getStatus());
+        ASSERT_BSONOBJ_EQ(makeBatch(i), swRes.getValue());
+    }
+
+    auto swRes = nextResponse(&fetcher);
+    ASSERT_OK(swRes.getStatus());
+    ASSERT(swRes.getValue().isEmpty());
+}
+
+TEST_F(MigrationCloneBatchFetcherTest, MultipleThreadsReturnEveryBatchBeforeTheEnd) {
+    const int kNumBatches = 100;
+
+    stdx::mutex mutex;
+    int nextId = 0;
+
+    MigrationCloneBatchFetcher fetcher(serviceContext(),
+                                       [&](OperationContext* opCtx) -> StatusWith<BSONObj> {
+                                           stdx::lock_guard<stdx::mutex> lk(mutex);
+                                           if (nextId == kNumBatches) {
+                                               return kEmptyBatch;
+                                           }
+                                           return makeBatch(nextId++);
+                                       },
+                                       4,
+                                       0);
+
+    std::set<int> ids;
+    while (true) {
+        auto swRes = nextResponse(&fetcher);
+        ASSERT_OK(swRes.getStatus());
+        if (swRes.getValue().isEmpty()) {
+            break;
+        }
+
+        ASSERT(ids.insert(swRes.getValue()["objects"].Obj().firstElement().Obj()["_id"].Int())
+                   .second);
+    }
+
+    ASSERT_EQ(static_cast<size_t>(kNumBatches), ids.size());
+    ASSERT_EQ(0, *ids.begin());
+    ASSERT_EQ(kNumBatches - 1, *ids.rbegin());
+}
+
+TEST_F(MigrationCloneBatchFetcherTest, EmptyBatchWhileAnotherFetchIsInFlightDoesNotStopThread) {
+    const int kNumIds = 10;
+
+    stdx::mutex mutex;
+    stdx::condition_variable condVar;
+    int nextId = 0;
+    int numFetchesInFlight = 0;
+    bool firstFetchStarted = false;
+    bool emptyBatchReturned = false;
+    bool firstFetchDone = false;
+    bool fetchedConcurrentlyAfterEmptyBatch = false;
+
+    MigrationCloneBatchFetcher fetcher(
+        serviceContext(),
+        [&](OperationContext* opCtx) -> StatusWith<BSONObj> {
+            stdx::unique_lock<stdx::mutex> lk(mutex);
+            ++numFetchesInFlight;
+            condVar.notify_all();
+            const auto fetchDone = MakeGuard([&] {
+                --numFetchesInFlight;
+                condVar.notify_all();
+            });
+
+            // The first request holds every document of the donor until the other one has been
+            // answered with an empty batch
+            if (!firstFetchStarted) {
+                firstFetchStarted = true;
+                opCtx->waitForConditionOrInterrupt(condVar, lk, [&] { return emptyBatchReturned; });
+                firstFetchDone = true;
+                return makeBatch(nextId++);
+            }
+
+            if (!firstFetchDone) {
+                emptyBatchReturned = true;
+                return kEmptyBatch;
+            }
+
+            // The thread which got the empty batch must have kept fetching
+            if (!fetchedConcurrentlyAfterEmptyBatch) {
+                fetchedConcurrentlyAfterEmptyBatch = condVar.wait_for(
+                    lk, Seconds(10).toSystemDuration(), [&] { return numFetchesInFlight == 2; });
+            }
+
+            if (nextId == kNumIds) {
+                return kEmptyBatch;
+            }
+            return makeBatch(nextId++);
+        },
+        2,
+        0);
+
+    std::set<int> ids;
+    while (true) {
+        auto swRes = nextResponse(&fetcher);
+        ASSERT_OK(swRes.getStatus());
+        if (swRes.getValue().isEmpty()) {
+            break;
+        }
+
+        ASSERT(ids.insert(swRes.getValue()["objects"].Obj().firstElement().Obj()["_id"].Int())
+                   .second);
+    }
+
+    ASSERT_EQ(static_cast<size_t>(kNumIds), ids.size());
+
+    stdx::lock_guard<stdx::mutex> lk(mutex);
+    ASSERT(fetchedConcurrentlyAfterEmptyBatch);
+}
+
+TEST_F(MigrationCloneBatchFetcherTest, FailedFetchIsReturnedAfterEarlierBatches) {
+    stdx::mutex mutex;
+    int nextId = 0;
+
+    MigrationCloneBatchFetcher fetcher(serviceContext(),
+                                       [&](OperationContext* opCtx) -> StatusWith<BSONObj> {
+                                           stdx::lock_guard<stdx::mutex> lk(mutex);
+                                           if (nextId == 2) {
+                                               return Status(ErrorCodes::HostUnreachable,
+                                                             "Donor is unreachable");
+                                           }
+                                           return makeBatch(nextId++);
+                                       },
+                                       1,
+                                       0);
+
+    // The batches buffered before the failure may or may not be consumed, but the error must be
+    // reported and must not be followed by the end of the clone
+    auto swRes = nextResponse(&fetcher);
+    while (swRes.isOK()) {
+        ASSERT(!swRes.getValue().isEmpty());
+        swRes = nextResponse(&fetcher);
+    }
+
+    ASSERT_EQ(ErrorCodes::HostUnreachable, swRes.getStatus());
+    ASSERT_EQ(ErrorCodes::HostUnreachable, nextResponse(&fetcher).getStatus());
+}
+
+TEST_F(MigrationCloneBatchFetcherTest, ShutdownInterruptsFetchesInFlight) {
+    const int kNumThreads = 3;
+
+    stdx::mutex mutex;
+    stdx::condition_variable condVar;
+    int numFetchesInFlight = 0;
+    int numFetchesInterrupted = 0;
+
+    MigrationCloneBatchFetcher fetcher(
+        serviceContext(),
+        [&](OperationContext* opCtx) -> StatusWith<BSONObj> {
+            stdx::unique_lock<stdx::mutex> lk(mutex);
+            ++numFetchesInFlight;
+            condVar.notify_all();
+
+            // Simulates a donor which never responds
+            try {
+                opCtx->waitForConditionOrInterrupt(condVar, lk, [] { return false; });
+            } catch (const DBException& ex) {
+                if (ex.code() == ErrorCodes::Interrupted) {
+                    ++numFetchesInterrupted;
+                }
+                throw;
+            }
+
+            MONGO_UNREACHABLE;
+        },
+        kNumThreads,
+        0);
+
+    {
+        stdx::unique_lock<stdx::mutex> lk(mutex);
+        condVar.wait(lk, [&] { return numFetchesInFlight == kNumThreads; });
+    }
+
+    ASSERT(!fetcher.next(operationContext(), Milliseconds(10)));
+
+    fetcher.shutdown();
+
+    stdx::lock_guard<stdx::mutex> lk(mutex);
+    ASSERT_EQ(kNumThreads, numFetchesInterrupted);
+}
+
+}  // namespace
+}  // namespace mongo
@@ -36,11 +36,15 @@
 #include <vector>
 
 #include "mongo/client/connpool.h"
+#include "mongo/client/read_preference.h"
+#include "mongo/client/remote_command_targeter.h"
 #include "mongo/db/auth/authorization_manager_global.h"
 #include "mongo/db/auth/authorization_session.h"
+#include "mongo/db/catalog/collection.h"
 #include "mongo/db/catalog/collection_catalog_entry.h"
 #include "mongo/db/catalog/document_validation.h"
 #include "mongo/db/catalog/index_create.h"
+#include "mongo/db/concurrency/write_conflict_exception.h"
 #include "mongo/db/db_raii.h"
 #include "mongo/db/dbhelpers.h"
 #include "mongo/db/namespace_string.h"
@@ -49,10 +53,15 @@
 #include "mongo/db/repl/repl_client_info.h"
 #include "mongo/db/repl/replication_coordinator_global.h"
 #include "mongo/db/s/collection_sharding_state.h"
+#include "mongo/db/s/migration_clone_batch_fetcher.h"
 #include "mongo/db/s/migration_util.h"
 #include "mongo/db/s/move_timing_helper.h"
 #include "mongo/db/s/sharding_state.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/service_context.h"
+#include "mongo/executor/task_executor.h"
+#include "mongo/executor/task_executor_pool.h"
+#include "mongo/rpc/get_status_from_command_result.h"
 #include "mongo/s/catalog/type_chunk.h"
 #include "mongo/s/client/shard_registry.h"
 #include "mongo/s/grid.h"
@@ -66,6 +75,17 @@
 namespace mongo {
 namespace {
 
+// Number of connections over which the recipient of a migration concurrently fetches batches of
+// documents from the donor during the initial clone
+MONGO_EXPORT_SERVER_PARAMETER(migrateCloneFetcherThreads, int, 2);
+
+// Upper bound on the rate at which the initial clone fetches documents from the donor, 0 means
+// unlimited
+MONGO_EXPORT_SERVER_PARAMETER(migrateCloneMaxBytesPerSec, int, 0);
+
+// Maximum number of cloned documents written to the collection in a single storage transaction
+const std::ptrdiff_t kMaxCloneInsertGroupSize = 64;
+
 const WriteConcernOptions kMajorityWriteConcern(WriteConcernOptions::kMajority,
                                                 // Note: Even though we're setting UNSET here,
                                                 // kMajority implies JOURNAL if journaling is
@@ -192,6 +212,58 @@ BSONObj createTransferModsRequest(const NamespaceString& nss, const MigrationSes
     return builder.obj();
 }
 
+/**
+ * Issues a single _migrateClone request against the primary of the donor shard. Gives up on the
+ * request if 'opCtx' is interrupted, so that the recipient does not have to wait for the donor to
+ * respond in order to abort the migration.
+ */
+StatusWith<BSONObj> fetchCloneBatch(OperationContext* opCtx,
+                                    const ShardId& donorShardId,
+                                    const BSONObj& migrateCloneRequest) {
+    auto swDonorShard = Grid::get(opCtx)->shardRegistry()->getShard(opCtx, donorShardId);
+    if (!swDonorShard.isOK()) {
+        return swDonorShard.getStatus();
+    }
+
+    auto swDonorHost = swDonorShard.getValue()->getTargeter()->findHost(
+        opCtx, ReadPreferenceSetting{ReadPreference::PrimaryOnly});
+    if (!swDonorHost.isOK()) {
+        return swDonorHost.getStatus();
+    }
+
+    auto const executor = Grid::get(opCtx)->getExecutorPool()->getFixedExecutor();
+
+    auto response = std::make_shared<Notification<executor::RemoteCommandResponse>>();
+    auto swCallbackHandle = executor->scheduleRemoteCommand(
+        executor::RemoteCommandRequest(
+            swDonorHost.getValue(), "admin", migrateCloneRequest, nullptr),
+        [response](const executor::TaskExecutor::RemoteCommandCallbackArgs& args) {
+            response->set(args.response);
+        });
+    if (!swCallbackHandle.isOK()) {
+        return swCallbackHandle.getStatus();
+    }
+
+    try {
+        response->get(opCtx);
+    } catch (const DBException&) {
+        executor->cancel(swCallbackHandle.getValue());
+        throw;
+    }
+
+    const auto& responseStatus = response->get();
+    if (!responseStatus.isOK()) {
+        return responseStatus.status;
+    }
+
+    Status commandStatus = getStatusFromCommandResult(responseStatus.data);
+    if (!commandStatus.isOK()) {
+        return commandStatus.withContext("_migrateClone failed");
+    }
+
+    return responseStatus.data.getOwned();
+}
+
 // Enabling / disabling these fail points pauses / resumes MigrateStatus::_go(), the thread which
 // receives a chunk migration from the donor.
 MONGO_FP_DECLARE(migrateThreadHangAtStep1);
@@ -693,21 +765,40 @@ void MigrationDestinationManager::_migrateDriver(OperationContext* opCtx,
 
         _chunkMarkedPending = true;  // no lock needed, only the migrate thread looks.
 
+        MigrationCloneBatchFetcher fetcher(
+            serviceContext,
+            [this, migrateCloneRequest](OperationContext* fetcherOpCtx) {
+                return fetchCloneBatch(fetcherOpCtx, _fromShard, migrateCloneRequest);
+            },
+            std::max(1, migrateCloneFetcherThreads.load()),
+            migrateCloneMaxBytesPerSec.load());
+
         while (true) {
-            BSONObj res;
-            if (!conn->runCommand("admin",
-                                  migrateCloneRequest,
-                                  res)) {  // gets array of objects to copy, in disk order
-                setStateFail(str::stream() << "_migrateClone failed: " << redact(res.toString()));
-                conn.done();
+            if (getState() == ABORT) {
+                log() << "Migration aborted while copying documents";
                 return;
             }
 
-            BSONObj arr = res["objects"].Obj();
-            int thisTime = 0;
+            auto swRes = fetcher.next(opCtx, Seconds(1));
+            if (!swRes) {
+                continue;
+            }
+
+            if (!swRes->isOK()) {
+                setStateFail(swRes->getStatus().reason());
+                return;
+            }
+
+            const BSONObj& res = swRes->getValue();
+            if (res.isEmpty())
+                break;
 
-            BSONObjIterator i(arr);
-            while (i.more()) {
+            std::vector<BSONObj> docsToClone;
+            for (auto&& elem : res["objects"].Obj()) {
+                docsToClone.push_back(elem.Obj());
+            }
+
+            for (auto it = docsToClone.cbegin(); it != docsToClone.cend();) {
                 opCtx->checkForInterrupt();
 
                 if (getState() == ABORT) {
@@ -715,39 +806,23 @@ void MigrationDestinationManager::_migrateDriver(OperationContext* opCtx,
                     return;
                 }
 
-                BSONObj docToClone = i.next().Obj();
-                {
-                    OldClientWriteContext cx(opCtx, _nss.ns());
-
-                    BSONObj localDoc;
-                    if (willOverrideLocalId(opCtx,
-                                            _nss,
-                                            min,
-                                            max,
-                                            shardKeyPattern,
-                                            cx.db(),
-                                            docToClone,
-                                            &localDoc)) {
-                        const std::string errMsg = str::stream()
-                            << "cannot migrate chunk, local document " << redact(localDoc)
-                            << " has same _id as cloned "
-                            << "remote document " << redact(docToClone);
-                        warning() << errMsg;
-
-                        // Exception will abort migration cleanly
-                        uasserted(16976, errMsg);
-                    }
+                const auto groupEnd = it + std::min<std::ptrdiff_t>(kMaxCloneInsertGroupSize,
+                                                                   docsToClone.cend() - it);
+                _insertClonedDocuments(opCtx, min, max, shardKeyPattern, it, groupEnd);
 
-                    Helpers::upsert(opCtx, _nss.ns(), docToClone, true);
+                long long groupBytes = 0;
+                for (auto docIt = it; docIt != groupEnd; ++docIt) {
+                    groupBytes += docIt->objsize();
                 }
-                thisTime++;
 
                 {
                     stdx::lock_guard<stdx::mutex> statsLock(_mutex);
-                    _numCloned++;
-                    _clonedBytes += docToClone.objsize();
+                    _numCloned += groupEnd - it;
+                    _clonedBytes += groupBytes;
                 }
 
+                it = groupEnd;
+
                 if (writeConcern.shouldWaitForOtherNodes()) {
                     repl::ReplicationCoordinator::StatusAndDuration replStatus =
                         repl::ReplicationCoordinator::get(opCtx)->awaitReplication(
@@ -762,9 +837,6 @@ void MigrationDestinationManager::_migrateDriver(OperationContext* opCtx,
                     }
                 }
             }
-
-            if (thisTime == 0)
-                break;
         }
 
         timing.done(3);
@@ -931,6 +1003,61 @@ void MigrationDestinationManager::_migrateDriver(OperationContext* opCtx,
     conn.done();
 }
 
+void MigrationDestinationManager::_insertClonedDocuments(
+    OperationContext* opCtx,
+    const BSONObj& min,
+    const BSONObj& max,
+    const BSONObj& shardKeyPattern,
+    std::vector<BSONObj>::const_iterator begin,
+    std::vector<BSONObj>::const_iterator end) {
+    OldClientWriteContext cx(opCtx, _nss.ns());
+
+    std::vector<InsertStatement> toInsert;
+    for (auto it = begin; it != end; ++it) {
+        const BSONObj& docToClone = *it;
+
+        BSONObj localDoc;
+        if (willOverrideLocalId(
+                opCtx, _nss, min, max, shardKeyPattern, cx.db(), docToClone, &localDoc)) {
+            const std::string errMsg = str::stream()
+                << "cannot migrate chunk, local document " << redact(localDoc)
+                << " has same _id as cloned "
+                << "remote document " << redact(docToClone);
+            warning() << errMsg;
+
+            // Exception will abort migration cleanly
+            uasserted(16976, errMsg);
+        }
+
+        if (localDoc.isEmpty()) {
+            toInsert.emplace_back(docToClone);
+        } else {
+            Helpers::upsert(opCtx, _nss.ns(), docToClone, true);
+        }
+    }
+
+    if (toInsert.empty()) {
+        return;
+    }
+
+    Collection* const collection = cx.getCollection();
+    uassert(ErrorCodes::NamespaceNotFound,
+            str::stream() << "collection " << _nss.ns() << " was dropped during migration",
+            collection);
+
+    writeConflictRetry(opCtx, "migrateClone", _nss.ns(), [&] {
+        WriteUnitOfWork wuow(opCtx);
+        OpDebug* const nullOpDebug = nullptr;
+        uassertStatusOK(collection->insertDocuments(opCtx,
+                                                    toInsert.cbegin(),
+                                                    toInsert.cend(),
+                                                    nullOpDebug,
+                                                    true /* enforceQuota */,
+                                                    true /* fromMigrate */));
+        wuow.commit();
+    });
+}
+
 bool MigrationDestinationManager::_applyMigrateOp(OperationContext* opCtx,
                                                   const NamespaceString& nss,
                                                   const BSONObj& min,
@@ -29,6 +29,7 @@
 #pragma once
 
 #include <string>
+#include <vector>
 
 #include "mongo/base/disallow_copying.h"
 #include "mongo/bson/bsonobj.h"
@@ -143,6 +144,18 @@ private:
                         const OID& epoch,
                         const WriteConcernOptions& writeConcern);
 
+    /**
+     * Writes a group of documents received during the initial clone under a single collection
+     * lock. Documents whose _id is not present locally are bulk inserted; the rest are upserted.
+     * Throws if a local document with the same _id as a cloned one lies outside of the range.
+     */
+    void _insertClonedDocuments(OperationContext* opCtx,
+                                const BSONObj& min,
+                                const BSONObj& max,
+                                const BSONObj& shardKeyPattern,
+                                std::vector<BSONObj>::const_iterator begin,
+                                std::vector<BSONObj>::const_iterator end);
+
     bool _applyMigrateOp(OperationContext* opCtx,
                          const NamespaceString& ns,
                          const BSONObj& min,
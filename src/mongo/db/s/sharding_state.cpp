@@ -109,6 +109,7 @@ void updateShardIdentityConfigStringCB(const string& setName, const string& newC
 
 ShardingState::ShardingState()
     : _chunkSplitter(stdx::make_unique<ChunkSplitter>()),
+      _chunkFieldSummaryPublisher(stdx::make_unique<ChunkFieldSummaryPublisher>()),
       _initializationState(static_cast<uint32_t>(InitializationState::kNew)),
       _initializationStatus(Status(ErrorCodes::InternalError, "Uninitialized value")),
       _globalInit(&initializeGlobalShardingStateForMongod) {}
@@ -204,12 +205,18 @@ ChunkSplitter* ShardingState::getChunkSplitter() {
     return _chunkSplitter.get();
 }
 
+ChunkFieldSummaryPublisher* ShardingState::getChunkFieldSummaryPublisher() {
+    return _chunkFieldSummaryPublisher.get();
+}
+
 void ShardingState::initiateChunkSplitter() {
     _chunkSplitter->initiateChunkSplitter();
+    _chunkFieldSummaryPublisher->initiate();
 }
 
 void ShardingState::interruptChunkSplitter() {
     _chunkSplitter->interruptChunkSplitter();
+    _chunkFieldSummaryPublisher->interrupt();
 }
 
 void ShardingState::setGlobalInitMethodForTest(GlobalInitFunc func) {
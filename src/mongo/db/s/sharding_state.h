@@ -35,6 +35,7 @@
 #include "mongo/bson/oid.h"
 #include "mongo/db/namespace_string.h"
 #include "mongo/db/s/active_migrations_registry.h"
+#include "mongo/db/s/chunk_field_summary_publisher.h"
 #include "mongo/db/s/chunk_splitter.h"
 #include "mongo/db/s/collection_range_deleter.h"
 #include "mongo/db/s/migration_destination_manager.h"
@@ -145,15 +146,19 @@ public:
 
     ChunkSplitter* getChunkSplitter();
 
+    ChunkFieldSummaryPublisher* getChunkFieldSummaryPublisher();
+
     /**
      * Should be invoked when the shard server primary enters the 'PRIMARY' state.
-     * Sets up the ChunkSplitter to begin accepting split requests.
+     * Sets up the ChunkSplitter to begin accepting split requests and the
+     * ChunkFieldSummaryPublisher to begin publishing.
      */
     void initiateChunkSplitter();
 
     /**
      * Should be invoked when this node which is currently serving as a 'PRIMARY' steps down.
-     * Sets the state of the ChunkSplitter so that it will no longer accept split requests.
+     * Sets the state of the ChunkSplitter so that it will no longer accept split requests and
+     * stops the ChunkFieldSummaryPublisher.
      */
     void interruptChunkSplitter();
 
@@ -323,6 +328,9 @@ private:
     // Handles asynchronous auto-splitting of chunks
     std::unique_ptr<ChunkSplitter> _chunkSplitter;
 
+    // Handles asynchronous publishing of chunk field summaries
+    std::unique_ptr<ChunkFieldSummaryPublisher> _chunkFieldSummaryPublisher;
+
     // Protects state below
     stdx::mutex _mutex;
 
@@ -43,13 +43,25 @@
 #include "mongo/db/namespace_string.h"
 #include "mongo/db/query/internal_plans.h"
 #include "mongo/db/query/plan_executor.h"
+#include "mongo/db/storage/record_store.h"
+#include "mongo/s/shard_key_pattern.h"
 #include "mongo/util/log.h"
+#include "mongo/util/timer.h"
 
 namespace mongo {
 namespace {
 
 const int kMaxObjectPerChunk{250000};
 
+// Upper bound on the number of random documents looked at by sampleSplitPoints
+const int kMaxSampledDocuments{10000};
+
+// Sampling stops early once this many of the sampled documents fall into the chunk
+const int kTargetInRangeSamples{1000};
+
+// Below this many samples inside the chunk, the estimates are too rough to be used
+const int kMinInRangeSamples{100};
+
 BSONObj prettyKey(const BSONObj& keyPattern, const BSONObj& key) {
     return key.replaceFieldNames(keyPattern).clientReadable();
 }
@@ -277,4 +289,133 @@ StatusWith<std::vector<BSONObj>> splitVector(OperationContext* opCtx,
     return splitKeys;
 }
 
+StatusWith<boost::optional<std::vector<BSONObj>>> sampleSplitPoints(OperationContext* opCtx,
+                                                                    const NamespaceString& nss,
+                                                                    const BSONObj& keyPattern,
+                                                                    const BSONObj& min,
+                                                                    const BSONObj& max,
+                                                                    long long maxChunkSizeBytes) {
+    if (maxChunkSizeBytes <= 0) {
+        return {ErrorCodes::InvalidOptions, "need to specify the desired max chunk size"};
+    }
+
+    const ShardKeyPattern shardKeyPattern(keyPattern);
+
+    AutoGetCollection autoColl(opCtx, nss, MODE_IS);
+
+    Collection* const collection = autoColl.getCollection();
+    if (!collection) {
+        return {ErrorCodes::NamespaceNotFound, "ns not found"};
+    }
+
+    const long long recCount = collection->numRecords(opCtx);
+    const long long dataSize = collection->dataSize(opCtx);
+
+    // If there's not enough data for more than one chunk, no point continuing.
+    if (dataSize < maxChunkSizeBytes || recCount == 0) {
+        return boost::optional<std::vector<BSONObj>>(std::vector<BSONObj>());
+    }
+
+    // A chunk which is considered for splitting holds about maxChunkSizeBytes of data. If that is
+    // too small a share of the collection for enough of the samples to be expected to fall into
+    // it, sampling would only be wasted work before the scan.
+    if (double(maxChunkSizeBytes) / dataSize * kMaxSampledDocuments < kMinInRangeSamples) {
+        return boost::optional<std::vector<BSONObj>>();
+    }
+
+    auto cursor = collection->getRecordStore()->getRandomCursor(opCtx);
+    if (!cursor) {
+        return boost::optional<std::vector<BSONObj>>();
+    }
+
+    Timer timer;
+
+    std::vector<BSONObj> sampledKeys;
+    int numSampled = 0;
+    while (numSampled < kMaxSampledDocuments &&
+           sampledKeys.size() < size_t(kTargetInRangeSamples)) {
+        auto record = cursor->next();
+        if (!record) {
+            break;
+        }
+
+        numSampled++;
+
+        const BSONObj key = shardKeyPattern.extractShardKeyFromDoc(record->data.toBson());
+        if (key.isEmpty()) {
+            // Documents without a complete shard key are indexed under null values, which the
+            // sample cannot place reliably
+            return boost::optional<std::vector<BSONObj>>();
+        }
+
+        if (key.woCompare(min) >= 0 && key.woCompare(max) < 0) {
+            sampledKeys.push_back(key.getOwned());
+        }
+
+        // Give up as soon as the remaining samples can no longer produce enough hits
+        if (sampledKeys.size() + (kMaxSampledDocuments - numSampled) <
+            size_t(kMinInRangeSamples)) {
+            return boost::optional<std::vector<BSONObj>>();
+        }
+
+        if (numSampled % 1000 == 0) {
+            opCtx->checkForInterrupt();
+        }
+    }
+
+    if (sampledKeys.size() < size_t(kMinInRangeSamples)) {
+        return boost::optional<std::vector<BSONObj>>();
+    }
+
+    // Same target number of documents per chunk as splitVector, applied to the estimated number of
+    // documents in the chunk
+    const long long avgRecSize = std::max(dataSize / recCount, 1LL);
+    const long long keyCount =
+        std::max(std::min(maxChunkSizeBytes / (2 * avgRecSize), (long long)kMaxObjectPerChunk),
+                 1LL);
+    const double estimatedChunkDocs = double(recCount) * sampledKeys.size() / numSampled;
+
+    std::sort(sampledKeys.begin(),
+              sampledKeys.end(),
+              SimpleBSONObjComparator::kInstance.makeLessThan());
+
+    auto splitKeys = pickSplitPointsFromSample(sampledKeys, min, estimatedChunkDocs, keyCount);
+
+    LOG(1) << "sampled " << numSampled << " documents, " << sampledKeys.size()
+           << " in chunk " << nss.toString() << " " << redact(min) << " -->> " << redact(max)
+           << ", estimated " << (long long)estimatedChunkDocs << " documents and picked "
+           << splitKeys.size() << " split points in " << timer.millis() << "ms";
+
+    return boost::optional<std::vector<BSONObj>>(std::move(splitKeys));
+}
+
+std::vector<BSONObj> pickSplitPointsFromSample(const std::vector<BSONObj>& sortedSampledKeys,
+                                               const BSONObj& min,
+                                               double estimatedChunkDocs,
+                                               long long keyCount) {
+    std::vector<BSONObj> splitKeys;
+    if (sortedSampledKeys.empty() || estimatedChunkDocs <= 0) {
+        return splitKeys;
+    }
+
+    // splitVector picks every (keyCount + 1)-th key, which maps to the following stride over the
+    // sorted sample
+    const double stride = double(sortedSampledKeys.size()) * (keyCount + 1) / estimatedChunkDocs;
+
+    for (double pos = stride; pos < sortedSampledKeys.size(); pos += stride) {
+        const BSONObj& candidate = sortedSampledKeys[size_t(pos)];
+
+        // A split point must be strictly inside the chunk and all instances of a key value must
+        // stay in the same chunk
+        if (candidate.woCompare(min) == 0 ||
+            (!splitKeys.empty() && candidate.woCompare(splitKeys.back()) == 0)) {
+            continue;
+        }
+
+        splitKeys.push_back(candidate);
+    }
+
+    return splitKeys;
+}
+
 }  // namespace mongo
@@ -66,4 +66,33 @@ StatusWith<std::vector<BSONObj>> splitVector(OperationContext* opCtx,
                                              boost::optional<long long> maxChunkSize,
                                              boost::optional<long long> maxChunkSizeBytes);
 
+/**
+ * Approximates the split points, which splitVector would return for a non-forced split of the
+ * chunk [min, max) with the given maximum size, from a bounded number of randomly sampled
+ * documents instead of a scan of the shard key index over the whole chunk. The number of documents
+ * in the chunk is estimated from the fraction of the samples which fall into it and the split
+ * points are picked at the corresponding quantiles of the sampled shard keys.
+ *
+ * Returns boost::none if the storage engine does not support random cursors, if the chunk is too
+ * small a share of the collection for the bounded sample to land in it often enough, or if the
+ * sample is not representative enough. The exact splitVector should be used instead in that case.
+ */
+StatusWith<boost::optional<std::vector<BSONObj>>> sampleSplitPoints(OperationContext* opCtx,
+                                                                    const NamespaceString& nss,
+                                                                    const BSONObj& keyPattern,
+                                                                    const BSONObj& min,
+                                                                    const BSONObj& max,
+                                                                    long long maxChunkSizeBytes);
+
+/**
+ * Picks the split points for the chunk with lower bound 'min' from a uniform sample of the shard
+ * keys in it, sorted in ascending order. 'estimatedChunkDocs' is the estimated number of documents
+ * in the chunk and a split point is picked every 'keyCount' + 1 documents, as splitVector does.
+ * Split points equal to 'min' or to the previous split point are skipped.
+ */
+std::vector<BSONObj> pickSplitPointsFromSample(const std::vector<BSONObj>& sortedSampledKeys,
+                                               const BSONObj& min,
+                                               double estimatedChunkDocs,
+                                               long long keyCount);
+
 }  // namespace mongo
@@ -300,5 +300,80 @@ TEST_F(SplitVectorTest, NoMaxChunkSize) {
     ASSERT_EQUALS(status.code(), ErrorCodes::InvalidOptions);
 }
 
+TEST_F(SplitVectorTest, SampleSplitPointsNotNeededForSmallCollection) {
+    auto splitKeys = unittest::assertGet(sampleSplitPoints(operationContext(),
+                                                           kNss,
+                                                           BSON(kPattern << 1),
+                                                           BSON(kPattern << 0),
+                                                           BSON(kPattern << 100),
+                                                           getDocSizeBytes() * 1000LL));
+    ASSERT(splitKeys);
+    ASSERT(splitKeys->empty());
+}
+
+TEST_F(SplitVectorTest, SampleSplitPointsFallsBackWithoutRandomCursor) {
+    // The storage engine used by the unit tests does not support random cursors
+    auto splitKeys = unittest::assertGet(sampleSplitPoints(operationContext(),
+                                                           kNss,
+                                                           BSON(kPattern << 1),
+                                                           BSON(kPattern << 0),
+                                                           BSON(kPattern << 100),
+                                                           getDocSizeBytes() * 10LL));
+    ASSERT_FALSE(splitKeys);
+}
+
+TEST_F(SplitVectorTest, SampleSplitPointsRequiresMaxChunkSize) {
+    auto status = sampleSplitPoints(operationContext(),
+                                    kNss,
+                                    BSON(kPattern << 1),
+                                    BSON(kPattern << 0),
+                                    BSON(kPattern << 100),
+                                    0)
+                      .getStatus();
+    ASSERT_EQUALS(status.code(), ErrorCodes::InvalidOptions);
+}
+
+std::vector<BSONObj> makeSortedKeys(std::initializer_list<int> values) {
+    std::vector<BSONObj> keys;
+    for (int value : values) {
+        keys.push_back(BSON(kPattern << value));
+    }
+    return keys;
+}
+
+TEST(PickSplitPointsFromSample, PicksQuantilesOfTheSample) {
+    std::vector<BSONObj> sample;
+    for (int i = 0; i < 100; i++) {
+        sample.push_back(BSON(kPattern << i));
+    }
+
+    // 1000 documents in the chunk and a split every 250 documents means a split at every 25th
+    // sampled key
+    auto splitKeys = pickSplitPointsFromSample(sample, BSON(kPattern << 0), 1000, 249);
+    ASSERT_EQUALS(3U, splitKeys.size());
+    ASSERT_BSONOBJ_EQ(BSON(kPattern << 25), splitKeys[0]);
+    ASSERT_BSONOBJ_EQ(BSON(kPattern << 50), splitKeys[1]);
+    ASSERT_BSONOBJ_EQ(BSON(kPattern << 75), splitKeys[2]);
+}
+
+TEST(PickSplitPointsFromSample, NoSplitPointsWhenChunkIsSmallerThanKeyCount) {
+    auto splitKeys = pickSplitPointsFromSample(
+        makeSortedKeys({0, 1, 2, 3, 4, 5, 6, 7, 8, 9}), BSON(kPattern << 0), 100, 100);
+    ASSERT(splitKeys.empty());
+}
+
+TEST(PickSplitPointsFromSample, SkipsChunkMinAndRepeatedKeys) {
+    // Every other sampled key is a split point candidate
+    auto splitKeys = pickSplitPointsFromSample(
+        makeSortedKeys({0, 0, 0, 0, 4, 4, 4, 4, 8, 9}), BSON(kPattern << 0), 10, 1);
+    ASSERT_EQUALS(2U, splitKeys.size());
+    ASSERT_BSONOBJ_EQ(BSON(kPattern << 4), splitKeys[0]);
+    ASSERT_BSONOBJ_EQ(BSON(kPattern << 8), splitKeys[1]);
+}
+
+TEST(PickSplitPointsFromSample, NoSplitPointsFromEmptySample) {
+    ASSERT(pickSplitPointsFromSample({}, BSON(kPattern << 0), 1000, 10).empty());
+}
+
 }  // namespace
 }  // namespace mongo
@@ -0,0 +1,301 @@
+/**
+ * Copyright (C) 2018 MongoDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or  modify
+ * it under the terms of the GNU Affero General Public License, version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, the copyright holders give permission to link the
+ * code of portions of this program with the OpenSSL library under certain
+ * conditions as described in each individual source file and distribute
+ * linked combinations including the program with the OpenSSL library. You
+ * must comply with the GNU Affero General Public License in all respects
+ * for all of the code used other than as permitted herein. If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so. If you do not
+ * wish to do so, delete this exception statement from your version. If you
+ * delete this exception statement from all source files in the program,
+ * then also delete it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kNetwork
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/stats/metrics_exporter.h"
+
+#include <asio.hpp>
+#include <asio/system_timer.hpp>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/db/client.h"
+#include "mongo/db/commands/server_status.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/db/service_context.h"
+#include "mongo/db/stats/prometheus_format.h"
+#include "mongo/stdx/memory.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/stdx/thread.h"
+#include "mongo/util/log.h"
+#include "mongo/util/mongoutils/str.h"
+#include "mongo/util/stringutils.h"
+
+namespace mongo {
+namespace {
+
+// Port on which the metrics exporter listens. The exporter is disabled if this is 0.
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(metricsExporterPort, int, 0);
+
+// Address the metrics exporter binds to. Defaults to the loopback interface so that the
+// unauthenticated endpoint is only reachable locally.
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(metricsExporterBindIp, std::string, "127.0.0.1");
+
+// Comma separated list of server status sections to export. "metrics" exports the metrics tree
+// and opLatencies is exported with its histograms.
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(metricsExporterSections,
+                                      std::string,
+                                      "opcounters,opLatencies,locks,globalLock,connections,"
+                                      "network,metrics");
+
+// How long a client has to send its request and read the response before the exporter closes the
+// connection. Connections are served on a single thread, so stalled clients must not be kept.
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(metricsExporterRequestTimeoutMillis, int, 10 * 1000);
+
+constexpr StringData kMetricPrefix = "mongodb"_sd;
+constexpr size_t kMaxRequestSize = 8 * 1024;
+
+/**
+ * Serves the exported metrics over HTTP. All network activity, including generating the metrics,
+ * happens on a single thread running the io_context, so scrapes are serialized.
+ */
+class MetricsExporter {
+    MONGO_DISALLOW_COPYING(MetricsExporter);
+
+public:
+    explicit MetricsExporter(BSONObj sectionSpec)
+        : _sectionSpec(std::move(sectionSpec)), _acceptor(_ioContext) {}
+
+    Status start(const std::string& bindIp, int port) {
+        asio::error_code ec;
+        const auto address = asio::ip::make_address(bindIp, ec);
+        if (ec) {
+            return {ErrorCodes::BadValue,
+                    str::stream() << "Invalid metricsExporterBindIp '" << bindIp
+                                  << "': " << ec.message()};
+        }
+
+        const asio::ip::tcp::endpoint endpoint(address, port);
+        _acceptor.open(endpoint.protocol(), ec);
+        if (!ec) {
+            _acceptor.set_option(asio::ip::tcp::acceptor::reuse_address(true), ec);
+        }
+        if (!ec) {
+            _acceptor.bind(endpoint, ec);
+        }
+        if (!ec) {
+            _acceptor.listen(asio::socket_base::max_listen_connections, ec);
+        }
+        if (ec) {
+            return {ErrorCodes::SocketException,
+                    str::stream() << "Failed to listen for metrics exporter connections on "
+                                  << bindIp << ":" << port << ": " << ec.message()};
+        }
+
+        _accept();
+
+        _thread = stdx::thread([this] {
+            Client::initThread("MetricsExporter");
+            _ioContext.run();
+        });
+
+        log() << "Exporting metrics on " << bindIp << ":" << port;
+        return Status::OK();
+    }
+
+    void shutdown() {
+        _ioContext.stop();
+        if (_thread.joinable()) {
+            _thread.join();
+        }
+    }
+
+    /**
+     * Generates the exported sections and renders them in the Prometheus text format.
+     */
+    std::string collect() {
+        auto opCtx = cc().makeOperationContext();
+
+        BSONObjBuilder statsBuilder;
+        appendServerStatusSections(opCtx.get(), _sectionSpec, &statsBuilder);
+
+        StringBuilder text;
+        appendPrometheusText(kMetricPrefix, statsBuilder.done(), &text);
+        return text.str();
+    }
+
+private:
+    struct Connection {
+        explicit Connection(asio::io_context& ioContext)
+            : socket(ioContext), deadline(ioContext), requestBuffer(kMaxRequestSize) {}
+
+        asio::ip::tcp::socket socket;
+        asio::system_timer deadline;
+        asio::streambuf requestBuffer;
+        std::string response;
+    };
+
+    void _accept() {
+        auto connection = std::make_shared<Connection>(_ioContext);
+        _acceptor.async_accept(connection->socket, [this, connection](const asio::error_code& ec) {
+            if (ec == asio::error::operation_aborted) {
+                return;
+            }
+            if (!ec) {
+                _readRequest(connection);
+            }
+            _accept();
+        });
+    }
+
+    void _readRequest(std::shared_ptr<Connection> connection) {
+        // Closing the socket aborts whichever read or write is outstanding when the deadline hits.
+        connection->deadline.expires_after(
+            Milliseconds(metricsExporterRequestTimeoutMillis).toSystemDuration());
+        connection->deadline.async_wait([connection](const asio::error_code& ec) {
+            if (ec == asio::error::operation_aborted) {
+                return;
+            }
+            LOG(2) << "Closing metrics exporter connection which timed out";
+            asio::error_code ignored;
+            connection->socket.close(ignored);
+        });
+
+        asio::async_read_until(
+            connection->socket,
+            connection->requestBuffer,
+            "\r\n\r\n",
+            [this, connection](const asio::error_code& ec, size_t) {
+                if (ec) {
+                    LOG(2) << "Failed to read metrics exporter request: " << ec.message();
+                    connection->deadline.cancel();
+                    return;
+                }
+
+                std::istream requestStream(&connection->requestBuffer);
+                std::string method, target;
+                requestStream >> method >> target;
+
+                _writeResponse(connection, _handleRequest(method, target));
+            });
+    }
+
+    std::string _handleRequest(const std::string& method, const std::string& target) {
+        if (method != "GET") {
+            return _formatResponse("405 Method Not Allowed", "");
+        }
+        if (target != "/metrics") {
+            return _formatResponse("404 Not Found", "");
+        }
+
+        try {
+            return _formatResponse("200 OK", collect());
+        } catch (const DBException& ex) {
+            warning() << "Failed to collect exported metrics: " << redact(ex);
+            return _formatResponse("500 Internal Server Error", "");
+        }
+    }
+
+    static std::string _formatResponse(StringData status, const std::string& body) {
+        return str::stream() << "HTTP/1.1 " << status << "\r\n"
+                             << "Content-Type: text/plain; version=0.0.4\r\n"
+                             << "Content-Length: " << body.size() << "\r\n"
+                             << "Connection: close\r\n\r\n"
+                             << body;
+    }
+
+    void _writeResponse(std::shared_ptr<Connection> connection, std::string response) {
+        connection->response = std::move(response);
+        asio::async_write(connection->socket,
+                          asio::buffer(connection->response),
+                          [connection](const asio::error_code& ec, size_t) {
+                              if (ec) {
+                                  LOG(2) << "Failed to write metrics exporter response: "
+                                         << ec.message();
+                              }
+                              connection->deadline.cancel();
+                              asio::error_code ignored;
+                              connection->socket.shutdown(asio::ip::tcp::socket::shutdown_both,
+                                                          ignored);
+                          });
+    }
+
+    const BSONObj _sectionSpec;
+
+    asio::io_context _ioContext;
+    asio::ip::tcp::acceptor _acceptor;
+    stdx::thread _thread;
+};
+
+stdx::mutex exporterMutex;
+std::unique_ptr<MetricsExporter> exporter;
+
+BSONObj makeSectionSpec(const std::string& sections) {
+    std::vector<std::string> sectionNames;
+    splitStringDelim(sections, &sectionNames, ',');
+
+    BSONObjBuilder specBuilder;
+    for (const auto& sectionName : sectionNames) {
+        if (sectionName.empty()) {
+            continue;
+        }
+        if (sectionName == "opLatencies") {
+            specBuilder.append(sectionName, BSON("histograms" << true));
+        } else {
+            specBuilder.append(sectionName, 1);
+        }
+    }
+    return specBuilder.obj();
+}
+
+}  // namespace
+
+Status startMetricsExporter(ServiceContext* serviceContext) {
+    if (metricsExporterPort <= 0) {
+        return Status::OK();
+    }
+
+    stdx::lock_guard<stdx::mutex> lk(exporterMutex);
+    invariant(!exporter);
+
+    auto newExporter =
+        stdx::make_unique<MetricsExporter>(makeSectionSpec(metricsExporterSections));
+    auto status = newExporter->start(metricsExporterBindIp, metricsExporterPort);
+    if (!status.isOK()) {
+        return status;
+    }
+
+    exporter = std::move(newExporter);
+    return Status::OK();
+}
+
+void shutdownMetricsExporter() {
+    stdx::lock_guard<stdx::mutex> lk(exporterMutex);
+    if (exporter) {
+        exporter->shutdown();
+        exporter.reset();
+    }
+}
+
+}  // namespace mongo
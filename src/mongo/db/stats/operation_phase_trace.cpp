@@ -0,0 +1,181 @@
+/**
+ * Copyright (C) 2018 MongoDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or  modify
+ * it under the terms of the GNU Affero General Public License, version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, the copyright holders give permission to link the
+ * code of portions of this program with the OpenSSL library under certain
+ * conditions as described in each individual source file and distribute
+ * linked combinations including the program with the OpenSSL library. You
+ * must comply with the GNU Affero General Public License in all respects
+ * for all of the code used other than as permitted herein. If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so. If you do not
+ * wish to do so, delete this exception statement from your version. If you
+ * delete this exception statement from all source files in the program,
+ * then also delete it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/stats/operation_phase_trace.h"
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/util/assert_util.h"
+#include "mongo/util/mongoutils/str.h"
+
+namespace mongo {
+namespace {
+
+// Enables per-operation phase tracing for operations started after it is set.
+MONGO_EXPORT_SERVER_PARAMETER(operationPhaseTracing, bool, false);
+
+}  // namespace
+
+constexpr int OperationPhaseTrace::kNumPhases;
+constexpr size_t OperationPhaseTrace::kMaxTransitions;
+
+const OperationContext::Decoration<OperationPhaseTrace> OperationPhaseTrace::get =
+    OperationContext::declareDecoration<OperationPhaseTrace>();
+
+OperationPhaseTrace::ScopedPhase::ScopedPhase(OperationContext* opCtx, Phase phase)
+    : _trace(opCtx && get(opCtx).isActive() ? &get(opCtx) : nullptr) {
+    if (_trace) {
+        _previousPhase = _trace->enterPhase(phase);
+    }
+}
+
+OperationPhaseTrace::ScopedPhase::~ScopedPhase() {
+    if (_trace) {
+        _trace->enterPhase(_previousPhase);
+    }
+}
+
+bool OperationPhaseTrace::isEnabled() {
+    return operationPhaseTracing.load();
+}
+
+StringData OperationPhaseTrace::phaseName(Phase phase) {
+    switch (phase) {
+        case Phase::kQueued:
+            return "queued"_sd;
+        case Phase::kExecuting:
+            return "executing"_sd;
+        case Phase::kTicketAcquisition:
+            return "ticketAcquisition"_sd;
+        case Phase::kLockWait:
+            return "lockWait"_sd;
+    }
+    MONGO_UNREACHABLE;
+}
+
+void OperationPhaseTrace::start(TickSource* tickSource, TickSource::Tick queuedSince) {
+    invariant(!isActive());
+
+    const auto now = tickSource->getTicks();
+    _startTick = queuedSince ? queuedSince : now;
+
+    _currentPhase.store(static_cast<int>(Phase::kQueued));
+    _currentPhaseStartTick.store(_startTick);
+    _transitions[0] = {Phase::kQueued, _startTick};
+    _numTransitions = 1;
+
+    _ticksPerSecond.store(tickSource->getTicksPerSecond());
+    _tickSource.store(tickSource);
+
+    enterPhase(Phase::kExecuting);
+}
+
+OperationPhaseTrace::Phase OperationPhaseTrace::enterPhase(Phase phase) {
+    invariant(isActive());
+
+    const auto now = _tickSource.load()->getTicks();
+    const auto previous = static_cast<Phase>(_currentPhase.load());
+
+    auto& ticksInPrevious = _ticksInPhase[static_cast<int>(previous)];
+    ticksInPrevious.store(ticksInPrevious.load() + (now - _currentPhaseStartTick.load()));
+
+    _currentPhaseStartTick.store(now);
+    _currentPhase.store(static_cast<int>(phase));
+
+    _transitions[_numTransitions % kMaxTransitions] = {phase, now};
+    ++_numTransitions;
+
+    return previous;
+}
+
+Microseconds OperationPhaseTrace::getTimeInPhase(Phase phase) const {
+    const auto tickSource = _tickSource.load();
+    if (!tickSource) {
+        return Microseconds(0);
+    }
+
+    auto ticks = _ticksInPhase[static_cast<int>(phase)].load();
+    if (_currentPhase.load() == static_cast<int>(phase)) {
+        ticks += tickSource->getTicks() - _currentPhaseStartTick.load();
+    }
+
+    return _ticksToMicros(ticks);
+}
+
+void OperationPhaseTrace::append(BSONObjBuilder* builder) const {
+    if (!isActive()) {
+        return;
+    }
+
+    BSONObjBuilder phaseBuilder(builder->subobjStart("phaseMicros"));
+    for (int i = 0; i < kNumPhases; ++i) {
+        const auto phase = static_cast<Phase>(i);
+        phaseBuilder.append(phaseName(phase),
+                            durationCount<Microseconds>(getTimeInPhase(phase)));
+    }
+}
+
+void OperationPhaseTrace::appendTransitions(BSONArrayBuilder* builder) const {
+    if (!isActive()) {
+        return;
+    }
+
+    const size_t first = _numTransitions > kMaxTransitions ? _numTransitions - kMaxTransitions : 0;
+    for (size_t i = first; i < _numTransitions; ++i) {
+        const auto& transition = _transitions[i % kMaxTransitions];
+        BSONObjBuilder transitionBuilder(builder->subobjStart());
+        transitionBuilder.append("phase", phaseName(transition.phase));
+        transitionBuilder.append(
+            "micros", durationCount<Microseconds>(_ticksToMicros(transition.tick - _startTick)));
+    }
+}
+
+std::string OperationPhaseTrace::toString() const {
+    if (!isActive()) {
+        return "";
+    }
+
+    str::stream ss;
+    ss << "{";
+    for (int i = 0; i < kNumPhases; ++i) {
+        const auto phase = static_cast<Phase>(i);
+        ss << (i ? ", " : " ") << phaseName(phase) << ": "
+           << durationCount<Microseconds>(getTimeInPhase(phase));
+    }
+    ss << " }";
+    return ss;
+}
+
+Microseconds OperationPhaseTrace::_ticksToMicros(TickSource::Tick ticks) const {
+    const auto ticksPerSecond = _ticksPerSecond.load();
+    return Microseconds(static_cast<long long>(ticks * (1000 * 1000.0 / ticksPerSecond)));
+}
+
+}  // namespace mongo
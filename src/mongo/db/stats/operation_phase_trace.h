@@ -0,0 +1,166 @@
+/**
+ * Copyright (C) 2018 MongoDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or  modify
+ * it under the terms of the GNU Affero General Public License, version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, the copyright holders give permission to link the
+ * code of portions of this program with the OpenSSL library under certain
+ * conditions as described in each individual source file and distribute
+ * linked combinations including the program with the OpenSSL library. You
+ * must comply with the GNU Affero General Public License in all respects
+ * for all of the code used other than as permitted herein. If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so. If you do not
+ * wish to do so, delete this exception statement from your version. If you
+ * delete this exception statement from all source files in the program,
+ * then also delete it in the license file.
+ */
+
+#pragma once
+
+#include <array>
+#include <string>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/base/string_data.h"
+#include "mongo/db/operation_context.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/util/tick_source.h"
+#include "mongo/util/time_support.h"
+
+namespace mongo {
+
+class BSONArrayBuilder;
+class BSONObjBuilder;
+
+/**
+ * Records where an operation's time goes by tracking timestamped transitions between the phases
+ * it moves through (waiting to be scheduled after its request was read off the network,
+ * executing, waiting for a storage engine ticket, waiting for a lock).
+ *
+ * Tracing is only active for operations started while the operationPhaseTracing server parameter
+ * is enabled; for all other operations every method below is a single branch. The last
+ * kMaxTransitions transitions are kept in a fixed-size ring buffer owned by the operation, so
+ * recording never allocates.
+ *
+ * Only the thread executing the operation may call the mutators, toString() and
+ * appendTransitions(). The per-phase totals reported by append() may be read by other threads
+ * holding the operation's Client lock, which is how $currentOp reports them.
+ */
+class OperationPhaseTrace {
+    MONGO_DISALLOW_COPYING(OperationPhaseTrace);
+
+public:
+    enum class Phase {
+        kQueued,
+        kExecuting,
+        kTicketAcquisition,
+        kLockWait,
+    };
+
+    static constexpr int kNumPhases = static_cast<int>(Phase::kLockWait) + 1;
+    static constexpr size_t kMaxTransitions = 32;
+
+    static const OperationContext::Decoration<OperationPhaseTrace> get;
+
+    /**
+     * RAII helper which moves the operation into the given phase for the duration of a scope and
+     * back to the phase it was in afterwards. Does nothing if tracing is not active.
+     */
+    class ScopedPhase {
+        MONGO_DISALLOW_COPYING(ScopedPhase);
+
+    public:
+        ScopedPhase(OperationContext* opCtx, Phase phase);
+        ~ScopedPhase();
+
+    private:
+        OperationPhaseTrace* const _trace;
+        Phase _previousPhase{Phase::kExecuting};
+    };
+
+    // Decoration requires a default constructor.
+    OperationPhaseTrace() = default;
+
+    /**
+     * Returns whether newly started operations should be traced.
+     */
+    static bool isEnabled();
+
+    static StringData phaseName(Phase phase);
+
+    /**
+     * Starts tracing this operation. If 'queuedSince' is non-zero, it is the tick at which the
+     * operation's request was received and the time until now is accounted to Phase::kQueued.
+     * The operation is then in Phase::kExecuting.
+     */
+    void start(TickSource* tickSource, TickSource::Tick queuedSince);
+
+    bool isActive() const {
+        return _tickSource.load() != nullptr;
+    }
+
+    /**
+     * Moves the operation into 'phase' and returns the phase it was in before. Must only be called
+     * while tracing is active.
+     */
+    Phase enterPhase(Phase phase);
+
+    /**
+     * Returns the time spent so far in 'phase', including the time spent in it since the last
+     * transition if it is the current phase.
+     */
+    Microseconds getTimeInPhase(Phase phase) const;
+
+    /**
+     * Appends a "phaseMicros" subobject with the time spent in each phase. Appends nothing if
+     * tracing is not active.
+     */
+    void append(BSONObjBuilder* builder) const;
+
+    /**
+     * Appends the recorded transitions, oldest first, as {phase: <name>, micros: <offset from the
+     * start of the trace>} objects.
+     */
+    void appendTransitions(BSONArrayBuilder* builder) const;
+
+    /**
+     * Returns the per-phase times in the format used by slow operation log lines.
+     */
+    std::string toString() const;
+
+private:
+    struct Transition {
+        Phase phase;
+        TickSource::Tick tick;
+    };
+
+    Microseconds _ticksToMicros(TickSource::Tick ticks) const;
+
+    // Published last by start() and read by $currentOp from other threads, so it is atomic.
+    AtomicWord<TickSource*> _tickSource{nullptr};
+    TickSource::Tick _startTick{0};
+
+    // Zero until start() is called. Written last by start(), so that readers which see a non-zero
+    // value also see a consistent current phase.
+    AtomicInt64 _ticksPerSecond;
+
+    AtomicInt32 _currentPhase;
+    AtomicInt64 _currentPhaseStartTick;
+    std::array<AtomicInt64, kNumPhases> _ticksInPhase;
+
+    std::array<Transition, kMaxTransitions> _transitions;
+    size_t _numTransitions{0};
+};
+
+}  // namespace mongo
@@ -0,0 +1,130 @@
+/**
+ * Copyright (C) 2018 MongoDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or  modify
+ * it under the terms of the GNU Affero General Public License, version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, the copyright holders give permission to link the
+ * code of portions of this program with the OpenSSL library under certain
+ * conditions as described in each individual source file and distribute
+ * linked combinations including the program with the OpenSSL library. You
+ * must comply with the GNU Affero General Public License in all respects
+ * for all of the code used other than as permitted herein. If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so. If you do not
+ * wish to do so, delete this exception statement from your version. If you
+ * delete this exception statement from all source files in the program,
+ * then also delete it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/stats/operation_phase_trace.h"
+
+#include "mongo/db/jsobj.h"
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/tick_source_mock.h"
+
+namespace mongo {
+namespace {
+
+using Phase = OperationPhaseTrace::Phase;
+
+TEST(OperationPhaseTrace, InactiveTraceReportsNothing) {
+    OperationPhaseTrace trace;
+    ASSERT_FALSE(trace.isActive());
+    ASSERT_EQUALS(Microseconds(0), trace.getTimeInPhase(Phase::kExecuting));
+
+    BSONObjBuilder builder;
+    trace.append(&builder);
+    ASSERT_BSONOBJ_EQ(BSONObj(), builder.obj());
+    ASSERT_EQUALS("", trace.toString());
+}
+
+TEST(OperationPhaseTrace, AccountsQueuedTimeBeforeStart) {
+    TickSourceMock tickSource;
+    const auto received = tickSource.getTicks();
+    tickSource.advance(Milliseconds(3));
+
+    OperationPhaseTrace trace;
+    trace.start(&tickSource, received);
+    tickSource.advance(Milliseconds(7));
+
+    ASSERT_EQUALS(Microseconds(3000), trace.getTimeInPhase(Phase::kQueued));
+    ASSERT_EQUALS(Microseconds(7000), trace.getTimeInPhase(Phase::kExecuting));
+}
+
+TEST(OperationPhaseTrace, EnterPhaseAccumulatesTimeAndReturnsPreviousPhase) {
+    TickSourceMock tickSource;
+    OperationPhaseTrace trace;
+    trace.start(&tickSource, 0);
+
+    tickSource.advance(Milliseconds(1));
+    ASSERT(Phase::kExecuting == trace.enterPhase(Phase::kTicketAcquisition));
+    tickSource.advance(Milliseconds(2));
+    ASSERT(Phase::kTicketAcquisition == trace.enterPhase(Phase::kExecuting));
+    tickSource.advance(Milliseconds(4));
+    ASSERT(Phase::kExecuting == trace.enterPhase(Phase::kLockWait));
+    tickSource.advance(Milliseconds(8));
+    trace.enterPhase(Phase::kExecuting);
+    tickSource.advance(Milliseconds(16));
+    trace.enterPhase(Phase::kLockWait);
+    tickSource.advance(Milliseconds(32));
+
+    ASSERT_EQUALS(Microseconds(0), trace.getTimeInPhase(Phase::kQueued));
+    ASSERT_EQUALS(Microseconds(21000), trace.getTimeInPhase(Phase::kExecuting));
+    ASSERT_EQUALS(Microseconds(2000), trace.getTimeInPhase(Phase::kTicketAcquisition));
+    ASSERT_EQUALS(Microseconds(40000), trace.getTimeInPhase(Phase::kLockWait));
+
+    BSONObjBuilder builder;
+    trace.append(&builder);
+    ASSERT_BSONOBJ_EQ(BSON("phaseMicros" << BSON("queued" << 0LL << "executing" << 21000LL
+                                                          << "ticketAcquisition"
+                                                          << 2000LL
+                                                          << "lockWait"
+                                                          << 40000LL)),
+                      builder.obj());
+}
+
+TEST(OperationPhaseTrace, TransitionsKeepOnlyTheMostRecent) {
+    TickSourceMock tickSource;
+    OperationPhaseTrace trace;
+    trace.start(&tickSource, 0);
+
+    const size_t numLockWaits = OperationPhaseTrace::kMaxTransitions;
+    for (size_t i = 0; i < numLockWaits; ++i) {
+        tickSource.advance(Milliseconds(1));
+        trace.enterPhase(Phase::kLockWait);
+        trace.enterPhase(Phase::kExecuting);
+    }
+
+    BSONArrayBuilder builder;
+    trace.appendTransitions(&builder);
+    const auto transitions = builder.arr();
+
+    ASSERT_EQUALS(OperationPhaseTrace::kMaxTransitions,
+                  static_cast<size_t>(transitions.nFields()));
+
+    const auto last = transitions[static_cast<int>(OperationPhaseTrace::kMaxTransitions) - 1].Obj();
+    ASSERT_EQUALS("executing", last["phase"].String());
+    ASSERT_EQUALS(static_cast<long long>(numLockWaits * 1000), last["micros"].numberLong());
+
+    // The initial queued and executing transitions have been overwritten.
+    ASSERT_EQUALS("lockWait", transitions[0].Obj()["phase"].String());
+}
+
+TEST(OperationPhaseTrace, ScopedPhaseIsNoopWithoutOperationContext) {
+    OperationPhaseTrace::ScopedPhase scopedPhase(nullptr, Phase::kLockWait);
+}
+
+}  // namespace
+}  // namespace mongo
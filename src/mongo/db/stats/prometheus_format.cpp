@@ -0,0 +1,131 @@
+/**
+ * Copyright (C) 2018 MongoDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or  modify
+ * it under the terms of the GNU Affero General Public License, version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, the copyright holders give permission to link the
+ * code of portions of this program with the OpenSSL library under certain
+ * conditions as described in each individual source file and distribute
+ * linked combinations including the program with the OpenSSL library. You
+ * must comply with the GNU Affero General Public License in all respects
+ * for all of the code used other than as permitted herein. If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so. If you do not
+ * wish to do so, delete this exception statement from your version. If you
+ * delete this exception statement from all source files in the program,
+ * then also delete it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/stats/prometheus_format.h"
+
+#include <algorithm>
+#include <array>
+
+#include "mongo/bson/bsonobj.h"
+#include "mongo/db/stats/operation_latency_histogram.h"
+
+namespace mongo {
+namespace {
+
+bool isValidMetricNameChar(char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+}
+
+std::string makeMetricName(StringData prefix, StringData fieldName) {
+    std::string name;
+    name.reserve(prefix.size() + 1 + fieldName.size());
+    name.append(prefix.rawData(), prefix.size());
+    name.push_back('_');
+    for (char c : fieldName) {
+        name.push_back(isValidMetricNameChar(c) ? c : '_');
+    }
+    return name;
+}
+
+bool isLatencyHistogram(const BSONObj& obj) {
+    return obj["histogram"].type() == Array && obj["latency"].isNumber() && obj["ops"].isNumber();
+}
+
+void appendLatencyHistogram(const std::string& name, const BSONObj& obj, StringBuilder* out) {
+    const auto& lowerBounds = OperationLatencyHistogram::kLowerBounds;
+    const long long ops = obj["ops"].safeNumberLong();
+
+    *out << "# TYPE " << name << " histogram\n";
+
+    // The histogram only lists non-empty buckets, but scrapers expect the same bucket set on
+    // every scrape, so counts are first spread back out over all of the histogram's buckets.
+    std::array<long long, OperationLatencyHistogram::kMaxBuckets> counts{};
+    for (const auto& entry : obj["histogram"].Obj()) {
+        if (entry.type() != Object) {
+            continue;
+        }
+        const auto entryObj = entry.Obj();
+        const auto micros = static_cast<uint64_t>(entryObj["micros"].safeNumberLong());
+        const auto bucket = std::upper_bound(lowerBounds.begin(), lowerBounds.end(), micros);
+        if (bucket == lowerBounds.begin()) {
+            continue;
+        }
+        counts[bucket - lowerBounds.begin() - 1] += entryObj["count"].safeNumberLong();
+    }
+
+    // Each bucket counts the whole microseconds in [lower bound, next lower bound), so its
+    // cumulative count is reported against the largest value it holds, one less than the next
+    // bucket's lower bound. The last bucket is only covered by +Inf.
+    long long cumulativeCount = 0;
+    for (size_t i = 0; i + 1 < lowerBounds.size(); ++i) {
+        cumulativeCount += counts[i];
+        *out << name << "_bucket{le=\"" << static_cast<long long>(lowerBounds[i + 1]) - 1
+             << "\"} " << cumulativeCount << '\n';
+    }
+
+    *out << name << "_bucket{le=\"+Inf\"} " << ops << '\n';
+    *out << name << "_sum " << obj["latency"].safeNumberLong() << '\n';
+    *out << name << "_count " << ops << '\n';
+}
+
+}  // namespace
+
+void appendPrometheusText(StringData prefix, const BSONObj& stats, StringBuilder* out) {
+    for (const auto& elem : stats) {
+        const auto name = makeMetricName(prefix, elem.fieldNameStringData());
+
+        switch (elem.type()) {
+            case Object: {
+                const auto obj = elem.Obj();
+                if (isLatencyHistogram(obj)) {
+                    appendLatencyHistogram(name, obj, out);
+                } else {
+                    appendPrometheusText(name, obj, out);
+                }
+                break;
+            }
+            case NumberInt:
+            case NumberLong:
+                *out << name << ' ' << elem.safeNumberLong() << '\n';
+                break;
+            case NumberDouble:
+            case NumberDecimal:
+                *out << name << ' ' << elem.numberDouble() << '\n';
+                break;
+            case Bool:
+                *out << name << ' ' << (elem.boolean() ? 1 : 0) << '\n';
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+}  // namespace mongo
@@ -0,0 +1,54 @@
+/**
+ * Copyright (C) 2018 MongoDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or  modify
+ * it under the terms of the GNU Affero General Public License, version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, the copyright holders give permission to link the
+ * code of portions of this program with the OpenSSL library under certain
+ * conditions as described in each individual source file and distribute
+ * linked combinations including the program with the OpenSSL library. You
+ * must comply with the GNU Affero General Public License in all respects
+ * for all of the code used other than as permitted herein. If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so. If you do not
+ * wish to do so, delete this exception statement from your version. If you
+ * delete this exception statement from all source files in the program,
+ * then also delete it in the license file.
+ */
+
+#pragma once
+
+#include "mongo/base/string_data.h"
+#include "mongo/bson/bsonobj.h"
+#include "mongo/bson/util/builder.h"
+
+namespace mongo {
+
+/**
+ * Renders server status style statistics in the Prometheus text exposition format.
+ *
+ * Every numeric or boolean leaf of 'stats' becomes one sample named after 'prefix' and the path to
+ * the leaf, with the path components joined by underscores and characters which are not valid in
+ * metric names replaced by underscores. For example {opcounters: {insert: 5}} with prefix
+ * "mongodb" becomes "mongodb_opcounters_insert 5".
+ *
+ * Subobjects in the format produced by OperationLatencyHistogram::append() with histograms
+ * included ({histogram: [{micros, count}, ...], latency, ops}) are rendered as Prometheus
+ * histograms with cumulative buckets. Every histogram exposes the same fixed set of buckets, one
+ * per OperationLatencyHistogram bucket bound plus "+Inf", whether or not the buckets are empty.
+ *
+ * Strings, dates, arrays and other non-numeric values are skipped.
+ */
+void appendPrometheusText(StringData prefix, const BSONObj& stats, StringBuilder* out);
+
+}  // namespace mongo
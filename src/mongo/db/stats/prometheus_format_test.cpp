@@ -0,0 +1,146 @@
+/**
+ * Copyright (C) 2018 MongoDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or  modify
+ * it under the terms of the GNU Affero General Public License, version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, the copyright holders give permission to link the
+ * code of portions of this program with the OpenSSL library under certain
+ * conditions as described in each individual source file and distribute
+ * linked combinations including the program with the OpenSSL library. You
+ * must comply with the GNU Affero General Public License in all respects
+ * for all of the code used other than as permitted herein. If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so. If you do not
+ * wish to do so, delete this exception statement from your version. If you
+ * delete this exception statement from all source files in the program,
+ * then also delete it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/stats/prometheus_format.h"
+
+#include "mongo/db/jsobj.h"
+#include "mongo/db/stats/operation_latency_histogram.h"
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/mongoutils/str.h"
+
+namespace mongo {
+namespace {
+
+std::string render(const BSONObj& stats) {
+    StringBuilder out;
+    appendPrometheusText("mongodb", stats, &out);
+    return out.str();
+}
+
+TEST(PrometheusFormat, NumericLeavesBecomeSamples) {
+    ASSERT_EQUALS(
+        "mongodb_opcounters_insert 5\n"
+        "mongodb_opcounters_query 7\n"
+        "mongodb_network_bytesIn 1.5\n"
+        "mongodb_ok 1\n",
+        render(BSON("opcounters" << BSON("insert" << 5 << "query" << 7LL) << "network"
+                                 << BSON("bytesIn" << 1.5)
+                                 << "ok"
+                                 << true)));
+}
+
+TEST(PrometheusFormat, NonNumericValuesAreSkipped) {
+    ASSERT_EQUALS("mongodb_a_n 1\n",
+                  render(BSON("host"
+                              << "localhost"
+                              << "a"
+                              << BSON("n" << 1 << "when" << Date_t() << "list" << BSON_ARRAY(1)))));
+}
+
+TEST(PrometheusFormat, InvalidCharactersInNamesAreReplaced) {
+    ASSERT_EQUALS("mongodb_a_b_c 2\n", render(BSON("a.b-c" << 2)));
+}
+
+TEST(PrometheusFormat, LatencyHistogramsBecomeCumulativeHistograms) {
+    OperationLatencyHistogram histogram;
+    histogram.increment(1, Command::ReadWriteType::kRead);
+    histogram.increment(3, Command::ReadWriteType::kRead);
+    histogram.increment(3, Command::ReadWriteType::kRead);
+
+    BSONObjBuilder latencies;
+    {
+        BSONObjBuilder opLatencies(latencies.subobjStart("opLatencies"));
+        histogram.append(true, &opLatencies);
+    }
+
+    const auto text = render(latencies.obj());
+    ASSERT_STRING_CONTAINS(text,
+                           "# TYPE mongodb_opLatencies_reads histogram\n"
+                           "mongodb_opLatencies_reads_bucket{le=\"1\"} 1\n"
+                           "mongodb_opLatencies_reads_bucket{le=\"3\"} 3\n"
+                           "mongodb_opLatencies_reads_bucket{le=\"7\"} 3\n");
+    ASSERT_STRING_CONTAINS(text,
+                           "mongodb_opLatencies_reads_bucket{le=\"+Inf\"} 3\n"
+                           "mongodb_opLatencies_reads_sum 7\n"
+                           "mongodb_opLatencies_reads_count 3\n"
+                           "# TYPE mongodb_opLatencies_writes histogram\n"
+                           "mongodb_opLatencies_writes_bucket{le=\"1\"} 0\n");
+    ASSERT_STRING_CONTAINS(text,
+                           "mongodb_opLatencies_writes_bucket{le=\"+Inf\"} 0\n"
+                           "mongodb_opLatencies_writes_sum 0\n"
+                           "mongodb_opLatencies_writes_count 0\n");
+}
+
+TEST(PrometheusFormat, LatencyHistogramBoundaryValuesCountTowardsTheNextBucket) {
+    OperationLatencyHistogram histogram;
+    histogram.increment(2, Command::ReadWriteType::kRead);
+    histogram.increment(4, Command::ReadWriteType::kRead);
+
+    BSONObjBuilder latencies;
+    {
+        BSONObjBuilder opLatencies(latencies.subobjStart("opLatencies"));
+        histogram.append(true, &opLatencies);
+    }
+
+    ASSERT_STRING_CONTAINS(render(latencies.obj()),
+                           "# TYPE mongodb_opLatencies_reads histogram\n"
+                           "mongodb_opLatencies_reads_bucket{le=\"1\"} 0\n"
+                           "mongodb_opLatencies_reads_bucket{le=\"3\"} 1\n"
+                           "mongodb_opLatencies_reads_bucket{le=\"7\"} 2\n");
+}
+
+TEST(PrometheusFormat, LatencyHistogramsAlwaysExposeEveryBucket) {
+    const auto& lowerBounds = OperationLatencyHistogram::kLowerBounds;
+
+    OperationLatencyHistogram histogram;
+    histogram.increment(lowerBounds[10], Command::ReadWriteType::kRead);
+
+    BSONObjBuilder latencies;
+    {
+        BSONObjBuilder opLatencies(latencies.subobjStart("opLatencies"));
+        histogram.append(true, &opLatencies);
+    }
+
+    const auto text = render(latencies.obj());
+    for (size_t i = 1; i < lowerBounds.size(); ++i) {
+        const auto le = static_cast<long long>(lowerBounds[i]) - 1;
+        ASSERT_STRING_CONTAINS(text,
+                               str::stream() << "mongodb_opLatencies_reads_bucket{le=\"" << le
+                                             << "\"} "
+                                             << (i > 10 ? 1 : 0)
+                                             << "\n");
+        ASSERT_STRING_CONTAINS(text,
+                               str::stream() << "mongodb_opLatencies_writes_bucket{le=\"" << le
+                                             << "\"} 0\n");
+    }
+}
+
+}  // namespace
+}  // namespace mongo
@@ -33,6 +33,9 @@
 #include "mongo/s/async_requests_sender.h"
 
 #include "mongo/client/remote_command_targeter.h"
+#include "mongo/db/query/cursor_response.h"
+#include "mongo/db/query/killcursors_request.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/executor/remote_command_request.h"
 #include "mongo/rpc/get_status_from_command_result.h"
 #include "mongo/s/client/shard_registry.h"
@@ -48,6 +51,63 @@ namespace {
 // Maximum number of retries for network and replication notMaster errors (per host).
 const int kMaxNumFailedHostRetryAttempts = 3;
 
+// The percentile of the round trip times observed for a host after which a request which is still
+// outstanding is also sent to another host.
+const int kHedgeDelayPercentile = 95;
+
+MONGO_EXPORT_SERVER_PARAMETER(enableHedgedReads, bool, false);
+
+// Lower bound on the hedging delay, so that a shard whose members all answer very quickly does not
+// get every read sent to it twice.
+MONGO_EXPORT_SERVER_PARAMETER(hedgedReadsMinDelayMS, int, 5);
+
+/**
+ * Reports the round trip time of a request sent to 'host' to the targeter of the shard, so it can
+ * be used for host selection and for computing hedging delays.
+ */
+void recordCommandLatency(const ShardId& shardId,
+                          const HostAndPort& host,
+                          const executor::RemoteCommandResponse& response) {
+    if (!response.isOK() || !response.elapsedMillis) {
+        return;
+    }
+
+    if (const auto shard = grid.shardRegistry()->getShardNoReload(shardId)) {
+        shard->getTargeter()->updateHostCommandLatency(
+            host, duration_cast<Microseconds>(*response.elapsedMillis));
+    }
+}
+
+/**
+ * Handles the reply to a request which completed after another request for the same remote had
+ * already produced its response, by killing any cursor the losing request opened on 'host'.
+ */
+void killLosingCursor(executor::TaskExecutor* executor,
+                      const executor::RemoteCommandResponse& response,
+                      const HostAndPort& host) {
+    if (!response.isOK()) {
+        return;
+    }
+
+    auto swCursorResponse = CursorResponse::parseFromBSON(response.data);
+    if (!swCursorResponse.isOK() || swCursorResponse.getValue().getCursorId() == 0) {
+        return;
+    }
+
+    const auto& cursorResponse = swCursorResponse.getValue();
+    BSONObj cmdObj =
+        KillCursorsRequest(cursorResponse.getNSS(), {cursorResponse.getCursorId()}).toBSON();
+    executor::RemoteCommandRequest request(
+        host, cursorResponse.getNSS().db().toString(), cmdObj, nullptr);
+
+    // We do not process the response to the killCursors request (we make a good-faith attempt at
+    // cleaning up the cursor, but ignore any returned errors).
+    executor
+        ->scheduleRemoteCommand(request,
+                                [](const executor::TaskExecutor::RemoteCommandCallbackArgs&) {})
+        .status_with_transitional_ignore();
+}
+
 }  // namespace
 
 AsyncRequestsSender::AsyncRequestsSender(OperationContext* opCtx,
@@ -60,7 +120,12 @@ AsyncRequestsSender::AsyncRequestsSender(OperationContext* opCtx,
       _executor(executor),
       _db(std::move(db)),
       _readPreference(readPreference),
-      _retryPolicy(retryPolicy) {
+      _retryPolicy(retryPolicy),
+      _hedgeReads(enableHedgedReads.load() &&
+                  readPreference.pref != ReadPreference::PrimaryOnly),
+      _callbackState(std::make_shared<CallbackState>()) {
+    _callbackState->ars = this;
+
     for (const auto& request : requests) {
         _remotes.emplace_back(request.shardId, request.cmdObj);
     }
@@ -86,6 +151,12 @@ AsyncRequestsSender::~AsyncRequestsSender() {
     while (!done()) {
         next();
     }
+
+    // Requests which lost a hedging race can still be outstanding after all responses were
+    // returned. Rather than waiting for the slower host, detach from their callbacks, which kill
+    // any cursor those requests opened.
+    stdx::lock_guard<stdx::mutex> lk(_callbackState->mutex);
+    _callbackState->ars = nullptr;
 }
 
 AsyncRequestsSender::Response AsyncRequestsSender::next() {
@@ -113,6 +184,26 @@ AsyncRequestsSender::Response AsyncRequestsSender::next() {
     return *readyResponse;
 }
 
+void AsyncRequestsSender::addRequest(const AsyncRequestsSender::Request& request) {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+
+    _remotes.emplace_back(request.shardId, request.cmdObj);
+    auto& remote = _remotes.back();
+
+    auto scheduleStatus = _stopRetrying
+        ? Status(ErrorCodes::CallbackCanceled,
+                 str::stream() << "Request to remote " << remote.shardId
+                               << " was not sent because no more requests are being scheduled")
+        : _scheduleRequest(lk, _remotes.size() - 1);
+    if (!scheduleStatus.isOK()) {
+        remote.swResponse = std::move(scheduleStatus);
+        // Signal the notification, since no callback for this remote will run.
+        if (!*_notification) {
+            _notification->set();
+        }
+    }
+}
+
 void AsyncRequestsSender::stopRetrying() {
     stdx::lock_guard<stdx::mutex> lk(_mutex);
     _stopRetrying = true;
@@ -130,9 +221,29 @@ void AsyncRequestsSender::_cancelPendingRequests() {
 
     // Cancel all outstanding requests so they return immediately.
     for (auto& remote : _remotes) {
-        if (remote.cbHandle.isValid()) {
+        // Requests in a hedging race, or which already lost one, are left to complete, because a
+        // canceled request can not tell which cursor it opened on the remote host. Their replies
+        // are handled as losing responses, so that any cursor they opened gets killed.
+        if (remote.hedgeHostAndPort) {
+            if (!remote.swResponse) {
+                remote.swResponse = Status(ErrorCodes::CallbackCanceled,
+                                           str::stream() << "Request to remote " << remote.shardId
+                                                         << " was canceled");
+                if (!*_notification) {
+                    _notification->set();
+                }
+            }
+            continue;
+        }
+
+        if (remote.cbHandle.isValid() && !remote.swResponse) {
             _executor->cancel(remote.cbHandle);
         }
+
+        // Not sent yet, so there is nothing to clean up.
+        if (remote.hedgeCbHandle.isValid()) {
+            _executor->cancel(remote.hedgeCbHandle);
+        }
     }
 }
 
@@ -150,9 +261,11 @@ boost::optional<AsyncRequestsSender::Response> AsyncRequestsSender::_ready() {
     for (auto& remote : _remotes) {
         if (remote.swResponse && !remote.done) {
             remote.done = true;
+            // The shard id is copied rather than moved, since a request which lost a hedging race
+            // still needs it to report its round trip time.
             if (remote.swResponse->isOK()) {
                 invariant(remote.shardHostAndPort);
-                return Response(std::move(remote.shardId),
+                return Response(remote.shardId,
                                 std::move(remote.swResponse->getValue()),
                                 std::move(*remote.shardHostAndPort));
             } else {
@@ -161,7 +274,7 @@ boost::optional<AsyncRequestsSender::Response> AsyncRequestsSender::_ready() {
                     ErrorCodes::CallbackCanceled == remote.swResponse->getStatus().code()) {
                     remote.swResponse = _interruptStatus;
                 }
-                return Response(std::move(remote.shardId),
+                return Response(remote.shardId,
                                 std::move(remote.swResponse->getStatus()),
                                 std::move(remote.shardHostAndPort));
             }
@@ -226,7 +339,28 @@ void AsyncRequestsSender::_scheduleRequests(WithLock lk) {
     }
 }
 
-Status AsyncRequestsSender::_scheduleRequest(WithLock, size_t remoteIndex) {
+executor::TaskExecutor::RemoteCommandCallbackFn AsyncRequestsSender::_makeRemoteCommandCallback(
+    void (AsyncRequestsSender::*handler)(const executor::TaskExecutor::RemoteCommandCallbackArgs&,
+                                         size_t),
+    size_t remoteIndex) {
+    return [ state = _callbackState,
+             executor = _executor,
+             shardId = _remotes[remoteIndex].shardId,
+             handler,
+             remoteIndex ](const executor::TaskExecutor::RemoteCommandCallbackArgs& cbData) {
+        stdx::lock_guard<stdx::mutex> lk(state->mutex);
+        if (state->ars) {
+            (state->ars->*handler)(cbData, remoteIndex);
+            return;
+        }
+
+        // Every response has already been returned, so this request lost a hedging race.
+        recordCommandLatency(shardId, cbData.request.target, cbData.response);
+        killLosingCursor(executor, cbData.response, cbData.request.target);
+    };
+}
+
+Status AsyncRequestsSender::_scheduleRequest(WithLock lk, size_t remoteIndex) {
     auto& remote = _remotes[remoteIndex];
 
     invariant(!remote.cbHandle.isValid());
@@ -241,14 +375,13 @@ Status AsyncRequestsSender::_scheduleRequest(WithLock, size_t remoteIndex) {
         *remote.shardHostAndPort, _db, remote.cmdObj, _metadataObj, _opCtx);
 
     auto callbackStatus = _executor->scheduleRemoteCommand(
-        request, [=](const executor::TaskExecutor::RemoteCommandCallbackArgs& cbData) {
-            _handleResponse(cbData, remoteIndex);
-        });
+        request, _makeRemoteCommandCallback(&AsyncRequestsSender::_handleResponse, remoteIndex));
     if (!callbackStatus.isOK()) {
         return callbackStatus.getStatus();
     }
 
     remote.cbHandle = callbackStatus.getValue();
+    _scheduleHedgeTimer(lk, remoteIndex);
     return Status::OK();
 }
 
@@ -257,12 +390,26 @@ void AsyncRequestsSender::_handleResponse(
     stdx::lock_guard<stdx::mutex> lk(_mutex);
 
     auto& remote = _remotes[remoteIndex];
-    invariant(!remote.swResponse);
 
     // Clear the callback handle. This indicates that we are no longer waiting on a response from
     // 'remote'.
     remote.cbHandle = executor::TaskExecutor::CallbackHandle();
 
+    recordCommandLatency(remote.shardId, cbData.request.target, cbData.response);
+
+    // A hedged request for this remote was answered first.
+    if (remote.swResponse) {
+        invariant(_hedgeReads);
+        killLosingCursor(_executor, cbData.response, cbData.request.target);
+        return;
+    }
+
+    // A hedged request which was already sent is left to complete and clean up after itself, but
+    // one which has not been sent yet is no longer needed.
+    if (remote.hedgeCbHandle.isValid() && !remote.hedgeHostAndPort) {
+        _executor->cancel(remote.hedgeCbHandle);
+    }
+
     // Store the response or error.
     if (cbData.response.status.isOK()) {
         remote.swResponse = std::move(cbData.response);
@@ -276,6 +423,125 @@ void AsyncRequestsSender::_handleResponse(
     }
 }
 
+void AsyncRequestsSender::_scheduleHedgeTimer(WithLock, size_t remoteIndex) {
+    auto& remote = _remotes[remoteIndex];
+    if (!_hedgeReads || remote.hedgeCbHandle.isValid()) {
+        return;
+    }
+
+    const auto shard = remote.getShard();
+    if (!shard) {
+        return;
+    }
+
+    // Without enough round trip times for the host there is no telling whether it is slow.
+    const auto latency = shard->getTargeter()->getHostCommandLatencyPercentile(
+        *remote.shardHostAndPort, kHedgeDelayPercentile);
+    if (!latency) {
+        return;
+    }
+
+    const auto hedgeDelay = std::max(duration_cast<Milliseconds>(*latency),
+                                     Milliseconds(hedgedReadsMinDelayMS.load()));
+    auto callbackStatus = _executor->scheduleWorkAt(
+        _executor->now() + hedgeDelay,
+        [ state = _callbackState,
+          remoteIndex ](const executor::TaskExecutor::CallbackArgs& cbData) {
+            stdx::lock_guard<stdx::mutex> lk(state->mutex);
+            if (state->ars) {
+                state->ars->_sendHedgedRequest(cbData, remoteIndex);
+            }
+        });
+    if (!callbackStatus.isOK()) {
+        // Hedging is best-effort, so the original request simply proceeds on its own.
+        return;
+    }
+
+    remote.hedgeCbHandle = callbackStatus.getValue();
+}
+
+void AsyncRequestsSender::_sendHedgedRequest(const executor::TaskExecutor::CallbackArgs& cbData,
+                                             size_t remoteIndex) {
+    stdx::unique_lock<stdx::mutex> lk(_mutex);
+
+    // Only hedge if the original request is still waiting for its response.
+    const auto shouldHedge = [&] {
+        const auto& remote = _remotes[remoteIndex];
+        return cbData.status.isOK() && !_stopRetrying && !remote.swResponse &&
+            remote.cbHandle.isValid();
+    };
+
+    std::shared_ptr<Shard> shard;
+    if (shouldHedge()) {
+        shard = _remotes[remoteIndex].getShard();
+    }
+    if (!shard) {
+        _remotes[remoteIndex].hedgeCbHandle = executor::TaskExecutor::CallbackHandle();
+        return;
+    }
+
+    // Target without holding the mutex. The callback state stays locked, so the ARS is not
+    // destroyed in the meantime.
+    const auto originalHost = *_remotes[remoteIndex].shardHostAndPort;
+    lk.unlock();
+    auto swHedgeHost = shard->getTargeter()->findHostExcluding(_readPreference, {originalHost});
+    lk.lock();
+
+    auto& remote = _remotes[remoteIndex];
+    remote.hedgeCbHandle = executor::TaskExecutor::CallbackHandle();
+
+    if (!swHedgeHost.isOK() || !shouldHedge()) {
+        return;
+    }
+
+    LOG(2) << "Sending hedged request to remote " << remote.shardId << " at host "
+           << swHedgeHost.getValue() << " since host " << originalHost
+           << " has not responded yet";
+
+    executor::RemoteCommandRequest request(
+        swHedgeHost.getValue(), _db, remote.cmdObj, _metadataObj, _opCtx);
+
+    auto callbackStatus = _executor->scheduleRemoteCommand(
+        request,
+        _makeRemoteCommandCallback(&AsyncRequestsSender::_handleHedgedResponse, remoteIndex));
+    if (!callbackStatus.isOK()) {
+        return;
+    }
+
+    remote.hedgeHostAndPort = std::move(swHedgeHost.getValue());
+    remote.hedgeCbHandle = callbackStatus.getValue();
+}
+
+void AsyncRequestsSender::_handleHedgedResponse(
+    const executor::TaskExecutor::RemoteCommandCallbackArgs& cbData, size_t remoteIndex) {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+
+    auto& remote = _remotes[remoteIndex];
+    remote.hedgeCbHandle = executor::TaskExecutor::CallbackHandle();
+    remote.hedgeHostAndPort.reset();
+
+    recordCommandLatency(remote.shardId, cbData.request.target, cbData.response);
+
+    const bool succeeded = cbData.response.isOK() &&
+        getStatusFromCommandResult(cbData.response.data).isOK();
+    if (!succeeded) {
+        return;
+    }
+
+    if (remote.swResponse) {
+        killLosingCursor(_executor, cbData.response, cbData.request.target);
+        return;
+    }
+
+    // The original request is left to complete and clean up after itself.
+    remote.swResponse = cbData.response;
+    remote.shardHostAndPort = cbData.request.target;
+
+    if (!*_notification) {
+        _notification->set();
+    }
+}
+
 AsyncRequestsSender::Request::Request(ShardId shardId, BSONObj cmdObj)
     : shardId(shardId), cmdObj(cmdObj) {}
 
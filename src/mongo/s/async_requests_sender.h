@@ -29,6 +29,7 @@
 #pragma once
 
 #include <boost/optional.hpp>
+#include <memory>
 #include <vector>
 
 #include "mongo/base/disallow_copying.h"
@@ -78,6 +79,12 @@ namespace mongo {
  *     }
  * }
  *
+ * When the enableHedgedReads server parameter is set and the read preference allows secondaries,
+ * a request which has not been answered within the 95th percentile of the round trip times seen
+ * for its host is also sent to another eligible host of the same shard, and the first successful
+ * reply is returned. The ARS does not wait for the losing request, which kills any cursor it opened
+ * once it completes.
+ *
  * Does not throw exceptions.
  */
 class AsyncRequestsSender {
@@ -131,7 +138,7 @@ public:
 
     /**
      * Ensures pending network I/O for any outstanding requests has been canceled and waits for
-     * outstanding callbacks to complete.
+     * outstanding callbacks to complete. Requests which lost a hedging race are not waited for.
      */
     ~AsyncRequestsSender();
 
@@ -152,6 +159,16 @@ public:
      */
     Response next();
 
+    /**
+     * Schedules an additional request, whose response is returned by next() along with those of
+     * the requests the ARS was constructed with. May be called between calls to next(), including
+     * after done() has become true, in which case it becomes false again.
+     *
+     * If the ARS has already stopped retrying because the operation was interrupted or
+     * stopRetrying() was called, the request is not sent and its response is an error.
+     */
+    void addRequest(const AsyncRequestsSender::Request& request);
+
     /**
      * Stops the ARS from retrying requests.
      *
@@ -161,6 +178,19 @@ public:
     void stopRetrying();
 
 private:
+    /**
+     * State shared between the ARS and the callbacks it schedules on the executor, which may
+     * outlive the ARS.
+     */
+    struct CallbackState {
+        // Held while a callback runs, so the ARS is not destroyed in the meantime.
+        stdx::mutex mutex;
+
+        // Is reset once the ARS is destroyed. Callbacks which run afterwards belong to requests
+        // which lost a hedging race, and only clean up after themselves.
+        AsyncRequestsSender* ars;
+    };
+
     /**
      * We instantiate one of these per remote host.
      */
@@ -200,6 +230,14 @@ private:
         // The callback handle to an outstanding request for this remote.
         executor::TaskExecutor::CallbackHandle cbHandle;
 
+        // The host to which a hedged copy of the command was sent. Is unset unless a hedged
+        // request is outstanding.
+        boost::optional<HostAndPort> hedgeHostAndPort;
+
+        // The callback handle to the timer which sends the hedged request or, once it has been
+        // sent, to the outstanding hedged request.
+        executor::TaskExecutor::CallbackHandle hedgeCbHandle;
+
         // Whether this remote's result has been returned.
         bool done = false;
     };
@@ -230,6 +268,15 @@ private:
      */
     void _scheduleRequests(WithLock);
 
+    /**
+     * Returns an executor callback which runs 'handler' for the remote at 'remoteIndex' unless the
+     * ARS has been destroyed, in which case it kills any cursor the request opened instead.
+     */
+    executor::TaskExecutor::RemoteCommandCallbackFn _makeRemoteCommandCallback(
+        void (AsyncRequestsSender::*handler)(
+            const executor::TaskExecutor::RemoteCommandCallbackArgs&, size_t),
+        size_t remoteIndex);
+
     /**
      * Helper to schedule a command to a remote.
      *
@@ -251,6 +298,30 @@ private:
     void _handleResponse(const executor::TaskExecutor::RemoteCommandCallbackArgs& cbData,
                          size_t remoteIndex);
 
+    /**
+     * If reads are hedged, schedules a timer which sends a second copy of the command for the
+     * remote at 'remoteIndex' to another eligible host of its shard, in case no response has been
+     * received by the time the slowest 5% of commands sent to the original host complete.
+     */
+    void _scheduleHedgeTimer(WithLock, size_t remoteIndex);
+
+    /**
+     * The callback for the hedge timer. Sends the hedged request if the original request for the
+     * remote at 'remoteIndex' is still outstanding.
+     */
+    void _sendHedgedRequest(const executor::TaskExecutor::CallbackArgs& cbData,
+                            size_t remoteIndex);
+
+    /**
+     * The callback for a hedged remote command.
+     *
+     * A successful reply is stored as the response of the remote at 'remoteIndex' if none has been
+     * received yet, and signals the notification. Errors are ignored, and are left for the
+     * original request to report.
+     */
+    void _handleHedgedResponse(const executor::TaskExecutor::RemoteCommandCallbackArgs& cbData,
+                               size_t remoteIndex);
+
     OperationContext* _opCtx;
 
     executor::TaskExecutor* _executor;
@@ -268,6 +339,12 @@ private:
     // The policy to use when deciding whether to retry on an error.
     Shard::RetryPolicy _retryPolicy;
 
+    // Whether requests which are slow to be answered are also sent to a second host.
+    const bool _hedgeReads;
+
+    // Shared with every callback scheduled on the executor.
+    const std::shared_ptr<CallbackState> _callbackState;
+
     // Is set to a non-OK status if the client operation is interrupted.
     // When waiting for a remote to be ready, we only check for interrupt if the _interruptStatus
     // has not already been set to an error (so we can wait for callbacks for (canceled) outstanding
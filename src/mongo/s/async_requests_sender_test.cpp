@@ -0,0 +1,244 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/client/remote_command_targeter_factory_mock.h"
+#include "mongo/client/remote_command_targeter_mock.h"
+#include "mongo/db/json.h"
+#include "mongo/db/query/cursor_response.h"
+#include "mongo/db/query/killcursors_request.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/executor/network_interface_mock.h"
+#include "mongo/s/async_requests_sender.h"
+#include "mongo/s/catalog/type_shard.h"
+#include "mongo/s/sharding_test_fixture.h"
+#include "mongo/stdx/memory.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+using executor::NetworkInterfaceMock;
+using executor::RemoteCommandResponse;
+using unittest::assertGet;
+
+const HostAndPort kTestConfigShardHost = HostAndPort("FakeConfigHost", 12345);
+const ShardId kTestShardId = ShardId("FakeShard1");
+const HostAndPort kTestShardHost = HostAndPort("FakeShard1Host", 12345);
+const HostAndPort kTestHedgeHost = HostAndPort("FakeShard1HedgeHost", 12345);
+const NamespaceString kTestNss("testdb.testcoll");
+
+void setEnableHedgedReads(StringData value) {
+    auto param = ServerParameterSet::getGlobal()->getMap().find("enableHedgedReads");
+    invariant(param != ServerParameterSet::getGlobal()->getMap().end());
+    ASSERT_OK(param->second->setFromString(value.toString()));
+}
+
+RemoteCommandResponse makeCursorResponse(CursorId cursorId) {
+    return RemoteCommandResponse(
+        CursorResponse(kTestNss, cursorId, {fromjson("{_id: 1}")})
+            .toBSON(CursorResponse::ResponseType::InitialResponse),
+        BSONObj(),
+        Milliseconds(1));
+}
+
+class AsyncRequestsSenderTest : public ShardingTestFixture {
+public:
+    void setUp() override {
+        ShardingTestFixture::setUp();
+        setEnableHedgedReads("true");
+
+        configTargeter()->setFindHostReturnValue(kTestConfigShardHost);
+
+        ShardType shardType;
+        shardType.setName(kTestShardId.toString());
+        shardType.setHost(kTestShardHost.toString());
+
+        // Requests to the shard are hedged to kTestHedgeHost if they take longer than 10ms.
+        auto targeter = stdx::make_unique<RemoteCommandTargeterMock>();
+        targeter->setConnectionStringReturnValue(ConnectionString(kTestShardHost));
+        targeter->setFindHostReturnValue(kTestShardHost);
+        targeter->setFindHostExcludingReturnValue(kTestHedgeHost);
+        targeter->setHostCommandLatencyPercentileReturnValue(Microseconds(10 * 1000));
+
+        targeterFactory()->addTargeterToReturn(ConnectionString(kTestShardHost),
+                                               std::move(targeter));
+
+        setupShards({shardType});
+    }
+
+    void tearDown() override {
+        setEnableHedgedReads("false");
+        ShardingTestFixture::tearDown();
+    }
+
+protected:
+    std::unique_ptr<AsyncRequestsSender> makeARS() {
+        return stdx::make_unique<AsyncRequestsSender>(
+            operationContext(),
+            executor(),
+            kTestNss.db().toString(),
+            std::vector<AsyncRequestsSender::Request>{
+                {kTestShardId, fromjson("{find: 'testcoll'}")}},
+            ReadPreferenceSetting{ReadPreference::SecondaryPreferred},
+            Shard::RetryPolicy::kIdempotent);
+    }
+
+    /**
+     * Must be called from within the network. Returns the original request and the hedged request,
+     * which is sent once the network's clock passed the hedging delay.
+     */
+    std::pair<NetworkInterfaceMock::NetworkOperationIterator,
+              NetworkInterfaceMock::NetworkOperationIterator>
+    getOriginalAndHedgedRequests() {
+        auto originalNoi = network()->getNextReadyRequest();
+        ASSERT_EQ(kTestShardHost, originalNoi->getRequest().target);
+
+        while (!network()->hasReadyRequests()) {
+            network()->runUntil(network()->now() + Milliseconds(10));
+        }
+
+        auto hedgeNoi = network()->getNextReadyRequest();
+        ASSERT_EQ(kTestHedgeHost, hedgeNoi->getRequest().target);
+        ASSERT_BSONOBJ_EQ(originalNoi->getRequest().cmdObj, hedgeNoi->getRequest().cmdObj);
+
+        return {originalNoi, hedgeNoi};
+    }
+
+    void respond(NetworkInterfaceMock::NetworkOperationIterator noi,
+                 const RemoteCommandResponse& response) {
+        network()->scheduleResponse(noi, network()->now(), response);
+        network()->runReadyNetworkOperations();
+    }
+
+    /**
+     * Must be called from within the network. Expects the next request to kill one of the cursors
+     * in 'expectedCursors', which maps hosts to cursor ids, and returns the host it was sent to.
+     */
+    HostAndPort expectKillCursors(std::map<HostAndPort, CursorId> expectedCursors) {
+        auto noi = network()->getNextReadyRequest();
+        const auto& request = noi->getRequest();
+
+        auto killCursorsRequest =
+            assertGet(KillCursorsRequest::parseFromBSON(request.dbname, request.cmdObj));
+        ASSERT_EQ(kTestNss, killCursorsRequest.nss);
+        ASSERT_EQ(1U, killCursorsRequest.cursorIds.size());
+
+        auto it = expectedCursors.find(request.target);
+        ASSERT(it != expectedCursors.end());
+        ASSERT_EQ(it->second, killCursorsRequest.cursorIds.front());
+
+        respond(noi, RemoteCommandResponse(BSON("ok" << 1), BSONObj(), Milliseconds(1)));
+        return request.target;
+    }
+};
+
+TEST_F(AsyncRequestsSenderTest, HedgedRequestWinsAndOriginalCursorIsKilled) {
+    auto future = launchAsync([&] {
+        auto ars = makeARS();
+        auto response = ars->next();
+        ASSERT_OK(response.swResponse.getStatus());
+        ASSERT_EQ(kTestHedgeHost, *response.shardHostAndPort);
+        ASSERT_EQ(CursorId(456),
+                  assertGet(CursorResponse::parseFromBSON(response.swResponse.getValue().data))
+                      .getCursorId());
+        ASSERT(ars->done());
+
+        // The destructor does not wait for the losing request to complete.
+    });
+
+    network()->enterNetwork();
+    auto noiPair = getOriginalAndHedgedRequests();
+    respond(noiPair.second, makeCursorResponse(456));
+    network()->exitNetwork();
+
+    future.timed_get(kFutureTimeout);
+
+    // The losing request kills its cursor once it completes.
+    network()->enterNetwork();
+    respond(noiPair.first, makeCursorResponse(123));
+    expectKillCursors({{kTestShardHost, 123}});
+    network()->exitNetwork();
+}
+
+TEST_F(AsyncRequestsSenderTest, OriginalRequestWinsAndHedgedCursorIsKilled) {
+    auto future = launchAsync([&] {
+        auto ars = makeARS();
+        auto response = ars->next();
+        ASSERT_OK(response.swResponse.getStatus());
+        ASSERT_EQ(kTestShardHost, *response.shardHostAndPort);
+        ASSERT(ars->done());
+    });
+
+    network()->enterNetwork();
+    auto noiPair = getOriginalAndHedgedRequests();
+    respond(noiPair.first, makeCursorResponse(123));
+    network()->exitNetwork();
+
+    future.timed_get(kFutureTimeout);
+
+    network()->enterNetwork();
+    respond(noiPair.second, makeCursorResponse(456));
+    expectKillCursors({{kTestHedgeHost, 456}});
+    network()->exitNetwork();
+}
+
+TEST_F(AsyncRequestsSenderTest, RequestsInHedgingRaceAreNotCanceledOnInterrupt) {
+    auto future = launchAsync([&] {
+        auto ars = makeARS();
+        auto response = ars->next();
+        ASSERT_EQ(ErrorCodes::Interrupted, response.swResponse.getStatus());
+        ASSERT(ars->done());
+
+        // The destructor does not wait for either request to complete.
+    });
+
+    network()->enterNetwork();
+    auto noiPair = getOriginalAndHedgedRequests();
+    network()->exitNetwork();
+
+    {
+        stdx::lock_guard<Client> lk(*operationContext()->getClient());
+        operationContext()->markKilled();
+    }
+    future.timed_get(kFutureTimeout);
+
+    // Both requests were left running, so that the cursors they opened can be killed.
+    network()->enterNetwork();
+    respond(noiPair.first, makeCursorResponse(123));
+    respond(noiPair.second, makeCursorResponse(456));
+
+    std::map<HostAndPort, CursorId> expectedCursors{{kTestShardHost, 123}, {kTestHedgeHost, 456}};
+    expectedCursors.erase(expectKillCursors(expectedCursors));
+    expectKillCursors(expectedCursors);
+    network()->exitNetwork();
+}
+
+}  // namespace
+}  // namespace mongo
@@ -0,0 +1,157 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/namespace_string.h"
+#include "mongo/s/catalog/sharding_catalog_manager.h"
+#include "mongo/s/catalog/type_chunk.h"
+#include "mongo/s/config_server_test_fixture.h"
+
+namespace mongo {
+namespace {
+
+using unittest::assertGet;
+
+using CommitChunkFieldSummariesTest = ConfigServerTestFixture;
+
+const NamespaceString kNss("TestDB.TestColl");
+const ShardId kShard("shard0000");
+
+BSONObj makeFieldSummary(int min, int max) {
+    return BSON(ChunkType::kFieldSummaryMin << min << ChunkType::kFieldSummaryMax << max);
+}
+
+ChunkType makeChunk(const ChunkVersion& version) {
+    ChunkType chunk;
+    chunk.setNS(kNss.ns());
+    chunk.setVersion(version);
+    chunk.setShard(kShard);
+    chunk.setMin(BSON("a" << 1));
+    chunk.setMax(BSON("a" << 10));
+    return chunk;
+}
+
+TEST_F(CommitChunkFieldSummariesTest, InstallsAndWidensSummariesAndBumpsVersion) {
+    const auto origVersion = ChunkVersion(1, 0, OID::gen());
+    const auto chunk = makeChunk(origVersion);
+    ASSERT_OK(setupChunks({chunk}));
+
+    // Widenings are ignored for fields without a summary, since they do not cover all documents
+    ASSERT_OK(ShardingCatalogManager::get(operationContext())
+                  ->commitChunkFieldSummaries(operationContext(),
+                                              kNss,
+                                              origVersion.epoch(),
+                                              chunk.getRange(),
+                                              kShard.toString(),
+                                              BSON("ts" << makeFieldSummary(10, 20)),
+                                              BSON("n" << makeFieldSummary(1, 1))));
+
+    auto updatedChunk = assertGet(getChunkDoc(operationContext(), chunk.getMin()));
+    ASSERT_BSONOBJ_EQ(BSON("ts" << makeFieldSummary(10, 20)), updatedChunk.getFieldSummaries());
+    ASSERT_EQ(origVersion.majorVersion(), updatedChunk.getVersion().majorVersion());
+    ASSERT_EQ(origVersion.minorVersion() + 1, updatedChunk.getVersion().minorVersion());
+
+    ASSERT_OK(ShardingCatalogManager::get(operationContext())
+                  ->commitChunkFieldSummaries(operationContext(),
+                                              kNss,
+                                              origVersion.epoch(),
+                                              chunk.getRange(),
+                                              kShard.toString(),
+                                              BSONObj(),
+                                              BSON("ts" << makeFieldSummary(5, 15))));
+
+    updatedChunk = assertGet(getChunkDoc(operationContext(), chunk.getMin()));
+    ASSERT_BSONOBJ_EQ(BSON("ts" << makeFieldSummary(5, 20)), updatedChunk.getFieldSummaries());
+    ASSERT_EQ(origVersion.minorVersion() + 2, updatedChunk.getVersion().minorVersion());
+}
+
+TEST_F(CommitChunkFieldSummariesTest, CoveredSummariesDoNotBumpVersion) {
+    const auto origVersion = ChunkVersion(1, 0, OID::gen());
+    auto chunk = makeChunk(origVersion);
+    chunk.setFieldSummaries(BSON("ts" << makeFieldSummary(10, 20)));
+    ASSERT_OK(setupChunks({chunk}));
+
+    ASSERT_OK(ShardingCatalogManager::get(operationContext())
+                  ->commitChunkFieldSummaries(operationContext(),
+                                              kNss,
+                                              origVersion.epoch(),
+                                              chunk.getRange(),
+                                              kShard.toString(),
+                                              BSONObj(),
+                                              BSON("ts" << makeFieldSummary(12, 20))));
+
+    auto updatedChunk = assertGet(getChunkDoc(operationContext(), chunk.getMin()));
+    ASSERT_BSONOBJ_EQ(chunk.getFieldSummaries(), updatedChunk.getFieldSummaries());
+    ASSERT_EQ(origVersion, updatedChunk.getVersion());
+}
+
+TEST_F(CommitChunkFieldSummariesTest, ChunkNotOnShardShouldFail) {
+    const auto origVersion = ChunkVersion(1, 0, OID::gen());
+    const auto chunk = makeChunk(origVersion);
+    ASSERT_OK(setupChunks({chunk}));
+
+    ASSERT_EQ(ErrorCodes::IncompatibleShardingMetadata,
+              ShardingCatalogManager::get(operationContext())
+                  ->commitChunkFieldSummaries(operationContext(),
+                                              kNss,
+                                              origVersion.epoch(),
+                                              chunk.getRange(),
+                                              "shard0001",
+                                              BSON("ts" << makeFieldSummary(10, 20)),
+                                              BSONObj()));
+
+    ASSERT_EQ(ErrorCodes::IncompatibleShardingMetadata,
+              ShardingCatalogManager::get(operationContext())
+                  ->commitChunkFieldSummaries(operationContext(),
+                                              kNss,
+                                              origVersion.epoch(),
+                                              ChunkRange(BSON("a" << 1), BSON("a" << 5)),
+                                              kShard.toString(),
+                                              BSON("ts" << makeFieldSummary(10, 20)),
+                                              BSONObj()));
+}
+
+TEST_F(CommitChunkFieldSummariesTest, WrongEpochShouldFail) {
+    const auto origVersion = ChunkVersion(1, 0, OID::gen());
+    const auto chunk = makeChunk(origVersion);
+    ASSERT_OK(setupChunks({chunk}));
+
+    ASSERT_EQ(ErrorCodes::StaleEpoch,
+              ShardingCatalogManager::get(operationContext())
+                  ->commitChunkFieldSummaries(operationContext(),
+                                              kNss,
+                                              OID::gen(),
+                                              chunk.getRange(),
+                                              kShard.toString(),
+                                              BSON("ts" << makeFieldSummary(10, 20)),
+                                              BSONObj()));
+}
+
+}  // namespace
+}  // namespace mongo
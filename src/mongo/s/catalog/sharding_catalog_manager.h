@@ -188,6 +188,24 @@ public:
                                              const ShardId& fromShard,
                                              const ShardId& toShard);
 
+    /**
+     * Updates the field summaries of the given chunk in the config.chunks collection. Summaries in
+     * 'fieldSummaries' must cover all documents of the chunk and are installed for fields which do
+     * not have one yet, while 'fieldSummaryWidenings' only extend the fields' existing summaries.
+     * The chunk's version is bumped if its summaries changed, so that routers pick them up on their
+     * next incremental refresh.
+     *
+     * Returns IncompatibleShardingMetadata if the chunk no longer exists on the given shard, which
+     * means that it was split, merged or migrated and its summaries were discarded.
+     */
+    Status commitChunkFieldSummaries(OperationContext* opCtx,
+                                     const NamespaceString& nss,
+                                     const OID& requestEpoch,
+                                     const ChunkRange& range,
+                                     const std::string& shardName,
+                                     const BSONObj& fieldSummaries,
+                                     const BSONObj& fieldSummaryWidenings);
+
     //
     // Database Operations
     //
@@ -34,6 +34,7 @@
 
 #include "mongo/base/status_with.h"
 #include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/bson/simple_bsonobj_comparator.h"
 #include "mongo/bson/util/bson_extract.h"
 #include "mongo/client/connection_string.h"
 #include "mongo/client/read_preference.h"
@@ -226,6 +227,71 @@ BSONObj makeCommitChunkTransactionCommand(const NamespaceString& nss,
     return BSON("doTxn" << updates.arr());
 }
 
+/**
+ * Appends to 'builder' a summary for 'fieldName', which spans all the given summaries. Elements,
+ * which are not summaries (such as missing ones), are skipped.
+ */
+void appendFieldSummaryUnion(BSONObjBuilder* builder,
+                             StringData fieldName,
+                             const std::vector<BSONElement>& summaryElems) {
+    BSONElement unionMin;
+    BSONElement unionMax;
+
+    for (const auto& summaryElem : summaryElems) {
+        if (summaryElem.type() != Object) {
+            continue;
+        }
+
+        const auto summary = summaryElem.Obj();
+        const auto summaryMin = summary[ChunkType::kFieldSummaryMin];
+        const auto summaryMax = summary[ChunkType::kFieldSummaryMax];
+
+        if (unionMin.eoo() || summaryMin.woCompare(unionMin, false) < 0) {
+            unionMin = summaryMin;
+        }
+        if (unionMax.eoo() || summaryMax.woCompare(unionMax, false) > 0) {
+            unionMax = summaryMax;
+        }
+    }
+
+    invariant(!unionMin.eoo() && !unionMax.eoo());
+
+    BSONObjBuilder summaryBuilder(builder->subobjStart(fieldName));
+    summaryBuilder.appendAs(unionMin, ChunkType::kFieldSummaryMin);
+    summaryBuilder.appendAs(unionMax, ChunkType::kFieldSummaryMax);
+}
+
+/**
+ * Returns the chunk field summaries resulting from installing 'fieldSummaries' for the fields
+ * which are not in 'existing' and widening the existing ones with both 'fieldSummaries' and
+ * 'fieldSummaryWidenings'.
+ */
+BSONObj mergeChunkFieldSummaries(const BSONObj& existing,
+                                 const BSONObj& fieldSummaries,
+                                 const BSONObj& fieldSummaryWidenings) {
+    BSONObjBuilder merged;
+
+    for (const auto& existingElem : existing) {
+        const auto fieldName = existingElem.fieldNameStringData();
+        appendFieldSummaryUnion(
+            &merged,
+            fieldName,
+            {existingElem, fieldSummaries[fieldName], fieldSummaryWidenings[fieldName]});
+    }
+
+    for (const auto& summaryElem : fieldSummaries) {
+        const auto fieldName = summaryElem.fieldNameStringData();
+        if (existing.hasField(fieldName)) {
+            continue;
+        }
+
+        appendFieldSummaryUnion(
+            &merged, fieldName, {summaryElem, fieldSummaryWidenings[fieldName]});
+    }
+
+    return merged.obj();
+}
+
 }  // namespace
 
 Status ShardingCatalogManager::commitChunkSplit(OperationContext* opCtx,
@@ -666,4 +732,141 @@ StatusWith<BSONObj> ShardingCatalogManager::commitChunkMigration(
     return result.obj();
 }
 
+Status ShardingCatalogManager::commitChunkFieldSummaries(OperationContext* opCtx,
+                                                         const NamespaceString& nss,
+                                                         const OID& requestEpoch,
+                                                         const ChunkRange& range,
+                                                         const std::string& shardName,
+                                                         const BSONObj& fieldSummaries,
+                                                         const BSONObj& fieldSummaryWidenings) {
+    for (const auto& summaries : {fieldSummaries, fieldSummaryWidenings}) {
+        Status validateStatus = ChunkType::validateFieldSummaries(summaries);
+        if (!validateStatus.isOK()) {
+            return validateStatus;
+        }
+    }
+
+    auto const configShard = Grid::get(opCtx)->shardRegistry()->getConfigShard();
+
+    // Take _kChunkOpLock in exclusive mode to prevent concurrent chunk splits, merges, and
+    // migrations, because the new chunk version is generated from the current collection version
+    Lock::ExclusiveLock lk(opCtx->lockState(), _kChunkOpLock);
+
+    // Get the max chunk version for this namespace.
+    auto findCollVersionStatus =
+        configShard->exhaustiveFindOnConfig(opCtx,
+                                            ReadPreferenceSetting{ReadPreference::PrimaryOnly},
+                                            repl::ReadConcernLevel::kLocalReadConcern,
+                                            NamespaceString(ChunkType::ConfigNS),
+                                            BSON("ns" << nss.ns()),
+                                            BSON(ChunkType::lastmod << -1),
+                                            1);
+    if (!findCollVersionStatus.isOK()) {
+        return findCollVersionStatus.getStatus();
+    }
+
+    const auto& collVersionDocs = findCollVersionStatus.getValue().docs;
+    if (collVersionDocs.empty()) {
+        return {ErrorCodes::IllegalOperation,
+                "collection does not exist, isn't sharded, or has no chunks"};
+    }
+
+    const ChunkVersion collVersion =
+        ChunkVersion::fromBSON(collVersionDocs.front(), ChunkType::lastmod());
+    if (collVersion.epoch() != requestEpoch) {
+        return {ErrorCodes::StaleEpoch,
+                "epoch of chunk does not match epoch of request. This most likely means "
+                "that the collection was dropped and re-created."};
+    }
+
+    // Must use local read concern because we will perform subsequent writes.
+    auto findChunkStatus = configShard->exhaustiveFindOnConfig(
+        opCtx,
+        ReadPreferenceSetting{ReadPreference::PrimaryOnly},
+        repl::ReadConcernLevel::kLocalReadConcern,
+        NamespaceString(ChunkType::ConfigNS),
+        BSON(ChunkType::ns(nss.ns()) << ChunkType::min(range.getMin())
+                                     << ChunkType::max(range.getMax())
+                                     << ChunkType::shard(shardName)),
+        BSONObj(),
+        1);
+    if (!findChunkStatus.isOK()) {
+        return findChunkStatus.getStatus();
+    }
+
+    const auto& chunkDocs = findChunkStatus.getValue().docs;
+    if (chunkDocs.empty()) {
+        return {ErrorCodes::IncompatibleShardingMetadata,
+                str::stream() << "Chunk " << range.toString() << " of collection " << nss.ns()
+                              << " no longer exists on shard " << shardName};
+    }
+
+    auto chunkStatus = ChunkType::fromConfigBSON(chunkDocs.front());
+    if (!chunkStatus.isOK()) {
+        return chunkStatus.getStatus();
+    }
+
+    auto chunk = std::move(chunkStatus.getValue());
+
+    const auto mergedFieldSummaries = mergeChunkFieldSummaries(
+        chunk.getFieldSummaries(), fieldSummaries, fieldSummaryWidenings);
+    if (SimpleBSONObjComparator::kInstance.evaluate(mergedFieldSummaries ==
+                                                     chunk.getFieldSummaries())) {
+        // The existing summaries already cover the requested ones
+        return Status::OK();
+    }
+
+    ChunkVersion newVersion = collVersion;
+    newVersion.incMinor();
+
+    chunk.setVersion(newVersion);
+    chunk.setFieldSummaries(mergedFieldSummaries);
+
+    BSONArrayBuilder updates;
+    {
+        BSONObjBuilder op;
+        op.append("op", "u");
+        op.appendBool("b", false);  // No upserting
+        op.append("ns", ChunkType::ConfigNS);
+        op.append("o", chunk.toConfigBSON());
+        op.append("o2", BSON(ChunkType::name(chunk.getName())));
+
+        updates.append(op.obj());
+    }
+
+    BSONArrayBuilder preCond;
+    {
+        BSONObjBuilder b;
+        b.append("ns", ChunkType::ConfigNS);
+        b.append("q",
+                 BSON("query" << BSON(ChunkType::ns(nss.ns()) << ChunkType::min(range.getMin())
+                                                              << ChunkType::max(range.getMax()))
+                              << "orderby"
+                              << BSON(ChunkType::lastmod() << -1)));
+        {
+            BSONObjBuilder bb(b.subobjStart("res"));
+            bb.append(ChunkType::epoch(), requestEpoch);
+            bb.append(ChunkType::shard(), shardName);
+        }
+        preCond.append(b.obj());
+    }
+
+    Status applyOpsStatus = Grid::get(opCtx)->catalogClient()->applyChunkOpsDeprecated(
+        opCtx,
+        updates.arr(),
+        preCond.arr(),
+        nss.ns(),
+        newVersion,
+        WriteConcernOptions(),
+        repl::ReadConcernLevel::kLocalReadConcern);
+    if (!applyOpsStatus.isOK()) {
+        return applyOpsStatus;
+    }
+
+    LOG(1) << "Updated field summaries of chunk " << redact(range.toString()) << " of "
+           << nss.ns() << " to " << redact(mergedFieldSummaries) << " at version " << newVersion;
+
+    return Status::OK();
+}
+
 }  // namespace mongo
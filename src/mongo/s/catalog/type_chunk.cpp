@@ -54,6 +54,10 @@ const BSONField<std::string> ChunkType::shard("shard");
 const BSONField<bool> ChunkType::jumbo("jumbo");
 const BSONField<Date_t> ChunkType::lastmod("lastmod");
 const BSONField<OID> ChunkType::epoch("lastmodEpoch");
+const BSONField<BSONObj> ChunkType::fieldSummaries("fieldSummaries");
+
+const StringData ChunkType::kFieldSummaryMin = "min"_sd;
+const StringData ChunkType::kFieldSummaryMax = "max"_sd;
 
 namespace {
 
@@ -78,6 +82,30 @@ Status extractObject(const BSONObj& obj, const std::string& fieldName, BSONEleme
     return Status::OK();
 }
 
+/**
+ * Extracts the optional field summaries from 'obj' into 'fieldSummaries', validating their format.
+ */
+Status extractFieldSummaries(const BSONObj& obj, boost::optional<BSONObj>* fieldSummaries) {
+    BSONElement fieldSummariesElem;
+    Status status = bsonExtractTypedField(
+        obj, ChunkType::fieldSummaries.name(), Object, &fieldSummariesElem);
+    if (status == ErrorCodes::NoSuchKey) {
+        // Chunks without published summaries cannot be pruned by them
+        return Status::OK();
+    }
+    if (!status.isOK()) {
+        return status;
+    }
+
+    status = ChunkType::validateFieldSummaries(fieldSummariesElem.Obj());
+    if (!status.isOK()) {
+        return status;
+    }
+
+    *fieldSummaries = fieldSummariesElem.Obj().getOwned();
+    return Status::OK();
+}
+
 }  // namespace
 
 ChunkRange::ChunkRange(BSONObj minKey, BSONObj maxKey)
@@ -204,6 +232,12 @@ StatusWith<ChunkType> ChunkType::fromConfigBSON(const BSONObj& source) {
         }
     }
 
+    {
+        Status status = extractFieldSummaries(source, &chunk._fieldSummaries);
+        if (!status.isOK())
+            return status;
+    }
+
     {
         auto versionStatus = ChunkVersion::parseFromBSONForChunk(source);
         if (!versionStatus.isOK()) {
@@ -231,6 +265,8 @@ BSONObj ChunkType::toConfigBSON() const {
         _version->appendForChunk(&builder);
     if (_jumbo)
         builder.append(jumbo.name(), getJumbo());
+    if (_fieldSummaries)
+        builder.append(fieldSummaries.name(), *_fieldSummaries);
 
     return builder.obj();
 }
@@ -278,6 +314,12 @@ StatusWith<ChunkType> ChunkType::fromShardBSON(const BSONObj& source, const OID&
         chunk._version = std::move(statusWithChunkVersion.getValue());
     }
 
+    {
+        Status status = extractFieldSummaries(source, &chunk._fieldSummaries);
+        if (!status.isOK())
+            return status;
+    }
+
     return chunk;
 }
 
@@ -291,6 +333,8 @@ BSONObj ChunkType::toShardBSON() const {
     builder.append(max.name(), getMax());
     builder.append(shard.name(), getShard().toString());
     builder.appendTimestamp(lastmod.name(), _version->toLong());
+    if (_fieldSummaries)
+        builder.append(fieldSummaries.name(), *_fieldSummaries);
     return builder.obj();
 }
 
@@ -329,6 +373,39 @@ void ChunkType::setJumbo(bool jumbo) {
     _jumbo = jumbo;
 }
 
+void ChunkType::setFieldSummaries(const BSONObj& fieldSummaries) {
+    invariantOK(validateFieldSummaries(fieldSummaries));
+    _fieldSummaries = fieldSummaries.getOwned();
+}
+
+Status ChunkType::validateFieldSummaries(const BSONObj& fieldSummaries) {
+    for (const auto& summaryElem : fieldSummaries) {
+        if (summaryElem.type() != Object) {
+            return {ErrorCodes::TypeMismatch,
+                    str::stream() << "The summary for field '" << summaryElem.fieldNameStringData()
+                                  << "' must be an object"};
+        }
+
+        const auto summary = summaryElem.Obj();
+        const auto minElem = summary[kFieldSummaryMin];
+        const auto maxElem = summary[kFieldSummaryMax];
+        if (minElem.eoo() || maxElem.eoo()) {
+            return {ErrorCodes::NoSuchKey,
+                    str::stream() << "The summary for field '" << summaryElem.fieldNameStringData()
+                                  << "' must have both a '" << kFieldSummaryMin << "' and a '"
+                                  << kFieldSummaryMax << "' value"};
+        }
+
+        if (minElem.woCompare(maxElem, false) > 0) {
+            return {ErrorCodes::BadValue,
+                    str::stream() << "The summary for field '" << summaryElem.fieldNameStringData()
+                                  << "' has min " << minElem << " greater than max " << maxElem};
+        }
+    }
+
+    return Status::OK();
+}
+
 std::string ChunkType::genID(StringData ns, const BSONObj& o) {
     StringBuilder buf;
     buf << ns << "-";
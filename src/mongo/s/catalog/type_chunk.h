@@ -125,7 +125,10 @@ private:
  *      shard : "test-rs1",
  *      lastmod : Timestamp(1, 0),
  *      lastmodEpoch : ObjectId("587fc60cef168288439ad6ed"),
- *      jumbo : false              // optional field
+ *      jumbo : false,             // optional field
+ *      fieldSummaries : {         // optional field
+ *              "ts" : { min : ISODate("2018-01-01"), max : ISODate("2018-01-02") }
+ *      }
  *   }
  *
  * Expected shard server config.chunks.<epoch> collection format:
@@ -138,6 +141,9 @@ private:
  *      }
  *      shard : "test-rs1",
  *      lastmod : Timestamp(1, 0),
+ *      fieldSummaries : {         // optional field
+ *              "ts" : { min : ISODate("2018-01-01"), max : ISODate("2018-01-02") }
+ *      }
  *   }
  *
  * Note: it is intended to change the config server's collection schema to mirror the new shard
@@ -162,6 +168,11 @@ public:
     static const BSONField<bool> jumbo;
     static const BSONField<Date_t> lastmod;
     static const BSONField<OID> epoch;
+    static const BSONField<BSONObj> fieldSummaries;
+
+    // Field names of the bounds inside each entry of the fieldSummaries document
+    static const StringData kFieldSummaryMin;
+    static const StringData kFieldSummaryMax;
 
     ChunkType();
     ChunkType(NamespaceString nss, ChunkRange range, ChunkVersion version, ShardId shardId);
@@ -236,6 +247,21 @@ public:
     }
     void setJumbo(bool jumbo);
 
+    /**
+     * Min/max values of selected non-shard-key fields over the documents in the chunk, in the
+     * format {<field>: {min: <value>, max: <value>}}. Empty if no summaries have been published.
+     */
+    BSONObj getFieldSummaries() const {
+        return _fieldSummaries.get_value_or(BSONObj());
+    }
+    void setFieldSummaries(const BSONObj& fieldSummaries);
+
+    /**
+     * Returns OK if 'fieldSummaries' has the format described for getFieldSummaries and every
+     * summary's min is not greater than its max.
+     */
+    static Status validateFieldSummaries(const BSONObj& fieldSummaries);
+
     /**
      * Generates chunk id based on the namespace name and the lower bound of the chunk.
      */
@@ -267,6 +293,8 @@ private:
     boost::optional<ShardId> _shard;
     // (O)(C)     too big to move?
     boost::optional<bool> _jumbo;
+    // (O)(C)(S)  min/max of selected non-shard-key fields, used to prune targeted shards
+    boost::optional<BSONObj> _fieldSummaries;
 };
 
 }  // namespace mongo
@@ -235,6 +235,51 @@ TEST(ChunkType, BadType) {
     ASSERT_FALSE(chunkRes.isOK());
 }
 
+TEST(ChunkType, ToFromBSONWithFieldSummaries) {
+    ChunkVersion chunkVersion(1, 2, OID::gen());
+    const BSONObj fieldSummaries =
+        BSON("ts" << BSON("min" << Date_t::fromMillisSinceEpoch(1000) << "max"
+                                << Date_t::fromMillisSinceEpoch(2000))
+                  << "n"
+                  << BSON("min" << 5 << "max" << 5));
+    BSONObj obj = BSON(ChunkType::name("test.mycol-a_10")
+                       << ChunkType::ns("test.mycol")
+                       << ChunkType::min(BSON("a" << 10))
+                       << ChunkType::max(BSON("a" << 20))
+                       << ChunkType::shard("shard0001")
+                       << "lastmod"
+                       << Timestamp(chunkVersion.toLong())
+                       << "lastmodEpoch"
+                       << chunkVersion.epoch()
+                       << ChunkType::fieldSummaries(fieldSummaries));
+    ChunkType chunk = assertGet(ChunkType::fromConfigBSON(obj));
+    ASSERT_BSONOBJ_EQ(chunk.toConfigBSON(), obj);
+    ASSERT_BSONOBJ_EQ(chunk.getFieldSummaries(), fieldSummaries);
+
+    ChunkType shardChunk =
+        assertGet(ChunkType::fromShardBSON(chunk.toShardBSON(), chunkVersion.epoch()));
+    ASSERT_BSONOBJ_EQ(shardChunk.getFieldSummaries(), fieldSummaries);
+}
+
+TEST(ChunkType, FieldSummaryMinGreaterThanMaxShouldError) {
+    ChunkVersion chunkVersion(1, 2, OID::gen());
+    BSONObj obj = BSON(ChunkType::name("test.mycol-a_10")
+                       << ChunkType::ns("test.mycol")
+                       << ChunkType::min(BSON("a" << 10))
+                       << ChunkType::max(BSON("a" << 20))
+                       << ChunkType::shard("shard0001")
+                       << "lastmod"
+                       << Timestamp(chunkVersion.toLong())
+                       << "lastmodEpoch"
+                       << chunkVersion.epoch()
+                       << ChunkType::fieldSummaries(BSON("n" << BSON("min" << 10 << "max" << 5))));
+    ASSERT_EQ(ErrorCodes::BadValue, ChunkType::fromConfigBSON(obj).getStatus());
+
+    ASSERT_EQ(ErrorCodes::NoSuchKey,
+              ChunkType::validateFieldSummaries(BSON("n" << BSON("min" << 10))));
+    ASSERT_EQ(ErrorCodes::TypeMismatch, ChunkType::validateFieldSummaries(BSON("n" << 10)));
+}
+
 TEST(ChunkRange, BasicBSONParsing) {
     auto parseStatus =
         ChunkRange::fromBSON(BSON("min" << BSON("x" << 0) << "max" << BSON("x" << 10)));
@@ -32,6 +32,7 @@
 
 #include "mongo/s/catalog_cache.h"
 
+#include "mongo/base/init.h"
 #include "mongo/base/status.h"
 #include "mongo/base/status_with.h"
 #include "mongo/bson/bsonobjbuilder.h"
@@ -39,6 +40,7 @@
 #include "mongo/db/repl/optime_with.h"
 #include "mongo/platform/unordered_set.h"
 #include "mongo/s/catalog/sharding_catalog_client.h"
+#include "mongo/s/catalog/type_chunk.h"
 #include "mongo/s/catalog/type_collection.h"
 #include "mongo/s/catalog/type_database.h"
 #include "mongo/s/client/shard_registry.h"
@@ -113,6 +115,40 @@ std::shared_ptr<ChunkManager> refreshCollectionRoutingInfo(
     return chunkManager;
 }
 
+/**
+ * Returns the version of the most recently changed chunk of 'nss'. Reads from the config server
+ * primary with majority read concern, so that the result includes every chunk change which the
+ * config server acknowledged to a shard.
+ */
+StatusWith<ChunkVersion> fetchLatestCollectionVersion(OperationContext* opCtx,
+                                                      const NamespaceString& nss) {
+    auto findStatus =
+        Grid::get(opCtx)->shardRegistry()->getConfigShard()->exhaustiveFindOnConfig(
+            opCtx,
+            ReadPreferenceSetting{ReadPreference::PrimaryOnly},
+            repl::ReadConcernLevel::kMajorityReadConcern,
+            NamespaceString(ChunkType::ConfigNS),
+            BSON(ChunkType::ns(nss.ns())),
+            BSON(ChunkType::lastmod() << -1),
+            1);
+    if (!findStatus.isOK()) {
+        return findStatus.getStatus();
+    }
+
+    const auto& chunkDocs = findStatus.getValue().docs;
+    if (chunkDocs.empty()) {
+        return {ErrorCodes::NamespaceNotFound,
+                str::stream() << "Collection " << nss.ns() << " has no chunks"};
+    }
+
+    return ChunkVersion::fromBSON(chunkDocs.front(), ChunkType::lastmod());
+}
+
+MONGO_INITIALIZER(RegisterChunkManagerCollectionVersionFetcher)(InitializerContext* context) {
+    ChunkManager::registerCollectionVersionFetcher(fetchLatestCollectionVersion);
+    return Status::OK();
+}
+
 }  // namespace
 
 CatalogCache::CatalogCache(CatalogCacheLoader& cacheLoader) : _cacheLoader(cacheLoader) {}
@@ -278,6 +314,23 @@ void CatalogCache::invalidateShardedCollection(const NamespaceString& nss) {
     it->second->collections[nss.ns()].needsRefresh = true;
 }
 
+void CatalogCache::refreshShardedCollectionsInBackground() {
+    stdx::lock_guard<stdx::mutex> lg(_mutex);
+
+    for (const auto& db : _databases) {
+        for (const auto& coll : db.second->collections) {
+            const auto& collEntry = coll.second;
+            if (collEntry.needsRefresh || collEntry.backgroundRefreshInProgress ||
+                !collEntry.routingInfo) {
+                continue;
+            }
+
+            _scheduleBackgroundCollectionRefresh(
+                lg, db.second, collEntry.routingInfo, NamespaceString(coll.first));
+        }
+    }
+}
+
 void CatalogCache::purgeDatabase(StringData dbName) {
     stdx::lock_guard<stdx::mutex> lg(_mutex);
     _databases.erase(dbName);
@@ -461,6 +514,84 @@ void CatalogCache::_scheduleCollectionRefresh(WithLock lk,
     }
 }
 
+void CatalogCache::_scheduleBackgroundCollectionRefresh(
+    WithLock lk,
+    std::shared_ptr<DatabaseInfoEntry> dbEntry,
+    std::shared_ptr<ChunkManager> existingRoutingInfo,
+    NamespaceString const& nss) {
+    auto& collections = dbEntry->collections;
+    auto it = collections.find(nss.ns());
+    invariant(it != collections.end());
+    invariant(!it->second.needsRefresh);
+    it->second.backgroundRefreshInProgress = true;
+
+    _stats.countBackgroundRefreshesStarted.addAndFetch(1);
+
+    // Invoked once the background refresh has finished, whether with success or error
+    const auto onRefreshCompleted = [ this, dbEntry, nss, existingRoutingInfo ](
+        WithLock, const Status& status, std::shared_ptr<ChunkManager> newRoutingInfo) {
+        auto& collections = dbEntry->collections;
+        auto it = collections.find(nss.ns());
+        if (it == collections.end()) {
+            return;
+        }
+
+        auto& collEntry = it->second;
+        collEntry.backgroundRefreshInProgress = false;
+
+        if (!status.isOK()) {
+            LOG(1) << "Background refresh for collection " << nss << " failed"
+                   << causedBy(redact(status));
+            return;
+        }
+
+        // A regular refresh has been scheduled or has completed since this refresh started, so
+        // its result takes precedence
+        if (collEntry.needsRefresh || collEntry.routingInfo != existingRoutingInfo) {
+            return;
+        }
+
+        if (!newRoutingInfo) {
+            log() << "Background refresh for collection " << nss
+                  << " found the collection is not sharded";
+            collections.erase(it);
+            return;
+        }
+
+        if (newRoutingInfo->getVersion() == existingRoutingInfo->getVersion()) {
+            return;
+        }
+
+        log() << "Background refresh for collection " << nss << " found version "
+              << newRoutingInfo->getVersion();
+
+        _stats.countBackgroundRefreshesApplied.addAndFetch(1);
+        collEntry.routingInfo = std::move(newRoutingInfo);
+    };
+
+    const auto refreshCallback = [ this, nss, existingRoutingInfo, onRefreshCompleted ](
+        OperationContext * opCtx,
+        StatusWith<CatalogCacheLoader::CollectionAndChangedChunks> swCollAndChunks) noexcept {
+        std::shared_ptr<ChunkManager> newRoutingInfo;
+        Status status = Status::OK();
+        try {
+            newRoutingInfo = refreshCollectionRoutingInfo(
+                opCtx, nss, existingRoutingInfo, std::move(swCollAndChunks));
+        } catch (const DBException& ex) {
+            status = ex.toStatus();
+        }
+
+        stdx::lock_guard<stdx::mutex> lg(_mutex);
+        onRefreshCompleted(lg, status, std::move(newRoutingInfo));
+    };
+
+    try {
+        _cacheLoader.getChunksSince(nss, existingRoutingInfo->getVersion(), refreshCallback);
+    } catch (const DBException& ex) {
+        onRefreshCompleted(lk, ex.toStatus(), nullptr);
+    }
+}
+
 void CatalogCache::Stats::report(BSONObjBuilder* builder) const {
     builder->append("countStaleConfigErrors", countStaleConfigErrors.load());
 
@@ -473,6 +604,9 @@ void CatalogCache::Stats::report(BSONObjBuilder* builder) const {
     builder->append("countFullRefreshesStarted", countFullRefreshesStarted.load());
 
     builder->append("countFailedRefreshes", countFailedRefreshes.load());
+
+    builder->append("countBackgroundRefreshesStarted", countBackgroundRefreshesStarted.load());
+    builder->append("countBackgroundRefreshesApplied", countBackgroundRefreshesApplied.load());
 }
 
 CachedDatabaseInfo::CachedDatabaseInfo(std::shared_ptr<CatalogCache::DatabaseInfoEntry> db)
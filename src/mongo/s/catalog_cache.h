@@ -124,6 +124,14 @@ public:
      */
     void invalidateShardedCollection(const NamespaceString& nss);
 
+    /**
+     * Non-blocking method, which schedules an incremental refresh for every cached sharded
+     * collection, which is not already being refreshed. Unlike the refreshes caused by stale config
+     * errors, callers of getCollectionRoutingInfo keep using the existing routing table while these
+     * are in progress and it is only replaced once a newer version has been loaded.
+     */
+    void refreshShardedCollectionsInBackground();
+
     /**
      * Non-blocking method, which removes the entire specified database (including its collections)
      * from the cache.
@@ -160,6 +168,9 @@ private:
 
         // Contains the cached routing information (only available if needsRefresh is false)
         std::shared_ptr<ChunkManager> routingInfo;
+
+        // Whether a background refresh, which does not block readers, is currently running
+        bool backgroundRefreshInProgress{false};
     };
 
     /**
@@ -191,6 +202,16 @@ private:
                                     NamespaceString const& nss,
                                     int refreshAttempt);
 
+    /**
+     * Non-blocking call which schedules an asynchronous refresh for the specified namespace, whose
+     * result replaces 'existingRoutingInfo' only if no regular refresh of the namespace has been
+     * scheduled in the meantime. The namespace must not be in the 'needsRefresh' state.
+     */
+    void _scheduleBackgroundCollectionRefresh(WithLock,
+                                              std::shared_ptr<DatabaseInfoEntry> dbEntry,
+                                              std::shared_ptr<ChunkManager> existingRoutingInfo,
+                                              NamespaceString const& nss);
+
     // Interface from which chunks will be retrieved
     CatalogCacheLoader& _cacheLoader;
 
@@ -221,6 +242,14 @@ private:
         // for whatever reason
         AtomicInt64 countFailedRefreshes{0};
 
+        // Cumulative, always-increasing counter of how many background refreshes have been kicked
+        // off
+        AtomicInt64 countBackgroundRefreshesStarted{0};
+
+        // Cumulative, always-increasing counter of how many background refreshes found a newer
+        // routing table and installed it
+        AtomicInt64 countBackgroundRefreshesApplied{0};
+
         /**
          * Reports the accumulated statistics for serverStatus.
          */
@@ -0,0 +1,78 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kSharding
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/s/catalog_cache_refresh_job.h"
+
+#include "mongo/db/client.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/s/catalog_cache.h"
+#include "mongo/s/grid.h"
+#include "mongo/util/concurrency/idle_thread_block.h"
+#include "mongo/util/exit.h"
+#include "mongo/util/log.h"
+#include "mongo/util/time_support.h"
+
+namespace mongo {
+namespace {
+
+MONGO_EXPORT_SERVER_PARAMETER(catalogCacheBackgroundRefreshIntervalSecs, int, 0);
+
+}  // namespace
+
+CatalogCacheRefreshJob catalogCacheRefreshJob;
+
+std::string CatalogCacheRefreshJob::name() const {
+    return "CatalogCacheRefreshJob";
+}
+
+void CatalogCacheRefreshJob::run() {
+    Client::initThread(name().c_str());
+
+    auto* const catalogCache = Grid::get(Client::getCurrent()->getServiceContext())->catalogCache();
+    invariant(catalogCache);
+
+    Date_t lastRefresh;
+
+    while (!globalInShutdownDeprecated()) {
+        const int intervalSecs = catalogCacheBackgroundRefreshIntervalSecs.load();
+        if (intervalSecs > 0 && Date_t::now() - lastRefresh >= Seconds(intervalSecs)) {
+            LOG(2) << "Refreshing the routing tables of all cached sharded collections";
+            catalogCache->refreshShardedCollectionsInBackground();
+            lastRefresh = Date_t::now();
+        }
+
+        MONGO_IDLE_THREAD_BLOCK;
+        sleepsecs(1);
+    }
+}
+
+}  // namespace mongo
@@ -36,6 +36,8 @@
 #include "mongo/s/catalog/type_database.h"
 #include "mongo/s/catalog_cache.h"
 #include "mongo/s/catalog_cache_test_fixture.h"
+#include "mongo/s/grid.h"
+#include "mongo/util/time_support.h"
 
 namespace mongo {
 namespace {
@@ -612,5 +614,60 @@ TEST_F(CatalogCacheRefreshTest, IncrementalLoadAfterMoveLastChunk) {
     ASSERT_EQ(version, cm->getVersion({"1"}));
 }
 
+TEST_F(CatalogCacheRefreshTest, BackgroundRefreshInstallsNewerVersion) {
+    const ShardKeyPattern shardKeyPattern(BSON("_id" << 1));
+
+    auto initialRoutingInfo(
+        makeChunkManager(kNss, shardKeyPattern, nullptr, true, {BSON("_id" << 0)}));
+    ASSERT_EQ(2, initialRoutingInfo->numChunks());
+
+    ChunkVersion version = initialRoutingInfo->getVersion();
+    const ChunkVersion initialVersion = version;
+
+    // The background refresh must not invalidate the cached entry, so lookups keep being served
+    // from the existing routing table until the newer one has been installed
+    auto future = launchAsync([&] {
+        auto client = serviceContext()->makeClient("Test");
+        auto opCtx = client->makeOperationContext();
+        auto const catalogCache = Grid::get(serviceContext())->catalogCache();
+        catalogCache->refreshShardedCollectionsInBackground();
+
+        for (int i = 0; i < 1000; i++) {
+            auto routingInfo =
+                uassertStatusOK(catalogCache->getCollectionRoutingInfo(opCtx.get(), kNss));
+            ASSERT(routingInfo.cm());
+            if (initialVersion.isOlderThan(routingInfo.cm()->getVersion())) {
+                return boost::make_optional(routingInfo);
+            }
+
+            sleepmillis(10);
+        }
+
+        return boost::optional<CachedCollectionRoutingInfo>();
+    });
+
+    expectGetCollection(version.epoch(), shardKeyPattern);
+
+    // Return set of chunks, which represent a move
+    expectFindOnConfigSendBSONObjVector([&]() {
+        version.incMajor();
+        ChunkType chunk1(
+            kNss, {shardKeyPattern.getKeyPattern().globalMin(), BSON("_id" << 0)}, version, {"1"});
+
+        version.incMinor();
+        ChunkType chunk2(
+            kNss, {BSON("_id" << 0), shardKeyPattern.getKeyPattern().globalMax()}, version, {"0"});
+
+        return std::vector<BSONObj>{chunk1.toConfigBSON(), chunk2.toConfigBSON()};
+    }());
+
+    auto routingInfo = future.timed_get(kFutureTimeout);
+    ASSERT(routingInfo);
+    auto cm = routingInfo->cm();
+
+    ASSERT_EQ(2, cm->numChunks());
+    ASSERT_EQ(version, cm->getVersion());
+}
+
 }  // namespace
 }  // namespace mongo
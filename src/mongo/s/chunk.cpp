@@ -40,6 +40,7 @@ Chunk::Chunk(const ChunkType& from)
     : _range(from.getMin(), from.getMax()),
       _shardId(from.getShard()),
       _lastmod(from.getVersion()),
+      _fieldSummaries(from.getFieldSummaries()),
       _jumbo(from.getJumbo()),
       _dataWritten(0) {
     invariantOK(from.validate());
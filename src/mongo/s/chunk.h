@@ -66,6 +66,14 @@ public:
         return _jumbo;
     }
 
+    /**
+     * Published min/max summaries of non-shard-key fields for the documents in this chunk. See
+     * ChunkType::getFieldSummaries for the format.
+     */
+    const BSONObj& getFieldSummaries() const {
+        return _fieldSummaries;
+    }
+
     /**
      * Returns a string represenation of the chunk for logging.
      */
@@ -98,6 +106,8 @@ private:
 
     const ChunkVersion _lastmod;
 
+    const BSONObj _fieldSummaries;
+
     // Indicates whether this chunk should be treated as jumbo and not attempted to be moved or
     // split
     mutable bool _jumbo;
@@ -32,6 +32,8 @@
 
 #include "mongo/s/chunk_manager.h"
 
+#include <numeric>
+
 #include "mongo/base/owned_pointer_vector.h"
 #include "mongo/bson/simple_bsonobj_comparator.h"
 #include "mongo/db/matcher/extensions_callback_noop.h"
@@ -39,6 +41,7 @@
 #include "mongo/db/query/index_bounds_builder.h"
 #include "mongo/db/query/query_planner.h"
 #include "mongo/db/query/query_planner_common.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/storage/key_string.h"
 #include "mongo/util/log.h"
 
@@ -56,16 +59,108 @@ void checkAllElementsAreOfType(BSONType type, const BSONObj& o) {
     }
 }
 
-std::string extractKeyStringInternal(const BSONObj& shardKeyValue, Ordering ordering) {
+void checkNoGapOrOverlap(const ChunkRange& lower, const ChunkRange& upper) {
+    uassert(ErrorCodes::ConflictingOperationInProgress,
+            str::stream() << "Gap or an overlap between ranges " << upper.toString() << " and "
+                          << lower.toString(),
+            SimpleBSONObjComparator::kInstance.evaluate(lower.getMax() == upper.getMin()));
+}
+
+void resetKeyStringInternal(const BSONObj& shardKeyValue, Ordering ordering, KeyString* ks) {
     BSONObjBuilder strippedKeyValue;
     for (const auto& elem : shardKeyValue) {
         strippedKeyValue.appendAs(elem, ""_sd);
     }
 
-    KeyString ks(KeyString::Version::V1, strippedKeyValue.done(), ordering);
+    ks->resetToKey(strippedKeyValue.done(), ordering);
+}
+
+std::string extractKeyStringInternal(const BSONObj& shardKeyValue, Ordering ordering) {
+    KeyString ks(KeyString::Version::V1);
+    resetKeyStringInternal(shardKeyValue, ordering, &ks);
     return {ks.getBuffer(), ks.getSize()};
 }
 
+// Number of chunks to step over when looking up sorted keys, before falling back to a search of
+// the chunk map
+const int kMaxSequentialChunkSteps = 4;
+
+// Whether queries, which do not target specific shard key ranges, should skip the chunks whose
+// published field summaries rule out any matches. Shards widen the published summaries before a
+// write commits, which bumps the collection version, so a routing table can only be used to skip
+// chunks while its version is still the latest one on the config server. Checking this costs a
+// read from the config server primary for each query which would skip a shard.
+MONGO_EXPORT_SERVER_PARAMETER(useChunkFieldSummariesForTargeting, bool, false);
+
+// Set on startup by the component which can reach the config server
+ChunkManager::CollectionVersionFetcher collectionVersionFetcher;
+
+/**
+ * Returns true if any of the intervals in 'oil' overlaps the [min, max] range described by a field
+ * summary.
+ */
+bool intervalsOverlapFieldSummary(const OrderedIntervalList& oil, const BSONObj& summary) {
+    const auto summaryMin = summary[ChunkType::kFieldSummaryMin];
+    const auto summaryMax = summary[ChunkType::kFieldSummaryMax];
+
+    for (const auto& interval : oil.intervals) {
+        const int endToMin = interval.end.woCompare(summaryMin, false);
+        if (endToMin < 0 || (endToMin == 0 && !interval.endInclusive)) {
+            continue;
+        }
+
+        const int startToMax = interval.start.woCompare(summaryMax, false);
+        if (startToMax > 0 || (startToMax == 0 && !interval.startInclusive)) {
+            continue;
+        }
+
+        return true;
+    }
+
+    return false;
+}
+
+/**
+ * Checks chunks' published field summaries against the bounds which a query imposes on the
+ * respective fields. The bounds for each field are only computed the first time a chunk with a
+ * summary for it is checked.
+ */
+class FieldSummaryFilter {
+public:
+    explicit FieldSummaryFilter(const CanonicalQuery& cq) : _cq(cq) {}
+
+    /**
+     * Returns false if the field summaries of 'chunk' show that none of its documents can match
+     * the query.
+     */
+    bool mayMatch(const Chunk& chunk) {
+        for (const auto& summaryElem : chunk.getFieldSummaries()) {
+            const auto& oil = _boundsForField(summaryElem.fieldName());
+            if (!intervalsOverlapFieldSummary(oil, summaryElem.Obj())) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+private:
+    const OrderedIntervalList& _boundsForField(const std::string& fieldName) {
+        auto it = _boundsByField.find(fieldName);
+        if (it == _boundsByField.end()) {
+            auto bounds = ChunkManager::getIndexBoundsForQuery(BSON(fieldName << 1), _cq);
+            invariant(bounds.size() == 1);
+            it = _boundsByField.emplace(fieldName, std::move(bounds.fields[0])).first;
+        }
+
+        return it->second;
+    }
+
+    const CanonicalQuery& _cq;
+
+    std::map<std::string, OrderedIntervalList> _boundsByField;
+};
+
 }  // namespace
 
 ChunkManager::ChunkManager(NamespaceString nss,
@@ -74,6 +169,7 @@ ChunkManager::ChunkManager(NamespaceString nss,
                            std::unique_ptr<CollatorInterface> defaultCollator,
                            bool unique,
                            ChunkMap chunkMap,
+                           ChunkMapViews chunkMapViews,
                            ChunkVersion collectionVersion)
     : _sequenceNumber(nextCMSequenceNumber.addAndFetch(1)),
       _nss(std::move(nss)),
@@ -83,8 +179,7 @@ ChunkManager::ChunkManager(NamespaceString nss,
       _defaultCollator(std::move(defaultCollator)),
       _unique(unique),
       _chunkMap(std::move(chunkMap)),
-      _chunkMapViews(
-          _constructChunkMapViews(collectionVersion.epoch(), _chunkMap, _shardKeyOrdering)),
+      _chunkMapViews(std::move(chunkMapViews)),
       _collectionVersion(collectionVersion) {}
 
 std::shared_ptr<Chunk> ChunkManager::findIntersectingChunk(const BSONObj& shardKey,
@@ -113,6 +208,63 @@ std::shared_ptr<Chunk> ChunkManager::findIntersectingChunkWithSimpleCollation(
     return findIntersectingChunk(shardKey, CollationSpec::kSimpleSpec);
 }
 
+std::vector<std::shared_ptr<Chunk>> ChunkManager::findIntersectingChunksWithSimpleCollation(
+    const std::vector<BSONObj>& shardKeys) const {
+    // Encode all the keys into a single buffer, so that targeting a large batch does not allocate
+    // a string per key
+    std::string keyStrings;
+    std::vector<std::pair<size_t, size_t>> keyStringRanges;
+    keyStringRanges.reserve(shardKeys.size());
+
+    KeyString ks(KeyString::Version::V1);
+    for (const auto& shardKey : shardKeys) {
+        resetKeyStringInternal(shardKey, _shardKeyOrdering, &ks);
+        keyStringRanges.emplace_back(keyStrings.size(), ks.getSize());
+        keyStrings.append(ks.getBuffer(), ks.getSize());
+    }
+
+    const auto keyStringAt = [&](size_t i) {
+        return StringData(keyStrings.data() + keyStringRanges[i].first,
+                          keyStringRanges[i].second);
+    };
+
+    std::vector<size_t> order(shardKeys.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&](size_t lhs, size_t rhs) {
+        return keyStringAt(lhs) < keyStringAt(rhs);
+    });
+
+    std::vector<std::shared_ptr<Chunk>> chunks(shardKeys.size());
+
+    // Since the keys are visited in increasing order, the upper bound of each key is never before
+    // the upper bound of the previous one, so 'it' only needs to move forward
+    auto it = _chunkMap.end();
+    bool positioned = false;
+    for (const auto i : order) {
+        const auto keyString = keyStringAt(i);
+
+        if (!positioned) {
+            it = _chunkMap.upper_bound(keyString.toString());
+            positioned = true;
+        } else {
+            int steps = 0;
+            while (it != _chunkMap.end() && !(keyString < StringData(it->first))) {
+                if (++steps > kMaxSequentialChunkSteps) {
+                    it = _chunkMap.upper_bound(keyString.toString());
+                    break;
+                }
+                ++it;
+            }
+        }
+
+        if (it != _chunkMap.end() && it->second->containsKey(shardKeys[i])) {
+            chunks[i] = it->second;
+        }
+    }
+
+    return chunks;
+}
+
 bool ChunkManager::keyBelongsToShard(const BSONObj& shardKey, const ShardId& shardId) const {
     if (shardKey.isEmpty())
         return false;
@@ -121,7 +273,7 @@ bool ChunkManager::keyBelongsToShard(const BSONObj& shardKey, const ShardId& sha
     if (it == _chunkMapViews.chunkRangeMap.end())
         return false;
 
-    return it->shardId == shardId;
+    return it->second.shardId == shardId;
 }
 
 void ChunkManager::getShardIdsForQuery(OperationContext* opCtx,
@@ -172,20 +324,36 @@ void ChunkManager::getShardIdsForQuery(OperationContext* opCtx,
     //   => Ranges { a : 1, b : 3 } => { a : 2, b : 4 }
     BoundList ranges = _shardKeyPattern.flattenBounds(bounds);
 
+    std::set<ShardId> rangeShardIds;
     for (BoundList::const_iterator it = ranges.begin(); it != ranges.end(); ++it) {
-        getShardIdsForRange(it->first /*min*/, it->second /*max*/, shardIds);
+        getShardIdsForRange(it->first /*min*/, it->second /*max*/, &rangeShardIds);
 
         // once we know we need to visit all shards no need to keep looping
-        if (shardIds->size() == _chunkMapViews.shardVersions.size()) {
+        if (rangeShardIds.size() == _chunkMapViews.shardVersions.size()) {
             break;
         }
     }
 
+    // Field summaries contain the raw field values, so they can only be compared against bounds
+    // generated with the simple collation
+    if (useChunkFieldSummariesForTargeting.load() && !cq->getCollator()) {
+        std::set<ShardId> summaryShardIds;
+        _getShardIdsForRangesUsingFieldSummaries(*cq, ranges, &summaryShardIds);
+
+        // A routing table which missed a widening of the summaries could skip a shard holding
+        // matching documents, so only do so if no chunk changed since it was loaded
+        if (summaryShardIds.size() < rangeShardIds.size() && _isLatestCollectionVersion(opCtx)) {
+            rangeShardIds = std::move(summaryShardIds);
+        }
+    }
+
+    shardIds->insert(rangeShardIds.begin(), rangeShardIds.end());
+
     // SERVER-4914 Some clients of getShardIdsForQuery() assume at least one shard will be returned.
     // For now, we satisfy that assumption by adding a shard with no matches rather than returning
     // an empty set of shards.
     if (shardIds->empty()) {
-        shardIds->insert(_chunkMapViews.chunkRangeMap.begin()->shardId);
+        shardIds->insert(_chunkMapViews.chunkRangeMap.begin()->second.shardId);
     }
 }
 
@@ -194,7 +362,7 @@ void ChunkManager::getShardIdsForRange(const BSONObj& min,
                                        std::set<ShardId>* shardIds) const {
     const auto bounds = _overlappingRanges(min, max, true);
     for (auto it = bounds.first; it != bounds.second; ++it) {
-        shardIds->insert(it->shardId);
+        shardIds->insert(it->second.shardId);
 
         // No need to iterate through the rest of the ranges, because we already know we need to use
         // all shards.
@@ -204,10 +372,58 @@ void ChunkManager::getShardIdsForRange(const BSONObj& min,
     }
 }
 
+void ChunkManager::_getShardIdsForRangesUsingFieldSummaries(const CanonicalQuery& cq,
+                                                            const BoundList& ranges,
+                                                            std::set<ShardId>* shardIds) const {
+    FieldSummaryFilter filter(cq);
+
+    for (const auto& range : ranges) {
+        // Unlike getShardIdsForRange, this needs to look at the individual chunks rather than the
+        // per-shard ranges, because each chunk has its own summaries
+        for (auto it = _chunkMap.upper_bound(_extractKeyString(range.first));
+             it != _chunkMap.end() &&
+             SimpleBSONObjComparator::kInstance.evaluate(it->second->getMin() <= range.second);
+             ++it) {
+            const auto& chunk = it->second;
+            if (shardIds->count(chunk->getShardId()) || !filter.mayMatch(*chunk)) {
+                continue;
+            }
+
+            shardIds->insert(chunk->getShardId());
+
+            // No need to look at the rest of the chunks, because we already know we need to use
+            // all shards
+            if (shardIds->size() == _chunkMapViews.shardVersions.size()) {
+                return;
+            }
+        }
+    }
+}
+
+bool ChunkManager::_isLatestCollectionVersion(OperationContext* opCtx) const {
+    if (!collectionVersionFetcher) {
+        return false;
+    }
+
+    auto swLatestVersion = collectionVersionFetcher(opCtx, _nss);
+    if (!swLatestVersion.isOK()) {
+        LOG(1) << "Not using field summaries to target " << _nss.ns()
+               << " because the latest collection version could not be read"
+               << causedBy(redact(swLatestVersion.getStatus()));
+        return false;
+    }
+
+    return swLatestVersion.getValue().isStrictlyEqualTo(_collectionVersion);
+}
+
+void ChunkManager::registerCollectionVersionFetcher(CollectionVersionFetcher fetcher) {
+    collectionVersionFetcher = std::move(fetcher);
+}
+
 bool ChunkManager::rangeOverlapsShard(const ChunkRange& range, const ShardId& shardId) const {
     const auto bounds = _overlappingRanges(range.getMin(), range.getMax(), false);
     const auto it = std::find_if(bounds.first, bounds.second, [&shardId](const auto& scr) {
-        return scr.shardId == shardId;
+        return scr.second.shardId == shardId;
     });
     return it != bounds.second;
 }
@@ -377,7 +593,7 @@ std::string ChunkManager::toString() const {
 
     sb << "Ranges:\n";
     for (const auto& entry : _chunkMapViews.chunkRangeMap) {
-        sb << "\t" << entry.range.toString() << " @ " << entry.shardId << '\n';
+        sb << "\t" << entry.second.range.toString() << " @ " << entry.second.shardId << '\n';
     }
 
     sb << "Shard versions:\n";
@@ -389,8 +605,7 @@ std::string ChunkManager::toString() const {
 }
 
 ChunkManager::ChunkMapViews ChunkManager::_constructChunkMapViews(const OID& epoch,
-                                                                  const ChunkMap& chunkMap,
-                                                                  Ordering shardKeyOrdering) {
+                                                                  const ChunkMap& chunkMap) {
     ChunkRangeMap chunkRangeMap;
     ShardVersionMap shardVersions;
     ChunkMap::const_iterator current = chunkMap.cbegin();
@@ -429,29 +644,23 @@ ChunkManager::ChunkMapViews ChunkManager::_constructChunkMapViews(const OID& epo
         const BSONObj rangeMax = rangeLast->second->getMax();
 
         if (!chunkRangeMap.empty()) {
-            uassert(
-                ErrorCodes::ConflictingOperationInProgress,
-                str::stream()
-                    << "Metadata contains chunks with the same or out-of-order max value; "
-                       "expected "
-                    << chunkRangeMap.back().max()
-                    << " < "
-                    << rangeMax,
-                SimpleBSONObjComparator::kInstance.evaluate(chunkRangeMap.back().max() < rangeMax));
-            // Make sure there are no gaps in the ranges
+            const auto& lastRange = std::prev(chunkRangeMap.cend())->second;
             uassert(ErrorCodes::ConflictingOperationInProgress,
-                    str::stream() << "Gap or an overlap between ranges "
-                                  << ChunkRange(rangeMin, rangeMax).toString()
-                                  << " and "
-                                  << chunkRangeMap.back().range.toString(),
-                    SimpleBSONObjComparator::kInstance.evaluate(chunkRangeMap.back().max() ==
-                                                                rangeMin));
+                    str::stream()
+                        << "Metadata contains chunks with the same or out-of-order max value; "
+                           "expected "
+                        << lastRange.max()
+                        << " < "
+                        << rangeMax,
+                    SimpleBSONObjComparator::kInstance.evaluate(lastRange.max() < rangeMax));
+            // Make sure there are no gaps in the ranges
+            checkNoGapOrOverlap(lastRange.range, ChunkRange(rangeMin, rangeMax));
         }
 
-        chunkRangeMap.emplace_back(
-            ShardAndChunkRange{{rangeMin, rangeMax},
-                               firstChunkInRange->getShardId(),
-                               extractKeyStringInternal(rangeMax, shardKeyOrdering)});
+        // The key of the last chunk in the range is the KeyString of the range's max
+        chunkRangeMap.insert(std::make_pair(
+            rangeLast->first,
+            ShardAndChunkRange{{rangeMin, rangeMax}, firstChunkInRange->getShardId()}));
 
         // If a shard has chunks it must have a shard version, otherwise we have an invalid chunk
         // somewhere, which should have been caught at chunk load time
@@ -462,12 +671,12 @@ ChunkManager::ChunkMapViews ChunkManager::_constructChunkMapViews(const OID& epo
         invariant(!chunkRangeMap.empty());
         invariant(!shardVersions.empty());
 
-        checkAllElementsAreOfType(MinKey, chunkRangeMap.front().min());
-        checkAllElementsAreOfType(MaxKey, chunkRangeMap.back().max());
+        checkAllElementsAreOfType(MinKey, chunkRangeMap.cbegin()->second.min());
+        checkAllElementsAreOfType(MaxKey, std::prev(chunkRangeMap.cend())->second.max());
 
-        DEV for (size_t i = 0; i < chunkRangeMap.size() - 1; ++i) {
-            const auto& c1 = chunkRangeMap[i];
-            const auto& c2 = chunkRangeMap[i + 1];
+        DEV for (auto it = chunkRangeMap.cbegin(); std::next(it) != chunkRangeMap.cend(); ++it) {
+            const auto& c1 = it->second;
+            const auto& c2 = std::next(it)->second;
 
             invariant(SimpleBSONObjComparator::kInstance.evaluate(c1.max() == c2.min()),
                       str::stream() << "Found gap between " << c1.range.toString() << " and "
@@ -484,28 +693,7 @@ std::string ChunkManager::_extractKeyString(const BSONObj& shardKeyValue) const
 
 ChunkManager::ChunkRangeMap::const_iterator ChunkManager::_rangeMapUpperBound(
     const BSONObj& key) const {
-
-    // This class is necessary, because the last argument to std::upper_bound is a functor which
-    // implements the BinaryPredicate concept. A binary predicate pred must be able to evaluate both
-    // pred(*iter1, *iter2) and pred(*iter1, value). The type of "value" in this case is
-    // std::string, while the type of *Iter is ShardAndChunkRange.
-    struct Key {
-        static const std::string& extract(const std::string& k) {
-            return k;
-        }
-        static void extract(std::string&& k) = delete;
-        static const std::string& extract(const ShardAndChunkRange& scr) {
-            return scr.ksMax;
-        }
-        static const std::string& extract(ShardAndChunkRange&&) = delete;
-    };
-
-    return std::upper_bound(_chunkMapViews.chunkRangeMap.cbegin(),
-                            _chunkMapViews.chunkRangeMap.cend(),
-                            _extractKeyString(key),
-                            [](const auto& lhs, const auto& rhs) -> bool {
-                                return Key::extract(lhs) < Key::extract(rhs);
-                            });
+    return _chunkMapViews.chunkRangeMap.upper_bound(_extractKeyString(key));
 }
 
 std::pair<ChunkManager::ChunkRangeMap::const_iterator, ChunkManager::ChunkRangeMap::const_iterator>
@@ -525,7 +713,8 @@ ChunkManager::_overlappingRanges(const mongo::BSONObj& min,
     // chunk, in which case bumping the end will result in one extra chunk claimed to cover the
     // range.
     if (end != _chunkMapViews.chunkRangeMap.cend() &&
-        (isMaxInclusive || SimpleBSONObjComparator::kInstance.evaluate(max > end->min()))) {
+        (isMaxInclusive ||
+         SimpleBSONObjComparator::kInstance.evaluate(max > end->second.min()))) {
         ++end;
     }
 
@@ -546,6 +735,7 @@ std::shared_ptr<ChunkManager> ChunkManager::makeNew(
                         std::move(defaultCollator),
                         std::move(unique),
                         {},
+                        {},
                         {0, 0, epoch})
         .makeUpdated(chunks);
 }
@@ -554,7 +744,19 @@ std::shared_ptr<ChunkManager> ChunkManager::makeUpdated(
     const std::vector<ChunkType>& changedChunks) {
 
     const auto startingCollectionVersion = getVersion();
+    const auto& epoch = startingCollectionVersion.epoch();
+
+    // Copying the chunk map and the shard versions only copies their top-level structure, the
+    // chunks themselves are shared with this chunk manager.
     auto chunkMap = _chunkMap;
+    auto shardVersions = _chunkMapViews.shardVersions;
+
+    // Key ranges of the chunk map replaced by the changes, which are the only parts of the chunk
+    // range map that need to be rebuilt
+    std::vector<ChangedRange> changedRanges;
+
+    // Shards which lost the chunk determining their shard version without getting a newer one
+    std::set<ShardId> shardsToRecompute;
 
     ChunkVersion collectionVersion = startingCollectionVersion;
     for (const auto& chunk : changedChunks) {
@@ -570,8 +772,8 @@ std::shared_ptr<ChunkManager> ChunkManager::makeUpdated(
         invariant(chunkVersion >= collectionVersion);
         collectionVersion = chunkVersion;
 
-        const auto chunkMinKeyString = _extractKeyString(chunk.getMin());
-        const auto chunkMaxKeyString = _extractKeyString(chunk.getMax());
+        auto chunkMinKeyString = _extractKeyString(chunk.getMin());
+        auto chunkMaxKeyString = _extractKeyString(chunk.getMax());
 
         // Returns the first chunk with a max key that is > min - implies that the chunk overlaps
         // min
@@ -581,11 +783,27 @@ std::shared_ptr<ChunkManager> ChunkManager::makeUpdated(
         // not overlap max
         const auto high = chunkMap.upper_bound(chunkMaxKeyString);
 
+        for (auto it = low; it != high; ++it) {
+            const auto& removedChunk = it->second;
+            const auto shardVersionIt = shardVersions.find(removedChunk->getShardId());
+            if (shardVersionIt != shardVersions.end() &&
+                removedChunk->getLastmod() == shardVersionIt->second) {
+                shardsToRecompute.insert(removedChunk->getShardId());
+            }
+        }
+
         // Erase all chunks from the map, which overlap the chunk we got from the persistent store
         chunkMap.erase(low, high);
 
         // Insert only the chunk itself
         chunkMap.insert(std::make_pair(chunkMaxKeyString, std::make_shared<Chunk>(chunk)));
+
+        // The chunk's version is newer than that of any chunk already in the map, so it is the
+        // version of its shard
+        shardVersions[chunk.getShard()] = chunkVersion;
+        shardsToRecompute.erase(chunk.getShard());
+
+        changedRanges.push_back({std::move(chunkMinKeyString), std::move(chunkMaxKeyString)});
     }
 
     // If at least one diff was applied, the metadata is correct, but it might not have changed so
@@ -599,6 +817,48 @@ std::shared_ptr<ChunkManager> ChunkManager::makeUpdated(
         return shared_from_this();
     }
 
+    ChunkMapViews chunkMapViews;
+    if (_chunkMap.empty()) {
+        chunkMapViews = _constructChunkMapViews(epoch, chunkMap);
+    } else {
+        chunkMapViews.chunkRangeMap = _chunkMapViews.chunkRangeMap;
+        _updateChunkRangeMap(chunkMap, std::move(changedRanges), &chunkMapViews.chunkRangeMap);
+
+        // Only a shard which gave away its most recently changed chunks without receiving any new
+        // chunk needs to look at its remaining chunks
+        if (!shardsToRecompute.empty()) {
+            for (const auto& shardId : shardsToRecompute) {
+                shardVersions.erase(shardId);
+            }
+            for (const auto& entry : chunkMap) {
+                const auto& chunk = entry.second;
+                if (!shardsToRecompute.count(chunk->getShardId()))
+                    continue;
+
+                auto& shardVersion =
+                    shardVersions.emplace(chunk->getShardId(), ChunkVersion(0, 0, epoch))
+                        .first->second;
+                if (chunk->getLastmod() > shardVersion)
+                    shardVersion = chunk->getLastmod();
+            }
+        }
+        chunkMapViews.shardVersions = std::move(shardVersions);
+
+        DEV {
+            const auto expected = _constructChunkMapViews(epoch, chunkMap);
+            invariant(expected.shardVersions == chunkMapViews.shardVersions);
+            invariant(expected.chunkRangeMap.size() == chunkMapViews.chunkRangeMap.size());
+            for (auto expectedIt = expected.chunkRangeMap.cbegin(),
+                      it = chunkMapViews.chunkRangeMap.cbegin();
+                 expectedIt != expected.chunkRangeMap.cend();
+                 ++expectedIt, ++it) {
+                invariant(expectedIt->first == it->first);
+                invariant(expectedIt->second.shardId == it->second.shardId);
+                invariant(expectedIt->second.range == it->second.range);
+            }
+        }
+    }
+
     return std::shared_ptr<ChunkManager>(
         new ChunkManager(_nss,
                          _uuid,
@@ -606,7 +866,119 @@ std::shared_ptr<ChunkManager> ChunkManager::makeUpdated(
                          CollatorInterface::cloneCollator(getDefaultCollator()),
                          isUnique(),
                          std::move(chunkMap),
+                         std::move(chunkMapViews),
                          collectionVersion));
 }
 
+void ChunkManager::_updateChunkRangeMap(const ChunkMap& chunkMap,
+                                        std::vector<ChangedRange> changedRanges,
+                                        ChunkRangeMap* chunkRangeMap) {
+    // Coalesce the changed ranges which overlap or touch, so that each one below is surrounded by
+    // chunks which did not change
+    std::sort(changedRanges.begin(), changedRanges.end(), [](const auto& lhs, const auto& rhs) {
+        return lhs.ksMin < rhs.ksMin;
+    });
+
+    std::vector<ChangedRange> coalesced;
+    for (auto& changed : changedRanges) {
+        if (!coalesced.empty() && changed.ksMin <= coalesced.back().ksMax) {
+            if (coalesced.back().ksMax < changed.ksMax)
+                coalesced.back().ksMax = std::move(changed.ksMax);
+        } else {
+            coalesced.push_back(std::move(changed));
+        }
+    }
+
+    for (const auto& changed : coalesced) {
+        // The chunks which replaced the changed range, along with the unchanged chunks right
+        // before and after them. Since the chunk map was valid before the changes, checking that
+        // these are contiguous is enough to validate the whole map.
+        const auto chunksBegin = chunkMap.upper_bound(changed.ksMin);
+        const auto chunksEnd = chunkMap.upper_bound(changed.ksMax);
+        uassert(ErrorCodes::ConflictingOperationInProgress,
+                "Routing table update left no chunk in the range of a changed chunk",
+                chunksBegin != chunksEnd);
+
+        const auto& firstChunk = chunksBegin->second;
+        const auto& lastChunk = std::prev(chunksEnd)->second;
+        const bool hasChunkBefore = chunksBegin != chunkMap.cbegin();
+        const bool hasChunkAfter = chunksEnd != chunkMap.cend();
+
+        if (hasChunkBefore) {
+            checkNoGapOrOverlap(ChunkRange(std::prev(chunksBegin)->second->getMin(),
+                                           std::prev(chunksBegin)->second->getMax()),
+                                ChunkRange(firstChunk->getMin(), firstChunk->getMax()));
+        } else {
+            checkAllElementsAreOfType(MinKey, firstChunk->getMin());
+        }
+        if (hasChunkAfter) {
+            checkNoGapOrOverlap(ChunkRange(lastChunk->getMin(), lastChunk->getMax()),
+                                ChunkRange(chunksEnd->second->getMin(),
+                                           chunksEnd->second->getMax()));
+        } else {
+            checkAllElementsAreOfType(MaxKey, lastChunk->getMax());
+        }
+
+        // The ranges currently covering [firstChunk min, lastChunk max), extended by the ranges
+        // right before and after, which might have to be merged with the rebuilt ones
+        auto rangesBegin = hasChunkBefore
+            ? chunkRangeMap->upper_bound(std::prev(chunksBegin)->first)
+            : chunkRangeMap->cbegin();
+        auto rangesEnd = chunkRangeMap->lower_bound(std::prev(chunksEnd)->first);
+        invariant(rangesBegin != chunkRangeMap->cend());
+        invariant(rangesEnd != chunkRangeMap->cend());
+        ++rangesEnd;
+
+        std::vector<std::pair<std::string, ShardAndChunkRange>> newRanges;
+        auto appendRange = [&newRanges](std::string ksMax, ShardAndChunkRange range) {
+            if (!newRanges.empty() && newRanges.back().second.shardId == range.shardId) {
+                newRanges.back().first = std::move(ksMax);
+                newRanges.back().second.range =
+                    ChunkRange(newRanges.back().second.min(), range.max());
+            } else {
+                newRanges.emplace_back(std::move(ksMax), std::move(range));
+            }
+        };
+
+        // Whatever part of the first range lies before the rebuilt chunks is unchanged
+        const auto& firstRange = rangesBegin->second;
+        if (SimpleBSONObjComparator::kInstance.evaluate(firstRange.min() != firstChunk->getMin())) {
+            appendRange(std::prev(chunksBegin)->first,
+                        {{firstRange.min(), firstChunk->getMin()}, firstRange.shardId});
+        } else if (rangesBegin != chunkRangeMap->cbegin()) {
+            --rangesBegin;
+            appendRange(rangesBegin->first, rangesBegin->second);
+        }
+
+        for (auto it = chunksBegin; it != chunksEnd; ++it) {
+            const auto& chunk = it->second;
+            if (it != chunksBegin) {
+                const auto& prevChunk = std::prev(it)->second;
+                checkNoGapOrOverlap(ChunkRange(prevChunk->getMin(), prevChunk->getMax()),
+                                    ChunkRange(chunk->getMin(), chunk->getMax()));
+            }
+            appendRange(it->first, {{chunk->getMin(), chunk->getMax()}, chunk->getShardId()});
+        }
+
+        // Whatever part of the last range lies after the rebuilt chunks is unchanged
+        const auto& lastRange = std::prev(rangesEnd)->second;
+        if (SimpleBSONObjComparator::kInstance.evaluate(lastRange.max() != lastChunk->getMax())) {
+            appendRange(std::prev(rangesEnd)->first,
+                        {{lastChunk->getMax(), lastRange.max()}, lastRange.shardId});
+        } else if (rangesEnd != chunkRangeMap->cend()) {
+            appendRange(rangesEnd->first, rangesEnd->second);
+            ++rangesEnd;
+        }
+
+        chunkRangeMap->erase(rangesBegin, rangesEnd);
+        for (auto& newRange : newRanges) {
+            chunkRangeMap->insert(std::move(newRange));
+        }
+    }
+
+    invariant(!chunkRangeMap->empty());
+    checkAllElementsAreOfType(MinKey, chunkRangeMap->cbegin()->second.min());
+    checkAllElementsAreOfType(MaxKey, std::prev(chunkRangeMap->cend())->second.max());
+}
+
 }  // namespace mongo
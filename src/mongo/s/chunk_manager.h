@@ -40,7 +40,9 @@
 #include "mongo/s/chunk_version.h"
 #include "mongo/s/client/shard.h"
 #include "mongo/s/shard_key_pattern.h"
+#include "mongo/stdx/functional.h"
 #include "mongo/util/concurrency/ticketholder.h"
+#include "mongo/util/persistent_ordered_map.h"
 
 namespace mongo {
 
@@ -48,8 +50,9 @@ class CanonicalQuery;
 struct QuerySolutionNode;
 class OperationContext;
 
-// Ordered map from the max for each chunk to an entry describing the chunk
-using ChunkMap = std::map<std::string, std::shared_ptr<Chunk>>;
+// Ordered map from the max for each chunk to an entry describing the chunk. Copies share storage so
+// that routing table refreshes only pay for the chunks which changed.
+using ChunkMap = PersistentOrderedMap<std::string, std::shared_ptr<Chunk>>;
 
 // Map from a shard is to the max chunk version on that shard
 using ShardVersionMap = std::map<ShardId, ChunkVersion>;
@@ -129,9 +132,24 @@ public:
      *
      * The changes in "changedChunks" must be sorted in ascending order by chunk version, and adhere
      * to the requirements of the routing table update algorithm.
+     *
+     * The new instance shares the unchanged parts of its chunk map and of the views derived from
+     * it with this one, so the cost of the update is proportional to the number of changed chunks.
      */
     std::shared_ptr<ChunkManager> makeUpdated(const std::vector<ChunkType>& changedChunks);
 
+    /**
+     * Returns the most recent version of collection 'nss' on the config server.
+     */
+    using CollectionVersionFetcher =
+        stdx::function<StatusWith<ChunkVersion>(OperationContext*, const NamespaceString&)>;
+
+    /**
+     * Registers the function used to check that a routing table is the latest one before its field
+     * summaries are used to skip shards. Without one, the summaries are never used.
+     */
+    static void registerCollectionVersionFetcher(CollectionVersionFetcher fetcher);
+
     /**
      * Returns an increasing number of the reload sequence number of this chunk manager.
      */
@@ -208,9 +226,23 @@ public:
      */
     std::shared_ptr<Chunk> findIntersectingChunkWithSimpleCollation(const BSONObj& shardKey) const;
 
+    /**
+     * Batch version of findIntersectingChunkWithSimpleCollation, which returns the chunk for each
+     * of 'shardKeys' in the same order as the keys. The keys are looked up in sorted order, so
+     * that consecutive keys falling in the same or in neighbouring chunks do not need a separate
+     * search of the chunk map. Unlike the single key version, a key which cannot be targeted does
+     * not throw, but gets a null entry in the result.
+     */
+    std::vector<std::shared_ptr<Chunk>> findIntersectingChunksWithSimpleCollation(
+        const std::vector<BSONObj>& shardKeys) const;
+
     /**
      * Finds the shard IDs for a given filter and collation. If collation is empty, we use the
      * collection default collation for targeting.
+     *
+     * If the 'useChunkFieldSummariesForTargeting' server parameter is enabled, shards whose chunks'
+     * field summaries rule out any matches are skipped, but only after checking with the config
+     * server that this routing table is still the latest one.
      */
     void getShardIdsForQuery(OperationContext* opCtx,
                              const BSONObj& query,
@@ -276,10 +308,10 @@ private:
 
         ChunkRange range;
         ShardId shardId;
-        std::string ksMax;
     };
 
-    using ChunkRangeMap = std::vector<ShardAndChunkRange>;
+    // Ordered map from the KeyString of the max of each range to the range
+    using ChunkRangeMap = PersistentOrderedMap<std::string, ShardAndChunkRange>;
 
     /**
      * Contains different transformations of the chunk map for efficient querying
@@ -288,19 +320,33 @@ private:
         // Transformation of the chunk map containing what range of keys reside on which shard. The
         // index is the max key of the respective range and the union of all ranges in a such
         // constructed map must cover the complete space from [MinKey, MaxKey).
-        const ChunkRangeMap chunkRangeMap;
+        ChunkRangeMap chunkRangeMap;
 
         // Map from shard id to the maximum chunk version for that shard. If a shard contains no
         // chunks, it won't be present in this map.
-        const ShardVersionMap shardVersions;
+        ShardVersionMap shardVersions;
+    };
+
+    /**
+     * Key range [min, max) of the chunk map which was replaced by a routing table update.
+     */
+    struct ChangedRange {
+        std::string ksMin;
+        std::string ksMax;
     };
 
     /**
      * Does a single pass over the chunkMap and constructs the ChunkMapViews object.
      */
-    static ChunkMapViews _constructChunkMapViews(const OID& epoch,
-                                                 const ChunkMap& chunkMap,
-                                                 Ordering shardKeyOrdering);
+    static ChunkMapViews _constructChunkMapViews(const OID& epoch, const ChunkMap& chunkMap);
+
+    /**
+     * Brings "chunkRangeMap", which describes the chunk map before the changes, up to date with
+     * "chunkMap" by rebuilding only the ranges around "changedRanges".
+     */
+    static void _updateChunkRangeMap(const ChunkMap& chunkMap,
+                                     std::vector<ChangedRange> changedRanges,
+                                     ChunkRangeMap* chunkRangeMap);
 
     ChunkManager(NamespaceString nss,
                  boost::optional<UUID> uuid,
@@ -308,6 +354,7 @@ private:
                  std::unique_ptr<CollatorInterface> defaultCollator,
                  bool unique,
                  ChunkMap chunkMap,
+                 ChunkMapViews chunkMapViews,
                  ChunkVersion collectionVersion);
 
     std::string _extractKeyString(const BSONObj& shardKeyValue) const;
@@ -317,6 +364,20 @@ private:
     std::pair<ChunkRangeMap::const_iterator, ChunkRangeMap::const_iterator> _overlappingRanges(
         const BSONObj& min, const BSONObj& max, bool isMaxInclusive) const;
 
+    /**
+     * Adds to 'shardIds' the shards of all chunks, which overlap any of the inclusive shard key
+     * 'ranges' and whose published field summaries do not rule out matches for 'cq'.
+     */
+    void _getShardIdsForRangesUsingFieldSummaries(const CanonicalQuery& cq,
+                                                  const BoundList& ranges,
+                                                  std::set<ShardId>* shardIds) const;
+
+    /**
+     * Returns whether the config server confirms that no chunk of the collection changed since
+     * this routing table was loaded. Returns false if this cannot be checked.
+     */
+    bool _isLatestCollectionVersion(OperationContext* opCtx) const;
+
     // The shard versioning mechanism hinges on keeping track of the number of times we reload
     // ChunkManagers.
     const unsigned long long _sequenceNumber;
@@ -33,9 +33,11 @@
 #include <set>
 
 #include "mongo/db/query/collation/collator_interface_mock.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/s/catalog_cache_test_fixture.h"
 #include "mongo/s/chunk_manager.h"
 #include "mongo/util/log.h"
+#include "mongo/util/scopeguard.h"
 
 namespace mongo {
 namespace {
@@ -487,5 +489,194 @@ TEST_F(ChunkManagerQueryTest, SimpleCollationNumbersMultiShard) {
         {ShardId("0")});
 }
 
+std::shared_ptr<ChunkManager> makeFourChunkManager(const OID& epoch) {
+    // Chunks [MinKey, -100) and [-100, 0) on shard "0", [0, 100) and [100, MaxKey) on shard "1"
+    const std::vector<BSONObj> bounds{BSON("a" << MINKEY),
+                                      BSON("a" << -100),
+                                      BSON("a" << 0),
+                                      BSON("a" << 100),
+                                      BSON("a" << MAXKEY)};
+    std::vector<ChunkType> chunks;
+    for (size_t i = 0; i + 1 < bounds.size(); ++i) {
+        chunks.emplace_back(kNss,
+                            ChunkRange{bounds[i], bounds[i + 1]},
+                            ChunkVersion(1, i, epoch),
+                            ShardId(i < 2 ? "0" : "1"));
+    }
+    return ChunkManager::makeNew(
+        kNss, UUID::gen(), KeyPattern(BSON("a" << 1)), nullptr, false, epoch, chunks);
+}
+
+TEST_F(ChunkManagerQueryTest, UpdatedChunkManagerReflectsMigrationAndLeavesOriginalUnchanged) {
+    const OID epoch = OID::gen();
+    auto original = makeFourChunkManager(epoch);
+
+    // Move [0, 100) to shard "0", bumping the version of the chunk left on shard "1"
+    auto updated = original->makeUpdated(
+        {ChunkType{kNss, ChunkRange{BSON("a" << 0), BSON("a" << 100)}, {2, 0, epoch}, {"0"}},
+         ChunkType{kNss, ChunkRange{BSON("a" << 100), BSON("a" << MAXKEY)}, {2, 1, epoch}, {"1"}}});
+
+    ASSERT_EQ(4, updated->numChunks());
+    ASSERT(updated->keyBelongsToShard(BSON("a" << 50), ShardId("0")));
+    ASSERT_EQ(ChunkVersion(2, 0, epoch), updated->getVersion(ShardId("0")));
+    ASSERT_EQ(ChunkVersion(2, 1, epoch), updated->getVersion(ShardId("1")));
+
+    std::set<ShardId> shardIds;
+    updated->getShardIdsForRange(BSON("a" << MINKEY), BSON("a" << 99), &shardIds);
+    ASSERT_EQ(1U, shardIds.size());
+    ASSERT_EQ(1U, shardIds.count(ShardId("0")));
+
+    ASSERT(original->keyBelongsToShard(BSON("a" << 50), ShardId("1")));
+    ASSERT_EQ(ChunkVersion(1, 1, epoch), original->getVersion(ShardId("0")));
+    ASSERT_EQ(ChunkVersion(1, 3, epoch), original->getVersion(ShardId("1")));
+}
+
+TEST_F(ChunkManagerQueryTest, UpdatedChunkManagerSplitsAndDropsShardWithoutChunks) {
+    const OID epoch = OID::gen();
+    auto original = makeFourChunkManager(epoch);
+
+    // Split [-100, 0) and then move both of shard "1"'s chunks to shard "0"
+    auto updated = original->makeUpdated(
+        {ChunkType{kNss, ChunkRange{BSON("a" << -100), BSON("a" << -50)}, {1, 4, epoch}, {"0"}},
+         ChunkType{kNss, ChunkRange{BSON("a" << -50), BSON("a" << 0)}, {1, 5, epoch}, {"0"}},
+         ChunkType{kNss, ChunkRange{BSON("a" << 0), BSON("a" << 100)}, {2, 0, epoch}, {"0"}},
+         ChunkType{kNss, ChunkRange{BSON("a" << 100), BSON("a" << MAXKEY)}, {3, 0, epoch}, {"0"}}});
+
+    ASSERT_EQ(5, updated->numChunks());
+    ASSERT_EQ(ChunkVersion(3, 0, epoch), updated->getVersion(ShardId("0")));
+    ASSERT_EQ(ChunkVersion(0, 0, epoch), updated->getVersion(ShardId("1")));
+
+    std::set<ShardId> shardIds;
+    updated->getAllShardIds(&shardIds);
+    ASSERT_EQ(1U, shardIds.size());
+    ASSERT_EQ(1U, shardIds.count(ShardId("0")));
+    ASSERT_EQ(ShardId("0"),
+              updated->findIntersectingChunkWithSimpleCollation(BSON("a" << -75))->getShardId());
+    ASSERT_BSONOBJ_EQ(
+        BSON("a" << -50),
+        updated->findIntersectingChunkWithSimpleCollation(BSON("a" << -75))->getMax());
+}
+
+TEST_F(ChunkManagerQueryTest, FindIntersectingChunksMatchesSingleKeyLookups) {
+    const OID epoch = OID::gen();
+    auto cm = makeFourChunkManager(epoch);
+
+    // Unsorted keys, with repeats and keys far apart, to exercise both stepping over neighbouring
+    // chunks and searching the chunk map
+    const std::vector<BSONObj> shardKeys{BSON("a" << 150),
+                                         BSON("a" << -1000),
+                                         BSON("a" << 0),
+                                         BSON("a" << 150),
+                                         BSON("a" << -100),
+                                         BSON("a" << 99),
+                                         BSON("a" << MINKEY)};
+
+    const auto chunks = cm->findIntersectingChunksWithSimpleCollation(shardKeys);
+    ASSERT_EQ(shardKeys.size(), chunks.size());
+    for (size_t i = 0; i < shardKeys.size(); ++i) {
+        ASSERT(chunks[i]);
+        ASSERT_BSONOBJ_EQ(cm->findIntersectingChunkWithSimpleCollation(shardKeys[i])->getMin(),
+                          chunks[i]->getMin());
+    }
+
+    ASSERT(cm->findIntersectingChunksWithSimpleCollation({}).empty());
+}
+
+void setUseChunkFieldSummariesForTargeting(bool value) {
+    auto param =
+        ServerParameterSet::getGlobal()->getMap().find("useChunkFieldSummariesForTargeting");
+    invariant(param != ServerParameterSet::getGlobal()->getMap().end());
+    ASSERT_OK(param->second->setFromString(value ? "true" : "false"));
+}
+
+BSONObj makeFieldSummary(int min, int max) {
+    return BSON(ChunkType::kFieldSummaryMin << min << ChunkType::kFieldSummaryMax << max);
+}
+
+TEST_F(ChunkManagerQueryTest, FieldSummariesPruneShardsOnlyWhenEnabled) {
+    const OID epoch = OID::gen();
+
+    // Chunk [-100, 0) on shard "0" has no summary, so it can never be pruned
+    std::vector<ChunkType> chunks{
+        {kNss, {BSON("a" << MINKEY), BSON("a" << -100)}, {1, 0, epoch}, {"0"}},
+        {kNss, {BSON("a" << -100), BSON("a" << 0)}, {1, 1, epoch}, {"0"}},
+        {kNss, {BSON("a" << 0), BSON("a" << 100)}, {1, 2, epoch}, {"1"}},
+        {kNss, {BSON("a" << 100), BSON("a" << MAXKEY)}, {1, 3, epoch}, {"1"}}};
+    chunks[0].setFieldSummaries(BSON("ts" << makeFieldSummary(0, 10)));
+    chunks[2].setFieldSummaries(BSON("ts" << makeFieldSummary(40, 50)));
+    chunks[3].setFieldSummaries(BSON("ts" << makeFieldSummary(60, 70)));
+
+    auto cm = ChunkManager::makeNew(
+        kNss, UUID::gen(), KeyPattern(BSON("a" << 1)), nullptr, false, epoch, chunks);
+
+    const auto getShardIds = [&](const BSONObj& query) {
+        std::set<ShardId> shardIds;
+        cm->getShardIdsForQuery(operationContext(), query, BSONObj(), &shardIds);
+        return shardIds;
+    };
+
+    const BSONObj tsQuery = BSON("ts" << BSON("$gte" << 45 << "$lt" << 60));
+    ASSERT_EQ(2U, getShardIds(tsQuery).size());
+
+    setUseChunkFieldSummariesForTargeting(true);
+    ON_BLOCK_EXIT([] { setUseChunkFieldSummariesForTargeting(false); });
+
+    // Shard "0" is still targeted because of the chunk without a summary
+    ASSERT_EQ(2U, getShardIds(tsQuery).size());
+
+    // Predicates which cannot be converted to bounds on the summarized field do not prune anything
+    auto shardIds = getShardIds(BSON("a" << BSON("$gte" << 0) << "$where"
+                                         << "this.ts > 100"));
+    ASSERT_EQ(1U, shardIds.size());
+    ASSERT_EQ(1U, shardIds.count(ShardId("1")));
+
+    // Skipping a shard requires the config server to confirm that the routing table is the latest
+    const auto getShardIdsAsync = [&](const BSONObj& query) {
+        return launchAsync([this, cm, query] {
+            auto client = serviceContext()->makeClient("Test");
+            auto opCtx = client->makeOperationContext();
+
+            std::set<ShardId> shardIds;
+            cm->getShardIdsForQuery(opCtx.get(), query, BSONObj(), &shardIds);
+            return shardIds;
+        });
+    };
+
+    // Excluding the chunk without a summary lets shard "0" be skipped
+    const BSONObj prunableQuery = BSON("$or" << BSON_ARRAY(BSON("a" << BSON("$lte" << -101))
+                                                          << BSON("a" << BSON("$gte" << 0)))
+                                             << "ts"
+                                             << 65);
+
+    auto future = getShardIdsAsync(prunableQuery);
+    expectFindOnConfigSendBSONObjVector({chunks[3].toConfigBSON()});
+    shardIds = future.timed_get(kFutureTimeout);
+    ASSERT_EQ(1U, shardIds.size());
+    ASSERT_EQ(1U, shardIds.count(ShardId("1")));
+
+    // No chunk can match, but a shard is still returned (SERVER-4914)
+    future = getShardIdsAsync(
+        BSON("a" << BSON("$gte" << 0) << "ts" << BSON("$gt" << 50 << "$lt" << 60)));
+    expectFindOnConfigSendBSONObjVector({chunks[3].toConfigBSON()});
+    shardIds = future.timed_get(kFutureTimeout);
+    ASSERT_EQ(1U, shardIds.size());
+    ASSERT_EQ(1U, shardIds.count(ShardId("0")));
+
+    // A chunk changed since the routing table was loaded, so its summaries may have been widened
+    auto changedChunk = chunks[3];
+    changedChunk.setVersion({1, 4, epoch});
+
+    future = getShardIdsAsync(prunableQuery);
+    expectFindOnConfigSendBSONObjVector({changedChunk.toConfigBSON()});
+    ASSERT_EQ(2U, future.timed_get(kFutureTimeout).size());
+
+    // Same if the latest version cannot be read
+    future = getShardIdsAsync(prunableQuery);
+    onFindCommand([](const executor::RemoteCommandRequest&) -> StatusWith<std::vector<BSONObj>> {
+        return Status(ErrorCodes::InternalError, "Failed to read config.chunks");
+    });
+    ASSERT_EQ(2U, future.timed_get(kFutureTimeout).size());
+}
+
 }  // namespace
 }  // namespace mongo
@@ -44,6 +44,7 @@
 #include "mongo/db/operation_context.h"
 #include "mongo/db/query/query_request.h"
 #include "mongo/db/repl/read_concern_args.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/executor/task_executor_pool.h"
 #include "mongo/rpc/get_status_from_command_result.h"
 #include "mongo/rpc/metadata/repl_set_metadata.h"
@@ -64,6 +65,12 @@ using rpc::TrackingMetadata;
 using RemoteCommandCallbackArgs = TaskExecutor::RemoteCommandCallbackArgs;
 
 namespace {
+
+// When enabled, identical concurrent exhaustive finds against the config server (such as the
+// ones issued by routing table refreshes for the same collection) are coalesced into a single
+// remote request whose result is shared by all the waiters.
+MONGO_EXPORT_SERVER_PARAMETER(coalesceConfigServerReads, bool, true);
+
 // Include kReplSetMetadataFieldName in a request to get the shard's ReplSetMetadata in the
 // response.
 const BSONObj kReplMetadata(BSON(rpc::kReplSetMetadataFieldName << 1));
@@ -236,6 +243,112 @@ StatusWith<Shard::QueryResponse> ShardRemote::_exhaustiveFindOnConfig(
     ReadPreferenceSetting readPrefWithMinOpTime(readPref);
     readPrefWithMinOpTime.minOpTime = grid.configOpTime();
 
+    BSONObj readConcernObj;
+    {
+        invariant(readConcernLevel == repl::ReadConcernLevel::kMajorityReadConcern);
+        const repl::ReadConcernArgs readConcern{grid.configOpTime(), readConcernLevel};
+        BSONObjBuilder bob;
+        readConcern.appendInfo(&bob);
+        readConcernObj =
+            bob.done().getObjectField(repl::ReadConcernArgs::kReadConcernFieldName).getOwned();
+    }
+
+    if (!coalesceConfigServerReads.load()) {
+        return _runExhaustiveFindOnConfig(
+            opCtx, readPrefWithMinOpTime, readConcernObj, nss, query, sort, limit);
+    }
+
+    // The read concern is part of the key, so that a find is never handed a result read at a
+    // different level or from before its own afterOpTime.
+    std::string key;
+    {
+        BSONObjBuilder keyBuilder;
+        readPrefWithMinOpTime.toContainingBSON(&keyBuilder);
+        readPrefWithMinOpTime.minOpTime.append(&keyBuilder, "minOpTime");
+        keyBuilder.append(repl::ReadConcernArgs::kReadConcernFieldName, readConcernObj);
+        keyBuilder.append("ns", nss.ns());
+        keyBuilder.append("query", query);
+        keyBuilder.append("sort", sort);
+        if (limit) {
+            keyBuilder.append("limit", *limit);
+        }
+        const BSONObj keyObj = keyBuilder.obj();
+        key.assign(keyObj.objdata(), keyObj.objsize());
+    }
+
+    std::shared_ptr<InProgressFind> inProgressFind;
+    bool isLeader = false;
+    {
+        stdx::lock_guard<stdx::mutex> lk(_inProgressFindsMutex);
+        auto& inProgress = _inProgressFinds[key];
+        if (!inProgress) {
+            inProgress = std::make_shared<InProgressFind>();
+            isLeader = true;
+        } else {
+            ++inProgress->numFollowers;
+        }
+        inProgressFind = inProgress;
+    }
+
+    if (!isLeader) {
+        StatusWith<QueryResponse> swResponse{ErrorCodes::InternalError, "Uninitialized"};
+        try {
+            swResponse = inProgressFind->notification.get(opCtx);
+        } catch (const DBException& ex) {
+            return ex.toStatus();
+        }
+
+        // The leader's own deadline or interruption should not fail the other waiters, so retry
+        // independently in that case.
+        if (!swResponse.isOK() &&
+            (ErrorCodes::isInterruption(swResponse.getStatus().code()) ||
+             ErrorCodes::isExceededTimeLimitError(swResponse.getStatus().code()))) {
+            LOG(1) << "Coalesced config server find on " << nss.ns()
+                   << " was interrupted, retrying it independently "
+                   << causedBy(swResponse.getStatus());
+            return _runExhaustiveFindOnConfig(
+                opCtx, readPrefWithMinOpTime, readConcernObj, nss, query, sort, limit);
+        }
+
+        return swResponse;
+    }
+
+    auto publishResult = [&](StatusWith<QueryResponse> swResponse) {
+        {
+            stdx::lock_guard<stdx::mutex> lk(_inProgressFindsMutex);
+            _inProgressFinds.erase(key);
+        }
+        inProgressFind->notification.set(std::move(swResponse));
+    };
+
+    try {
+        auto swResponse = _runExhaustiveFindOnConfig(
+            opCtx, readPrefWithMinOpTime, readConcernObj, nss, query, sort, limit);
+        publishResult(swResponse);
+        return swResponse;
+    } catch (const DBException& ex) {
+        publishResult(ex.toStatus());
+        throw;
+    }
+}
+
+int ShardRemote::getNumCoalescedFindFollowersForTest() {
+    stdx::lock_guard<stdx::mutex> lk(_inProgressFindsMutex);
+    int numFollowers = 0;
+    for (const auto& inProgress : _inProgressFinds) {
+        numFollowers += inProgress.second->numFollowers;
+    }
+    return numFollowers;
+}
+
+StatusWith<Shard::QueryResponse> ShardRemote::_runExhaustiveFindOnConfig(
+    OperationContext* opCtx,
+    const ReadPreferenceSetting& readPrefWithMinOpTime,
+    const BSONObj& readConcernObj,
+    const NamespaceString& nss,
+    const BSONObj& query,
+    const BSONObj& sort,
+    boost::optional<long long> limit) {
     const auto host = _targeter->findHost(opCtx, readPrefWithMinOpTime);
     if (!host.isOK()) {
         return host.getStatus();
@@ -285,16 +398,6 @@ StatusWith<Shard::QueryResponse> ShardRemote::_exhaustiveFindOnConfig(
         getMoreBob->append("collection", data.nss.coll());
     };
 
-    BSONObj readConcernObj;
-    {
-        invariant(readConcernLevel == repl::ReadConcernLevel::kMajorityReadConcern);
-        const repl::ReadConcernArgs readConcern{grid.configOpTime(), readConcernLevel};
-        BSONObjBuilder bob;
-        readConcern.appendInfo(&bob);
-        readConcernObj =
-            bob.done().getObjectField(repl::ReadConcernArgs::kReadConcernFieldName).getOwned();
-    }
-
     const Milliseconds maxTimeMS =
         std::min(opCtx->getRemainingMaxTimeMillis(), kDefaultConfigCommandTimeout);
 
@@ -33,6 +33,9 @@
 #include "mongo/s/client/shard.h"
 
 #include "mongo/base/disallow_copying.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/util/concurrency/notification.h"
+#include "mongo/util/string_map.h"
 
 namespace mongo {
 
@@ -75,6 +78,12 @@ public:
                                const BSONObj& keys,
                                bool unique) override;
 
+    /**
+     * Returns the number of callers which are waiting for the result of a coalesced config server
+     * find sent by another caller.
+     */
+    int getNumCoalescedFindFollowersForTest();
+
 private:
     /**
      * Returns the metadata that should be used when running commands against this shard with
@@ -98,6 +107,30 @@ private:
         const BSONObj& sort,
         boost::optional<long long> limit) final;
 
+    /**
+     * Sends the find described by the arguments to a config server host and collects every batch
+     * of the resulting cursor. Unlike _exhaustiveFindOnConfig, never shares its result with other
+     * callers.
+     */
+    StatusWith<QueryResponse> _runExhaustiveFindOnConfig(
+        OperationContext* opCtx,
+        const ReadPreferenceSetting& readPrefWithMinOpTime,
+        const BSONObj& readConcernObj,
+        const NamespaceString& nss,
+        const BSONObj& query,
+        const BSONObj& sort,
+        boost::optional<long long> limit);
+
+    /**
+     * A config server find which is in flight, along with the callers waiting for its result.
+     */
+    struct InProgressFind {
+        Notification<StatusWith<QueryResponse>> notification;
+
+        // Number of callers, other than the one which sent the find, waiting for its result
+        int numFollowers{0};
+    };
+
     /**
      * Connection string for the shard at the creation time.
      */
@@ -107,6 +140,14 @@ private:
      * Targeter for obtaining hosts from which to read or to which to write.
      */
     const std::shared_ptr<RemoteCommandTargeter> _targeter;
+
+    // Protects _inProgressFinds
+    stdx::mutex _inProgressFindsMutex;
+
+    // Config server finds which are currently in flight, keyed by the serialized read
+    // preference, minimum optime, read concern and query shape. Identical finds issued while one
+    // of these is outstanding wait for its result instead of contacting the config server again.
+    StringMap<std::shared_ptr<InProgressFind>> _inProgressFinds;
 };
 
 }  // namespace mongo
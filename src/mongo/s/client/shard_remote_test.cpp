@@ -0,0 +1,190 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/base/checked_cast.h"
+#include "mongo/client/remote_command_targeter_mock.h"
+#include "mongo/db/query/cursor_response.h"
+#include "mongo/db/repl/read_concern_args.h"
+#include "mongo/executor/network_interface_mock.h"
+#include "mongo/s/client/shard_registry.h"
+#include "mongo/s/client/shard_remote.h"
+#include "mongo/s/grid.h"
+#include "mongo/s/sharding_test_fixture.h"
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/time_support.h"
+
+namespace mongo {
+namespace {
+
+using executor::NetworkInterfaceMock;
+using executor::RemoteCommandResponse;
+
+const HostAndPort kTestConfigShardHost = HostAndPort("FakeConfigHost", 12345);
+const NamespaceString kTestNss("config.collections");
+
+class ShardRemoteTest : public ShardingTestFixture {
+public:
+    void setUp() override {
+        ShardingTestFixture::setUp();
+        configTargeter()->setFindHostReturnValue(kTestConfigShardHost);
+    }
+
+protected:
+    ShardRemote* configShard() {
+        return checked_cast<ShardRemote*>(shardRegistry()->getConfigShard().get());
+    }
+
+    /**
+     * Runs a find for all documents of kTestNss against the config server on a separate client.
+     */
+    executor::NetworkTestEnv::FutureHandle<std::vector<BSONObj>> launchFind() {
+        return launchAsync([this] {
+            auto client = serviceContext()->makeClient("Test");
+            auto opCtx = client->makeOperationContext();
+
+            auto response = uassertStatusOK(configShard()->exhaustiveFindOnConfig(
+                opCtx.get(),
+                ReadPreferenceSetting{ReadPreference::PrimaryOnly},
+                repl::ReadConcernLevel::kMajorityReadConcern,
+                kTestNss,
+                BSONObj(),
+                BSONObj(),
+                boost::none));
+            return response.docs;
+        });
+    }
+
+    /**
+     * Waits until the network has a request which has not been responded to yet.
+     */
+    void waitForReadyRequest() {
+        for (int i = 0; i < 1000; i++) {
+            network()->enterNetwork();
+            const bool hasReadyRequests = network()->hasReadyRequests();
+            network()->exitNetwork();
+            if (hasReadyRequests) {
+                return;
+            }
+            sleepmillis(10);
+        }
+        FAIL("Timed out waiting for a request");
+    }
+
+    /**
+     * Returns the next find request without responding to it.
+     */
+    NetworkInterfaceMock::NetworkOperationIterator getNextFind() {
+        network()->enterNetwork();
+        auto noi = network()->getNextReadyRequest();
+        network()->exitNetwork();
+        ASSERT_EQ("find"_sd, noi->getRequest().cmdObj.firstElementFieldName());
+        return noi;
+    }
+
+    /**
+     * Returns the afterOpTime of the read concern the find was sent with.
+     */
+    repl::OpTime getAfterOpTime(NetworkInterfaceMock::NetworkOperationIterator noi) {
+        repl::ReadConcernArgs readConcern;
+        ASSERT_OK(readConcern.initialize(
+            noi->getRequest().cmdObj[repl::ReadConcernArgs::kReadConcernFieldName]));
+        ASSERT(readConcern.getArgsOpTime());
+        return *readConcern.getArgsOpTime();
+    }
+
+    /**
+     * Responds to the find with a single batch containing 'doc'.
+     */
+    void respondToFind(NetworkInterfaceMock::NetworkOperationIterator noi, const BSONObj& doc) {
+        BSONObjBuilder result;
+        appendCursorResponseObject(0LL, kTestNss.ns(), BSON_ARRAY(doc), &result);
+        result.append("ok", 1);
+
+        network()->enterNetwork();
+        network()->scheduleResponse(
+            noi, network()->now(), RemoteCommandResponse(result.obj(), BSONObj(), Milliseconds(1)));
+        network()->runReadyNetworkOperations();
+        network()->exitNetwork();
+    }
+};
+
+TEST_F(ShardRemoteTest, IdenticalConcurrentFindsAreCoalesced) {
+    auto future1 = launchFind();
+    auto future2 = launchFind();
+
+    // Wait until one of the finds is waiting for the result of the other.
+    for (int i = 0; i < 1000 && configShard()->getNumCoalescedFindFollowersForTest() == 0; i++) {
+        sleepmillis(10);
+    }
+    ASSERT_EQ(1, configShard()->getNumCoalescedFindFollowersForTest());
+
+    const BSONObj doc = BSON("_id" << kTestNss.ns());
+    respondToFind(getNextFind(), doc);
+
+    for (auto future : {&future1, &future2}) {
+        auto docs = future->timed_get(kFutureTimeout);
+        ASSERT_EQ(1U, docs.size());
+        ASSERT_BSONOBJ_EQ(doc, docs.front());
+    }
+
+    network()->enterNetwork();
+    ASSERT_FALSE(network()->hasReadyRequests());
+    network()->exitNetwork();
+}
+
+TEST_F(ShardRemoteTest, FindsWithDifferentReadConcernAreNotCoalesced) {
+    const repl::OpTime firstOpTime(Timestamp(100, 1), 1);
+    const repl::OpTime secondOpTime(Timestamp(200, 1), 1);
+
+    Grid::get(operationContext())->advanceConfigOpTime(firstOpTime);
+    auto future1 = launchFind();
+    auto noi1 = getNextFind();
+    ASSERT_EQ(firstOpTime, getAfterOpTime(noi1));
+
+    // A find which must observe a later config optime can not use the result of the first one, so
+    // it is sent while the first one is still outstanding.
+    Grid::get(operationContext())->advanceConfigOpTime(secondOpTime);
+    auto future2 = launchFind();
+    waitForReadyRequest();
+    auto noi2 = getNextFind();
+    ASSERT_EQ(secondOpTime, getAfterOpTime(noi2));
+
+    const BSONObj doc1 = BSON("_id" << 1);
+    const BSONObj doc2 = BSON("_id" << 2);
+    respondToFind(noi1, doc1);
+    respondToFind(noi2, doc2);
+    ASSERT_BSONOBJ_EQ(doc1, future1.timed_get(kFutureTimeout).front());
+    ASSERT_BSONOBJ_EQ(doc2, future2.timed_get(kFutureTimeout).front());
+
+    ASSERT_EQ(0, configShard()->getNumCoalescedFindFollowersForTest());
+}
+
+}  // namespace
+}  // namespace mongo
@@ -315,6 +315,66 @@ StatusWith<ShardEndpoint> ChunkManagerTargeter::targetInsert(OperationContext* o
     return Status::OK();
 }
 
+std::vector<StatusWith<ShardEndpoint>> ChunkManagerTargeter::targetInserts(
+    OperationContext* opCtx, const std::vector<BSONObj>& docs) const {
+    if (!_routingInfo->cm()) {
+        return NSTargeter::targetInserts(opCtx, docs);
+    }
+
+    const auto& shardKeyPattern = _routingInfo->cm()->getShardKeyPattern();
+
+    std::vector<StatusWith<ShardEndpoint>> endpoints;
+    endpoints.reserve(docs.size());
+
+    // Indexes into 'docs' of the documents with a valid shard key and their shard keys
+    std::vector<size_t> docIndexes;
+    std::vector<BSONObj> shardKeys;
+
+    for (size_t i = 0; i < docs.size(); ++i) {
+        BSONObj shardKey = shardKeyPattern.extractShardKeyFromDoc(docs[i]);
+        if (shardKey.isEmpty()) {
+            endpoints.push_back({ErrorCodes::ShardKeyNotFound,
+                                 str::stream() << "document " << docs[i]
+                                               << " does not contain shard key for pattern "
+                                               << shardKeyPattern.toString()});
+            continue;
+        }
+
+        Status status = ShardKeyPattern::checkShardKeySize(shardKey);
+        if (!status.isOK()) {
+            endpoints.push_back(std::move(status));
+            continue;
+        }
+
+        // Placeholder, which is overwritten once the chunks have been looked up
+        endpoints.push_back({ErrorCodes::InternalError, "document was not targeted"});
+        docIndexes.push_back(i);
+        shardKeys.push_back(std::move(shardKey));
+    }
+
+    const auto chunks = _routingInfo->cm()->findIntersectingChunksWithSimpleCollation(shardKeys);
+
+    for (size_t i = 0; i < chunks.size(); ++i) {
+        const auto& doc = docs[docIndexes[i]];
+        auto& endpoint = endpoints[docIndexes[i]];
+
+        const auto& chunk = chunks[i];
+        if (!chunk) {
+            endpoint = {ErrorCodes::ShardKeyNotFound,
+                        str::stream() << "Cannot target single shard using key " << shardKeys[i]};
+            continue;
+        }
+
+        // Track autosplit stats for sharded collections, same as _targetShardKey
+        _stats->chunkSizeDelta[chunk->getMin()] += doc.objsize();
+
+        endpoint = ShardEndpoint(chunk->getShardId(),
+                                 _routingInfo->cm()->getVersion(chunk->getShardId()));
+    }
+
+    return endpoints;
+}
+
 StatusWith<std::vector<ShardEndpoint>> ChunkManagerTargeter::targetUpdate(
     OperationContext* opCtx, const write_ops::UpdateOpEntry& updateDoc) const {
     //
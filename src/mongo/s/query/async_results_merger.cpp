@@ -38,6 +38,7 @@
 #include "mongo/db/query/cursor_response.h"
 #include "mongo/db/query/getmore_request.h"
 #include "mongo/db/query/killcursors_request.h"
+#include "mongo/db/storage/key_string.h"
 #include "mongo/executor/remote_command_request.h"
 #include "mongo/executor/remote_command_response.h"
 #include "mongo/s/client/shard_registry.h"
@@ -51,6 +52,10 @@ namespace {
 // Maximum number of retries for network and replication notMaster errors (per host).
 const int kMaxNumFailedHostRetryAttempts = 3;
 
+// Maximum number of fields of a sort pattern for which Ordering::make can describe the direction
+// of each field.
+const int kMaxSortKeyOrderingFields = 32;
+
 /**
  * Returns the sort key out of the $sortKey metadata field in 'obj'. This object is of the form
  * {'': 'firstSortKey', '': 'secondSortKey', ...}.
@@ -76,6 +81,18 @@ int compareSortKeys(BSONObj leftSortKey, BSONObj rightSortKey, BSONObj sortKeyPa
     return leftSortKey.woCompare(rightSortKey, sortKeyPattern, considerFieldName);
 }
 
+/**
+ * Returns the Ordering used to encode the sort keys of results sorted according to
+ * 'sortKeyPattern' as KeyStrings, which compare the same way as compareSortKeys does. Returns
+ * boost::none if there is no sort or if the pattern has too many fields for an Ordering.
+ */
+boost::optional<Ordering> makeSortKeyOrdering(const BSONObj& sortKeyPattern) {
+    if (sortKeyPattern.isEmpty() || sortKeyPattern.nFields() > kMaxSortKeyOrderingFields) {
+        return boost::none;
+    }
+    return Ordering::make(sortKeyPattern);
+}
+
 }  // namespace
 
 AsyncResultsMerger::AsyncResultsMerger(OperationContext* opCtx,
@@ -84,12 +101,17 @@ AsyncResultsMerger::AsyncResultsMerger(OperationContext* opCtx,
     : _opCtx(opCtx),
       _executor(executor),
       _params(params),
-      _mergeQueue(MergingComparator(_remotes, _params->sort, _params->compareWholeSortKey)) {
+      _sortKeyOrdering(makeSortKeyOrdering(_params->sort)),
+      _mergeQueue(MergingComparator(_remotes,
+                                    _params->sort,
+                                    _params->compareWholeSortKey,
+                                    static_cast<bool>(_sortKeyOrdering))) {
     size_t remoteIndex = 0;
     for (const auto& remote : _params->remotes) {
         _remotes.emplace_back(remote.hostAndPort,
                               remote.cursorResponse.getNSS(),
                               remote.cursorResponse.getCursorId());
+        _mergeQueue.addLeaf();
 
         // We don't check the return value of _addBatchToBuffer here; if there was an error,
         // it will be stored in the remote and the first call to ready() will return true.
@@ -173,6 +195,7 @@ void AsyncResultsMerger::addNewShardCursors(
         _remotes.emplace_back(remote.hostAndPort,
                               remote.cursorResponse.getNSS(),
                               remote.cursorResponse.getCursorId());
+        _mergeQueue.addLeaf();
     }
 }
 
@@ -284,15 +307,19 @@ ClusterQueryResult AsyncResultsMerger::_nextReadySorted(WithLock) {
     size_t smallestRemote = _mergeQueue.top();
     _mergeQueue.pop();
 
-    invariant(!_remotes[smallestRemote].docBuffer.empty());
-    invariant(_remotes[smallestRemote].status.isOK());
+    auto& remote = _remotes[smallestRemote];
+    invariant(!remote.docBuffer.empty());
+    invariant(remote.status.isOK());
 
-    ClusterQueryResult front = _remotes[smallestRemote].docBuffer.front();
-    _remotes[smallestRemote].docBuffer.pop();
+    ClusterQueryResult front = remote.docBuffer.front();
+    remote.docBuffer.pop();
+    if (_sortKeyOrdering) {
+        remote.sortKeyBuffer.pop();
+    }
 
     // Re-populate the merging queue with the next result from 'smallestRemote', if it has a
     // next result.
-    if (!_remotes[smallestRemote].docBuffer.empty()) {
+    if (!remote.docBuffer.empty()) {
         _mergeQueue.push(smallestRemote);
     }
 
@@ -536,6 +563,8 @@ void AsyncResultsMerger::_cleanUpFailedBatch(WithLock lk, Status status, size_t
         // Clear the results buffer and cursor id.
         std::queue<ClusterQueryResult> emptyBuffer;
         std::swap(remote.docBuffer, emptyBuffer);
+        std::queue<std::string> emptySortKeyBuffer;
+        std::swap(remote.sortKeyBuffer, emptySortKeyBuffer);
         remote.cursorId = 0;
     }
 }
@@ -606,6 +635,13 @@ bool AsyncResultsMerger::_addBatchToBuffer(WithLock lk,
             }
         }
 
+        if (_sortKeyOrdering) {
+            KeyString sortKey(KeyString::Version::V1,
+                              extractSortKey(obj, _params->compareWholeSortKey),
+                              *_sortKeyOrdering);
+            remote.sortKeyBuffer.emplace(sortKey.getBuffer(), sortKey.getSize());
+        }
+
         ClusterQueryResult result(obj);
         remote.docBuffer.push(result);
         ++remote.fetchedCount;
@@ -729,13 +765,17 @@ std::shared_ptr<Shard> AsyncResultsMerger::RemoteCursorData::getShard() {
 // AsyncResultsMerger::MergingComparator
 //
 
-bool AsyncResultsMerger::MergingComparator::operator()(const size_t& lhs, const size_t& rhs) {
+bool AsyncResultsMerger::MergingComparator::operator()(size_t lhs, size_t rhs) const {
+    if (_compareKeyStrings) {
+        return _remotes[lhs].sortKeyBuffer.front() < _remotes[rhs].sortKeyBuffer.front();
+    }
+
     const ClusterQueryResult& leftDoc = _remotes[lhs].docBuffer.front();
     const ClusterQueryResult& rightDoc = _remotes[rhs].docBuffer.front();
 
     return compareSortKeys(extractSortKey(*leftDoc.getResult(), _compareWholeSortKey),
                            extractSortKey(*rightDoc.getResult(), _compareWholeSortKey),
-                           _sort) > 0;
+                           _sort) < 0;
 }
 
 }  // namespace mongo
@@ -35,10 +35,12 @@
 #include "mongo/base/disallow_copying.h"
 #include "mongo/base/status_with.h"
 #include "mongo/bson/bsonobj.h"
+#include "mongo/bson/ordering.h"
 #include "mongo/db/cursor_id.h"
 #include "mongo/executor/task_executor.h"
 #include "mongo/s/query/cluster_client_cursor_params.h"
 #include "mongo/s/query/cluster_query_result.h"
+#include "mongo/s/query/loser_tree.h"
 #include "mongo/stdx/mutex.h"
 #include "mongo/util/concurrency/with_lock.h"
 #include "mongo/util/net/hostandport.h"
@@ -256,6 +258,11 @@ private:
         // The buffer of results that have been retrieved but not yet returned to the caller.
         std::queue<ClusterQueryResult> docBuffer;
 
+        // When merging sorted results, holds the KeyString encodings of the sort keys of the
+        // results in 'docBuffer', so that they can be compared with memcmp. Is empty if the sort
+        // pattern has too many fields to build a KeyString from it.
+        std::queue<std::string> sortKeyBuffer;
+
         // Is valid if there is currently a pending request to this remote.
         executor::TaskExecutor::CallbackHandle cbHandle;
 
@@ -272,10 +279,17 @@ private:
     public:
         MergingComparator(const std::vector<RemoteCursorData>& remotes,
                           const BSONObj& sort,
-                          bool compareWholeSortKey)
-            : _remotes(remotes), _sort(sort), _compareWholeSortKey(compareWholeSortKey) {}
+                          bool compareWholeSortKey,
+                          bool compareKeyStrings)
+            : _remotes(remotes),
+              _sort(sort),
+              _compareWholeSortKey(compareWholeSortKey),
+              _compareKeyStrings(compareKeyStrings) {}
 
-        bool operator()(const size_t& lhs, const size_t& rhs);
+        /**
+         * Returns true if the next result of the remote 'lhs' sorts before that of 'rhs'.
+         */
+        bool operator()(size_t lhs, size_t rhs) const;
 
     private:
         const std::vector<RemoteCursorData>& _remotes;
@@ -286,6 +300,10 @@ private:
         // We extract the sort key {$sortKey: <value>}. The sort key pattern '_sort' is verified to
         // be {$sortKey: 1}.
         const bool _compareWholeSortKey;
+
+        // Whether the remotes' 'sortKeyBuffer's are filled and are compared instead of the BSON
+        // sort keys
+        const bool _compareKeyStrings;
     };
 
     enum LifecycleState { kAlive, kKillStarted, kKillComplete };
@@ -400,9 +418,14 @@ private:
     // Data tracking the state of our communication with each of the remote nodes.
     std::vector<RemoteCursorData> _remotes;
 
-    // The top of this priority queue is the index into '_remotes' for the remote host that has the
-    // next document to return, according to the sort order. Used only if there is a sort.
-    std::priority_queue<size_t, std::vector<size_t>, MergingComparator> _mergeQueue;
+    // Ordering used to encode the sort keys of the results as KeyStrings. Is not set if there is no
+    // sort, or if the sort pattern has more fields than an Ordering can describe.
+    const boost::optional<Ordering> _sortKeyOrdering;
+
+    // Tournament tree with one leaf per entry of '_remotes', whose winner is the index of the remote
+    // host that has the next document to return, according to the sort order. Used only if there
+    // is a sort.
+    LoserTree<MergingComparator> _mergeQueue;
 
     // The index into '_remotes' for the remote from which we are currently retrieving results.
     // Used only if there is *not* a sort.
@@ -463,6 +463,50 @@ TEST_F(AsyncResultsMergerTest, MultiShardSorted) {
     ASSERT_TRUE(unittest::assertGet(arm->nextReady()).isEOF());
 }
 
+TEST_F(AsyncResultsMergerTest, MultiShardSortedCompoundMixedDirectionsAndTypes) {
+    BSONObj findCmd = fromjson("{find: 'testcoll', sort: {a: -1, b: 1}}");
+    std::vector<ClusterClientCursorParams::RemoteCursor> cursors;
+    cursors.emplace_back(kTestShardIds[0], kTestShardHosts[0], CursorResponse(_nss, 5, {}));
+    cursors.emplace_back(kTestShardIds[1], kTestShardHosts[1], CursorResponse(_nss, 6, {}));
+    cursors.emplace_back(kTestShardIds[2], kTestShardHosts[2], CursorResponse(_nss, 7, {}));
+    makeCursorFromExistingCursors(std::move(cursors), findCmd);
+
+    auto readyEvent = unittest::assertGet(arm->nextEvent());
+
+    // Numbers of different types compare by value, and strings sort after numbers.
+    std::vector<CursorResponse> responses;
+    responses.emplace_back(_nss,
+                           CursorId(0),
+                           std::vector<BSONObj>{fromjson("{$sortKey: {'': 'x', '': 1}}"),
+                                                fromjson("{$sortKey: {'': 2.5, '': 'b'}}")});
+    responses.emplace_back(_nss,
+                           CursorId(0),
+                           std::vector<BSONObj>{fromjson("{$sortKey: {'': 3, '': 0}}"),
+                                                fromjson("{$sortKey: {'': 2.5, '': 'a'}}")});
+    responses.emplace_back(_nss,
+                           CursorId(0),
+                           std::vector<BSONObj>{fromjson("{$sortKey: {'': 'x', '': 0.5}}"),
+                                                fromjson("{$sortKey: {'': -1, '': 0}}")});
+    scheduleNetworkResponses(std::move(responses),
+                             CursorResponse::ResponseType::SubsequentResponse);
+
+    executor()->waitForEvent(readyEvent);
+    ASSERT_TRUE(arm->ready());
+
+    for (auto&& expected : {"{$sortKey: {'': 'x', '': 0.5}}",
+                            "{$sortKey: {'': 'x', '': 1}}",
+                            "{$sortKey: {'': 3, '': 0}}",
+                            "{$sortKey: {'': 2.5, '': 'a'}}",
+                            "{$sortKey: {'': 2.5, '': 'b'}}",
+                            "{$sortKey: {'': -1, '': 0}}"}) {
+        ASSERT_TRUE(arm->ready());
+        ASSERT_BSONOBJ_EQ(fromjson(expected), *unittest::assertGet(arm->nextReady()).getResult());
+    }
+
+    ASSERT_TRUE(arm->ready());
+    ASSERT_TRUE(unittest::assertGet(arm->nextReady()).isEOF());
+}
+
 TEST_F(AsyncResultsMergerTest, MultiShardMultipleGets) {
     std::vector<ClusterClientCursorParams::RemoteCursor> cursors;
     cursors.emplace_back(kTestShardIds[0], kTestShardHosts[0], CursorResponse(_nss, 5, {}));
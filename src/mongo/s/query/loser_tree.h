@@ -0,0 +1,184 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include "mongo/util/assert_util.h"
+
+namespace mongo {
+
+/**
+ * A tournament tree for merging a number of sorted sequences ("leaves"), which keeps for each
+ * internal node the leaf which lost the match played at that node. After the winning leaf has
+ * advanced to its next element, the new winner is found by replaying only the matches on the path
+ * from that leaf to the root, which takes one comparison per level of the tree.
+ *
+ * The tree does not hold the elements itself. 'Less' is called with two leaf indexes and must
+ * compare the current elements of these leaves. A leaf without a current element is inactive and
+ * loses every match against an active leaf.
+ *
+ * A change to a leaf other than the winner requires the tree to be rebuilt, which is deferred to
+ * the next call to empty() or top() and costs one comparison per leaf. Popping the winner and then
+ * pushing the same leaf again only replays its path once.
+ */
+template <typename Less>
+class LoserTree {
+public:
+    explicit LoserTree(Less less) : _less(std::move(less)) {}
+
+    /**
+     * Adds a leaf, which starts out inactive. Returns its index.
+     */
+    std::size_t addLeaf() {
+        _active.push_back(false);
+        _nodes.push_back(0);
+        _needsRebuild = true;
+        return _active.size() - 1;
+    }
+
+    std::size_t numLeaves() const {
+        return _active.size();
+    }
+
+    /**
+     * Notifies the tree that 'leaf' has a current element. Does nothing if the leaf was already
+     * active, since the current element of an active leaf may only change through pop().
+     */
+    void push(std::size_t leaf) {
+        invariant(leaf < _active.size());
+        if (_active[leaf])
+            return;
+
+        _active[leaf] = true;
+        if (_needsReplay && !_needsRebuild && leaf == _nodes[0]) {
+            _replay(leaf);
+            _needsReplay = false;
+        } else {
+            _needsRebuild = true;
+        }
+    }
+
+    /**
+     * Returns true if no leaf is active.
+     */
+    bool empty() {
+        _update();
+        return _active.empty() || !_active[_nodes[0]];
+    }
+
+    /**
+     * Returns the leaf with the smallest current element. Invalid to call if empty().
+     */
+    std::size_t top() {
+        invariant(!empty());
+        return _nodes[0];
+    }
+
+    /**
+     * Notifies the tree that the current element of the winning leaf was consumed, which makes the
+     * leaf inactive until it is pushed again.
+     */
+    void pop() {
+        const auto winner = top();
+        _active[winner] = false;
+        _needsReplay = true;
+    }
+
+private:
+    /**
+     * Returns true if the current element of leaf 'a' sorts before that of leaf 'b'.
+     */
+    bool _beats(std::size_t a, std::size_t b) {
+        return _active[a] && (!_active[b] || _less(a, b));
+    }
+
+    void _update() {
+        if (_needsRebuild) {
+            _rebuild();
+        } else if (_needsReplay) {
+            _replay(_nodes[0]);
+        }
+        _needsRebuild = false;
+        _needsReplay = false;
+    }
+
+    /**
+     * Plays all the matches. The leaves are at the positions [n, 2n) of a complete binary tree
+     * whose internal nodes are the positions [1, n) of '_nodes', and '_nodes[0]' is the winner.
+     */
+    void _rebuild() {
+        const auto n = _active.size();
+        if (n == 0)
+            return;
+
+        std::vector<std::size_t> winners(2 * n);
+        for (std::size_t i = 0; i < n; ++i) {
+            winners[n + i] = i;
+        }
+        for (std::size_t node = n - 1; node > 0; --node) {
+            const auto left = winners[2 * node];
+            const auto right = winners[2 * node + 1];
+            const bool leftWins = _beats(left, right);
+            winners[node] = leftWins ? left : right;
+            _nodes[node] = leftWins ? right : left;
+        }
+        _nodes[0] = winners[1];
+    }
+
+    /**
+     * Replays the matches from 'leaf' up to the root.
+     */
+    void _replay(std::size_t leaf) {
+        auto winner = leaf;
+        for (auto node = (leaf + _active.size()) / 2; node > 0; node /= 2) {
+            if (_beats(_nodes[node], winner)) {
+                std::swap(_nodes[node], winner);
+            }
+        }
+        _nodes[0] = winner;
+    }
+
+    Less _less;
+
+    // Whether each leaf has a current element
+    std::vector<bool> _active;
+
+    // The winner followed by the loser of each internal node
+    std::vector<std::size_t> _nodes;
+
+    bool _needsRebuild = false;
+
+    // Whether the winner was popped and its matches have not been replayed yet
+    bool _needsReplay = false;
+};
+
+}  // namespace mongo
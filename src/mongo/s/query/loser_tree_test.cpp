@@ -0,0 +1,193 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <algorithm>
+#include <deque>
+#include <vector>
+
+#include "mongo/platform/random.h"
+#include "mongo/s/query/loser_tree.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+using Sequences = std::vector<std::deque<int>>;
+
+class FrontLess {
+public:
+    explicit FrontLess(const Sequences* sequences) : _sequences(sequences) {}
+
+    bool operator()(size_t lhs, size_t rhs) const {
+        return (*_sequences)[lhs].front() < (*_sequences)[rhs].front();
+    }
+
+private:
+    const Sequences* _sequences;
+};
+
+using TestTree = LoserTree<FrontLess>;
+
+/**
+ * Merges 'sequences' by popping the winner of 'tree', which must have one active leaf per
+ * non-empty sequence.
+ */
+std::vector<int> drain(Sequences* sequences, TestTree* tree) {
+    std::vector<int> merged;
+    while (!tree->empty()) {
+        const auto winner = tree->top();
+        merged.push_back((*sequences)[winner].front());
+        (*sequences)[winner].pop_front();
+
+        tree->pop();
+        if (!(*sequences)[winner].empty()) {
+            tree->push(winner);
+        }
+    }
+    return merged;
+}
+
+TEST(LoserTreeTest, EmptyTree) {
+    Sequences sequences;
+    TestTree tree{FrontLess(&sequences)};
+    ASSERT(tree.empty());
+
+    sequences.emplace_back();
+    tree.addLeaf();
+    ASSERT(tree.empty());
+}
+
+TEST(LoserTreeTest, MergesSortedSequences) {
+    Sequences sequences{{1, 4, 7}, {}, {2, 2, 9}, {0}, {3, 5, 6, 8}};
+    TestTree tree{FrontLess(&sequences)};
+    for (size_t i = 0; i < sequences.size(); ++i) {
+        ASSERT_EQ(i, tree.addLeaf());
+        if (!sequences[i].empty()) {
+            tree.push(i);
+        }
+    }
+
+    ASSERT_EQ(3U, tree.top());
+    ASSERT((std::vector<int>{0, 1, 2, 2, 3, 4, 5, 6, 7, 8, 9}) == drain(&sequences, &tree));
+}
+
+TEST(LoserTreeTest, LeafWhichIsNotTheWinnerBecomesActive) {
+    Sequences sequences{{5, 6}, {}, {7}};
+    TestTree tree{FrontLess(&sequences)};
+    for (size_t i = 0; i < sequences.size(); ++i) {
+        tree.addLeaf();
+    }
+    tree.push(0);
+    tree.push(2);
+    ASSERT_EQ(0U, tree.top());
+
+    sequences[1].push_back(1);
+    tree.push(1);
+    ASSERT_EQ(1U, tree.top());
+
+    // A leaf added after the tree was built takes part in the next match
+    sequences.push_back({0});
+    tree.push(tree.addLeaf());
+    ASSERT_EQ(3U, tree.top());
+
+    ASSERT((std::vector<int>{0, 1, 5, 6, 7}) == drain(&sequences, &tree));
+}
+
+TEST(LoserTreeTest, RandomSequencesRefilledWhileMerging) {
+    PseudoRandom random(7);
+
+    for (int iteration = 0; iteration < 200; ++iteration) {
+        const size_t numSequences = 1 + random.nextInt32(20);
+
+        // Each sequence is handed to the tree a few elements at a time, the way remote cursors
+        // return batches
+        Sequences pending(numSequences);
+        Sequences buffered(numSequences);
+        std::vector<int> expected;
+        for (auto& sequence : pending) {
+            const int length = random.nextInt32(30);
+            for (int i = 0; i < length; ++i) {
+                sequence.push_back(random.nextInt32(100));
+            }
+            std::sort(sequence.begin(), sequence.end());
+            expected.insert(expected.end(), sequence.begin(), sequence.end());
+        }
+        std::sort(expected.begin(), expected.end());
+
+        TestTree tree{FrontLess(&buffered)};
+        for (size_t i = 0; i < numSequences; ++i) {
+            tree.addLeaf();
+        }
+
+        std::vector<int> merged;
+        while (true) {
+            bool allBuffered = true;
+            for (size_t i = 0; i < numSequences; ++i) {
+                if (!buffered[i].empty() || pending[i].empty()) {
+                    continue;
+                }
+
+                if (random.nextInt32(2)) {
+                    allBuffered = false;
+                    continue;
+                }
+
+                for (int n = 1 + random.nextInt32(4); n > 0 && !pending[i].empty(); --n) {
+                    buffered[i].push_back(pending[i].front());
+                    pending[i].pop_front();
+                }
+                tree.push(i);
+            }
+
+            // Like a sorted merge of cursors, only return a result once every sequence which is
+            // not exhausted has a buffered element
+            if (!allBuffered) {
+                continue;
+            }
+            if (tree.empty()) {
+                break;
+            }
+
+            const auto winner = tree.top();
+            merged.push_back(buffered[winner].front());
+            buffered[winner].pop_front();
+
+            tree.pop();
+            if (!buffered[winner].empty()) {
+                tree.push(winner);
+            }
+        }
+
+        ASSERT(expected == merged);
+    }
+}
+
+}  // namespace
+}  // namespace mongo
@@ -64,6 +64,7 @@
 #include "mongo/db/service_context.h"
 #include "mongo/db/service_context_noop.h"
 #include "mongo/db/session_killer.h"
+#include "mongo/db/stats/metrics_exporter.h"
 #include "mongo/db/startup_warnings_common.h"
 #include "mongo/db/wire_version.h"
 #include "mongo/executor/task_executor_pool.h"
@@ -72,6 +73,7 @@
 #include "mongo/s/balancer_configuration.h"
 #include "mongo/s/catalog/sharding_catalog_client.h"
 #include "mongo/s/catalog_cache.h"
+#include "mongo/s/catalog_cache_refresh_job.h"
 #include "mongo/s/client/shard_connection.h"
 #include "mongo/s/client/shard_factory.h"
 #include "mongo/s/client/shard_registry.h"
@@ -258,6 +260,8 @@ static void cleanupTask() {
 
         // Shutdown Full-Time Data Capture
         stopMongoSFTDC();
+
+        shutdownMetricsExporter();
     }
 
     audit::logShutdown(Client::getCurrent());
@@ -416,6 +420,12 @@ static ExitCode runMongosServer() {
         return EXIT_SHARDING_ERROR;
     }
 
+    status = startMetricsExporter(opCtx->getServiceContext());
+    if (!status.isOK()) {
+        error() << "Failed to start the metrics exporter: " << status;
+        return EXIT_NET_ERROR;
+    }
+
     // Construct the sharding uptime reporter after the startup parameters have been parsed in order
     // to ensure that it picks up the server port instead of reporting the default value.
     shardingUptimeReporter.emplace();
@@ -423,6 +433,8 @@ static ExitCode runMongosServer() {
 
     clusterCursorCleanupJob.go();
 
+    catalogCacheRefreshJob.go();
+
     UserCacheInvalidator cacheInvalidatorThread(getGlobalAuthorizationManager());
     {
         cacheInvalidatorThread.initialize(opCtx.get());
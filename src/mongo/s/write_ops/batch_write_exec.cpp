@@ -34,6 +34,7 @@
 
 #include "mongo/base/error_codes.h"
 #include "mongo/base/owned_pointer_map.h"
+#include "mongo/base/owned_pointer_vector.h"
 #include "mongo/base/status.h"
 #include "mongo/bson/util/builder.h"
 #include "mongo/client/connection_string.h"
@@ -51,14 +52,6 @@ namespace {
 
 const ReadPreferenceSetting kPrimaryOnlyReadPreference(ReadPreference::PrimaryOnly);
 
-//
-// Map which allows associating ConnectionString hosts with TargetedWriteBatches
-// This is needed since the dispatcher only returns hosts with responses.
-//
-
-// TODO: Unordered map?
-typedef OwnedPointerMap<ShardId, TargetedWriteBatch> OwnedShardBatchMap;
-
 WriteErrorDetail errorFromStatus(const Status& status) {
     WriteErrorDetail error;
     error.setStatus(status);
@@ -91,6 +84,8 @@ void BatchWriteExec::executeBatch(OperationContext* opCtx,
 
     BatchWriteOp batchOp(opCtx, clientRequest);
 
+    const bool ordered = clientRequest.getWriteCommandBase().getOrdered();
+
     // Current batch status
     bool refreshedTargeter = false;
     int rounds = 0;
@@ -141,161 +136,166 @@ void BatchWriteExec::executeBatch(OperationContext* opCtx,
         // Send all child batches
         //
 
-        const size_t numToSend = childBatches.size();
-        size_t numSent = 0;
+        // Batches which were sent and whose response has not been received yet. There is at most
+        // one such batch per shard.
+        std::map<ShardId, TargetedWriteBatch*> pendingBatches;
 
-        while (numSent != numToSend) {
-            // Collect batches out on the network, mapped by endpoint
-            OwnedShardBatchMap ownedPendingBatches;
-            OwnedShardBatchMap::MapType& pendingBatches = ownedPendingBatches.mutableMap();
+        // Owns the batches targeted while the responses of this round are received
+        OwnedPointerVector<TargetedWriteBatch> pipelinedBatchesOwned;
 
-            //
-            // Construct the requests.
-            //
+        const auto buildRequest = [&](const TargetedWriteBatch& batch) {
+            const auto shardBatchRequest(batchOp.buildBatchRequest(batch));
 
-            std::vector<AsyncRequestsSender::Request> requests;
+            BSONObjBuilder requestBuilder;
+            shardBatchRequest.serialize(&requestBuilder);
 
-            // Get as many batches as we can at once
-            for (auto& childBatch : childBatches) {
-                TargetedWriteBatch* const nextBatch = childBatch.second;
+            {
+                OperationSessionInfo sessionInfo;
 
-                // If the batch is nullptr, we sent it previously, so skip
-                if (!nextBatch)
-                    continue;
+                if (opCtx->getLogicalSessionId()) {
+                    sessionInfo.setSessionId(*opCtx->getLogicalSessionId());
+                }
 
-                // If we already have a batch for this shard, wait until the next time
-                const auto& targetShardId = nextBatch->getEndpoint().shardName;
+                sessionInfo.setTxnNumber(opCtx->getTxnNumber());
+                sessionInfo.serialize(&requestBuilder);
+            }
 
-                if (pendingBatches.count(targetShardId))
-                    continue;
+            const auto& targetShardId = batch.getEndpoint().shardName;
+            auto request = requestBuilder.obj();
 
-                const auto request = [&] {
-                    const auto shardBatchRequest(batchOp.buildBatchRequest(*nextBatch));
+            LOG(4) << "Sending write batch to " << targetShardId << ": " << redact(request);
 
-                    BSONObjBuilder requestBuilder;
-                    shardBatchRequest.serialize(&requestBuilder);
+            return AsyncRequestsSender::Request(targetShardId, std::move(request));
+        };
 
-                    {
-                        OperationSessionInfo sessionInfo;
+        std::vector<AsyncRequestsSender::Request> requests;
+        for (const auto& childBatch : childBatches) {
+            requests.push_back(buildRequest(*childBatch.second));
+            pendingBatches.emplace(childBatch.first, childBatch.second);
+        }
+
+        AsyncRequestsSender ars(opCtx,
+                                Grid::get(opCtx)->getExecutorPool()->getArbitraryExecutor(),
+                                clientRequest.getTargetingNS().db().toString(),
+                                requests,
+                                kPrimaryOnlyReadPreference,
+                                opCtx->getTxnNumber() ? Shard::RetryPolicy::kIdempotent
+                                                      : Shard::RetryPolicy::kNoRetry);
+
+        // The writes of an unordered batch which did not fit in this round's child batches can be
+        // sent to a shard as soon as it has answered, rather than after the slowest shard of the
+        // round has answered. This stops once the targeter needs to be refreshed.
+        bool pipelineBatches = !ordered && targetStatus.isOK();
 
-                        if (opCtx->getLogicalSessionId()) {
-                            sessionInfo.setSessionId(*opCtx->getLogicalSessionId());
-                        }
+        //
+        // Receive the responses.
+        //
 
-                        sessionInfo.setTxnNumber(opCtx->getTxnNumber());
-                        sessionInfo.serialize(&requestBuilder);
-                    }
+        while (!ars.done()) {
+            // Block until a response is available.
+            auto response = ars.next();
 
-                    return requestBuilder.obj();
-                }();
+            // Get the TargetedWriteBatch to find where to put the response
+            const auto pendingIt = pendingBatches.find(response.shardId);
+            invariant(pendingIt != pendingBatches.end());
+            TargetedWriteBatch* batch = pendingIt->second;
+            pendingBatches.erase(pendingIt);
 
-                LOG(4) << "Sending write batch to " << targetShardId << ": " << redact(request);
+            // First check if we were able to target a shard host.
+            if (!response.shardHostAndPort) {
+                invariant(!response.swResponse.isOK());
 
-                requests.emplace_back(targetShardId, request);
+                // Record a resolve failure
+                batchOp.noteBatchError(*batch, errorFromStatus(response.swResponse.getStatus()));
 
-                // Indicate we're done by setting the batch to nullptr. We'll only get duplicate
-                // hostEndpoints if we have broadcast and non-broadcast endpoints for the same host,
-                // so this should be pretty efficient without moving stuff around.
-                childBatch.second = nullptr;
+                // TODO: It may be necessary to refresh the cache if stale, or maybe just cancel
+                // and retarget the batch
+                LOG(4) << "Unable to send write batch to " << batch->getEndpoint().shardName
+                       << causedBy(response.swResponse.getStatus());
+                continue;
+            }
 
-                // Recv-side is responsible for cleaning up the nextBatch when used
-                pendingBatches.emplace(targetShardId, nextBatch);
+            const auto shardHost(std::move(*response.shardHostAndPort));
+
+            // Then check if we successfully got a response.
+            Status responseStatus = response.swResponse.getStatus();
+            BatchedCommandResponse batchedCommandResponse;
+            if (responseStatus.isOK()) {
+                std::string errMsg;
+                if (!batchedCommandResponse.parseBSON(response.swResponse.getValue().data,
+                                                      &errMsg) ||
+                    !batchedCommandResponse.isValid(&errMsg)) {
+                    responseStatus = {ErrorCodes::FailedToParse, errMsg};
+                }
             }
 
-            AsyncRequestsSender ars(opCtx,
-                                    Grid::get(opCtx)->getExecutorPool()->getArbitraryExecutor(),
-                                    clientRequest.getTargetingNS().db().toString(),
-                                    requests,
-                                    kPrimaryOnlyReadPreference,
-                                    opCtx->getTxnNumber() ? Shard::RetryPolicy::kIdempotent
-                                                          : Shard::RetryPolicy::kNoRetry);
-            numSent += pendingBatches.size();
+            if (responseStatus.isOK()) {
+                TrackedErrors trackedErrors;
+                trackedErrors.startTracking(ErrorCodes::StaleShardVersion);
+
+                LOG(4) << "Write results received from " << shardHost.toString() << ": "
+                       << redact(batchedCommandResponse.toString());
+
+                // Dispatch was ok, note response
+                batchOp.noteBatchResponse(*batch, batchedCommandResponse, &trackedErrors);
+
+                // Note if anything was stale
+                const auto& staleErrors = trackedErrors.getErrors(ErrorCodes::StaleShardVersion);
+                if (!staleErrors.empty()) {
+                    noteStaleResponses(staleErrors, &targeter);
+                    ++stats->numStaleBatches;
+                    pipelineBatches = false;
+                }
+
+                // Remember that we successfully wrote to this shard
+                // NOTE: This will record lastOps for shards where we actually didn't update
+                // or delete any documents, which preserves old behavior but is conservative
+                stats->noteWriteAt(shardHost,
+                                   batchedCommandResponse.isLastOpSet()
+                                       ? batchedCommandResponse.getLastOp()
+                                       : repl::OpTime(),
+                                   batchedCommandResponse.isElectionIdSet()
+                                       ? batchedCommandResponse.getElectionId()
+                                       : OID());
+            } else {
+                // Error occurred dispatching, note it
+                const Status status = responseStatus.withContext(
+                    str::stream() << "Write results unavailable from " << shardHost);
+
+                batchOp.noteBatchError(*batch, errorFromStatus(status));
+
+                LOG(4) << "Unable to receive write results from " << shardHost
+                       << causedBy(redact(status));
+            }
 
             //
-            // Receive the responses.
+            // Target and send the next batches for the shards which are not busy
             //
 
-            while (!ars.done()) {
-                // Block until a response is available.
-                auto response = ars.next();
-
-                // Get the TargetedWriteBatch to find where to put the response
-                dassert(pendingBatches.find(response.shardId) != pendingBatches.end());
-                TargetedWriteBatch* batch = pendingBatches.find(response.shardId)->second;
-
-                // First check if we were able to target a shard host.
-                if (!response.shardHostAndPort) {
-                    invariant(!response.swResponse.isOK());
-
-                    // Record a resolve failure
-                    batchOp.noteBatchError(*batch,
-                                           errorFromStatus(response.swResponse.getStatus()));
-
-                    // TODO: It may be necessary to refresh the cache if stale, or maybe just cancel
-                    // and retarget the batch
-                    LOG(4) << "Unable to send write batch to " << batch->getEndpoint().shardName
-                           << causedBy(response.swResponse.getStatus());
-
-                    // We're done with this batch. Clean up when we can't resolve a host.
-                    auto it = childBatches.find(batch->getEndpoint().shardName);
-                    invariant(it != childBatches.end());
-                    delete it->second;
-                    it->second = nullptr;
-                    continue;
-                }
+            if (!pipelineBatches || batchOp.numWriteOpsIn(WriteOpState_Ready) == 0)
+                continue;
 
-                const auto shardHost(std::move(*response.shardHostAndPort));
-
-                // Then check if we successfully got a response.
-                Status responseStatus = response.swResponse.getStatus();
-                BatchedCommandResponse batchedCommandResponse;
-                if (responseStatus.isOK()) {
-                    std::string errMsg;
-                    if (!batchedCommandResponse.parseBSON(response.swResponse.getValue().data,
-                                                          &errMsg) ||
-                        !batchedCommandResponse.isValid(&errMsg)) {
-                        responseStatus = {ErrorCodes::FailedToParse, errMsg};
-                    }
-                }
+            std::set<ShardId> busyShards;
+            for (const auto& pendingBatch : pendingBatches) {
+                busyShards.insert(pendingBatch.first);
+            }
 
-                if (responseStatus.isOK()) {
-                    TrackedErrors trackedErrors;
-                    trackedErrors.startTracking(ErrorCodes::StaleShardVersion);
-
-                    LOG(4) << "Write results received from " << shardHost.toString() << ": "
-                           << redact(batchedCommandResponse.toString());
-
-                    // Dispatch was ok, note response
-                    batchOp.noteBatchResponse(*batch, batchedCommandResponse, &trackedErrors);
-
-                    // Note if anything was stale
-                    const auto& staleErrors =
-                        trackedErrors.getErrors(ErrorCodes::StaleShardVersion);
-                    if (!staleErrors.empty()) {
-                        noteStaleResponses(staleErrors, &targeter);
-                        ++stats->numStaleBatches;
-                    }
-
-                    // Remember that we successfully wrote to this shard
-                    // NOTE: This will record lastOps for shards where we actually didn't update
-                    // or delete any documents, which preserves old behavior but is conservative
-                    stats->noteWriteAt(shardHost,
-                                       batchedCommandResponse.isLastOpSet()
-                                           ? batchedCommandResponse.getLastOp()
-                                           : repl::OpTime(),
-                                       batchedCommandResponse.isElectionIdSet()
-                                           ? batchedCommandResponse.getElectionId()
-                                           : OID());
-                } else {
-                    // Error occurred dispatching, note it
-                    const Status status = responseStatus.withContext(
-                        str::stream() << "Write results unavailable from " << shardHost);
-
-                    batchOp.noteBatchError(*batch, errorFromStatus(status));
-
-                    LOG(4) << "Unable to receive write results from " << shardHost
-                           << causedBy(redact(status));
-                }
+            std::map<ShardId, TargetedWriteBatch*> nextBatches;
+            Status nextTargetStatus =
+                batchOp.targetBatch(targeter, recordTargetErrors, &nextBatches, busyShards);
+            if (!nextTargetStatus.isOK()) {
+                // Leave the untargeted writes for the next round, after a targeter refresh
+                targeter.noteCouldNotTarget();
+                refreshedTargeter = true;
+                ++stats->numTargetErrors;
+                pipelineBatches = false;
+                dassert(nextBatches.size() == 0u);
+            }
+
+            for (const auto& nextBatch : nextBatches) {
+                pipelinedBatchesOwned.mutableVector().push_back(nextBatch.second);
+                ars.addRequest(buildRequest(*nextBatch.second));
+                pendingBatches.emplace(nextBatch.first, nextBatch.second);
             }
         }
 
@@ -30,6 +30,7 @@
 
 #include "mongo/s/write_ops/batch_write_op.h"
 
+#include <algorithm>
 #include <numeric>
 
 #include "mongo/base/error_codes.h"
@@ -197,7 +198,8 @@ BatchWriteOp::~BatchWriteOp() {
 
 Status BatchWriteOp::targetBatch(const NSTargeter& targeter,
                                  bool recordTargetErrors,
-                                 std::map<ShardId, TargetedWriteBatch*>* targetedBatches) {
+                                 std::map<ShardId, TargetedWriteBatch*>* targetedBatches,
+                                 const std::set<ShardId>& busyShards) {
     //
     // Targeting of unordered batches is fairly simple - each remaining write op is targeted,
     // and each of those targeted writes are grouped into a batch for a particular shard
@@ -239,6 +241,41 @@ Status BatchWriteOp::targetBatch(const NSTargeter& targeter,
 
     const size_t numWriteOps = _clientRequest.sizeWriteOps();
 
+    // All the remaining documents of an unordered insert will be targeted, so target the ones
+    // which have not been targeted yet with a single call, which lets the targeter share the work
+    // of looking up their chunks
+    const bool batchTargetInserts = !ordered &&
+        _clientRequest.getBatchType() == BatchedCommandRequest::BatchType_Insert &&
+        !_clientRequest.isInsertIndexRequest();
+
+    // Targeting failures are not remembered, so that these inserts are retargeted after a refresh
+    std::map<size_t, Status> insertTargetErrors;
+    if (batchTargetInserts) {
+        _insertEndpoints.resize(numWriteOps);
+
+        std::vector<size_t> untargetedIndexes;
+        std::vector<BSONObj> docs;
+        for (size_t i = 0; i < numWriteOps; ++i) {
+            if (_writeOps[i].getWriteState() == WriteOpState_Ready && !_insertEndpoints[i]) {
+                untargetedIndexes.push_back(i);
+                docs.push_back(_writeOps[i].getWriteItem().getDocument());
+            }
+        }
+
+        if (!docs.empty()) {
+            auto endpoints = targeter.targetInserts(_opCtx, docs);
+            invariant(endpoints.size() == docs.size());
+
+            for (size_t j = 0; j < endpoints.size(); ++j) {
+                if (endpoints[j].isOK()) {
+                    _insertEndpoints[untargetedIndexes[j]] = std::move(endpoints[j].getValue());
+                } else {
+                    insertTargetErrors.emplace(untargetedIndexes[j], endpoints[j].getStatus());
+                }
+            }
+        }
+    }
+
     for (size_t i = 0; i < numWriteOps; ++i) {
         WriteOp& writeOp = _writeOps[i];
 
@@ -254,7 +291,10 @@ Status BatchWriteOp::targetBatch(const NSTargeter& targeter,
         OwnedPointerVector<TargetedWrite> writesOwned;
         vector<TargetedWrite*>& writes = writesOwned.mutableVector();
 
-        Status targetStatus = writeOp.targetWrites(_opCtx, targeter, &writes);
+        Status targetStatus = !batchTargetInserts
+            ? writeOp.targetWrites(_opCtx, targeter, &writes)
+            : _insertEndpoints[i] ? writeOp.targetWrites(*_insertEndpoints[i], &writes)
+                                  : writeOp.targetWrites(insertTargetErrors.at(i), &writes);
 
         if (!targetStatus.isOK()) {
             WriteErrorDetail targetError;
@@ -297,6 +337,19 @@ Status BatchWriteOp::targetBatch(const NSTargeter& targeter,
             }
         }
 
+        //
+        // If unordered, leave the writes for shards which are still busy with a previous batch for
+        // later
+        //
+
+        if (!ordered && !busyShards.empty() &&
+            std::any_of(writes.begin(), writes.end(), [&](const TargetedWrite* write) {
+                return busyShards.count(write->endpoint.shardName) != 0;
+            })) {
+            writeOp.cancelWrites(nullptr);
+            continue;
+        }
+
         // Account the array overhead once for the actual updates array and once for the statement
         // ids array, if retryable writes are used
         const int writeSizeBytes = getWriteSizeBytes(writeOp) + kBSONArrayPerElementOverheadBytes +
@@ -305,6 +358,11 @@ Status BatchWriteOp::targetBatch(const NSTargeter& targeter,
         if (wouldMakeBatchesTooBig(writes, writeSizeBytes, batchMap)) {
             invariant(!batchMap.empty());
             writeOp.cancelWrites(nullptr);
+
+            // The writes which follow may still fit in the batches for other shards
+            if (!ordered)
+                continue;
+
             break;
         }
 
@@ -540,6 +598,14 @@ void BatchWriteOp::noteBatchResponse(const TargetedWriteBatch& targetedBatch,
         }
     }
 
+    // A stale shard version means that the endpoints the inserts were targeted to may be out of
+    // date, so they must be targeted again after the targeter is refreshed
+    if (std::any_of(itemErrors.begin(), itemErrors.end(), [](const WriteErrorDetail* error) {
+            return ErrorCodes::isStaleShardingError(error->toStatus().code());
+        })) {
+        _insertEndpoints.clear();
+    }
+
     // Track errors we care about, whether batch or individual errors
     if (NULL != trackedErrors) {
         trackErrors(targetedBatch.getEndpoint(), itemErrors, trackedErrors);
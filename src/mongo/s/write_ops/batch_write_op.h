@@ -28,6 +28,7 @@
 
 #pragma once
 
+#include <boost/optional.hpp>
 #include <map>
 #include <set>
 #include <vector>
@@ -136,10 +137,17 @@ public:
      * targeting errors, but if not we should refresh once first.)
      *
      * Returned TargetedWriteBatches are owned by the caller.
+     *
+     * For unordered batches, the write ops which target any of 'busyShards' are left untargeted,
+     * so that the caller can target them again once its outstanding batches for these shards
+     * complete. Ops which do not fit in the batch for their shard are left untargeted in the same
+     * way, without stopping the targeting of the ops which follow them. The documents of unordered
+     * inserts are only targeted once, and again after a shard reports a stale version.
      */
     Status targetBatch(const NSTargeter& targeter,
                        bool recordTargetErrors,
-                       std::map<ShardId, TargetedWriteBatch*>* targetedBatches);
+                       std::map<ShardId, TargetedWriteBatch*>* targetedBatches,
+                       const std::set<ShardId>& busyShards = {});
 
     /**
      * Fills a BatchCommandRequest from a TargetedWriteBatch for this BatchWriteOp.
@@ -210,6 +218,11 @@ private:
     // Array of ops being processed from the client request
     std::vector<WriteOp> _writeOps;
 
+    // For unordered inserts, the endpoint each document was last targeted to, by write op index.
+    // Documents left for a later batch reuse it rather than being targeted again, until a shard
+    // reports a stale version.
+    std::vector<boost::optional<ShardEndpoint>> _insertEndpoints;
+
     // Current outstanding batch op write requests
     // Not owned here but tracked for reporting
     std::set<const TargetedWriteBatch*> _targeted;
@@ -772,6 +772,127 @@ TEST_F(BatchWriteOpTest, MultiOpOneOrTwoShardsUnordered) {
     ASSERT_EQUALS(clientResponse.getN(), 8);
 }
 
+// Unordered multi-op targeting test where one of the shards is still busy with a previous batch.
+// Only the ops for the other shard are targeted, and the rest are targeted once it is no longer
+// busy.
+TEST_F(BatchWriteOpTest, MultiOpTwoShardsOneBusyUnordered) {
+    NamespaceString nss("foo.bar");
+    ShardEndpoint endpointA(ShardId("shardA"), ChunkVersion::IGNORED());
+    ShardEndpoint endpointB(ShardId("shardB"), ChunkVersion::IGNORED());
+    MockNSTargeter targeter;
+    initTargeterSplitRange(nss, endpointA, endpointB, &targeter);
+
+    BatchedCommandRequest request([&] {
+        write_ops::Insert insertOp(nss);
+        insertOp.setWriteCommandBase([] {
+            write_ops::WriteCommandBase wcb;
+            wcb.setOrdered(false);
+            return wcb;
+        }());
+        insertOp.setDocuments({BSON("x" << -1), BSON("x" << 1), BSON("x" << -2), BSON("x" << 2)});
+        return insertOp;
+    }());
+
+    BatchWriteOp batchOp(operationContext(), request);
+
+    OwnedPointerMap<ShardId, TargetedWriteBatch> targetedOwned;
+    std::map<ShardId, TargetedWriteBatch*>& targeted = targetedOwned.mutableMap();
+    ASSERT_OK(batchOp.targetBatch(targeter, false, &targeted, {endpointB.shardName}));
+    ASSERT_EQUALS(targeted.size(), 1u);
+    verifyTargetedBatches({{endpointA.shardName, 2u}}, targeted);
+    ASSERT_EQUALS(2, batchOp.numWriteOpsIn(WriteOpState_Ready));
+
+    BatchedCommandResponse response;
+    buildResponse(2, &response);
+
+    batchOp.noteBatchResponse(*targeted.begin()->second, response, NULL);
+    ASSERT(!batchOp.isFinished());
+
+    targetedOwned.clear();
+    ASSERT_OK(batchOp.targetBatch(targeter, false, &targeted, {endpointA.shardName}));
+    ASSERT_EQUALS(targeted.size(), 1u);
+    verifyTargetedBatches({{endpointB.shardName, 2u}}, targeted);
+
+    batchOp.noteBatchResponse(*targeted.begin()->second, response, NULL);
+    ASSERT(batchOp.isFinished());
+
+    BatchedCommandResponse clientResponse;
+    batchOp.buildClientResponse(&clientResponse);
+    ASSERT(clientResponse.getOk());
+    ASSERT_EQUALS(clientResponse.getN(), 4);
+}
+
+// Unordered inserts which are left for a later batch because their shard is busy keep the endpoint
+// they were first targeted to, and are only targeted again after a stale shard version error.
+TEST_F(BatchWriteOpTest, MultiOpUnorderedInsertsAreRetargetedOnlyAfterStaleError) {
+    class CountingTargeter : public MockNSTargeter {
+    public:
+        StatusWith<ShardEndpoint> targetInsert(OperationContext* opCtx,
+                                               const BSONObj& doc) const override {
+            ++numTargetedInserts;
+            return MockNSTargeter::targetInsert(opCtx, doc);
+        }
+
+        mutable int numTargetedInserts{0};
+    };
+
+    NamespaceString nss("foo.bar");
+    ShardEndpoint endpointA(ShardId("shardA"), ChunkVersion::IGNORED());
+    ShardEndpoint endpointB(ShardId("shardB"), ChunkVersion::IGNORED());
+    CountingTargeter targeter;
+    initTargeterSplitRange(nss, endpointA, endpointB, &targeter);
+
+    BatchedCommandRequest request([&] {
+        write_ops::Insert insertOp(nss);
+        insertOp.setWriteCommandBase([] {
+            write_ops::WriteCommandBase wcb;
+            wcb.setOrdered(false);
+            return wcb;
+        }());
+        insertOp.setDocuments({BSON("x" << -1), BSON("x" << 1), BSON("x" << -2), BSON("x" << 2)});
+        return insertOp;
+    }());
+
+    BatchWriteOp batchOp(operationContext(), request);
+
+    OwnedPointerMap<ShardId, TargetedWriteBatch> targetedOwned;
+    std::map<ShardId, TargetedWriteBatch*>& targeted = targetedOwned.mutableMap();
+    ASSERT_OK(batchOp.targetBatch(targeter, false, &targeted, {endpointB.shardName}));
+    verifyTargetedBatches({{endpointA.shardName, 2u}}, targeted);
+    ASSERT_EQUALS(4, targeter.numTargetedInserts);
+
+    BatchedCommandResponse response;
+    buildResponse(2, &response);
+    batchOp.noteBatchResponse(*targeted.begin()->second, response, NULL);
+
+    // The writes for shardB reuse the endpoints they were targeted to in the first pass
+    targetedOwned.clear();
+    ASSERT_OK(batchOp.targetBatch(targeter, false, &targeted, {endpointA.shardName}));
+    verifyTargetedBatches({{endpointB.shardName, 2u}}, targeted);
+    ASSERT_EQUALS(4, targeter.numTargetedInserts);
+
+    BatchedCommandResponse staleResponse;
+    buildResponse(1, &staleResponse);
+    addError(ErrorCodes::StaleShardVersion, "mock stale error", 0, &staleResponse);
+    batchOp.noteBatchResponse(*targeted.begin()->second, staleResponse, NULL);
+    ASSERT_EQUALS(1, batchOp.numWriteOpsIn(WriteOpState_Ready));
+
+    // Only the write which got the stale error is targeted again
+    targetedOwned.clear();
+    ASSERT_OK(batchOp.targetBatch(targeter, false, &targeted));
+    verifyTargetedBatches({{endpointB.shardName, 1u}}, targeted);
+    ASSERT_EQUALS(5, targeter.numTargetedInserts);
+
+    buildResponse(1, &response);
+    batchOp.noteBatchResponse(*targeted.begin()->second, response, NULL);
+    ASSERT(batchOp.isFinished());
+
+    BatchedCommandResponse clientResponse;
+    batchOp.buildClientResponse(&clientResponse);
+    ASSERT(clientResponse.getOk());
+    ASSERT_EQUALS(clientResponse.getN(), 4);
+}
+
 // Multi-op targeting test where two ops go to two separate shards and there's an error on one op on
 // one shard. There should be one set of two batches to each shard and an error reported.
 TEST_F(BatchWriteOpTest, MultiOpSingleShardErrorUnordered) {
@@ -86,6 +86,23 @@ Status WriteOp::targetWrites(OperationContext* opCtx,
         swEndpoints = targeter.targetAllShards(opCtx);
     }
 
+    return _addTargetedWrites(std::move(swEndpoints), targetedWrites);
+}
+
+Status WriteOp::targetWrites(StatusWith<ShardEndpoint> swEndpoint,
+                             std::vector<TargetedWrite*>* targetedWrites) {
+    invariant(_itemRef.getOpType() == BatchedCommandRequest::BatchType_Insert &&
+              !_itemRef.getRequest()->isInsertIndexRequest());
+
+    if (!swEndpoint.isOK())
+        return swEndpoint.getStatus();
+
+    return _addTargetedWrites(std::vector<ShardEndpoint>{std::move(swEndpoint.getValue())},
+                              targetedWrites);
+}
+
+Status WriteOp::_addTargetedWrites(StatusWith<std::vector<ShardEndpoint>> swEndpoints,
+                                   std::vector<TargetedWrite*>* targetedWrites) {
     // If we had an error, stop here
     if (!swEndpoints.isOK())
         return swEndpoints.getStatus();
@@ -121,6 +121,13 @@ public:
                         const NSTargeter& targeter,
                         std::vector<TargetedWrite*>* targetedWrites);
 
+    /**
+     * Same as above, but for an insert whose endpoint was already determined by a batch call to
+     * NSTargeter::targetInserts.
+     */
+    Status targetWrites(StatusWith<ShardEndpoint> swEndpoint,
+                        std::vector<TargetedWrite*>* targetedWrites);
+
     /**
      * Returns the number of child writes that were last targeted.
      */
@@ -164,6 +171,13 @@ private:
      */
     void _updateOpState();
 
+    /**
+     * Creates a TargetedWrite for each of the endpoints returned by targeting this op, or returns
+     * the targeting error.
+     */
+    Status _addTargetedWrites(StatusWith<std::vector<ShardEndpoint>> swEndpoints,
+                              std::vector<TargetedWrite*>* targetedWrites);
+
     // Owned elsewhere, reference to a batch with a write item
     const BatchItemRef _itemRef;
 
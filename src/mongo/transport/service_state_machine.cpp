@@ -36,6 +36,7 @@
 #include "mongo/db/client.h"
 #include "mongo/db/dbmessage.h"
 #include "mongo/db/stats/counters.h"
+#include "mongo/db/stats/operation_phase_trace.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/transport/message_compressor_manager.h"
 #include "mongo/transport/service_entry_point.h"
@@ -282,6 +283,10 @@ void ServiceStateMachine::_sourceCallback(Status status) {
     if (status.isOK()) {
         _state.store(State::Process);
 
+        if (OperationPhaseTrace::isEnabled()) {
+            _inMessageReceivedTicks = _serviceContext->getTickSource()->getTicks();
+        }
+
         // Since we know that we're going to process a message, call scheduleNext() immediately
         // to schedule the call to processMessage() on the serviceExecutor (or just unwind the
         // stack)
@@ -362,6 +367,12 @@ void ServiceStateMachine::_processMessage(ThreadGuard guard) {
     // Pass sourced Message to handler to generate response.
     auto opCtx = Client::getCurrent()->makeOperationContext();
 
+    if (OperationPhaseTrace::isEnabled()) {
+        OperationPhaseTrace::get(opCtx.get())
+            .start(_serviceContext->getTickSource(), _inMessageReceivedTicks);
+    }
+    _inMessageReceivedTicks = 0;
+
     // The handleRequest is implemented in a subclass for mongod/mongos and actually all the
     // database work for this request.
     DbResponse dbresponse = _sep->handleRequest(opCtx.get(), _inMessage);
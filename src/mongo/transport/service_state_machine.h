@@ -44,6 +44,7 @@
 #include "mongo/transport/service_executor_task_names.h"
 #include "mongo/transport/session.h"
 #include "mongo/transport/transport_mode.h"
+#include "mongo/util/tick_source.h"
 
 namespace mongo {
 
@@ -230,6 +231,10 @@ private:
     boost::optional<MessageCompressorId> _compressorId;
     Message _inMessage;
 
+    // Tick at which _inMessage was received, used to account for the time a request waits to be
+    // processed when operation phase tracing is enabled. Zero if not recorded.
+    TickSource::Tick _inMessageReceivedTicks = 0;
+
     AtomicWord<Ownership> _owned{Ownership::kUnowned};
 #if MONGO_CONFIG_DEBUG_BUILD
     AtomicWord<stdx::thread::id> _owningThread;
@@ -36,6 +36,7 @@
 #include <set>
 
 #include "mongo/base/data_type_endian.h"
+#include "mongo/base/data_view.h"
 #include "mongo/db/bson/dotted_path_support.h"
 #include "mongo/rpc/object_check.h"
 #include "mongo/util/bufreader.h"
@@ -57,6 +58,25 @@ enum class Section : uint8_t {
     kDocSequence = 1,
 };
 
+/**
+ * Returns the number of documents in the document sequence payload [data, data + length) by
+ * following the length prefix of each document. Nothing is validated here: counting stops at the
+ * first length that does not fit in the remaining bytes, and the validating parse reports it.
+ */
+size_t countDocumentsInSequence(const char* data, size_t length) {
+    size_t count = 0;
+    while (length >= sizeof(int32_t)) {
+        const auto docSize = ConstDataView(data).read<LittleEndian<int32_t>>();
+        if (docSize < BSONObj::kMinBSONLength || static_cast<size_t>(docSize) > length)
+            break;
+
+        data += docSize;
+        length -= docSize;
+        ++count;
+    }
+    return count;
+}
+
 }  // namespace
 
 uint32_t OpMsg::flags(const Message& message) {
@@ -125,8 +145,15 @@ OpMsg OpMsg::parse(const Message& message) try {
                         !msg.getSequence(name));  // TODO IDL
 
                 msg.sequences.push_back({name.toString()});
+
+                // Size the vector up front so that large sequences (e.g. bulk inserts) are not
+                // repeatedly reallocated while the documents are validated. The documents are
+                // views into the message buffer and are not copied.
+                auto& objs = msg.sequences.back().objs;
+                objs.reserve(countDocumentsInSequence(static_cast<const char*>(seqBuf.pos()),
+                                                      seqBuf.remaining()));
                 while (!seqBuf.atEof()) {
-                    msg.sequences.back().objs.push_back(seqBuf.read<Validated<BSONObj>>());
+                    objs.push_back(seqBuf.read<Validated<BSONObj>>().val);
                 }
                 break;
             }
@@ -205,6 +205,75 @@ TEST_F(OpMsgParser, SucceedsWithBodyThenSequence) {
     ASSERT_BSONOBJ_EQ(msg.sequences[0].objs[1], fromjson("{a: 2}"));
 }
 
+TEST_F(OpMsgParser, DocumentSequenceIsViewOfMessageBuffer) {
+    auto message = OpMsgBytes{
+        kNoFlags,  //
+        kBodySection,
+        fromjson("{insert: 'coll', $db: 'db'}"),
+
+        kDocSequenceSection,
+        Sized{
+            "documents",  //
+            fromjson("{_id: 1}"),
+            fromjson("{_id: 2}"),
+            fromjson("{_id: 3}"),
+        },
+    }.done();
+
+    const auto msg = OpMsg::parse(message);
+    ASSERT_EQ(msg.sequences.size(), 1u);
+    ASSERT_EQ(msg.sequences[0].objs.size(), 3u);
+
+    const char* const messageBegin = message.buf();
+    const char* const messageEnd = message.buf() + message.size();
+    for (const auto& obj : msg.sequences[0].objs) {
+        ASSERT_FALSE(obj.isOwned());
+        ASSERT_GTE(obj.objdata(), messageBegin);
+        ASSERT_LTE(obj.objdata() + obj.objsize(), messageEnd);
+    }
+    ASSERT_BSONOBJ_EQ(msg.sequences[0].objs[2], fromjson("{_id: 3}"));
+}
+
+TEST_F(OpMsgParser, DocumentSequenceIsSizedFromLengthPrefixes) {
+    auto msg = OpMsgBytes{
+        kNoFlags,  //
+        kBodySection,
+        fromjson("{insert: 'coll', $db: 'db'}"),
+
+        kDocSequenceSection,
+        Sized{
+            "documents",  //
+            fromjson("{_id: 1}"),
+            fromjson("{_id: 2}"),
+            fromjson("{_id: 3}"),
+            fromjson("{_id: 4}"),
+            fromjson("{_id: 5}"),
+        },
+    }.parse();
+
+    ASSERT_EQ(msg.sequences.size(), 1u);
+    ASSERT_EQ(msg.sequences[0].objs.size(), 5u);
+    ASSERT_EQ(msg.sequences[0].objs.capacity(), 5u);
+    ASSERT_BSONOBJ_EQ(msg.sequences[0].objs[4], fromjson("{_id: 5}"));
+}
+
+TEST_F(OpMsgParser, FailsIfDocumentInSequenceTooSmall) {
+    auto msg = OpMsgBytes{
+        kNoFlags,  //
+        kBodySection,
+        fromjson("{ping: 1}"),
+
+        kDocSequenceSection,
+        Sized{
+            "docs",  //
+            fromjson("{a: 1}"),
+            int32_t{4},  // Length prefix of a document shorter than the smallest BSON object.
+        },
+    };
+
+    ASSERT_THROWS_CODE(msg.parse(), AssertionException, ErrorCodes::InvalidBSON);
+}
+
 TEST_F(OpMsgParser, SucceedsWithSequenceThenBody) {
     auto msg = OpMsgBytes{
         kNoFlags,  //
@@ -0,0 +1,378 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "mongo/util/assert_util.h"
+
+namespace mongo {
+
+/**
+ * An ordered map with unique keys whose copies share storage, so that making a modified copy of a
+ * large map costs time proportional to the size of the modification rather than to the size of
+ * the map.
+ *
+ * The entries are kept in sorted blocks of at most 'MaxBlockSize' entries, referenced from an
+ * ordered vector of blocks. Copying the map copies only the vector of block pointers; a block is
+ * cloned the first time a map which shares it modifies it, and is modified in place while it is
+ * owned by a single map. With n entries and block size B, copying costs O(n / B), lookups cost
+ * O(log n) and each insertion or erasure touches O(B) entries besides the copy of the block
+ * vector.
+ *
+ * Only const iteration is supported. Like for std::vector, any modification of the map
+ * invalidates its iterators. Distinct copies may be used concurrently from different threads,
+ * but a single instance is not thread safe.
+ */
+template <typename Key, typename T, std::size_t MaxBlockSize = 128>
+class PersistentOrderedMap {
+    static_assert(MaxBlockSize >= 4, "blocks must be able to hold at least 4 entries");
+
+public:
+    using key_type = Key;
+    using mapped_type = T;
+    using value_type = std::pair<Key, T>;
+    using size_type = std::size_t;
+
+private:
+    using Block = std::vector<value_type>;
+    using BlockVector = std::vector<std::shared_ptr<Block>>;
+
+public:
+    class const_iterator {
+    public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = PersistentOrderedMap::value_type;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const value_type*;
+        using reference = const value_type&;
+
+        const_iterator() = default;
+
+        reference operator*() const {
+            return (*(*_blocks)[_block])[_pos];
+        }
+
+        pointer operator->() const {
+            return &**this;
+        }
+
+        const_iterator& operator++() {
+            if (++_pos == (*_blocks)[_block]->size()) {
+                ++_block;
+                _pos = 0;
+            }
+            return *this;
+        }
+
+        const_iterator operator++(int) {
+            auto old = *this;
+            ++*this;
+            return old;
+        }
+
+        const_iterator& operator--() {
+            if (_pos == 0) {
+                --_block;
+                _pos = (*_blocks)[_block]->size();
+            }
+            --_pos;
+            return *this;
+        }
+
+        const_iterator operator--(int) {
+            auto old = *this;
+            --*this;
+            return old;
+        }
+
+        bool operator==(const const_iterator& other) const {
+            return _block == other._block && _pos == other._pos;
+        }
+
+        bool operator!=(const const_iterator& other) const {
+            return !(*this == other);
+        }
+
+    private:
+        friend class PersistentOrderedMap;
+
+        const_iterator(const BlockVector* blocks, std::size_t block, std::size_t pos)
+            : _blocks(blocks), _block(block), _pos(pos) {}
+
+        const BlockVector* _blocks = nullptr;
+        std::size_t _block = 0;
+        std::size_t _pos = 0;
+    };
+
+    using iterator = const_iterator;
+
+    bool empty() const {
+        return _size == 0;
+    }
+
+    size_type size() const {
+        return _size;
+    }
+
+    const_iterator begin() const {
+        return {&_blocks, 0, 0};
+    }
+
+    const_iterator end() const {
+        return {&_blocks, _blocks.size(), 0};
+    }
+
+    const_iterator cbegin() const {
+        return begin();
+    }
+
+    const_iterator cend() const {
+        return end();
+    }
+
+    /**
+     * Returns an iterator to the first entry whose key is greater than 'key'.
+     */
+    const_iterator upper_bound(const Key& key) const {
+        const auto block = std::upper_bound(
+            _blocks.begin(), _blocks.end(), key, [](const Key& k, const std::shared_ptr<Block>& b) {
+                return k < b->back().first;
+            });
+        if (block == _blocks.end()) {
+            return end();
+        }
+
+        const auto pos = std::upper_bound(
+            (*block)->begin(), (*block)->end(), key, [](const Key& k, const value_type& entry) {
+                return k < entry.first;
+            });
+        return {&_blocks,
+                static_cast<std::size_t>(block - _blocks.begin()),
+                static_cast<std::size_t>(pos - (*block)->begin())};
+    }
+
+    /**
+     * Returns an iterator to the first entry whose key is not less than 'key'.
+     */
+    const_iterator lower_bound(const Key& key) const {
+        const auto block = std::lower_bound(
+            _blocks.begin(), _blocks.end(), key, [](const std::shared_ptr<Block>& b, const Key& k) {
+                return b->back().first < k;
+            });
+        if (block == _blocks.end()) {
+            return end();
+        }
+
+        const auto pos = std::lower_bound(
+            (*block)->begin(), (*block)->end(), key, [](const value_type& entry, const Key& k) {
+                return entry.first < k;
+            });
+        return {&_blocks,
+                static_cast<std::size_t>(block - _blocks.begin()),
+                static_cast<std::size_t>(pos - (*block)->begin())};
+    }
+
+    const_iterator find(const Key& key) const {
+        const auto it = lower_bound(key);
+        if (it == end() || key < it->first) {
+            return end();
+        }
+        return it;
+    }
+
+    /**
+     * Inserts 'entry' unless an entry with the same key already exists. Returns an iterator to the
+     * entry with that key and whether the insertion took place.
+     */
+    std::pair<const_iterator, bool> insert(value_type entry) {
+        if (_blocks.empty()) {
+            _blocks.push_back(std::make_shared<Block>());
+            _blocks.back()->push_back(std::move(entry));
+            _size = 1;
+            return {begin(), true};
+        }
+
+        // Insert into the first block whose last key is not less than the new key, or append to
+        // the last block if the new key is greater than all the existing ones.
+        auto blockIt = std::lower_bound(
+            _blocks.begin(),
+            _blocks.end(),
+            entry.first,
+            [](const std::shared_ptr<Block>& b, const Key& k) { return b->back().first < k; });
+        if (blockIt == _blocks.end()) {
+            --blockIt;
+        }
+        auto blockIdx = static_cast<std::size_t>(blockIt - _blocks.begin());
+
+        auto pos = static_cast<std::size_t>(
+            std::lower_bound(_blocks[blockIdx]->begin(),
+                             _blocks[blockIdx]->end(),
+                             entry.first,
+                             [](const value_type& e, const Key& k) { return e.first < k; }) -
+            _blocks[blockIdx]->begin());
+        if (pos < _blocks[blockIdx]->size() && !(entry.first < (*_blocks[blockIdx])[pos].first)) {
+            return {const_iterator(&_blocks, blockIdx, pos), false};
+        }
+
+        Block& block = _mutableBlock(blockIdx);
+        block.insert(block.begin() + pos, std::move(entry));
+        ++_size;
+
+        if (block.size() > MaxBlockSize) {
+            // Split the block in half, moving the upper half into a new block right after it.
+            const auto half = block.size() / 2;
+            auto upper = std::make_shared<Block>(std::make_move_iterator(block.begin() + half),
+                                                 std::make_move_iterator(block.end()));
+            block.erase(block.begin() + half, block.end());
+            _blocks.insert(_blocks.begin() + blockIdx + 1, std::move(upper));
+
+            if (pos >= half) {
+                ++blockIdx;
+                pos -= half;
+            }
+        }
+
+        return {const_iterator(&_blocks, blockIdx, pos), true};
+    }
+
+    /**
+     * Removes the entries in the range [first, last).
+     */
+    void erase(const_iterator first, const_iterator last) {
+        invariant(first._blocks == &_blocks && last._blocks == &_blocks);
+        if (first == last) {
+            return;
+        }
+
+        if (first._block == last._block) {
+            Block& block = _mutableBlock(first._block);
+            block.erase(block.begin() + first._pos, block.begin() + last._pos);
+            _size -= last._pos - first._pos;
+            _removeOrMergeBlock(first._block);
+            return;
+        }
+
+        // Trim the tail of the first block, drop the blocks in between and trim the head of the
+        // last one, cloning only the two partially erased blocks.
+        std::size_t eraseBlocksBegin = first._block;
+        if (first._pos > 0) {
+            Block& block = _mutableBlock(first._block);
+            _size -= block.size() - first._pos;
+            block.erase(block.begin() + first._pos, block.end());
+            ++eraseBlocksBegin;
+        }
+
+        for (auto i = eraseBlocksBegin; i < last._block; ++i) {
+            _size -= _blocks[i]->size();
+        }
+        if (last._block < _blocks.size() && last._pos > 0) {
+            Block& block = _mutableBlock(last._block);
+            block.erase(block.begin(), block.begin() + last._pos);
+            _size -= last._pos;
+        }
+
+        _blocks.erase(_blocks.begin() + eraseBlocksBegin, _blocks.begin() + last._block);
+
+        // The blocks on either side of the erased range may now be small enough to merge.
+        if (eraseBlocksBegin < _blocks.size()) {
+            _removeOrMergeBlock(eraseBlocksBegin);
+        }
+        if (eraseBlocksBegin > 0 && eraseBlocksBegin - 1 < _blocks.size()) {
+            _removeOrMergeBlock(eraseBlocksBegin - 1);
+        }
+    }
+
+    void erase(const_iterator pos) {
+        auto next = pos;
+        erase(pos, ++next);
+    }
+
+    void clear() {
+        _blocks.clear();
+        _size = 0;
+    }
+
+private:
+    /**
+     * Returns the block at 'blockIdx' for modification, first cloning it if it is shared with
+     * another map.
+     */
+    Block& _mutableBlock(std::size_t blockIdx) {
+        auto& block = _blocks[blockIdx];
+        if (block.use_count() > 1) {
+            block = std::make_shared<Block>(*block);
+        }
+        return *block;
+    }
+
+    /**
+     * Removes the block at 'blockIdx' if it became empty, or merges it with a neighbour if it
+     * became small enough, so that the number of blocks stays proportional to the number of
+     * entries.
+     */
+    void _removeOrMergeBlock(std::size_t blockIdx) {
+        if (_blocks[blockIdx]->empty()) {
+            _blocks.erase(_blocks.begin() + blockIdx);
+            return;
+        }
+
+        if (_blocks[blockIdx]->size() >= MaxBlockSize / 4) {
+            return;
+        }
+
+        auto tryMerge = [this](std::size_t lower) {
+            if (_blocks[lower]->size() + _blocks[lower + 1]->size() > MaxBlockSize) {
+                return false;
+            }
+            const auto& upper = *_blocks[lower + 1];
+            Block& block = _mutableBlock(lower);
+            block.insert(block.end(), upper.begin(), upper.end());
+            _blocks.erase(_blocks.begin() + lower + 1);
+            return true;
+        };
+
+        if (blockIdx + 1 < _blocks.size() && tryMerge(blockIdx)) {
+            return;
+        }
+        if (blockIdx > 0) {
+            tryMerge(blockIdx - 1);
+        }
+    }
+
+    BlockVector _blocks;
+    size_type _size = 0;
+};
+
+}  // namespace mongo
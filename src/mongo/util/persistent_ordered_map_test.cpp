@@ -0,0 +1,197 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <map>
+#include <string>
+
+#include "mongo/platform/random.h"
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/persistent_ordered_map.h"
+
+namespace mongo {
+namespace {
+
+// Use tiny blocks so that the tests exercise block splits, merges and multi-block erasures.
+using TestMap = PersistentOrderedMap<int, std::string, 4>;
+
+void assertSameContents(const std::map<int, std::string>& expected, const TestMap& actual) {
+    ASSERT_EQUALS(expected.size(), actual.size());
+    ASSERT_EQUALS(expected.empty(), actual.empty());
+
+    auto expectedIt = expected.begin();
+    for (auto it = actual.begin(); it != actual.end(); ++it, ++expectedIt) {
+        ASSERT_EQUALS(expectedIt->first, it->first);
+        ASSERT_EQUALS(expectedIt->second, it->second);
+    }
+
+    // Walk backwards as well, across the block boundaries.
+    auto expectedRIt = expected.rbegin();
+    for (auto it = actual.end(); it != actual.begin(); ++expectedRIt) {
+        --it;
+        ASSERT_EQUALS(expectedRIt->first, it->first);
+    }
+}
+
+TEST(PersistentOrderedMapTest, EmptyMap) {
+    TestMap map;
+    ASSERT_TRUE(map.empty());
+    ASSERT_EQUALS(0U, map.size());
+    ASSERT(map.begin() == map.end());
+    ASSERT(map.upper_bound(0) == map.end());
+    ASSERT(map.lower_bound(0) == map.end());
+    ASSERT(map.find(0) == map.end());
+}
+
+TEST(PersistentOrderedMapTest, InsertKeepsEntriesOrdered) {
+    TestMap map;
+    std::map<int, std::string> expected;
+    for (int i : {5, 1, 9, 3, 7, 2, 8, 0, 6, 4, 11, 10}) {
+        auto result = map.insert({i, std::to_string(i)});
+        ASSERT_TRUE(result.second);
+        ASSERT_EQUALS(i, result.first->first);
+        expected.emplace(i, std::to_string(i));
+    }
+    assertSameContents(expected, map);
+
+    // Inserting an existing key does not replace its value.
+    auto result = map.insert({3, "other"});
+    ASSERT_FALSE(result.second);
+    ASSERT_EQUALS("3", result.first->second);
+    assertSameContents(expected, map);
+}
+
+TEST(PersistentOrderedMapTest, Bounds) {
+    TestMap map;
+    for (int i = 0; i < 40; i += 2) {
+        map.insert({i, std::to_string(i)});
+    }
+
+    ASSERT_EQUALS(0, map.upper_bound(-1)->first);
+    ASSERT_EQUALS(12, map.upper_bound(10)->first);
+    ASSERT_EQUALS(12, map.upper_bound(11)->first);
+    ASSERT(map.upper_bound(38) == map.end());
+
+    ASSERT_EQUALS(10, map.lower_bound(10)->first);
+    ASSERT_EQUALS(12, map.lower_bound(11)->first);
+    ASSERT(map.lower_bound(39) == map.end());
+
+    ASSERT_EQUALS("20", map.find(20)->second);
+    ASSERT(map.find(21) == map.end());
+}
+
+TEST(PersistentOrderedMapTest, EraseRanges) {
+    TestMap map;
+    std::map<int, std::string> expected;
+    for (int i = 0; i < 100; ++i) {
+        map.insert({i, std::to_string(i)});
+        expected.emplace(i, std::to_string(i));
+    }
+
+    // Within a block, across many blocks, a single entry and the tail of the map.
+    map.erase(map.find(1), map.find(3));
+    expected.erase(expected.find(1), expected.find(3));
+    assertSameContents(expected, map);
+
+    map.erase(map.find(10), map.find(60));
+    expected.erase(expected.find(10), expected.find(60));
+    assertSameContents(expected, map);
+
+    map.erase(map.find(0));
+    expected.erase(expected.find(0));
+    assertSameContents(expected, map);
+
+    map.erase(map.find(90), map.end());
+    expected.erase(expected.find(90), expected.end());
+    assertSameContents(expected, map);
+
+    map.erase(map.begin(), map.end());
+    ASSERT_TRUE(map.empty());
+    ASSERT(map.begin() == map.end());
+}
+
+TEST(PersistentOrderedMapTest, ModifyingACopyLeavesTheOriginalUnchanged) {
+    TestMap original;
+    std::map<int, std::string> expectedOriginal;
+    for (int i = 0; i < 50; ++i) {
+        original.insert({i, std::to_string(i)});
+        expectedOriginal.emplace(i, std::to_string(i));
+    }
+
+    TestMap copy = original;
+    std::map<int, std::string> expectedCopy = expectedOriginal;
+
+    copy.erase(copy.find(20), copy.find(30));
+    expectedCopy.erase(expectedCopy.find(20), expectedCopy.find(30));
+    copy.insert({100, "100"});
+    expectedCopy.emplace(100, "100");
+    copy.insert({-1, "-1"});
+    expectedCopy.emplace(-1, "-1");
+
+    assertSameContents(expectedCopy, copy);
+    assertSameContents(expectedOriginal, original);
+
+    // And the other way around.
+    original.erase(original.begin(), original.find(40));
+    expectedOriginal.erase(expectedOriginal.begin(), expectedOriginal.find(40));
+    assertSameContents(expectedOriginal, original);
+    assertSameContents(expectedCopy, copy);
+}
+
+TEST(PersistentOrderedMapTest, RandomizedOperationsMatchStdMap) {
+    PseudoRandom random(12345);
+
+    TestMap map;
+    std::map<int, std::string> expected;
+    std::vector<std::pair<TestMap, std::map<int, std::string>>> snapshots;
+
+    for (int round = 0; round < 2000; ++round) {
+        const int key = random.nextInt32(500);
+        if (random.nextInt32(3) != 0) {
+            const bool inserted = map.insert({key, std::to_string(round)}).second;
+            ASSERT_EQUALS(expected.emplace(key, std::to_string(round)).second, inserted);
+        } else {
+            const int last = key + random.nextInt32(20);
+            map.erase(map.lower_bound(key), map.lower_bound(last));
+            expected.erase(expected.lower_bound(key), expected.lower_bound(last));
+        }
+
+        if (round % 100 == 0) {
+            snapshots.emplace_back(map, expected);
+        }
+    }
+
+    assertSameContents(expected, map);
+    for (const auto& snapshot : snapshots) {
+        assertSameContents(snapshot.second, snapshot.first);
+    }
+}
+
+}  // namespace
+}  // namespace mongo